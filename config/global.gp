@@ -25,6 +25,11 @@
 #
 screenpath "/tmp/"
 
+# Write the performance stats of each second to the CSV file. Use "-" to write
+# stats to stdout. Press "i" twice to see the same stats on screen.
+#
+#statsfile "/tmp/gp-stats.csv"
+
 # Preload buffer length (in bytes). A larger value improves file loading performance.
 #
 preload 8388608
@@ -34,10 +39,27 @@ preload 8388608
 #
 chunk 4096
 
+# Map regular binary files (fp32 and fp64) into memory instead of reading them
+# through preload buffer. This greatly speeds up opening of large files.
+#
+mmap 1
+
+# Keep the parsed text datasets in the sidecar file ("file.csv.gpc") next to
+# the source file. The next open of the same file takes data from sidecar
+# without parsing and reads only the appended part of file.
+#
+sidecar 0
+
 # How long to wait (in milliseconds) for the new data in regular files.
 #
 timeout 5000
 
+# What to do when the stub dataset ring (of preload size) is full. By default
+# the rows are dropped. Enable backpressure to make the producer wait for the
+# reader up to the timeout above.
+#
+backpressure 0
+
 # Data length to allocate (number of lines). Define 0 to allocate unlimited.
 #
 length 0
@@ -110,6 +132,12 @@ shortfilename 1
 #
 fastdraw 200
 
+# Present the frames through SDL_Renderer streaming texture and upload only
+# the changed area of the screen (0 = "window surface", 1 = "renderer"). This
+# may save the frame time on HiDPI or remote displays.
+#
+renderer 0
+
 # Interpolation method of resample operation (0 = "nearest", 1 = "linear").
 #
 interpolation 1
@@ -123,3 +151,39 @@ defungap 10
 #
 lz4_compress 1
 
+# Apply XOR of each value with the previous one in column before LZ4 which
+# gives a better compression ratio on slow changing data. Data of fp32 files
+# are also kept compressed in single precision.
+#
+lz4_filter 1
+
+# Number of uncompressed chunks to keep in cache of LZ4 compressed dataset. Can
+# be used after dataset definition to resize cache of this dataset only.
+#
+cache 4
+
+# RAM budget in MB for LZ4 compressed chunks of all datasets (0 = "unlimited").
+# The least recently used chunks above the budget are spilled to a temporary
+# file and read back on demand.
+#
+spill 0
+
+# Store dataset chunks column by column instead of row by row. This speeds up
+# drawing of wide datasets (many columns) and improves LZ4 compression ratio.
+#
+columnar 0
+
+# Draw each bucket of rows that fits in one pixel by its min/max range instead
+# of every single segment (0 = "disabled", 1 = "enabled"). This makes drawing
+# of huge zoomed out datasets fast.
+#
+lod 1
+
+# Draw only the rows appended since the last frame while the view does not
+# change (0 = "disabled", 1 = "enabled"). This keeps the frame cost of live
+# data streams constant regardless of the history length. When the view is
+# moved by integer number of pixels the previous frame is shifted and only the
+# exposed strips are drawn from the dataset.
+#
+incremental 1
+
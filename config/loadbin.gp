@@ -17,6 +17,11 @@ include "global.gp"
 load 0 0 fp32 100 "tlmdata.f"
 #load 0 0 fp64 50 "tlmdata.d"
 
+# The data exported from plot into ".f32" or ".f64" file can be loaded back
+# the same way. The number of columns is the number of exported ones.
+#
+#load 1 0 fp32 4 "g0f0.f32"
+
 # Use the "stub" dataset type if you intend to load data by API calls.
 #
 #load 0 0 stub 10
@@ -30,6 +35,17 @@ load 0 0 fp32 100 "tlmdata.f"
 #
 #load 0 0 stdin
 
+# The name of "csv", "fp32" or "fp64" dataset can be the socket address. Use
+# "udp://[host]:port" to receive datagrams on the local port or "tcp://"
+# to connect to the server. Each datagram must hold the whole binary rows or
+# text lines, the malformed ones are counted as lost. UDP socket is kept open
+# through any pause of the sender, TCP one is closed after "timeout" of
+# silence. CSV socket needs the data to come while loading to detect the
+# number of columns.
+#
+#load 0 10000 fp32 8 "udp://:9000"
+#load 0 10000 csv "tcp://localhost:9001"
+
 # Select the dataset by ID. Make sense only if there are several ones.
 #
 bind 0
@@ -55,7 +71,7 @@ deflabel 1 "Line"
 # Time median transform of the group that applied by default.
 #
 # <1> Group ID.
-# <2> Median length.
+# <2> Median length (up to 65535).
 # <3> Time unwrap flag (optional).
 # <4> Data median flag (optional).
 #
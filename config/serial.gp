@@ -9,6 +9,7 @@ chunk 20
 #
 load 0 10000 csv "/dev/rfcomm0"
 #load 0 10000 csv "//./COM1"
+#load 0 10000 csv "udp://:9000"
 mkpages -1
 
 group 0 -1
@@ -21,11 +21,44 @@
 #include <string.h>
 #include <errno.h>
 
+#ifdef _WINDOWS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else /* _WINDOWS */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif /* _WINDOWS */
+
 #include <SDL2/SDL.h>
 
 #include "async.h"
 #include "plot.h"
 
+#define ASYNC_DATAGRAM_MAX		65536
+#define ASYNC_POLL_TIMEOUT		100
+
+#ifdef _WINDOWS
+typedef SOCKET			async_sock_t;
+
+#define ASYNC_SOCK_INVALID		INVALID_SOCKET
+#define async_sock_close		closesocket
+#define async_sock_poll			WSAPoll
+#define async_sock_again()		(WSAGetLastError() == WSAEWOULDBLOCK)
+#define async_sock_progress()		(WSAGetLastError() == WSAEWOULDBLOCK)
+#else /* _WINDOWS */
+typedef int			async_sock_t;
+
+#define ASYNC_SOCK_INVALID		(-1)
+#define async_sock_close		close
+#define async_sock_poll			poll
+#define async_sock_again()		(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+#define async_sock_progress()		(errno == EINPROGRESS)
+#endif /* _WINDOWS */
+
 static int
 async_READ(async_FILE *afd)
 {
@@ -85,6 +118,262 @@ async_READ(async_FILE *afd)
 	return 0;
 }
 
+static const char *
+async_sock_strerror()
+{
+#ifdef _WINDOWS
+	static char	msg[40];
+
+	sprintf(msg, "WSA error %i", WSAGetLastError());
+
+	return msg;
+#else /* _WINDOWS */
+	return strerror(errno);
+#endif /* _WINDOWS */
+}
+
+static int
+async_sock_recv(async_FILE *afd, char *raw, int len)
+{
+#ifdef SO_RXQ_OVFL
+	struct msghdr	msg;
+	struct iovec	iov;
+	struct cmsghdr	*cm;
+
+	char		ctl[CMSG_SPACE(sizeof(Uint32))];
+	Uint32		ovfl;
+	int		rc;
+
+	iov.iov_base = raw;
+	iov.iov_len = len;
+
+	memset(&msg, 0, sizeof(msg));
+
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctl;
+	msg.msg_controllen = sizeof(ctl);
+
+	rc = (int) recvmsg((async_sock_t) afd->sock, &msg, 0);
+
+	if (rc >= 0) {
+
+		for (cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)) {
+
+			if (		cm->cmsg_level == SOL_SOCKET
+					&& cm->cmsg_type == SO_RXQ_OVFL) {
+
+				/* The kernel counts the datagrams dropped
+				 * since the socket was opened.
+				 * */
+				memcpy(&ovfl, CMSG_DATA(cm), sizeof(ovfl));
+
+				SDL_AtomicAdd(&afd->dropped, (int) (ovfl - afd->overflow));
+
+				afd->overflow = ovfl;
+			}
+		}
+	}
+
+	return rc;
+#else /* SO_RXQ_OVFL */
+	return (int) recv((async_sock_t) afd->sock, raw, len, 0);
+#endif /* SO_RXQ_OVFL */
+}
+
+static void
+async_sock_datagram(async_FILE *afd, int *wp, int nw)
+{
+	char		*raw;
+	int		len, nb;
+
+	/* Receive straight into the ring when the largest datagram fits in
+	 * without the wrap. Otherwise it is copied from the packet buffer.
+	 * */
+	raw = (		afd->preload - *wp > ASYNC_DATAGRAM_MAX
+			&& nw > ASYNC_DATAGRAM_MAX) ? afd->stream + *wp : afd->pack;
+
+	len = async_sock_recv(afd, raw, ASYNC_DATAGRAM_MAX);
+
+	if (len <= 0)
+		return ;
+
+	afd->waiting = 0;
+
+	if (afd->frame != 0) {
+
+		if (len % afd->frame != 0) {
+
+			SDL_AtomicAdd(&afd->dropped, 1);
+			return ;
+		}
+	}
+	else if (raw[len - 1] != '\n') {
+
+		/* Each datagram is the complete text lines.
+		 * */
+		raw[len++] = '\n';
+	}
+
+	if (len > nw) {
+
+		SDL_AtomicAdd(&afd->dropped, 1);
+		return ;
+	}
+
+	if (raw == afd->pack) {
+
+		nb = afd->preload - *wp;
+		nb = (nb > len) ? len : nb;
+
+		memcpy(afd->stream + *wp, raw, nb);
+		memcpy(afd->stream, raw + nb, len - nb);
+	}
+
+	*wp += len;
+	*wp -= (*wp >= afd->preload) ? afd->preload : 0;
+
+	SDL_AtomicSet(&afd->wp, *wp);
+	SDL_AtomicAdd(&afd->accepted, 1);
+
+	afd->clock = SDL_GetTicks();
+}
+
+static int
+async_SOCKET(async_FILE *afd)
+{
+	struct pollfd	pfd;
+	int		rp, wp, nw, rc;
+
+	wp = SDL_AtomicGet(&afd->wp);
+
+	do {
+		rp = SDL_AtomicGet(&afd->rp);
+
+		nw = rp - (wp + 1);
+		nw += (nw < 0) ? afd->preload : 0;
+
+		if (afd->datagram == 0 && nw < 1) {
+
+			/* Stream is not read until there is a free space so
+			 * the sender is held back by TCP itself.
+			 * */
+			SDL_Delay(1);
+			continue;
+		}
+
+		pfd.fd = (async_sock_t) afd->sock;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+
+		rc = async_sock_poll(&pfd, 1, ASYNC_POLL_TIMEOUT);
+
+		if (rc == 0) {
+
+			/* Datagram source can be silent for any time as there
+			 * is no end of stream, only TCP is closed on timeout.
+			 * */
+			if (afd->datagram != 0)
+				continue;
+
+			if (afd->waiting < afd->timeout) {
+
+				afd->waiting += ASYNC_POLL_TIMEOUT;
+				continue;
+			}
+
+			break;
+		}
+		else if (rc < 0) {
+
+			if (async_sock_again())
+				continue;
+
+			ERROR("poll: %s\n", async_sock_strerror());
+			break;
+		}
+
+		if (afd->datagram != 0) {
+
+			async_sock_datagram(afd, &wp, nw);
+		}
+		else {
+			nw = (afd->preload - wp < nw) ? afd->preload - wp : nw;
+
+			rc = (int) recv((async_sock_t) afd->sock, afd->stream + wp, nw, 0);
+
+			if (rc > 0) {
+
+				wp += rc;
+				wp -= (wp >= afd->preload) ? afd->preload : 0;
+
+				SDL_AtomicSet(&afd->wp, wp);
+
+				afd->clock = SDL_GetTicks();
+				afd->waiting = 0;
+			}
+			else if (rc == 0 || async_sock_again() == 0) {
+
+				/* Connection was closed by peer.
+				 * */
+				break;
+			}
+		}
+	}
+	while (SDL_AtomicGet(&afd->flag_break) == 0);
+
+	async_sock_close((async_sock_t) afd->sock);
+
+	SDL_AtomicSet(&afd->flag_eof, 1);
+
+	return 0;
+}
+
+static int
+async_WRITE(async_FILE *afd)
+{
+	int		rp, wp, nr, brk;
+
+	rp = SDL_AtomicGet(&afd->rp);
+
+	do {
+		/* Take the break flag first so we do not miss the data that
+		 * was written before it.
+		 * */
+		brk = SDL_AtomicGet(&afd->flag_break);
+		wp = SDL_AtomicGet(&afd->wp);
+
+		nr = (wp < rp) ? afd->preload - rp : wp - rp;
+
+		if (nr > 0) {
+
+			nr = (nr > afd->chunk) ? afd->chunk : nr;
+
+			if ((int) fwrite(afd->stream + rp, 1, nr, afd->fd) != nr) {
+
+				SDL_AtomicAdd(&afd->dropped, nr);
+			}
+
+			rp += nr;
+			rp -= (rp >= afd->preload) ? afd->preload : 0;
+
+			SDL_AtomicSet(&afd->rp, rp);
+		}
+		else if (brk != 0) {
+
+			break;
+		}
+		else {
+			SDL_Delay(1);
+		}
+	}
+	while (1);
+
+	SDL_AtomicSet(&afd->flag_eof, 1);
+
+	return 0;
+}
+
 async_FILE *async_open(FILE *fd, int preload, int chunk, int timeout)
 {
 	async_FILE		*afd;
@@ -130,11 +419,256 @@ async_FILE *async_stub(int preload, int chunk, int timeout)
 	return afd;
 }
 
+static int
+async_sock_url(const char *url, char *host, char *port, int *datagram)
+{
+	const char	*s, *sep;
+	int		len;
+
+	if (strncmp(url, "udp://", 6) == 0) {
+
+		*datagram = 1;
+	}
+	else if (strncmp(url, "tcp://", 6) == 0) {
+
+		*datagram = 0;
+	}
+	else {
+		return -1;
+	}
+
+	s = url + 6;
+	sep = strrchr(s, ':');
+
+	if (sep == NULL || sep[1] == 0 || strlen(sep + 1) >= 16)
+		return -1;
+
+	len = sep - s;
+
+	if (		len >= 2 && s[0] == '['
+			&& s[len - 1] == ']') {
+
+		/* Take IPv6 address out of brackets.
+		 * */
+		s += 1;
+		len -= 2;
+	}
+
+	if (len >= 256)
+		return -1;
+
+	memcpy(host, s, len);
+	host[len] = 0;
+
+	strcpy(port, sep + 1);
+
+	return 0;
+}
+
+static int
+async_sock_connect(async_sock_t sock, const struct addrinfo *ai, int timeout)
+{
+	struct pollfd	pfd;
+	socklen_t	len;
+	int		err = 0;
+
+	if (connect(sock, ai->ai_addr, ai->ai_addrlen) == 0)
+		return 0;
+
+	if (async_sock_progress() == 0)
+		return -1;
+
+	pfd.fd = sock;
+	pfd.events = POLLOUT;
+	pfd.revents = 0;
+
+	timeout = (timeout < 1000) ? 1000 : timeout;
+
+	if (async_sock_poll(&pfd, 1, timeout) < 1) {
+
+		errno = ETIMEDOUT;
+		return -1;
+	}
+
+	len = sizeof(err);
+
+	getsockopt(sock, SOL_SOCKET, SO_ERROR, (char *) &err, &len);
+
+	if (err != 0) {
+
+		errno = err;
+		return -1;
+	}
+
+	return 0;
+}
+
+async_FILE *async_open_socket(const char *url, int preload, int chunk, int timeout, int frame)
+{
+	async_FILE		*afd;
+
+	struct addrinfo		hints, *res, *ai;
+	async_sock_t		sock = ASYNC_SOCK_INVALID;
+
+	char			host[256], port[16];
+	int			datagram, rc, opt;
+
+#ifdef _WINDOWS
+	static int		wsa_started = 0;
+	WSADATA			wsa;
+
+	if (wsa_started == 0) {
+
+		if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+
+			ERROR("WSAStartup: %s\n", async_sock_strerror());
+			return NULL;
+		}
+
+		wsa_started = 1;
+	}
+#endif /* _WINDOWS */
+
+	if (async_sock_url(url, host, port, &datagram) != 0) {
+
+		ERROR("Invalid socket address \"%s\"\n", url);
+		return NULL;
+	}
+
+	memset(&hints, 0, sizeof(hints));
+
+	hints.ai_family = (host[0] != 0) ? AF_UNSPEC : AF_INET;
+	hints.ai_socktype = (datagram != 0) ? SOCK_DGRAM : SOCK_STREAM;
+	hints.ai_flags = (datagram != 0) ? AI_PASSIVE : 0;
+
+	rc = getaddrinfo((host[0] != 0) ? host : NULL, port, &hints, &res);
+
+	if (rc != 0) {
+
+		ERROR("getaddrinfo(\"%s\"): %s\n", url, gai_strerror(rc));
+		return NULL;
+	}
+
+	for (ai = res; ai != NULL; ai = ai->ai_next) {
+
+		sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+		if (sock == ASYNC_SOCK_INVALID)
+			continue;
+
+		/* Let the kernel keep as much data as the ring does so the
+		 * bursts are not lost while we are busy.
+		 * */
+		opt = preload;
+		setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (const char *) &opt, sizeof(opt));
+
+#ifdef _WINDOWS
+		u_long		nbio = 1;
+
+		ioctlsocket(sock, FIONBIO, &nbio);
+#else /* _WINDOWS */
+		fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif /* _WINDOWS */
+
+		if (datagram != 0) {
+
+			opt = 1;
+			setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char *) &opt, sizeof(opt));
+#ifdef SO_RXQ_OVFL
+			setsockopt(sock, SOL_SOCKET, SO_RXQ_OVFL, &opt, sizeof(opt));
+#endif /* SO_RXQ_OVFL */
+
+			rc = bind(sock, ai->ai_addr, ai->ai_addrlen);
+		}
+		else {
+			rc = async_sock_connect(sock, ai, timeout);
+		}
+
+		if (rc == 0)
+			break;
+
+		async_sock_close(sock);
+
+		sock = ASYNC_SOCK_INVALID;
+	}
+
+	freeaddrinfo(res);
+
+	if (sock == ASYNC_SOCK_INVALID) {
+
+		ERROR("Unable to open socket \"%s\": %s\n", url, async_sock_strerror());
+		return NULL;
+	}
+
+	afd = (async_FILE *) calloc(1, sizeof(async_FILE));
+
+	afd->preload = preload;
+	afd->chunk = chunk;
+	afd->timeout = timeout;
+
+	afd->stream = (char *) malloc(afd->preload);
+	afd->pack = (char *) malloc(ASYNC_DATAGRAM_MAX + 1);
+
+	if (afd->stream == NULL || afd->pack == NULL) {
+
+		ERROR("No memory allocated for async preload\n");
+
+		async_sock_close(sock);
+		return NULL;
+	}
+
+	afd->sock = (intptr_t) sock;
+	afd->datagram = datagram;
+	afd->frame = frame;
+
+	afd->clock = SDL_GetTicks();
+
+	afd->thread = SDL_CreateThread((int (*) (void *)) &async_SOCKET, "async_SOCKET", afd);
+
+	return afd;
+}
+
+async_FILE *async_open_write(FILE *fd, int preload, int chunk)
+{
+	async_FILE		*afd;
+
+	afd = (async_FILE *) calloc(1, sizeof(async_FILE));
+
+	afd->preload = preload;
+	afd->chunk = chunk;
+	afd->writing = 1;
+
+	afd->stream = (char *) malloc(afd->preload);
+
+	if (afd->stream == NULL) {
+
+		ERROR("No memory allocated for async preload\n");
+		return NULL;
+	}
+
+	afd->fd = fd;
+	afd->thread = SDL_CreateThread((int (*) (void *)) &async_WRITE, "async_WRITE", afd);
+
+	return afd;
+}
+
 void async_close(async_FILE *afd)
 {
 	int		tN = 0;
 
 	SDL_AtomicSet(&afd->flag_break, 1);
+
+	if (afd->writing != 0) {
+
+		/* Wait for the writer to flush all of the data.
+		 * */
+		SDL_WaitThread(afd->thread, NULL);
+
+		free(afd->stream);
+		free(afd);
+		return ;
+	}
+
 	SDL_DetachThread(afd->thread);
 
 	do {
@@ -143,6 +677,7 @@ void async_close(async_FILE *afd)
 		if (SDL_AtomicGet(&afd->flag_eof) != 0) {
 
 			free(afd->stream);
+			free(afd->pack);
 			free(afd);
 			break;
 		}
@@ -158,41 +693,69 @@ void async_close(async_FILE *afd)
 	while (1);
 }
 
-int async_write(async_FILE *afd, const char *raw, int n)
+int async_write_block(async_FILE *afd, const char *raw, int size, int *n)
 {
-	int		rp, wp, nw;
-
-	rp = SDL_AtomicGet(&afd->rp);
-	wp = SDL_AtomicGet(&afd->wp);
-
-	nw = (wp < rp) ? rp - wp : rp + afd->preload - wp;
+	int		rp, wr, we, nw, nb;
 
-	if (nw > n) {
+	do {
+		/* Take the reserve pointer first so the read pointer is not
+		 * older than it.
+		 * */
+		wr = SDL_AtomicGet(&afd->wr);
+		rp = SDL_AtomicGet(&afd->rp);
 
-		if (wp + n >= afd->preload) {
+		nw = (wr < rp) ? rp - wr : rp + afd->preload - wr;
+		nw = (nw - 1) / size;
+		nw = (nw > *n) ? *n : nw;
 
-			nw = afd->preload - wp;
+		if (nw < 1) {
 
-			memcpy(afd->stream + wp, raw, nw);
-			memcpy(afd->stream, raw + nw, n - nw);
-
-			wp += n - afd->preload;
+			return ASYNC_NO_FREE_SPACE;
 		}
-		else {
-			memcpy(afd->stream + wp, raw, n);
 
-			wp += n;
-		}
+		nb = nw * size;
 
-		afd->clock = SDL_GetTicks();
+		we = wr + nb;
+		we -= (we >= afd->preload) ? afd->preload : 0;
+	}
+	while (SDL_AtomicCAS(&afd->wr, wr, we) == SDL_FALSE);
 
-		SDL_AtomicSet(&afd->wp, wp);
+	if (wr + nb > afd->preload) {
 
-		return ASYNC_OK;
+		nw = afd->preload - wr;
+
+		memcpy(afd->stream + wr, raw, nw);
+		memcpy(afd->stream, raw + nw, nb - nw);
 	}
 	else {
-		return ASYNC_NO_FREE_SPACE;
+		memcpy(afd->stream + wr, raw, nb);
+	}
+
+	/* Wait for the previous writers to publish their data. Yield the
+	 * processor if the writer we wait for was preempted.
+	 * */
+	for (nw = 0; SDL_AtomicCAS(&afd->wp, wr, we) == SDL_FALSE; ++nw) {
+
+		if (nw >= 100) {
+
+			SDL_Delay(0);
+		}
 	}
+
+	afd->clock = SDL_GetTicks();
+
+	SDL_AtomicAdd(&afd->accepted, nb / size);
+
+	*n = nb / size;
+
+	return ASYNC_OK;
+}
+
+int async_write(async_FILE *afd, const char *raw, int n)
+{
+	int		nw = 1;
+
+	return async_write_block(afd, raw, n, &nw);
 }
 
 int async_read(async_FILE *afd, char *raw, int n)
@@ -234,6 +797,51 @@ int async_read(async_FILE *afd, char *raw, int n)
 	}
 }
 
+int async_read_block(async_FILE *afd, char *raw, int size, int *n)
+{
+	int		rp, wp, nr, nb;
+
+	rp = SDL_AtomicGet(&afd->rp);
+	wp = SDL_AtomicGet(&afd->wp);
+
+	nr = (wp < rp) ? wp + afd->preload - rp : wp - rp;
+	nr = nr / size;
+	nr = (nr > *n) ? *n : nr;
+
+	if (nr > 0) {
+
+		nb = nr * size;
+
+		if (rp + nb >= afd->preload) {
+
+			nr = afd->preload - rp;
+
+			memcpy(raw, afd->stream + rp, nr);
+			memcpy(raw + nr, afd->stream, nb - nr);
+
+			rp += nb - afd->preload;
+		}
+		else {
+			memcpy(raw, afd->stream + rp, nb);
+
+			rp += nb;
+		}
+
+		SDL_AtomicSet(&afd->rp, rp);
+
+		*n = nb / size;
+
+		return ASYNC_OK;
+	}
+	else if (SDL_AtomicGet(&afd->flag_eof) != 0) {
+
+		return ASYNC_END_OF_FILE;
+	}
+	else {
+		return ASYNC_NO_DATA_READY;
+	}
+}
+
 int async_gets(async_FILE *afd, char *raw, int n)
 {
 	int		rp, wp, eol, nq;
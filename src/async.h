@@ -21,6 +21,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #include <SDL2/SDL.h>
 
@@ -36,6 +37,15 @@ typedef struct {
 	FILE		*fd;
 	SDL_Thread	*thread;
 
+	/* The socket source is read by the same ring. Each datagram is taken
+	 * whole or dropped if it does not fit or is not a multiple of frame.
+	 * */
+	intptr_t	sock;
+	int		datagram;
+	int		frame;
+	Uint32		overflow;
+	char		*pack;
+
 	Uint32		clock;
 
 	int		preload;
@@ -43,11 +53,17 @@ typedef struct {
 	int		timeout;
 	int		cached;
 	int		waiting;
+	int		writing;
 
 	char		*stream;
 
 	SDL_atomic_t	rp;
 	SDL_atomic_t	wp;
+	SDL_atomic_t	wr;
+
+	SDL_atomic_t	accepted;
+	SDL_atomic_t	dropped;
+	SDL_atomic_t	blocked;
 
 	SDL_atomic_t	flag_eof;
 	SDL_atomic_t	flag_break;
@@ -56,10 +72,35 @@ async_FILE;
 
 async_FILE *async_open(FILE *fd, int preload, int chunk, int timeout);
 async_FILE *async_stub(int preload, int chunk, int timeout);
+
+/* Open the socket given by "udp://[host]:port" to receive datagrams on the
+ * local port or by "tcp://host:port" to connect to the server. The frame is
+ * the size of binary row or zero for text lines. The number of datagrams
+ * lost is counted as dropped.
+ * */
+async_FILE *async_open_socket(const char *url, int preload, int chunk, int timeout, int frame);
+
+/* Open the stream that is written to the file by background thread. The
+ * data that is written before close is flushed to the file completely.
+ * */
+async_FILE *async_open_write(FILE *fd, int preload, int chunk);
 void async_close(async_FILE *afd);
 
 int async_write(async_FILE *afd, const char *raw, int n);
+
+/* Write as many whole records of SIZE bytes as fit but no more than N. Any
+ * number of threads can write concurrently, each one reserves the space
+ * first and then publishes it in order of reservation.
+ * */
+int async_write_block(async_FILE *afd, const char *raw, int size, int *n);
+
 int async_read(async_FILE *afd, char *raw, int n);
+
+/* Read as many whole records of SIZE bytes as available but no more than N.
+ * The number of records read is returned back in N.
+ * */
+int async_read_block(async_FILE *afd, char *raw, int size, int *n);
+
 int async_gets(async_FILE *afd, char *raw, int n);
 
 #endif /* _H_ASYNC_ */
@@ -0,0 +1,707 @@
+/*
+   Graph Plotter is a tool to analyse numerical data.
+   Copyright (C) 2024 Roman Belov <romblv@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <locale.h>
+#include <math.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "draw.h"
+#include "plot.h"
+#include "pool.h"
+#include "read.h"
+#include "scheme.h"
+
+#define BENCH_SURFACE_X			1200
+#define BENCH_SURFACE_Y			900
+#define BENCH_INSERT_BLOCK		4096
+#define BENCH_CANVAS_LINES		200000
+
+enum {
+	BENCH_NOISE_SMOOTH		= 0,
+	BENCH_NOISE_RANDOM,
+	BENCH_NOISE_STEPS
+};
+
+typedef struct {
+
+	scheme_t	*sch;
+	draw_t		*dw;
+	plot_t		*pl;
+	read_t		*rd;
+
+	SDL_Surface	*surface;
+
+	char		path[READ_FILE_PATH_MAX];
+	char		file[READ_FILE_PATH_MAX];
+
+	int		row_N;
+	int		column_N;
+	int		noise;
+	int		thread_N;
+
+	fval_t		*rows;
+
+	unsigned long long	seed;
+	Uint64			tick;
+}
+bench_t;
+
+static const char *bench_stage[] = {
+
+	"load", "insert", "subtract", "polyfit", "draw", "canvas", NULL
+};
+
+static const char *bench_noise[] = {
+
+	"smooth", "random", "steps", NULL
+};
+
+static double
+benchRandom(bench_t *bn)
+{
+	bn->seed = bn->seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+	return (double) (bn->seed >> 11) / (double) (1ULL << 52) - 1.;
+}
+
+/* Synthetic rows are the time column followed by the sine waves of various
+ * frequency. The noise profile changes how well LZ4 and the figure drawing
+ * are able to collapse the data.
+ * */
+static void
+benchGenerate(bench_t *bn)
+{
+	fval_t		*row;
+	double		fval;
+
+	int		jN, cN;
+
+	bn->rows = (fval_t *) malloc(sizeof(fval_t) * bn->row_N * bn->column_N);
+
+	if (bn->rows == NULL) {
+
+		ERROR("Unable to allocate memory of %i rows\n", bn->row_N);
+		exit(1);
+	}
+
+	bn->seed = 1;
+
+	for (jN = 0; jN < bn->row_N; ++jN) {
+
+		row = bn->rows + jN * bn->column_N;
+		row[0] = (double) jN * 1E-3;
+
+		for (cN = 1; cN < bn->column_N; ++cN) {
+
+			fval = sin(row[0] * (double) cN * 0.5 + (double) cN);
+
+			if (bn->noise == BENCH_NOISE_RANDOM) {
+
+				fval += 0.1 * benchRandom(bn);
+			}
+			else if (bn->noise == BENCH_NOISE_STEPS) {
+
+				fval = floor(fval * 8.) / 8.;
+			}
+
+			row[cN] = fval;
+		}
+	}
+}
+
+static void
+benchStart(bench_t *bn)
+{
+	bn->tick = SDL_GetPerformanceCounter();
+}
+
+static double
+benchStop(bench_t *bn, const char *stage, const char *name, int row_N, int frame_N)
+{
+	double		ms, rate;
+
+	ms = (double) (SDL_GetPerformanceCounter() - bn->tick) * 1E+3
+		/ (double) SDL_GetPerformanceFrequency();
+
+	rate = (ms > 0.) ? (double) row_N / (ms * 1E+3) : 0.;
+
+	printf("%s;%s;%i;%i;%i;%.3f;%.3f\n", stage, name, row_N,
+			bn->column_N, frame_N, ms, rate);
+
+	fflush(stdout);
+
+	return ms;
+}
+
+static int
+benchWriteFile(bench_t *bn, const char *ext, int fmt)
+{
+	FILE		*fd;
+	fval_t		*row;
+	float		fbuf[READ_COLUMN_MAX];
+
+	int		jN, cN;
+
+	sprintf(bn->file, "%.*s/bench%s", READ_FILE_PATH_MAX - 16, bn->path, ext);
+
+	fd = fopen(bn->file, "wb");
+
+	if (fd == NULL) {
+
+		ERROR("fopen(\"%s\"): %s\n", bn->file, strerror(errno));
+		return -1;
+	}
+
+	if (fmt == FORMAT_TEXT_CSV) {
+
+		fprintf(fd, "time@s");
+
+		for (cN = 1; cN < bn->column_N; ++cN)
+			fprintf(fd, ";wave%i@V", cN);
+
+		fprintf(fd, "\n");
+	}
+
+	for (jN = 0; jN < bn->row_N; ++jN) {
+
+		row = bn->rows + jN * bn->column_N;
+
+		if (fmt == FORMAT_TEXT_CSV) {
+
+			fprintf(fd, "%.6f", row[0]);
+
+			for (cN = 1; cN < bn->column_N; ++cN)
+				fprintf(fd, ";%.9g", row[cN]);
+
+			fprintf(fd, "\n");
+		}
+		else if (fmt == FORMAT_BINARY_FP_32) {
+
+			for (cN = 0; cN < bn->column_N; ++cN)
+				fbuf[cN] = (float) row[cN];
+
+			fwrite(fbuf, sizeof(float), bn->column_N, fd);
+		}
+		else {
+			fwrite(row, sizeof(fval_t), bn->column_N, fd);
+		}
+	}
+
+	fclose(fd);
+
+	return 0;
+}
+
+static void
+benchLoad(bench_t *bn)
+{
+	read_t		*rd = bn->rd;
+
+	const struct {
+
+		const char	*name;
+		const char	*ext;
+		int		fmt;
+		int		mmap;
+	}
+	list[] = {
+
+		{ "csv", ".csv", FORMAT_TEXT_CSV, 0 },
+		{ "csv-mmap", ".csv", FORMAT_TEXT_CSV, 1 },
+		{ "fp32", ".f32", FORMAT_BINARY_FP_32, 0 },
+		{ "fp64", ".f64", FORMAT_BINARY_FP_64, 0 },
+		{ NULL }
+	};
+
+	int		N;
+
+	for (N = 0; list[N].name != NULL; ++N) {
+
+		if (		N == 0
+				|| list[N].fmt != list[N - 1].fmt) {
+
+			if (benchWriteFile(bn, list[N].ext, list[N].fmt) != 0)
+				return ;
+		}
+
+		rd->mmap = list[N].mmap;
+
+		benchStart(bn);
+
+		readOpenUnified(rd, 0, bn->column_N, 0, bn->file, list[N].fmt);
+
+		while (rd->data[0].fd != NULL) {
+
+			readDataLoad(rd);
+		}
+
+		benchStop(bn, "load", list[N].name, plotDataLength(bn->pl, 0), 1);
+
+		readDatasetClean(rd, 0);
+
+		if (		list[N + 1].name == NULL
+				|| list[N + 1].fmt != list[N].fmt) {
+
+			remove(bn->file);
+		}
+	}
+}
+
+static void
+benchDataset(bench_t *bn, int lz4)
+{
+	plot_t		*pl = bn->pl;
+
+	int		jN, n;
+
+	plotDataClean(pl, 0);
+
+	pl->lz4_compress = lz4;
+
+	plotDataAlloc(pl, 0, bn->column_N, bn->row_N, STORAGE_FP64);
+
+	for (jN = 0; jN < bn->row_N; jN += n) {
+
+		n = bn->row_N - jN;
+		n = (n > BENCH_INSERT_BLOCK) ? BENCH_INSERT_BLOCK : n;
+
+		plotDataInsertBlock(pl, 0, bn->rows + jN * bn->column_N, n);
+	}
+}
+
+static void
+benchInsert(bench_t *bn, int lz4)
+{
+	benchStart(bn);
+	benchDataset(bn, lz4);
+	benchStop(bn, "insert", (lz4 != 0) ? "lz4" : "raw", bn->row_N, 1);
+}
+
+/* Each subtract reads the source columns and writes the result column back
+ * so with LZ4 enabled it is a full round-trip through chunk compression.
+ * */
+static void
+benchSubtract(bench_t *bn)
+{
+	plot_t		*pl = bn->pl;
+
+	const char	*name = (pl->data[0].lz4_compress != 0) ? "-lz4" : "";
+	char		sbuf[80];
+
+	sprintf(sbuf, "scale%s", name);
+	benchStart(bn);
+	plotGetSubtractScale(pl, 0, 1, 2., 1.);
+	benchStop(bn, "subtract", sbuf, bn->row_N, 1);
+
+	sprintf(sbuf, "difference%s", name);
+	benchStart(bn);
+	plotGetSubtractFilter(pl, 0, 0, 1, SUBTRACT_FILTER_DIFFERENCE, 0.);
+	benchStop(bn, "subtract", sbuf, bn->row_N, 1);
+
+	sprintf(sbuf, "low-pass%s", name);
+	benchStart(bn);
+	plotGetSubtractFilter(pl, 0, 0, 1, SUBTRACT_FILTER_LOW_PASS, 0.05);
+	benchStop(bn, "subtract", sbuf, bn->row_N, 1);
+
+	sprintf(sbuf, "median%s", name);
+	benchStart(bn);
+	plotGetSubtractMedian(pl, 0, 1, SUBTRACT_FILTER_MEDIAN, 21);
+	benchStop(bn, "subtract", sbuf, bn->row_N, 1);
+
+	if (bn->column_N > 2) {
+
+		sprintf(sbuf, "binary%s", name);
+		benchStart(bn);
+		plotGetSubtractBinary(pl, 0, SUBTRACT_BINARY_SUBTRACTION, 1, 2);
+		benchStop(bn, "subtract", sbuf, bn->row_N, 1);
+	}
+
+	plotDataSubtractClean(pl);
+}
+
+static void
+benchPolyfit(bench_t *bn)
+{
+	plot_t		*pl = bn->pl;
+
+	plotFigureAdd(pl, 0, 0, 0, 1, 0, 1, "wave");
+	plotAxisScaleDefault(pl);
+
+	benchStart(bn);
+	plotFigureSubtractPolyfit(pl, 0, 0, 6);
+	benchStop(bn, "polyfit", "degree-6", bn->row_N, 1);
+
+	plotFigureClean(pl);
+	plotDataSubtractClean(pl);
+}
+
+static void
+benchDraw(bench_t *bn)
+{
+	plot_t		*pl = bn->pl;
+	draw_t		*dw = bn->dw;
+
+	const char	*name[] = { "solid", "4x-msaa", "8x-msaa" };
+	char		sbuf[80];
+
+	int		N, fN, frame_N;
+
+	for (fN = 0; fN < bn->column_N - 1 && fN < PLOT_FIGURE_MAX; ++fN) {
+
+		sprintf(sbuf, "wave%i", fN + 1);
+		plotFigureAdd(pl, fN, 0, 0, fN + 1, 0, 1, sbuf);
+	}
+
+	for (N = DRAW_SOLID; N <= DRAW_8X_MSAA; ++N) {
+
+		dw->antialiasing = N;
+
+		plotSketchClean(pl);
+
+		frame_N = 0;
+
+		benchStart(bn);
+
+		do {
+			SDL_LockSurface(bn->surface);
+
+			drawClearSurface(dw, bn->surface, pl->sch->plot_background);
+
+			SDL_UnlockSurface(bn->surface);
+
+			plotLayout(pl);
+			plotAxisScaleDefault(pl);
+
+			plotDraw(pl, bn->surface);
+
+			frame_N++;
+		}
+		while (pl->draw_in_progress != 0);
+
+		benchStop(bn, "draw", name[N], bn->row_N * fN, frame_N);
+	}
+
+	plotFigureClean(pl);
+}
+
+static void
+benchCanvas(bench_t *bn)
+{
+	plot_t		*pl = bn->pl;
+	draw_t		*dw = bn->dw;
+
+	const char	*name[] = { "solid", "4x-msaa", "8x-msaa" };
+	char		sbuf[80];
+
+	double		xs, ys, xe, ye;
+	int		N, lN, w, h;
+
+	w = pl->viewport.max_x - pl->viewport.min_x;
+	h = pl->viewport.max_y - pl->viewport.min_y;
+
+	for (N = DRAW_SOLID; N <= DRAW_8X_MSAA; ++N) {
+
+		dw->antialiasing = N;
+
+		drawPixmapAlloc(dw, bn->surface);
+		drawClearCanvas(dw);
+
+		bn->seed = 1;
+
+		benchStart(bn);
+
+		for (lN = 0; lN < BENCH_CANVAS_LINES; ++lN) {
+
+			xs = pl->viewport.min_x + w * (.5 + .5 * benchRandom(bn));
+			ys = pl->viewport.min_y + h * (.5 + .5 * benchRandom(bn));
+			xe = xs + 40. * benchRandom(bn);
+			ye = ys + 40. * benchRandom(bn);
+
+			drawLineCanvas(dw, bn->surface, &pl->viewport, xs, ys,
+					xe, ye, 1 + (lN & 7), dw->thickness);
+		}
+
+		sprintf(sbuf, "lines-%s", name[N]);
+		benchStop(bn, "canvas", sbuf, BENCH_CANVAS_LINES, 1);
+
+		benchStart(bn);
+
+		SDL_LockSurface(bn->surface);
+
+		drawFlushCanvas(dw, bn->surface, &pl->viewport);
+
+		SDL_UnlockSurface(bn->surface);
+
+		sprintf(sbuf, "flush-%s", name[N]);
+		benchStop(bn, "canvas", sbuf, bn->surface->w * bn->surface->h, 1);
+	}
+}
+
+static void
+benchAlloc(bench_t *bn)
+{
+	bn->sch = (scheme_t *) calloc(1, sizeof(scheme_t));
+	bn->dw = (draw_t *) calloc(1, sizeof(draw_t));
+
+	bn->dw->antialiasing = DRAW_4X_MSAA;
+	bn->dw->blendfont = 1;
+	bn->dw->thickness = 2;
+	bn->dw->gamma = 50;
+
+	drawSIMDProbe(bn->dw);
+
+	bn->pl = plotAlloc(bn->dw, bn->sch);
+	bn->rd = readAlloc(bn->dw, bn->pl);
+	bn->pl->ld = bn->rd;
+
+	if (bn->thread_N > 0) {
+
+		if (bn->pl->pool != NULL)
+			poolClean(bn->pl->pool);
+
+		bn->pl->pool = (bn->thread_N > 1) ? poolAlloc(bn->thread_N) : NULL;
+	}
+
+	/* We read local files only so do not wait at the end of file.
+	 * */
+	bn->rd->timeout = 0;
+
+	schemeFill(bn->sch, 0);
+	drawGamma(bn->dw);
+
+	plotFontDefault(bn->pl, TTF_ID_ROBOTO_MONO_NORMAL, 24, TTF_STYLE_NORMAL);
+
+	bn->surface = SDL_CreateRGBSurfaceWithFormat(0, BENCH_SURFACE_X,
+			BENCH_SURFACE_Y, 32, SDL_PIXELFORMAT_XRGB8888);
+
+	if (bn->surface == NULL) {
+
+		ERROR("SDL_CreateRGBSurfaceWithFormat: %s\n", SDL_GetError());
+		exit(1);
+	}
+
+	bn->pl->screen.min_x = 0;
+	bn->pl->screen.max_x = bn->surface->w - 1;
+	bn->pl->screen.min_y = 0;
+	bn->pl->screen.max_y = bn->surface->h - 1;
+
+	plotLayout(bn->pl);
+}
+
+static void
+benchClean(bench_t *bn)
+{
+	SDL_FreeSurface(bn->surface);
+
+	readClean(bn->rd);
+	plotClean(bn->pl);
+
+	free(bn->dw);
+	free(bn->sch);
+	free(bn->rows);
+}
+
+static void
+benchUsageHelp()
+{
+	printf(	"Usage: bench [-rcntp...] [stage] ...\n"
+		"  -r[n]          Number of rows to generate\n"
+		"  -c[n]          Number of columns to generate\n"
+		"  -n[name]       Noise profile (smooth, random, steps)\n"
+		"  -t[n]          Number of threads in the pool\n"
+		"  -p[path]       Directory to write temporary files\n"
+		"  stage          One of (load, insert, subtract, polyfit, draw, canvas)\n");
+}
+
+static int
+benchLookup(const char *list[], const char *name)
+{
+	int		N;
+
+	for (N = 0; list[N] != NULL; ++N) {
+
+		if (strcmp(list[N], name) == 0)
+			return N;
+	}
+
+	return -1;
+}
+
+int main(int argn, char *argv[])
+{
+	bench_t		bn;
+
+	int		stage[sizeof(bench_stage) / sizeof(bench_stage[0])];
+	int		n, k, N, stage_N = 0;
+
+	setlocale(LC_NUMERIC, "C");
+
+	memset(&bn, 0, sizeof(bn));
+
+	bn.row_N = 1000000;
+	bn.column_N = 4;
+	bn.noise = BENCH_NOISE_RANDOM;
+
+	strcpy(bn.path, ".");
+
+	for (n = 1; n < argn; ++n) {
+
+		if (argv[n][0] == '-') {
+
+			switch (argv[n][1]) {
+
+				case 'r':
+					bn.row_N = atoi(&argv[n][2]);
+					break;
+
+				case 'c':
+					bn.column_N = atoi(&argv[n][2]);
+					break;
+
+				case 'n':
+					bn.noise = benchLookup(bench_noise, &argv[n][2]);
+					break;
+
+				case 't':
+					bn.thread_N = atoi(&argv[n][2]);
+					break;
+
+				case 'p':
+					snprintf(bn.path, READ_FILE_PATH_MAX, "%s", &argv[n][2]);
+					break;
+
+				default:
+					benchUsageHelp();
+					return 0;
+			}
+		}
+		else {
+			N = benchLookup(bench_stage, argv[n]);
+
+			if (N < 0) {
+
+				ERROR("Unknown stage \"%.80s\"\n", argv[n]);
+				return 1;
+			}
+
+			for (k = 0; k < stage_N; ++k) {
+
+				if (stage[k] == N)
+					break;
+			}
+
+			/* Each stage is run once so the list is bounded by
+			 * the number of known stages.
+			 * */
+			if (k == stage_N) {
+
+				stage[stage_N++] = N;
+			}
+		}
+	}
+
+	if (bn.row_N < 1 || bn.row_N > 100000000) {
+
+		ERROR("Number of rows %i is out of range\n", bn.row_N);
+		return 1;
+	}
+
+	if (bn.column_N < 2 || bn.column_N > READ_COLUMN_MAX) {
+
+		ERROR("Number of columns %i is out of range\n", bn.column_N);
+		return 1;
+	}
+
+	if (bn.noise < 0) {
+
+		ERROR("Unknown noise profile\n");
+		return 1;
+	}
+
+	if (stage_N == 0) {
+
+		for (N = 0; bench_stage[N] != NULL; ++N)
+			stage[stage_N++] = N;
+	}
+
+	if (SDL_Init(0) < 0) {
+
+		ERROR("SDL_Init: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	if (TTF_Init() < 0) {
+
+		ERROR("TTF_Init: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	benchAlloc(&bn);
+	benchGenerate(&bn);
+
+	printf("stage;case;rows;columns;frames;time@ms;rate@Mrow/s\n");
+
+	for (N = 0; N < stage_N; ++N) {
+
+		switch (stage[N]) {
+
+			case 0:
+				benchLoad(&bn);
+				break;
+
+			case 1:
+				benchInsert(&bn, 0);
+				benchInsert(&bn, 1);
+				break;
+
+			case 2:
+				benchDataset(&bn, 0);
+				benchSubtract(&bn);
+				benchDataset(&bn, 1);
+				benchSubtract(&bn);
+				break;
+
+			case 3:
+				benchDataset(&bn, 1);
+				benchPolyfit(&bn);
+				break;
+
+			case 4:
+				benchDataset(&bn, 1);
+				benchDraw(&bn);
+				break;
+
+			case 5:
+				benchCanvas(&bn);
+				break;
+		}
+	}
+
+	plotDataClean(bn.pl, 0);
+	benchClean(&bn);
+
+	SDL_Quit();
+
+	return 0;
+}
@@ -18,6 +18,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include <time.h>
 
@@ -25,6 +26,8 @@
 
 #ifdef _WINDOWS
 #include <windows.h>
+#include <fcntl.h>
+#include <io.h>
 
 struct dirent_priv {
 
@@ -173,6 +176,38 @@ int file_stat(const char *file, unsigned long long *nsize)
 	return ENT_OK;
 }
 
+int file_stat_mtime(const char *file, unsigned long long *mtime)
+{
+	wchar_t			wfile[DIRENT_PATH_MAX];
+	HANDLE			hFile;
+	FILETIME		fTime;
+	BOOL			bTime;
+
+	MultiByteToWideChar(CP_UTF8, 0, file, -1, wfile, DIRENT_PATH_MAX);
+
+	hFile = CreateFileW(wfile, FILE_READ_ATTRIBUTES, FILE_SHARE_READ
+			| FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+
+	if (hFile == INVALID_HANDLE_VALUE) {
+
+		return ENT_ERROR_UNKNOWN;
+	}
+
+	bTime = GetFileTime(hFile, NULL, NULL, &fTime);
+
+	CloseHandle(hFile);
+
+	if (bTime == 0) {
+
+		return ENT_ERROR_UNKNOWN;
+	}
+
+	*mtime = ((unsigned long long) fTime.dwHighDateTime << 32)
+		| (unsigned long long) fTime.dwLowDateTime;
+
+	return ENT_OK;
+}
+
 int file_remove(const char *file)
 {
 	wchar_t			wfile[DIRENT_PATH_MAX];
@@ -182,11 +217,132 @@ int file_remove(const char *file)
 	return (DeleteFileW(wfile) != 0) ? ENT_OK : ENT_ERROR_UNKNOWN;
 }
 
+FILE *file_tempfile()
+{
+	wchar_t			wpath[DIRENT_PATH_MAX];
+	wchar_t			wfile[DIRENT_PATH_MAX + 40];
+	HANDLE			hFile = INVALID_HANDLE_VALUE;
+	FILE			*fd;
+	int			N, len, fn;
+
+	len = (int) GetTempPathW(DIRENT_PATH_MAX, wpath);
+
+	if (len < 1 || len >= DIRENT_PATH_MAX) {
+
+		return NULL;
+	}
+
+	for (N = 0; N < 100; ++N) {
+
+		_snwprintf(wfile, DIRENT_PATH_MAX + 40, L"%lsgp-spill-%lu-%i.tmp", wpath,
+				(unsigned long) GetCurrentProcessId(), N);
+
+		/* The file is created exclusively and deleted by system when
+		 * the handle is closed.
+		 * */
+		hFile = CreateFileW(wfile, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+				CREATE_NEW, FILE_ATTRIBUTE_TEMPORARY
+				| FILE_FLAG_DELETE_ON_CLOSE, NULL);
+
+		if (		hFile != INVALID_HANDLE_VALUE
+				|| GetLastError() != ERROR_FILE_EXISTS)
+			break;
+	}
+
+	if (hFile == INVALID_HANDLE_VALUE) {
+
+		return NULL;
+	}
+
+	fn = _open_osfhandle((intptr_t) hFile, _O_BINARY);
+
+	if (fn < 0) {
+
+		CloseHandle(hFile);
+		return NULL;
+	}
+
+	fd = _fdopen(fn, "w+b");
+
+	if (fd == NULL) {
+
+		_close(fn);
+	}
+
+	return fd;
+}
+
+int file_map(struct file_map *fm, const char *file)
+{
+	wchar_t			wfile[DIRENT_PATH_MAX];
+	HANDLE			hFile, hMap;
+	LARGE_INTEGER		nSize = { 0 } ;
+
+	fm->base = NULL;
+	fm->nsize = 0;
+	fm->priv = NULL;
+
+	MultiByteToWideChar(CP_UTF8, 0, file, -1, wfile, DIRENT_PATH_MAX);
+
+	hFile = CreateFileW(wfile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+			NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if (hFile == INVALID_HANDLE_VALUE) {
+
+		return ENT_ERROR_UNKNOWN;
+	}
+
+	if (		GetFileSizeEx(hFile, &nSize) == 0
+			|| nSize.QuadPart == 0
+			|| (unsigned long long) nSize.QuadPart > (unsigned long long) SIZE_MAX) {
+
+		CloseHandle(hFile);
+		return ENT_ERROR_UNKNOWN;
+	}
+
+	hMap = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	CloseHandle(hFile);
+
+	if (hMap == NULL) {
+
+		return ENT_ERROR_UNKNOWN;
+	}
+
+	fm->base = MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+
+	if (fm->base == NULL) {
+
+		CloseHandle(hMap);
+		return ENT_ERROR_UNKNOWN;
+	}
+
+	fm->nsize = nSize.QuadPart;
+	fm->priv = (void *) hMap;
+
+	return ENT_OK;
+}
+
+void file_unmap(struct file_map *fm)
+{
+	if (fm->base != NULL) {
+
+		UnmapViewOfFile(fm->base);
+		CloseHandle((HANDLE) fm->priv);
+	}
+
+	fm->base = NULL;
+	fm->nsize = 0;
+	fm->priv = NULL;
+}
+
 #else /* _WINDOWS */
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 struct dirent_priv {
@@ -307,10 +463,119 @@ int file_stat(const char *file, unsigned long long *nsize)
 	return (rc == 0) ? ENT_OK : ENT_ERROR_UNKNOWN;
 }
 
+int file_stat_mtime(const char *file, unsigned long long *mtime)
+{
+	struct stat		sb;
+	int			rc;
+
+	rc = stat(file, &sb);
+
+	if (rc == 0) {
+
+		*mtime = (unsigned long long) sb.st_mtime;
+	}
+
+	return (rc == 0) ? ENT_OK : ENT_ERROR_UNKNOWN;
+}
+
 int file_remove(const char *file)
 {
 	return (remove(file) == 0) ? ENT_OK : ENT_ERROR_UNKNOWN;
 }
 
+FILE *file_tempfile()
+{
+	char			file[DIRENT_PATH_MAX];
+	const char		*temp;
+	FILE			*fd;
+	int			fn;
+
+	temp = getenv("TMPDIR");
+	temp = (temp != NULL && temp[0] != 0) ? temp : "/tmp";
+
+	if (strlen(temp) + 20 >= sizeof(file)) {
+
+		return NULL;
+	}
+
+	sprintf(file, "%s/gp-spill-XXXXXX", temp);
+
+	/* The file is created exclusively with unique name and unlinked at
+	 * once so it is gone with the last descriptor closed.
+	 * */
+	fn = mkstemp(file);
+
+	if (fn < 0) {
+
+		return NULL;
+	}
+
+	unlink(file);
+
+	fd = fdopen(fn, "w+b");
+
+	if (fd == NULL) {
+
+		close(fn);
+	}
+
+	return fd;
+}
+
+int file_map(struct file_map *fm, const char *file)
+{
+	struct stat		sb;
+	void			*base;
+	int			fd;
+
+	fm->base = NULL;
+	fm->nsize = 0;
+	fm->priv = NULL;
+
+	fd = open(file, O_RDONLY);
+
+	if (fd < 0) {
+
+		return ENT_ERROR_UNKNOWN;
+	}
+
+	if (		fstat(fd, &sb) != 0
+			|| S_ISREG(sb.st_mode) == 0
+			|| sb.st_size == 0
+			|| (unsigned long long) sb.st_size > (unsigned long long) SIZE_MAX) {
+
+		close(fd);
+		return ENT_ERROR_UNKNOWN;
+	}
+
+	base = mmap(NULL, (size_t) sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	close(fd);
+
+	if (base == MAP_FAILED) {
+
+		return ENT_ERROR_UNKNOWN;
+	}
+
+	madvise(base, (size_t) sb.st_size, MADV_SEQUENTIAL);
+
+	fm->base = (const void *) base;
+	fm->nsize = sb.st_size;
+
+	return ENT_OK;
+}
+
+void file_unmap(struct file_map *fm)
+{
+	if (fm->base != NULL) {
+
+		munmap((void *) fm->base, (size_t) fm->nsize);
+	}
+
+	fm->base = NULL;
+	fm->nsize = 0;
+	fm->priv = NULL;
+}
+
 #endif /* _WINDOWS */
 
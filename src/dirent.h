@@ -19,6 +19,8 @@
 #ifndef _H_DIRENT_
 #define _H_DIRENT_
 
+#include <stdio.h>
+
 #define DIRENT_PATH_MAX			272
 
 #ifdef _WINDOWS
@@ -57,8 +59,29 @@ int dirent_rewind(struct dirent_stat *sb);
 int dirent_read(struct dirent_stat *sb);
 void dirent_close(struct dirent_stat *sb);
 
+struct file_map {
+
+	const void		*base;
+	unsigned long long	nsize;
+
+	void			*priv;
+};
+
 int file_stat(const char *file, unsigned long long *nsize);
+int file_stat_mtime(const char *file, unsigned long long *mtime);
 int file_remove(const char *file);
 
+/* Create a new temporary file in the directory of temporary files of the
+ * user. The file is deleted when it is closed.
+ * */
+FILE *file_tempfile();
+
+/* Map the whole regular file into memory for read only access. Returns
+ * ENT_ERROR_UNKNOWN if file cannot be mapped (empty, too large for the
+ * address space, or not a regular file).
+ * */
+int file_map(struct file_map *fm, const char *file);
+void file_unmap(struct file_map *fm);
+
 #endif /* _H_DIRENT_ */
 
@@ -17,6 +17,7 @@
 */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include <SDL2/SDL.h>
@@ -26,6 +27,14 @@
 #include "plot.h"
 #include "svg.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define _DRAW_SIMD_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define _DRAW_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 extern int fp_isfinite(double x);
 
 void drawDashReset(draw_t *dw)
@@ -34,6 +43,29 @@ void drawDashReset(draw_t *dw)
 	dw->cached_ncol = -1;
 }
 
+void drawSIMDProbe(draw_t *dw)
+{
+	dw->simd = DRAW_SIMD_NONE;
+
+#ifdef _DRAW_SIMD_X86
+	if (SDL_HasAVX2() == SDL_TRUE) {
+
+		dw->simd = DRAW_SIMD_AVX2;
+	}
+	else if (SDL_HasSSE2() == SDL_TRUE) {
+
+		dw->simd = DRAW_SIMD_SSE2;
+	}
+#endif /* _DRAW_SIMD_X86 */
+
+#ifdef _DRAW_SIMD_NEON
+	if (SDL_HasNEON() == SDL_TRUE) {
+
+		dw->simd = DRAW_SIMD_NEON;
+	}
+#endif /* _DRAW_SIMD_NEON */
+}
+
 void drawGamma(draw_t *dw)
 {
 	int		n;
@@ -160,12 +192,16 @@ void drawPixmapAlloc(draw_t *dw, SDL_Surface *surface)
 
 	dw->pixmap.yspan = w;
 
+	dw->tile_min_y = 0;
+	dw->tile_max_y = h - 1;
+
 	if (dw->pixmap.len < len) {
 
 		if (dw->pixmap.len != 0) {
 
 			free(dw->pixmap.canvas);
 			free(dw->pixmap.trial);
+			free(dw->pixmap.layer);
 		}
 
 		dw->pixmap.len = len + 1048576UL;
@@ -182,6 +218,13 @@ void drawPixmapAlloc(draw_t *dw, SDL_Surface *surface)
 
 			ERROR("Unable to allocate memory of the trial pixmap\n");
 		}
+
+		dw->pixmap.layer = (void *) malloc(dw->pixmap.len);
+
+		if (dw->pixmap.layer == NULL) {
+
+			ERROR("Unable to allocate memory of the layer pixmap\n");
+		}
 	}
 }
 
@@ -191,7 +234,104 @@ void drawPixmapClean(draw_t *dw)
 
 		free(dw->pixmap.canvas);
 		free(dw->pixmap.trial);
+		free(dw->pixmap.layer);
+	}
+}
+
+void drawLayerSwap(draw_t *dw)
+{
+	void		*canvas;
+
+	canvas = dw->pixmap.canvas;
+
+	dw->pixmap.canvas = dw->pixmap.layer;
+	dw->pixmap.layer = canvas;
+}
+
+void drawLayerCopy(draw_t *dw)
+{
+	int			len;
+
+	len = dw->pixmap.yspan * dw->pixmap.h;
+
+	if (dw->antialiasing == DRAW_4X_MSAA) {
+
+		len *= 2;
+	}
+	else if (dw->antialiasing == DRAW_8X_MSAA) {
+
+		len *= 4;
+	}
+
+	memcpy(dw->pixmap.canvas, dw->pixmap.layer, len);
+}
+
+static void
+drawPixmapShift(Uint8 *pixmap, int yspan, int bpp, clipBox_t *cb, int dx, int dy)
+{
+	int			len, y, ys, ye, yd;
+
+	yspan *= bpp;
+	len = (cb->max_x - cb->min_x + 1 - abs(dx)) * bpp;
+
+	/* Go in order that does not overwrite the rows we have not moved yet.
+	 * */
+	ys = (dy > 0) ? cb->max_y : cb->min_y;
+	ye = (dy > 0) ? cb->min_y - 1 : cb->max_y + 1;
+	yd = (dy > 0) ? - 1 : 1;
+
+	for (y = ys; y != ye; y += yd) {
+
+		Uint8		*row = pixmap + y * yspan + cb->min_x * bpp;
+
+		if (		y - dy < cb->min_y
+				|| y - dy > cb->max_y) {
+
+			memset(row, 0, (cb->max_x - cb->min_x + 1) * bpp);
+			continue;
+		}
+
+		if (dx > 0) {
+
+			memmove(row + dx * bpp, pixmap + (y - dy) * yspan
+					+ cb->min_x * bpp, len);
+			memset(row, 0, dx * bpp);
+		}
+		else {
+			memmove(row, pixmap + (y - dy) * yspan
+					+ (cb->min_x - dx) * bpp, len);
+			memset(row + len, 0, - dx * bpp);
+		}
+	}
+}
+
+void drawCanvasShift(draw_t *dw, clipBox_t *cb, int dx, int dy)
+{
+	int			bpp = 1;
+
+	if (dw->antialiasing == DRAW_4X_MSAA) {
+
+		bpp = 2;
+	}
+	else if (dw->antialiasing == DRAW_8X_MSAA) {
+
+		bpp = 4;
 	}
+
+	drawPixmapShift((Uint8 *) dw->pixmap.canvas, dw->pixmap.yspan, bpp, cb, dx, dy);
+}
+
+void drawTrialShift(draw_t *dw, clipBox_t *cb, int dx, int dy)
+{
+	int			bpp;
+
+	bpp = (dw->antialiasing != DRAW_SOLID) ? 2 : 1;
+
+	drawPixmapShift((Uint8 *) dw->pixmap.trial, dw->pixmap.yspan, bpp, cb, dx, dy);
+
+	/* Cached vertical span is not valid at the new place.
+	 * */
+	dw->cached_ncol = -1;
 }
 
 static int
@@ -219,8 +359,7 @@ int clipBoxTest(clipBox_t *cb, int x, int y)
 	return (clipCode(cb, x, y) == 0);
 }
 
-static int
-clipLine(clipBox_t *cb, double *xs, double *ys, double *xe, double *ye)
+int clipLine(clipBox_t *cb, double *xs, double *ys, double *xe, double *ye)
 {
 	double			dx, dy;
 	int			s_cc, e_cc;
@@ -608,6 +747,9 @@ void drawLineCanvas(draw_t *dw, SDL_Surface *surface, clipBox_t *cb, double fxs,
 	lcb.max_x = (lcb.max_x > cb->max_x) ? cb->max_x : lcb.max_x;
 	lcb.max_y = (lcb.max_y > cb->max_y) ? cb->max_y : lcb.max_y;
 
+	lcb.min_y = (lcb.min_y < dw->tile_min_y) ? dw->tile_min_y : lcb.min_y;
+	lcb.max_y = (lcb.max_y > dw->tile_max_y) ? dw->tile_max_y : lcb.max_y;
+
 	l = (xs - xe) * (xs - xe) + (ys - ye) * (ys - ye);
 	d = (int) sqrtf((float) l);
 
@@ -1438,6 +1580,9 @@ void drawDashCanvas(draw_t *dw, SDL_Surface *surface, clipBox_t *cb, double fxs,
 	lcb.max_x = (lcb.max_x > cb->max_x) ? cb->max_x : lcb.max_x;
 	lcb.max_y = (lcb.max_y > cb->max_y) ? cb->max_y : lcb.max_y;
 
+	lcb.min_y = (lcb.min_y < dw->tile_min_y) ? dw->tile_min_y : lcb.min_y;
+	lcb.max_y = (lcb.max_y > dw->tile_max_y) ? dw->tile_max_y : lcb.max_y;
+
 	e = (xs - xe) * (xs - xe) + (ys - ye) * (ys - ye);
 	d = (int) sqrtf((float) e);
 
@@ -2258,27 +2403,14 @@ int drawLineTrial(draw_t *dw, clipBox_t *cb, double fxs, double fys,
 	return fill;
 }
 
-void drawText(draw_t *dw, SDL_Surface *surface, TTF_Font *font, int xs, int ys,
-		const char *text, int flags, Uint32 col)
+static SDL_Surface *
+drawTextRender(draw_t *dw, TTF_Font *font, const char *text, int flags, Uint32 col)
 {
-	svg_t			*g = (svg_t *) surface->userdata;
 	SDL_Surface		*textSurface, *surfaceCopy;
-	SDL_Rect		textRect;
 	SDL_Color		textColor;
 
 	int			pitch, i, j;
 
-	if (font == NULL)
-		return ;
-
-	if (text[0] == 0)
-		return ;
-
-	if (g != NULL) {
-
-		svgDrawText(g, xs, ys, text, (svgCol_t) col, flags);
-	}
-
 	textColor.a = (Uint8) 0;
 	textColor.r = (Uint8) ((col & 0x00FF0000UL) >> 16);
 	textColor.g = (Uint8) ((col & 0x0000FF00UL) >> 8);
@@ -2293,7 +2425,7 @@ void drawText(draw_t *dw, SDL_Surface *surface, TTF_Font *font, int xs, int ys,
 	}
 
 	if (textSurface == NULL)
-		return ;
+		return NULL;
 
 	if (flags & TEXT_VERTICAL) {
 
@@ -2358,6 +2490,138 @@ void drawText(draw_t *dw, SDL_Surface *surface, TTF_Font *font, int xs, int ys,
 		textSurface = surfaceCopy;
 	}
 
+	return textSurface;
+}
+
+static Uint32
+drawTextHash(const char *text)
+{
+	Uint32		hash = 2166136261U;
+
+	while (*text != 0) {
+
+		hash ^= (Uint8) *text++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static SDL_Surface *
+drawTextCached(draw_t *dw, TTF_Font *font, const char *text, int flags, Uint32 col)
+{
+	dtext_t		*tx, *lru;
+
+	Uint32		hash;
+	int		N, vertical;
+
+	if (strlen(text) >= DRAW_TEXT_LENGTH_MAX)
+		return NULL;
+
+	hash = drawTextHash(text);
+	vertical = (flags & TEXT_VERTICAL) ? 1 : 0;
+
+	dw->text_clock++;
+
+	lru = &dw->text[0];
+
+	for (N = 0; N < DRAW_TEXT_CACHE_MAX; ++N) {
+
+		tx = &dw->text[N];
+
+		if (		tx->surface != NULL
+				&& tx->hash == hash
+				&& tx->font == font
+				&& tx->col == col
+				&& tx->blendfont == dw->blendfont
+				&& tx->vertical == vertical
+				&& strcmp(tx->text, text) == 0) {
+
+			tx->clock = dw->text_clock;
+
+			return tx->surface;
+		}
+
+		if (tx->surface == NULL) {
+
+			lru = tx;
+			lru->clock = 0;
+		}
+		else if (dw->text_clock - tx->clock > dw->text_clock - lru->clock) {
+
+			lru = tx;
+		}
+	}
+
+	if (lru->surface != NULL) {
+
+		SDL_FreeSurface(lru->surface);
+	}
+
+	lru->surface = drawTextRender(dw, font, text, flags, col);
+
+	if (lru->surface != NULL) {
+
+		lru->font = font;
+		lru->col = col;
+		lru->blendfont = dw->blendfont;
+		lru->vertical = vertical;
+		lru->hash = hash;
+		lru->clock = dw->text_clock;
+
+		strcpy(lru->text, text);
+	}
+
+	return lru->surface;
+}
+
+void drawTextFlush(draw_t *dw)
+{
+	int		N;
+
+	for (N = 0; N < DRAW_TEXT_CACHE_MAX; ++N) {
+
+		if (dw->text[N].surface != NULL) {
+
+			SDL_FreeSurface(dw->text[N].surface);
+			dw->text[N].surface = NULL;
+		}
+	}
+}
+
+static void
+drawTextBlit(draw_t *dw, SDL_Surface *surface, TTF_Font *font, int xs, int ys,
+		const char *text, int flags, Uint32 col)
+{
+	svg_t			*g = (svg_t *) surface->userdata;
+	SDL_Surface		*textSurface, *textRender;
+	SDL_Rect		textRect;
+
+	if (font == NULL)
+		return ;
+
+	if (text[0] == 0)
+		return ;
+
+	if (g != NULL) {
+
+		svgDrawText(g, xs, ys, text, (svgCol_t) col, flags);
+	}
+
+	textRender = NULL;
+	textSurface = drawTextCached(dw, font, text, flags, col);
+
+	if (textSurface == NULL) {
+
+		/* Long strings are not cached.
+		 * */
+		textRender = drawTextRender(dw, font, text, flags, col);
+		textSurface = textRender;
+	}
+
+	if (textSurface == NULL)
+		return ;
+
 	textRect.w = textSurface->w;
 	textRect.h = textSurface->h;
 	textRect.x = xs;
@@ -2374,7 +2638,23 @@ void drawText(draw_t *dw, SDL_Surface *surface, TTF_Font *font, int xs, int ys,
 	}
 
 	SDL_BlitSurface(textSurface, NULL, surface, &textRect);
-	SDL_FreeSurface(textSurface);
+
+	if (textRender != NULL) {
+
+		SDL_FreeSurface(textRender);
+	}
+}
+
+void drawText(draw_t *dw, SDL_Surface *surface, TTF_Font *font, int xs, int ys,
+		const char *text, int flags, Uint32 col)
+{
+	Uint64		tSTART;
+
+	tSTART = SDL_GetPerformanceCounter();
+
+	drawTextBlit(dw, surface, font, xs, ys, text, flags, col);
+
+	dw->perf.text += SDL_GetPerformanceCounter() - tSTART;
 }
 
 void drawFillRect(SDL_Surface *surface, int xs, int ys,
@@ -2501,6 +2781,9 @@ void drawDotCanvas(draw_t *dw, SDL_Surface *surface, clipBox_t *cb, double fxs,
 	lcb.max_x = (lcb.max_x > cb->max_x) ? cb->max_x : lcb.max_x;
 	lcb.max_y = (lcb.max_y > cb->max_y) ? cb->max_y : lcb.max_y;
 
+	lcb.min_y = (lcb.min_y < dw->tile_min_y) ? dw->tile_min_y : lcb.min_y;
+	lcb.max_y = (lcb.max_y > dw->tile_max_y) ? dw->tile_max_y : lcb.max_y;
+
 	if (round == 0) {
 
 		w1 = lcb.min_x * 16 - xs + 8;
@@ -3315,7 +3598,490 @@ void drawMarkCanvas(draw_t *dw, SDL_Surface *surface, clipBox_t *cb, double fxs,
 	}
 }
 
-void drawFlushCanvas(draw_t *dw, SDL_Surface *surface, clipBox_t *cb)
+#ifdef _DRAW_SIMD_X86
+/* The flush kernels below are bitwise equal to the scalar code. Most of the
+ * canvas is empty so the main gain is to skip zero runs of canvas at once,
+ * the rest pixels are resolved with the channel sum done in vector lanes.
+ * */
+static inline __attribute__ ((target ("sse2"))) __m128i
+drawSumSSE2(Uint32 c0, Uint32 c1, Uint32 c2, Uint32 c3)
+{
+	__m128i		zero = _mm_setzero_si128();
+	__m128i		vcol, sum;
+
+	vcol = _mm_setr_epi32(c0, c1, c2, c3);
+
+	sum = _mm_add_epi16(_mm_unpacklo_epi8(vcol, zero),
+			_mm_unpackhi_epi8(vcol, zero));
+
+	return _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+}
+
+static inline __attribute__ ((target ("sse2"))) Uint32
+drawGammaSSE2(const Uint8 *ltgamma, __m128i sum)
+{
+	union {
+
+		Uint32          l;
+		Uint8           b[4];
+	}
+	vcol;
+
+	vcol.l = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+
+	vcol.b[0] = ltgamma[vcol.b[0]];
+	vcol.b[1] = ltgamma[vcol.b[1]];
+	vcol.b[2] = ltgamma[vcol.b[2]];
+	vcol.b[3] = 0;
+
+	return vcol.l;
+}
+
+static inline __attribute__ ((target ("sse2"))) Uint32
+drawBlend4xSSE2(const Uint32 *palette, const Uint8 *ltgamma, Uint16 nb)
+{
+	__m128i		sum;
+
+	sum = drawSumSSE2(palette[(nb & 0x000FU) >> 0],
+			palette[(nb & 0x00F0U) >> 4],
+			palette[(nb & 0x0F00U) >> 8],
+			palette[(nb & 0xF000U) >> 12]);
+
+	return drawGammaSSE2(ltgamma, _mm_srli_epi16(sum, 2));
+}
+
+static inline __attribute__ ((target ("sse2"))) Uint32
+drawBlend8xSSE2(const Uint32 *palette, const Uint8 *ltgamma, const Uint16 *nb)
+{
+	__m128i		sum;
+
+	sum = _mm_add_epi16(drawSumSSE2(palette[(nb[0] & 0x000FU) >> 0],
+				palette[(nb[0] & 0x00F0U) >> 4],
+				palette[(nb[0] & 0x0F00U) >> 8],
+				palette[(nb[0] & 0xF000U) >> 12]),
+			drawSumSSE2(palette[(nb[1] & 0x000FU) >> 0],
+				palette[(nb[1] & 0x00F0U) >> 4],
+				palette[(nb[1] & 0x0F00U) >> 8],
+				palette[(nb[1] & 0xF000U) >> 12]));
+
+	return drawGammaSSE2(ltgamma, _mm_srli_epi16(sum, 3));
+}
+
+static __attribute__ ((target ("sse2"))) void
+drawFlushSSE2(draw_t *dw, SDL_Surface *surface, clipBox_t *cb)
+{
+	Uint32			*pixels = (Uint32 *) surface->pixels;
+	Uint32			palette[16];
+	Uint8			*ltgamma = dw->ltgamma;
+
+	__m128i			zero = _mm_setzero_si128();
+	int			pitch, x, y, n, yspan;
+
+	memcpy(palette, dw->palette, sizeof(palette));
+
+	pitch = surface->pitch / 4;
+	pixels += cb->min_y * pitch;
+
+	if (dw->antialiasing == DRAW_SOLID) {
+
+		Uint8		*canvas = (Uint8 *) dw->pixmap.canvas;
+
+		yspan = dw->pixmap.yspan;
+		canvas += cb->min_y * yspan;
+
+		for (y = cb->min_y; y <= cb->max_y; ++y) {
+
+			for (x = cb->min_x; x <= cb->max_x; ) {
+
+				if (		x + 16 <= cb->max_x + 1
+						&& _mm_movemask_epi8(_mm_cmpeq_epi8(zero,
+						_mm_loadu_si128((const __m128i *) (canvas + x)))) == 0xFFFF) {
+
+					x += 16;
+					continue;
+				}
+
+				for (n = x + 16; x < n && x <= cb->max_x; ++x) {
+
+					if (canvas[x] != 0)
+						pixels[x] = palette[canvas[x]];
+				}
+			}
+
+			pixels += pitch;
+			canvas += yspan;
+		}
+	}
+	else if (dw->antialiasing == DRAW_4X_MSAA) {
+
+		Uint16		*canvas = (Uint16 *) dw->pixmap.canvas;
+
+		yspan = dw->pixmap.yspan;
+		canvas += cb->min_y * yspan;
+
+		for (y = cb->min_y; y <= cb->max_y; ++y) {
+
+			for (x = cb->min_x; x <= cb->max_x; ) {
+
+				if (		x + 8 <= cb->max_x + 1
+						&& _mm_movemask_epi8(_mm_cmpeq_epi16(zero,
+						_mm_loadu_si128((const __m128i *) (canvas + x)))) == 0xFFFF) {
+
+					x += 8;
+					continue;
+				}
+
+				for (n = x + 8; x < n && x <= cb->max_x; ++x) {
+
+					if (canvas[x] != 0) {
+
+						palette[0] = pixels[x];
+						pixels[x] = drawBlend4xSSE2(palette, ltgamma, canvas[x]);
+					}
+				}
+			}
+
+			pixels += pitch;
+			canvas += yspan;
+		}
+	}
+	else if (dw->antialiasing == DRAW_8X_MSAA) {
+
+		Uint16		*canvas = (Uint16 *) dw->pixmap.canvas;
+
+		yspan = dw->pixmap.yspan * 2;
+		canvas += cb->min_y * yspan;
+
+		for (y = cb->min_y; y <= cb->max_y; ++y) {
+
+			for (x = cb->min_x; x <= cb->max_x; ) {
+
+				if (		x + 4 <= cb->max_x + 1
+						&& _mm_movemask_epi8(_mm_cmpeq_epi16(zero,
+						_mm_loadu_si128((const __m128i *) (canvas + x * 2)))) == 0xFFFF) {
+
+					x += 4;
+					continue;
+				}
+
+				for (n = x + 4; x < n && x <= cb->max_x; ++x) {
+
+					if (		   canvas[x * 2 + 0] != 0
+							|| canvas[x * 2 + 1] != 0) {
+
+						palette[0] = pixels[x];
+						pixels[x] = drawBlend8xSSE2(palette, ltgamma, canvas + x * 2);
+					}
+				}
+			}
+
+			pixels += pitch;
+			canvas += yspan;
+		}
+	}
+}
+
+static __attribute__ ((target ("avx2"))) int
+drawZeroAVX2(const void *canvas)
+{
+	__m256i		vcan = _mm256_loadu_si256((const __m256i *) canvas);
+
+	return _mm256_testz_si256(vcan, vcan);
+}
+
+static __attribute__ ((target ("avx2"))) void
+drawFlushAVX2(draw_t *dw, SDL_Surface *surface, clipBox_t *cb)
+{
+	Uint32			*pixels = (Uint32 *) surface->pixels;
+	Uint32			palette[16];
+	Uint8			*ltgamma = dw->ltgamma;
+
+	int			pitch, x, y, n, yspan;
+
+	memcpy(palette, dw->palette, sizeof(palette));
+
+	pitch = surface->pitch / 4;
+	pixels += cb->min_y * pitch;
+
+	if (dw->antialiasing == DRAW_SOLID) {
+
+		Uint8		*canvas = (Uint8 *) dw->pixmap.canvas;
+
+		yspan = dw->pixmap.yspan;
+		canvas += cb->min_y * yspan;
+
+		for (y = cb->min_y; y <= cb->max_y; ++y) {
+
+			for (x = cb->min_x; x <= cb->max_x; ) {
+
+				if (		x + 32 <= cb->max_x + 1
+						&& drawZeroAVX2(canvas + x) != 0) {
+
+					x += 32;
+					continue;
+				}
+
+				for (n = x + 32; x < n && x <= cb->max_x; ++x) {
+
+					if (canvas[x] != 0)
+						pixels[x] = palette[canvas[x]];
+				}
+			}
+
+			pixels += pitch;
+			canvas += yspan;
+		}
+	}
+	else if (dw->antialiasing == DRAW_4X_MSAA) {
+
+		Uint16		*canvas = (Uint16 *) dw->pixmap.canvas;
+
+		yspan = dw->pixmap.yspan;
+		canvas += cb->min_y * yspan;
+
+		for (y = cb->min_y; y <= cb->max_y; ++y) {
+
+			for (x = cb->min_x; x <= cb->max_x; ) {
+
+				if (		x + 16 <= cb->max_x + 1
+						&& drawZeroAVX2(canvas + x) != 0) {
+
+					x += 16;
+					continue;
+				}
+
+				for (n = x + 16; x < n && x <= cb->max_x; ++x) {
+
+					if (canvas[x] != 0) {
+
+						palette[0] = pixels[x];
+						pixels[x] = drawBlend4xSSE2(palette, ltgamma, canvas[x]);
+					}
+				}
+			}
+
+			pixels += pitch;
+			canvas += yspan;
+		}
+	}
+	else if (dw->antialiasing == DRAW_8X_MSAA) {
+
+		Uint16		*canvas = (Uint16 *) dw->pixmap.canvas;
+
+		yspan = dw->pixmap.yspan * 2;
+		canvas += cb->min_y * yspan;
+
+		for (y = cb->min_y; y <= cb->max_y; ++y) {
+
+			for (x = cb->min_x; x <= cb->max_x; ) {
+
+				if (		x + 8 <= cb->max_x + 1
+						&& drawZeroAVX2(canvas + x * 2) != 0) {
+
+					x += 8;
+					continue;
+				}
+
+				for (n = x + 8; x < n && x <= cb->max_x; ++x) {
+
+					if (		   canvas[x * 2 + 0] != 0
+							|| canvas[x * 2 + 1] != 0) {
+
+						palette[0] = pixels[x];
+						pixels[x] = drawBlend8xSSE2(palette, ltgamma, canvas + x * 2);
+					}
+				}
+			}
+
+			pixels += pitch;
+			canvas += yspan;
+		}
+	}
+}
+#endif /* _DRAW_SIMD_X86 */
+
+#ifdef _DRAW_SIMD_NEON
+static inline int
+drawZeroNEON(const void *canvas)
+{
+	uint64x2_t	vcan = vreinterpretq_u64_u8(vld1q_u8((const uint8_t *) canvas));
+
+	return ((vgetq_lane_u64(vcan, 0) | vgetq_lane_u64(vcan, 1)) == 0) ? 1 : 0;
+}
+
+static inline uint16x4_t
+drawSumNEON(Uint32 c0, Uint32 c1, Uint32 c2, Uint32 c3)
+{
+	uint32x2_t	vlo = vset_lane_u32(c1, vdup_n_u32(c0), 1);
+	uint32x2_t	vhi = vset_lane_u32(c3, vdup_n_u32(c2), 1);
+	uint16x8_t	sum;
+
+	sum = vaddl_u8(vreinterpret_u8_u32(vlo), vreinterpret_u8_u32(vhi));
+
+	return vadd_u16(vget_low_u16(sum), vget_high_u16(sum));
+}
+
+static inline Uint32
+drawGammaNEON(const Uint8 *ltgamma, uint16x4_t sum)
+{
+	union {
+
+		Uint32          l;
+		Uint8           b[4];
+	}
+	vcol;
+
+	vcol.b[0] = ltgamma[vget_lane_u16(sum, 0) & 0xFFU];
+	vcol.b[1] = ltgamma[vget_lane_u16(sum, 1) & 0xFFU];
+	vcol.b[2] = ltgamma[vget_lane_u16(sum, 2) & 0xFFU];
+	vcol.b[3] = 0;
+
+	return vcol.l;
+}
+
+static inline Uint32
+drawBlend4xNEON(const Uint32 *palette, const Uint8 *ltgamma, Uint16 nb)
+{
+	uint16x4_t	sum;
+
+	sum = drawSumNEON(palette[(nb & 0x000FU) >> 0],
+			palette[(nb & 0x00F0U) >> 4],
+			palette[(nb & 0x0F00U) >> 8],
+			palette[(nb & 0xF000U) >> 12]);
+
+	return drawGammaNEON(ltgamma, vshr_n_u16(sum, 2));
+}
+
+static inline Uint32
+drawBlend8xNEON(const Uint32 *palette, const Uint8 *ltgamma, const Uint16 *nb)
+{
+	uint16x4_t	sum;
+
+	sum = vadd_u16(drawSumNEON(palette[(nb[0] & 0x000FU) >> 0],
+				palette[(nb[0] & 0x00F0U) >> 4],
+				palette[(nb[0] & 0x0F00U) >> 8],
+				palette[(nb[0] & 0xF000U) >> 12]),
+			drawSumNEON(palette[(nb[1] & 0x000FU) >> 0],
+				palette[(nb[1] & 0x00F0U) >> 4],
+				palette[(nb[1] & 0x0F00U) >> 8],
+				palette[(nb[1] & 0xF000U) >> 12]));
+
+	return drawGammaNEON(ltgamma, vshr_n_u16(sum, 3));
+}
+
+static void
+drawFlushNEON(draw_t *dw, SDL_Surface *surface, clipBox_t *cb)
+{
+	Uint32			*pixels = (Uint32 *) surface->pixels;
+	Uint32			palette[16];
+	Uint8			*ltgamma = dw->ltgamma;
+
+	int			pitch, x, y, n, yspan;
+
+	memcpy(palette, dw->palette, sizeof(palette));
+
+	pitch = surface->pitch / 4;
+	pixels += cb->min_y * pitch;
+
+	if (dw->antialiasing == DRAW_SOLID) {
+
+		Uint8		*canvas = (Uint8 *) dw->pixmap.canvas;
+
+		yspan = dw->pixmap.yspan;
+		canvas += cb->min_y * yspan;
+
+		for (y = cb->min_y; y <= cb->max_y; ++y) {
+
+			for (x = cb->min_x; x <= cb->max_x; ) {
+
+				if (		x + 16 <= cb->max_x + 1
+						&& drawZeroNEON(canvas + x) != 0) {
+
+					x += 16;
+					continue;
+				}
+
+				for (n = x + 16; x < n && x <= cb->max_x; ++x) {
+
+					if (canvas[x] != 0)
+						pixels[x] = palette[canvas[x]];
+				}
+			}
+
+			pixels += pitch;
+			canvas += yspan;
+		}
+	}
+	else if (dw->antialiasing == DRAW_4X_MSAA) {
+
+		Uint16		*canvas = (Uint16 *) dw->pixmap.canvas;
+
+		yspan = dw->pixmap.yspan;
+		canvas += cb->min_y * yspan;
+
+		for (y = cb->min_y; y <= cb->max_y; ++y) {
+
+			for (x = cb->min_x; x <= cb->max_x; ) {
+
+				if (		x + 8 <= cb->max_x + 1
+						&& drawZeroNEON(canvas + x) != 0) {
+
+					x += 8;
+					continue;
+				}
+
+				for (n = x + 8; x < n && x <= cb->max_x; ++x) {
+
+					if (canvas[x] != 0) {
+
+						palette[0] = pixels[x];
+						pixels[x] = drawBlend4xNEON(palette, ltgamma, canvas[x]);
+					}
+				}
+			}
+
+			pixels += pitch;
+			canvas += yspan;
+		}
+	}
+	else if (dw->antialiasing == DRAW_8X_MSAA) {
+
+		Uint16		*canvas = (Uint16 *) dw->pixmap.canvas;
+
+		yspan = dw->pixmap.yspan * 2;
+		canvas += cb->min_y * yspan;
+
+		for (y = cb->min_y; y <= cb->max_y; ++y) {
+
+			for (x = cb->min_x; x <= cb->max_x; ) {
+
+				if (		x + 4 <= cb->max_x + 1
+						&& drawZeroNEON(canvas + x * 2) != 0) {
+
+					x += 4;
+					continue;
+				}
+
+				for (n = x + 4; x < n && x <= cb->max_x; ++x) {
+
+					if (		   canvas[x * 2 + 0] != 0
+							|| canvas[x * 2 + 1] != 0) {
+
+						palette[0] = pixels[x];
+						pixels[x] = drawBlend8xNEON(palette, ltgamma, canvas + x * 2);
+					}
+				}
+			}
+
+			pixels += pitch;
+			canvas += yspan;
+		}
+	}
+}
+#endif /* _DRAW_SIMD_NEON */
+
+static void
+drawFlushDispatch(draw_t *dw, SDL_Surface *surface, clipBox_t *cb)
 {
 	Uint32			*pixels = (Uint32 *) surface->pixels;
 	Uint32			*palette = dw->palette;
@@ -3324,6 +4090,27 @@ void drawFlushCanvas(draw_t *dw, SDL_Surface *surface, clipBox_t *cb)
 	int			pitch, x, y;
 	int			yspan, ncol, blend[3];
 
+#ifdef _DRAW_SIMD_X86
+	if (dw->simd == DRAW_SIMD_AVX2) {
+
+		drawFlushAVX2(dw, surface, cb);
+		return ;
+	}
+	else if (dw->simd == DRAW_SIMD_SSE2) {
+
+		drawFlushSSE2(dw, surface, cb);
+		return ;
+	}
+#endif /* _DRAW_SIMD_X86 */
+
+#ifdef _DRAW_SIMD_NEON
+	if (dw->simd == DRAW_SIMD_NEON) {
+
+		drawFlushNEON(dw, surface, cb);
+		return ;
+	}
+#endif /* _DRAW_SIMD_NEON */
+
 	pitch = surface->pitch / 4;
 	pixels += cb->min_y * pitch;
 
@@ -3512,3 +4299,14 @@ void drawFlushCanvas(draw_t *dw, SDL_Surface *surface, clipBox_t *cb)
 	}
 }
 
+void drawFlushCanvas(draw_t *dw, SDL_Surface *surface, clipBox_t *cb)
+{
+	Uint64		tSTART;
+
+	tSTART = SDL_GetPerformanceCounter();
+
+	drawFlushDispatch(dw, surface, cb);
+
+	dw->perf.flush += SDL_GetPerformanceCounter() - tSTART;
+}
+
@@ -22,6 +22,9 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
+#define DRAW_TEXT_CACHE_MAX	256
+#define DRAW_TEXT_LENGTH_MAX	80
+
 enum {
 	TEXT_CENTERED_ON_X	= 1,
 	TEXT_CENTERED_ON_Y	= 2,
@@ -48,6 +51,13 @@ enum {
 	DRAW_8X_MSAA,
 };
 
+enum {
+	DRAW_SIMD_NONE		= 0,
+	DRAW_SIMD_SSE2,
+	DRAW_SIMD_AVX2,
+	DRAW_SIMD_NEON
+};
+
 typedef struct {
 
 	int		min_x;
@@ -57,6 +67,23 @@ typedef struct {
 }
 clipBox_t;
 
+typedef struct {
+
+	TTF_Font	*font;
+	Uint32		col;
+
+	int		blendfont;
+	int		vertical;
+
+	Uint32		hash;
+	Uint32		clock;
+
+	char		text[DRAW_TEXT_LENGTH_MAX];
+
+	SDL_Surface	*surface;
+}
+dtext_t;
+
 typedef struct {
 
 	int		antialiasing;
@@ -64,6 +91,11 @@ typedef struct {
 	int		thickness;
 	int		gamma;
 
+	/* The vector instruction set that canvas flush is dispatched to. It
+	 * is probed at runtime so the same binary runs on any CPU.
+	 * */
+	int		simd;
+
 	int		dash_context;
 
 	int		cached_x;
@@ -71,6 +103,12 @@ typedef struct {
 	int		cached_max_y;
 	int		cached_ncol;
 
+	/* The range of canvas rows that drawing is allowed to touch. So the
+	 * canvas can be split into horizontal tiles drawn in parallel.
+	 * */
+	int		tile_min_y;
+	int		tile_max_y;
+
 	struct {
 
 		int	w;
@@ -81,16 +119,34 @@ typedef struct {
 
 		void	*canvas;
 		void	*trial;
+		void	*layer;
 	}
 	pixmap;
 
 	Uint32		palette[16];
 	Uint8		ltgamma[256];
 	Uint8		ltcomap[256];
+
+	/* The rendered strings are kept to be blitted on the next frames. The
+	 * least recently used one is replaced.
+	 * */
+	dtext_t		text[DRAW_TEXT_CACHE_MAX];
+	Uint32		text_clock;
+
+	/* The total time spent in text blit and canvas flush in performance
+	 * counter ticks. The caller takes the difference between frames.
+	 * */
+	struct {
+
+		Uint64		text;
+		Uint64		flush;
+	}
+	perf;
 }
 draw_t;
 
 void drawDashReset(draw_t *dw);
+void drawSIMDProbe(draw_t *dw);
 void drawGamma(draw_t *dw);
 
 Uint32 drawRGBMap(draw_t *dw, Uint32 col);
@@ -102,7 +158,24 @@ void drawClearTrial(draw_t *dw);
 void drawPixmapAlloc(draw_t *dw, SDL_Surface *surface);
 void drawPixmapClean(draw_t *dw);
 
+/* The layer pixmap keeps the figures drawn in the previous frames. So we can
+ * draw into it only the new segments and copy the result to the canvas.
+ * */
+void drawLayerSwap(draw_t *dw);
+void drawLayerCopy(draw_t *dw);
+
+/* Move the canvas content within the clip box by integer number of pixels.
+ * The exposed area is cleared.
+ * */
+void drawCanvasShift(draw_t *dw, clipBox_t *cb, int dx, int dy);
+
+/* Move the trial pixmap the same way so the segments that were drawn are
+ * still rejected at the new place.
+ * */
+void drawTrialShift(draw_t *dw, clipBox_t *cb, int dx, int dy);
+
 int clipBoxTest(clipBox_t *cb, int x, int y);
+int clipLine(clipBox_t *cb, double *xs, double *ys, double *xe, double *ye);
 
 void drawLine(draw_t *dw, SDL_Surface *surface, clipBox_t *cb, double fxs, double fys,
 		double fxe, double fye, Uint32 col);
@@ -122,6 +195,11 @@ int drawLineTrial(draw_t *dw, clipBox_t *cb, double fxs, double fys,
 void drawText(draw_t *dw, SDL_Surface *surface, TTF_Font *font, int xs, int ys,
 		const char *text, int flags, Uint32 col);
 
+/* Drop all of rendered strings. Must be called when the font is closed or
+ * its style or hinting is changed.
+ * */
+void drawTextFlush(draw_t *dw);
+
 void drawFillRect(SDL_Surface *surface, int xs, int ys,
 		int xe, int ye, Uint32 col);
 
@@ -49,11 +49,28 @@
 #define GP_CONFIG_VERSION	17
 #define GP_CONFIG_FILE		"gprc"
 
+#define GP_BATCH_LINE_MAX	4096
+#define GP_BATCH_ARG_MAX	100
+
 enum {
 	GP_TAKE_NONE		= 0,
 	GP_TAKE_PNG,
 	GP_TAKE_SVG,
-	GP_TAKE_CSV
+	GP_TAKE_CSV,
+	GP_TAKE_FP32,
+	GP_TAKE_FP64
+};
+
+enum {
+	GP_PERF_LOAD		= 0,
+	GP_PERF_SUBTRACT,
+	GP_PERF_RCACHE,
+	GP_PERF_TRIAL,
+	GP_PERF_RASTER,
+	GP_PERF_FLUSH,
+	GP_PERF_TEXT,
+	GP_PERF_BLIT,
+	GP_PERF_MAX
 };
 
 enum {
@@ -82,14 +99,23 @@ struct gp_context {
 	SDL_Surface	*fb;
 	SDL_Surface	*surface;
 
+	SDL_Renderer	*renderer;
+	SDL_Texture	*texture;
+	SDL_Surface	*shadow;
+
+	int		present_full;
+
 	char		sbuf[4][READ_FILE_PATH_MAX];
 
 	char		rcfile[READ_FILE_PATH_MAX];
 	char		tempfile[READ_FILE_PATH_MAX];
+	char		exportfile[READ_FILE_PATH_MAX];
 
 	int		quit;
 	int		stat;
 
+	int		batch;
+
 	int		active;
 	int		unfinished;
 	int		drawn;
@@ -109,6 +135,29 @@ struct gp_context {
 	int		fps_frame;
 	int		fps_value;
 
+	/* The stage timings averaged over the last second and the totals
+	 * taken at the beginning of it.
+	 * */
+	Uint32		perf_clock;
+	Uint64		perf_load;
+	Uint64		perf_blit;
+	Uint64		perf_total[GP_PERF_MAX];
+	double		perf_ms[GP_PERF_MAX];
+
+	int		perf_frame;
+	int		perf_fps;
+	int		perf_hit;
+	int		perf_lz4;
+
+	unsigned long long	perf_rows;
+	unsigned long long	perf_rows_last;
+	unsigned long long	perf_ingest;
+	unsigned long long	perf_dropped;
+	unsigned long long	perf_cache_hit;
+	unsigned long long	perf_cache_miss;
+
+	FILE		*stats_fd;
+
 	int		fullscreen;
 	int		hinting;
 
@@ -124,6 +173,7 @@ struct gp_context {
 	int		blank_N;
 
 	int		screen_take;
+	int		export_progress;
 	int		screen_yank;
 	int		legend_drag;
 	int		data_box_drag;
@@ -215,7 +265,7 @@ gpMakeBlank(gpcon_t *gp, int length)
 		return ;
 	}
 
-	plotDataAlloc(gp->pl, dN, 1, length + 1);
+	plotDataAlloc(gp->pl, dN, 1, length + 1, STORAGE_FP64);
 
 	rd->data[dN].row[0] = (fval_t) 0.;
 
@@ -284,7 +334,10 @@ gpDefaultFile(gpcon_t *gp)
 		fprintf(fd,	"font 24 \"normal\"\n"
 				"preload 8388608\n"
 				"chunk 4096\n"
+				"mmap 1\n"
+				"sidecar 0\n"
 				"timeout 5000\n"
+				"backpressure 0\n"
 				"windowsize 1200 900\n"
 				"language 0\n"
 				"colorscheme 0\n"
@@ -301,9 +354,16 @@ gpDefaultFile(gpcon_t *gp)
 				"timecol -1\n"
 				"shortfilename 1\n"
 				"fastdraw 200\n"
+				"renderer 0\n"
 				"interpolation 1\n"
 				"defungap 10\n"
-				"lz4_compress 1\n");
+				"lz4_compress 1\n"
+				"lz4_filter 1\n"
+				"cache 4\n"
+				"spill 0\n"
+				"columnar 0\n"
+				"lod 1\n"
+				"incremental 1\n");
 
 #ifdef _WINDOWS
 		fprintf(fd,	"legacy_label 1\n");
@@ -338,7 +398,10 @@ gpWriteFile(gpcon_t *gp)
 		fprintf(fd, "font %i \"%s\"\n", pl->layout_font_pt, ttfname);
 		fprintf(fd, "preload %i\n", rd->preload);
 		fprintf(fd, "chunk %i\n", rd->chunk);
+		fprintf(fd, "mmap %i\n", rd->mmap);
+		fprintf(fd, "sidecar %i\n", rd->sidecar);
 		fprintf(fd, "timeout %i\n", rd->timeout);
+		fprintf(fd, "backpressure %i\n", rd->backpressure);
 
 		if (gp->window != NULL) {
 
@@ -366,9 +429,16 @@ gpWriteFile(gpcon_t *gp)
 		fprintf(fd, "timecol %i\n", rd->timecol);
 		fprintf(fd, "shortfilename %i\n", rd->shortfilename);
 		fprintf(fd, "fastdraw %i\n", rd->fastdraw);
+		fprintf(fd, "renderer %i\n", rd->renderer);
 		fprintf(fd, "interpolation %i\n", pl->interpolation);
 		fprintf(fd, "defungap %i\n", pl->defungap);
 		fprintf(fd, "lz4_compress %i\n", pl->lz4_compress);
+		fprintf(fd, "lz4_filter %i\n", pl->lz4_filter);
+		fprintf(fd, "cache %i\n", pl->cache_size);
+		fprintf(fd, "spill %i\n", pl->spill_budget);
+		fprintf(fd, "columnar %i\n", pl->columnar);
+		fprintf(fd, "lod %i\n", pl->lod);
+		fprintf(fd, "incremental %i\n", pl->incremental);
 
 #ifdef _WINDOWS
 		fprintf(fd, "legacy_label %i\n", rd->legacy_label);
@@ -516,6 +586,8 @@ gpFontHinting(gpcon_t *gp)
 {
 	plot_t		*pl = gp->pl;
 
+	drawTextFlush(gp->dw);
+
 	if (gp->hinting == 0) {
 
 		TTF_SetFontHinting(pl->font, TTF_HINTING_NONE);
@@ -1180,7 +1252,9 @@ gpMakeDatasetMenu(gpcon_t *gp)
 	char		*la = gp->la_menu;
 
 	int		N, cN, gN, dN, len, fnlen, unwrap, opdata;
-	int		mbUSAGE, mbRAW, mbCACHE, lzPC;
+	int		mbUSAGE, mbRAW, mbCACHE, lzPC, hitPC;
+
+	unsigned long long	nHIT, nMISS;
 
 	len = gpFullLength(gp->pl) - gp->layout_menu_dataset_margin;
 	len = (len < gp->layout_menu_dataset_minimal)
@@ -1276,8 +1350,13 @@ gpMakeDatasetMenu(gpcon_t *gp)
 
 	lzPC = (mbRAW != 0) ? 100U * mbUSAGE / mbRAW : 0;
 
+	nHIT = plotDataCacheHit(pl, dN);
+	nMISS = plotDataCacheMiss(pl, dN);
+
+	hitPC = (nHIT + nMISS != 0) ? (int) (100U * nHIT / (nHIT + nMISS)) : 0;
+
 	sprintf(gp->sbuf[0], gp->la->dataset_menu[5],
-			rd->data[dN].length_N, mbUSAGE, lzPC, mbCACHE);
+			rd->data[dN].length_N, mbUSAGE, lzPC, mbCACHE, hitPC);
 
 	strcpy(la, gp->sbuf[0]);
 	la += strlen(la) + 1;
@@ -1532,6 +1611,8 @@ gpMakeAboutMenu(gpcon_t *gp)
 static void
 gpTakeScreen(gpcon_t *gp)
 {
+	int		format;
+
 	if (gp->screen_take == GP_TAKE_PNG) {
 
 		if (IMG_SavePNG(gp->surface, gp->tempfile) == 0) {
@@ -1549,11 +1630,33 @@ gpTakeScreen(gpcon_t *gp)
 			ERROR("Figure was saved to \"%s\"\n", gp->tempfile);
 		}
 	}
-	else if (gp->screen_take == GP_TAKE_CSV) {
+	else if (	gp->screen_take == GP_TAKE_CSV
+			|| gp->screen_take == GP_TAKE_FP32
+			|| gp->screen_take == GP_TAKE_FP64) {
+
+		format = (gp->screen_take == GP_TAKE_FP32) ? EXPORT_FP32
+			: (gp->screen_take == GP_TAKE_FP64) ? EXPORT_FP64 : EXPORT_CSV;
+
+		/* The table is written step by step on each frame.
+		 * */
+		if (plotFigureExportOpen(gp->pl, gp->tempfile, format) == 0) {
 
-		if (plotFigureExportCSV(gp->pl, gp->tempfile) == 0) {
+			strcpy(gp->exportfile, gp->tempfile);
 
-			ERROR("CSV table was saved to \"%s\"\n", gp->tempfile);
+			gp->export_progress = 0;
+
+			if (gp->window == NULL) {
+
+				while (gp->pl->export_job != NULL) {
+
+					gp->export_progress = plotFigureExportStep(gp->pl);
+				}
+
+				if (gp->export_progress == 100) {
+
+					ERROR("Table was saved to \"%s\"\n", gp->exportfile);
+				}
+			}
 		}
 	}
 
@@ -1698,7 +1801,7 @@ gpMenuHandle(gpcon_t *gp, int menu_N, int item_N)
 				editRaise(ed, 7, gp->la->file_name_edit,
 						gp->sbuf[0], mu->box_X, mu->box_Y);
 
-				ed->list_fmt = ".png\0" ".svg\0" ".csv\0";
+				ed->list_fmt = ".png\0" ".svg\0" ".csv\0" ".f32\0" ".f64\0";
 
 				gp->stat = GP_EDIT;
 				break;
@@ -2855,6 +2958,8 @@ gpMenuHandle(gpcon_t *gp, int menu_N, int item_N)
 				editRaise(ed, 7, gp->la->file_name_edit,
 						gp->sbuf[0], mu->box_X, mu->box_Y);
 
+				ed->list_fmt = ".csv\0" ".f32\0" ".f64\0";
+
 				gp->stat = GP_EDIT;
 				break;
 
@@ -3172,20 +3277,32 @@ gpEditHandle(gpcon_t *gp, int edit_N, const char *text)
 
 			gp->screen_take = GP_TAKE_PNG;
 		}
-		else if (strcmp(ft, ".svg") == 0) {
+		else if (	strcmp(ft, ".svg") == 0
+				|| (len > 4 && strcmp(ft - 1, ".svgz") == 0)) {
 
 			g = svgOpenNew(gp->tempfile, gp->surface->w, gp->surface->h);
 
-			g->font_family = "monospace";
-			g->font_pt = pl->layout_font_pt;
+			if (g != NULL) {
 
-			gp->surface->userdata = (void *) g;
-			gp->screen_take = GP_TAKE_SVG;
+				g->font_family = "monospace";
+				g->font_pt = pl->layout_font_pt;
+
+				gp->surface->userdata = (void *) g;
+				gp->screen_take = GP_TAKE_SVG;
+			}
 		}
 		else if (strcmp(ft, ".csv") == 0) {
 
 			gp->screen_take = GP_TAKE_CSV;
 		}
+		else if (strcmp(ft, ".f32") == 0) {
+
+			gp->screen_take = GP_TAKE_FP32;
+		}
+		else if (strcmp(ft, ".f64") == 0) {
+
+			gp->screen_take = GP_TAKE_FP64;
+		}
 	}
 	else if (edit_N == 8) {
 
@@ -3577,20 +3694,35 @@ gpEventHandle(gpcon_t *gp, const SDL_Event *ev)
 
 			if (gp->window != NULL) {
 
-				gp->fb = SDL_GetWindowSurface(gp->window);
+				int		w, h;
 
-				if (		gp->fb->w != gp->surface->w
-						|| gp->fb->h != gp->surface->h) {
+				if (gp->renderer != NULL) {
+
+					SDL_GetWindowSize(gp->window, &w, &h);
+				}
+				else {
+					gp->fb = SDL_GetWindowSurface(gp->window);
+
+					w = gp->fb->w;
+					h = gp->fb->h;
+				}
+
+				if (		w != gp->surface->w
+						|| h != gp->surface->h) {
 
 					SDL_FreeSurface(gp->surface);
 
-					gp->surface = SDL_CreateRGBSurfaceWithFormat(0, gp->fb->w,
-							gp->fb->h, 32, SDL_PIXELFORMAT_XRGB8888);
+					gp->surface = SDL_CreateRGBSurfaceWithFormat(0, w,
+							h, 32, SDL_PIXELFORMAT_XRGB8888);
 				}
 
 				gpScreenLayout(gp);
 			}
 		}
+		else if (ev->window.event == SDL_WINDOWEVENT_EXPOSED) {
+
+			gp->present_full = 1;
+		}
 		else if (ev->window.event == SDL_WINDOWEVENT_CLOSE) {
 
 			gp->quit = 1;
@@ -3697,7 +3829,7 @@ gpEventHandle(gpcon_t *gp, const SDL_Event *ev)
 			}
 			else if (ev->key.keysym.sym == SDLK_i) {
 
-				gp->fps_show = gp->fps_show ? 0 : 1;
+				gp->fps_show = (gp->fps_show < 2) ? gp->fps_show + 1 : 0;
 			}
 			else if (	ev->key.keysym.sym == SDLK_PAGEUP
 					|| ev->key.keysym.sym == SDLK_UP) {
@@ -4644,10 +4776,177 @@ gpDrawBoxSelect(SDL_Surface *surface, gpcon_t *gp)
 	SDL_UnlockSurface(surface);
 }
 
+static void
+gpPresentClean(gpcon_t *gp)
+{
+	if (gp->texture != NULL) {
+
+		SDL_DestroyTexture(gp->texture);
+		gp->texture = NULL;
+	}
+
+	if (gp->shadow != NULL) {
+
+		SDL_FreeSurface(gp->shadow);
+		gp->shadow = NULL;
+	}
+}
+
+static int
+gpPresentDirty(gpcon_t *gp, SDL_Rect *rect)
+{
+	const Uint8	*pixels = (const Uint8 *) gp->surface->pixels;
+	const Uint8	*shadow = (const Uint8 *) gp->shadow->pixels;
+
+	const Uint32	*row, *old;
+
+	int		pitch, len, x, y, min_x, max_x, min_y, max_y;
+
+	pitch = gp->surface->pitch;
+	len = gp->surface->w * 4;
+
+	min_y = -1;
+	max_y = -1;
+
+	for (y = 0; y < gp->surface->h; ++y) {
+
+		if (memcmp(pixels + y * pitch, shadow + y * pitch, len) != 0) {
+
+			min_y = (min_y < 0) ? y : min_y;
+			max_y = y;
+		}
+	}
+
+	if (min_y < 0)
+		return 0;
+
+	min_x = gp->surface->w;
+	max_x = -1;
+
+	/* Narrow the changed area to the columns too. We only go over the
+	 * rows that are known to be different.
+	 * */
+	for (y = min_y; y <= max_y; ++y) {
+
+		row = (const Uint32 *) (pixels + y * pitch);
+		old = (const Uint32 *) (shadow + y * pitch);
+
+		for (x = 0; x < min_x; ++x) {
+
+			if (row[x] != old[x]) {
+
+				min_x = x;
+				break;
+			}
+		}
+
+		for (x = gp->surface->w - 1; x > max_x; --x) {
+
+			if (row[x] != old[x]) {
+
+				max_x = x;
+				break;
+			}
+		}
+	}
+
+	if (max_x < min_x)
+		return 0;
+
+	rect->x = min_x;
+	rect->y = min_y;
+	rect->w = max_x - min_x + 1;
+	rect->h = max_y - min_y + 1;
+
+	return 1;
+}
+
+static void
+gpPresent(gpcon_t *gp)
+{
+	SDL_Rect	rect;
+
+	const Uint8	*pixels;
+	Uint8		*shadow;
+
+	int		pitch, y;
+
+	if (gp->renderer == NULL) {
+
+		SDL_BlitSurface(gp->surface, NULL, gp->fb, NULL);
+		SDL_UpdateWindowSurface(gp->window);
+
+		return ;
+	}
+
+	if (		gp->shadow != NULL
+			&& (	   gp->shadow->w != gp->surface->w
+				|| gp->shadow->h != gp->surface->h)) {
+
+		gpPresentClean(gp);
+	}
+
+	if (gp->texture == NULL) {
+
+		gp->texture = SDL_CreateTexture(gp->renderer, SDL_PIXELFORMAT_XRGB8888,
+				SDL_TEXTUREACCESS_STREAMING, gp->surface->w, gp->surface->h);
+
+		if (gp->texture == NULL) {
+
+			ERROR("SDL_CreateTexture: %s\n", SDL_GetError());
+			return ;
+		}
+
+		gp->shadow = SDL_CreateRGBSurfaceWithFormat(0, gp->surface->w,
+				gp->surface->h, 32, SDL_PIXELFORMAT_XRGB8888);
+
+		gp->present_full = 1;
+	}
+
+	/* We keep a copy of the last uploaded frame to find out what area was
+	 * changed. Only this area is uploaded to the texture.
+	 * */
+	if (		gp->present_full != 0
+			|| gp->shadow == NULL
+			|| gp->shadow->pitch != gp->surface->pitch) {
+
+		rect.x = 0;
+		rect.y = 0;
+		rect.w = gp->surface->w;
+		rect.h = gp->surface->h;
+	}
+	else if (gpPresentDirty(gp, &rect) == 0) {
+
+		return ;
+	}
+
+	pitch = gp->surface->pitch;
+	pixels = (const Uint8 *) gp->surface->pixels + rect.y * pitch + rect.x * 4;
+
+	SDL_UpdateTexture(gp->texture, &rect, pixels, pitch);
+
+	if (		gp->shadow != NULL
+			&& gp->shadow->pitch == pitch) {
+
+		shadow = (Uint8 *) gp->shadow->pixels + rect.y * pitch + rect.x * 4;
+
+		for (y = 0; y < rect.h; ++y) {
+
+			memcpy(shadow + y * pitch, pixels + y * pitch, rect.w * 4);
+		}
+	}
+
+	SDL_RenderCopy(gp->renderer, gp->texture, NULL, NULL);
+	SDL_RenderPresent(gp->renderer);
+
+	gp->present_full = 0;
+}
+
 static void
 gpFPSUpdate(gpcon_t *gp)
 {
 	gp->fps_frame += 1;
+	gp->perf_frame += 1;
 
 	if (gp->fps_clock < gp->clock) {
 
@@ -4657,7 +4956,178 @@ gpFPSUpdate(gpcon_t *gp)
 	}
 }
 
-gpcon_t *gp_Alloc()
+static void
+gpPerfStats(gpcon_t *gp)
+{
+	read_t		*rd = gp->rd;
+
+	int		N;
+
+	if (gp->stats_fd == NULL) {
+
+		if (strcmp(rd->statsfile, "-") == 0) {
+
+			gp->stats_fd = stdout;
+		}
+		else {
+			gp->stats_fd = unified_fopen(rd->statsfile, "w");
+
+			if (gp->stats_fd == NULL) {
+
+				ERROR("fopen(\"%s\"): %s\n", rd->statsfile, strerror(errno));
+
+				rd->statsfile[0] = 0;
+				return ;
+			}
+		}
+
+		fprintf(gp->stats_fd, "time@s;fps;load@ms;subtract@ms;rcache@ms;"
+				"trial@ms;raster@ms;flush@ms;text@ms;blit@ms;"
+				"hit@%%;lz4@%%;ingest@row/s;dropped\n");
+	}
+
+	fprintf(gp->stats_fd, "%.3f;%i", (double) gp->clock / 1000., gp->perf_fps);
+
+	for (N = 0; N < GP_PERF_MAX; ++N) {
+
+		fprintf(gp->stats_fd, ";%.3f", gp->perf_ms[N]);
+	}
+
+	fprintf(gp->stats_fd, ";%i;%i;%llu;%llu\n", gp->perf_hit, gp->perf_lz4,
+			gp->perf_ingest, gp->perf_dropped);
+
+	fflush(gp->stats_fd);
+}
+
+static void
+gpPerfUpdate(gpcon_t *gp)
+{
+	draw_t		*dw = gp->dw;
+	plot_t		*pl = gp->pl;
+	read_t		*rd = gp->rd;
+
+	Uint64			total[GP_PERF_MAX];
+	unsigned long long	nHIT = 0U, nMISS = 0U, uSIZE = 0U, rSIZE = 0U;
+	double			freq;
+
+	int		N, dN, interval;
+
+	if (gp->fps_show != 2 && rd->statsfile[0] == 0)
+		return ;
+
+	if (gp->perf_clock > gp->clock)
+		return ;
+
+	/* The first call only takes the totals so the second one is full.
+	 * */
+	interval = (gp->perf_clock != 0U) ? gp->clock - gp->perf_clock + 1000 : 0;
+
+	total[GP_PERF_LOAD] = gp->perf_load;
+	total[GP_PERF_SUBTRACT] = pl->perf.subtract;
+	total[GP_PERF_RCACHE] = pl->perf.rcache;
+	total[GP_PERF_TRIAL] = pl->perf.trial;
+	total[GP_PERF_RASTER] = pl->perf.raster;
+	total[GP_PERF_FLUSH] = dw->perf.flush;
+	total[GP_PERF_TEXT] = dw->perf.text;
+	total[GP_PERF_BLIT] = gp->perf_blit;
+
+	freq = (double) SDL_GetPerformanceFrequency();
+
+	for (N = 0; N < GP_PERF_MAX; ++N) {
+
+		gp->perf_ms[N] = (gp->perf_frame != 0) ? (double) (total[N]
+				- gp->perf_total[N]) * 1E+3 / freq / gp->perf_frame : 0.;
+
+		gp->perf_total[N] = total[N];
+	}
+
+	gp->perf_dropped = 0U;
+
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+
+		if (pl->data[dN].column_N != 0) {
+
+			nHIT += plotDataCacheHit(pl, dN);
+			nMISS += plotDataCacheMiss(pl, dN);
+
+			uSIZE += plotDataMemoryUsage(pl, dN);
+			rSIZE += plotDataMemoryUncompressed(pl, dN);
+		}
+
+		if (rd->data[dN].afd != NULL) {
+
+			gp->perf_dropped += SDL_AtomicGet(&rd->data[dN].afd->dropped);
+		}
+	}
+
+	gp->perf_hit = (nHIT + nMISS > gp->perf_cache_hit + gp->perf_cache_miss)
+		? (int) (100U * (nHIT - gp->perf_cache_hit) / (nHIT + nMISS
+			- gp->perf_cache_hit - gp->perf_cache_miss)) : 100;
+
+	gp->perf_cache_hit = nHIT;
+	gp->perf_cache_miss = nMISS;
+
+	gp->perf_lz4 = (rSIZE != 0U) ? (int) (100U * uSIZE / rSIZE) : 100;
+
+	if (interval > 0) {
+
+		gp->perf_fps = gp->perf_frame * 1000 / interval;
+		gp->perf_ingest = (gp->perf_rows - gp->perf_rows_last) * 1000U / interval;
+	}
+
+	gp->perf_rows_last = gp->perf_rows;
+
+	gp->perf_frame = 0;
+	gp->perf_clock = gp->clock + 1000U;
+
+	if (		interval > 0
+			&& rd->statsfile[0] != 0) {
+
+		gpPerfStats(gp);
+	}
+}
+
+static void
+gpDrawPerf(gpcon_t *gp)
+{
+	plot_t		*pl = gp->pl;
+
+	const char	*name[GP_PERF_MAX] = { "load", "subtract", "rcache",
+		"trial", "raster", "flush", "text", "blit" };
+
+	char		line[GP_PERF_MAX + 4][40];
+	int		N, line_N, xs, ys;
+
+	for (N = 0; N < GP_PERF_MAX; ++N) {
+
+		sprintf(line[N], "%-8s %9.2f ms", name[N], gp->perf_ms[N]);
+	}
+
+	line_N = GP_PERF_MAX;
+
+	sprintf(line[line_N++], "%-8s %9i %% ", "hit", gp->perf_hit);
+	sprintf(line[line_N++], "%-8s %9i %% ", "lz4", gp->perf_lz4);
+	sprintf(line[line_N++], "%-8s %9llu /s", "ingest", gp->perf_ingest);
+	sprintf(line[line_N++], "%-8s %9llu   ", "dropped", gp->perf_dropped);
+
+	xs = pl->screen.max_x - (21 * pl->layout_font_long + 12);
+	ys = pl->screen.min_y;
+
+	drawFillRect(gp->surface, xs, ys, pl->screen.max_x,
+			ys + line_N * pl->layout_font_height + 6,
+			pl->sch->plot_background);
+
+	for (N = 0; N < line_N; ++N) {
+
+		drawText(gp->dw, gp->surface, pl->font, xs + 6,
+				ys + 3 + N * pl->layout_font_height
+				+ pl->layout_font_height / 2,
+				line[N], TEXT_CENTERED_ON_Y, 0xFF0000);
+	}
+}
+
+static gpcon_t *
+gpAllocBase()
 {
 	gpcon_t		*gp;
 	scheme_t	*sch;
@@ -4684,6 +5154,8 @@ gpcon_t *gp_Alloc()
 	dw->thickness = 2;
 	dw->gamma = 50;
 
+	drawSIMDProbe(dw);
+
 	pl = plotAlloc(dw, sch);
 	gp->pl = pl;
 
@@ -4702,6 +5174,17 @@ gpcon_t *gp_Alloc()
 	gp->cwd[0] = '.';
 	gp->cwd[1] = 0;
 
+	return gp;
+}
+
+gpcon_t *gp_Alloc()
+{
+	gpcon_t		*gp;
+	read_t		*rd;
+
+	gp = gpAllocBase();
+	rd = gp->rd;
+
 	gpFileGetPath(gp);
 
 #ifdef _LOCAL_GP
@@ -4762,13 +5245,27 @@ void gp_Clean(gpcon_t *gp)
 		SDL_FreeSurface(gp->surface);
 	}
 
+	if (		gp->stats_fd != NULL
+			&& gp->stats_fd != stdout) {
+
+		fclose(gp->stats_fd);
+	}
+
+	gpPresentClean(gp);
+	drawTextFlush(dw);
+
+	if (gp->renderer != NULL) {
+
+		SDL_DestroyRenderer(gp->renderer);
+	}
+
 	if (gp->window != NULL) {
 
 		SDL_DestroyWindow(gp->window);
 	}
 
-	plotClean(pl);
 	readClean(rd);
+	plotClean(pl);
 	menuClean(mu);
 	editClean(ed);
 
@@ -4871,40 +5368,123 @@ Uint32 gp_OpenWindow(gpcon_t *gp)
 	SDL_SetWindowMinimumSize(gp->window, GP_MIN_SIZE_X, GP_MIN_SIZE_Y);
 	SDL_StopTextInput();
 
-	gp->fb = SDL_GetWindowSurface(gp->window);
+	if (gp->window != NULL && rd->renderer != 0) {
 
-	if (gp->fb == NULL) {
+		gp->renderer = SDL_CreateRenderer(gp->window, -1, SDL_RENDERER_ACCELERATED);
 
-		ERROR("SDL_GetWindowSurface: %s\n", SDL_GetError());
+		if (gp->renderer == NULL) {
 
-		gp->quit = 1;
+			ERROR("SDL_CreateRenderer: %s\n", SDL_GetError());
+		}
+	}
+
+	if (gp->renderer == NULL) {
+
+		gp->fb = SDL_GetWindowSurface(gp->window);
+
+		if (gp->fb == NULL) {
+
+			ERROR("SDL_GetWindowSurface: %s\n", SDL_GetError());
+
+			gp->quit = 1;
+		}
 	}
 
 	return gp->window_ID;
 }
 
-int gp_DataAdd(gpcon_t *gp, int dN, const double *payload)
+int gp_DataAddBlock(gpcon_t *gp, int dN, const double *payload, int nrows)
 {
 	plot_t		*pl = gp->pl;
 	read_t		*rd = gp->rd;
+	async_FILE	*afd;
 
-	int		rc, N = 0;
+	int		rc, nw, cN, N = 0;
+	Uint32		tSTOP;
 
 	if (		dN >= 0 && dN < PLOT_DATASET_MAX
 			&& rd->data[dN].format == FORMAT_STUB_DATA) {
 
-		rc = async_write(rd->data[dN].afd, (void *) payload,
-				pl->data[dN].column_N * sizeof(double));
+		afd = rd->data[dN].afd;
+		cN = pl->data[dN].column_N;
+
+		tSTOP = SDL_GetTicks() + (Uint32) rd->timeout;
+
+		while (N < nrows) {
+
+			nw = nrows - N;
 
-		if (rc == ASYNC_OK) {
+			rc = async_write_block(afd, (const char *) (payload + N * cN),
+					cN * sizeof(double), &nw);
 
-			N = 1;
+			if (rc == ASYNC_OK) {
+
+				N += nw;
+			}
+			else if (	rd->backpressure != 0
+					&& SDL_GetTicks() < tSTOP) {
+
+				/* Wait for the reader to free up the space.
+				 * */
+				SDL_AtomicAdd(&afd->blocked, 1);
+				SDL_Delay(1);
+			}
+			else {
+				SDL_AtomicAdd(&afd->dropped, nrows - N);
+				break;
+			}
 		}
 	}
 
 	return N;
 }
 
+int gp_DataAdd(gpcon_t *gp, int dN, const double *payload)
+{
+	return gp_DataAddBlock(gp, dN, payload, 1);
+}
+
+int gp_DataStat(gpcon_t *gp, int dN, gpstat_t *st)
+{
+	plot_t		*pl = gp->pl;
+	read_t		*rd = gp->rd;
+	async_FILE	*afd;
+
+	int		rp, wp, size;
+
+	if (		dN >= 0 && dN < PLOT_DATASET_MAX
+			&& (	   rd->data[dN].format == FORMAT_STUB_DATA
+				|| rd->data[dN].socket != 0)) {
+
+		afd = rd->data[dN].afd;
+
+		if (rd->data[dN].socket != 0) {
+
+			/* Datagrams are counted for socket and the fill is
+			 * given in rows or bytes of text.
+			 * */
+			size = (afd->frame != 0) ? afd->frame : 1;
+		}
+		else {
+			size = pl->data[dN].column_N * sizeof(double);
+		}
+
+		rp = SDL_AtomicGet(&afd->rp);
+		wp = SDL_AtomicGet(&afd->wp);
+
+		st->accepted = SDL_AtomicGet(&afd->accepted);
+		st->dropped = SDL_AtomicGet(&afd->dropped);
+		st->blocked = SDL_AtomicGet(&afd->blocked);
+
+		st->fill_N = ((wp < rp) ? wp + afd->preload - rp : wp - rp) / size;
+		st->size_N = (afd->preload - 1) / size;
+
+		return 1;
+	}
+
+	return 0;
+}
+
 void gp_FileReload(gpcon_t *gp)
 {
 	read_t		*rd = gp->rd;
@@ -4977,10 +5557,20 @@ int gp_Draw(gpcon_t *gp)
 	menu_t		*mu = gp->mu;
 	edit_t		*ed = gp->ed;
 
+	Uint64		tSTART;
+	int		line_N;
+
 	gp->clock = SDL_GetTicks();
 	gp->drawn = 0;
 
-	if (readDataLoad(rd) != 0) {
+	tSTART = SDL_GetPerformanceCounter();
+
+	line_N = readDataLoad(rd);
+
+	gp->perf_load += SDL_GetPerformanceCounter() - tSTART;
+	gp->perf_rows += line_N;
+
+	if (line_N != 0) {
 
 		gp->active = 1;
 	}
@@ -4995,6 +5585,18 @@ int gp_Draw(gpcon_t *gp)
 		gp->active = 1;
 	}
 
+	if (pl->export_job != NULL) {
+
+		gp->export_progress = plotFigureExportStep(pl);
+
+		if (gp->export_progress == 100) {
+
+			ERROR("Table was saved to \"%s\"\n", gp->exportfile);
+		}
+
+		gp->active = 1;
+	}
+
 	if (gp->active != 0) {
 
 		gp->idled = 0;
@@ -5057,6 +5659,9 @@ int gp_Draw(gpcon_t *gp)
 
 			if (gp->level > 4) {
 
+				ERROR("Antialiasing is turned off as drawing took %i ms\n",
+						(int) (t1 - t0));
+
 				dw->antialiasing = DRAW_SOLID;
 				gp->level = 0;
 			}
@@ -5112,10 +5717,38 @@ int gp_Draw(gpcon_t *gp)
 					gp->sbuf[0], TEXT_CENTERED_ON_Y, 0xFF0000);
 		}
 
+		if (		gp->window != NULL
+				&& pl->export_job != NULL) {
+
+			int		len, jam;
+
+			sprintf(gp->sbuf[0], "EXPORT %2d%%", gp->export_progress);
+
+			TTF_SizeUTF8(pl->font, gp->sbuf[0], &len, &jam);
+
+			drawFillRect(gp->surface, pl->screen.min_x,
+					pl->screen.min_y - gp->layout_page_box,
+					pl->screen.min_x + (len + 12), pl->screen.min_y,
+					pl->sch->plot_background);
+
+			drawText(gp->dw, gp->surface, pl->font, pl->screen.min_x + 6,
+					pl->screen.min_y + gp->layout_page_title_offset,
+					gp->sbuf[0], TEXT_CENTERED_ON_Y, 0xFF0000);
+		}
+
+		if (		gp->window != NULL
+				&& gp->fps_show == 2) {
+
+			gpDrawPerf(gp);
+		}
+
 		if (gp->window != NULL) {
 
-			SDL_BlitSurface(gp->surface, NULL, gp->fb, NULL);
-			SDL_UpdateWindowSurface(gp->window);
+			tSTART = SDL_GetPerformanceCounter();
+
+			gpPresent(gp);
+
+			gp->perf_blit += SDL_GetPerformanceCounter() - tSTART;
 		}
 
 		gpFPSUpdate(gp);
@@ -5128,6 +5761,8 @@ int gp_Draw(gpcon_t *gp)
 		gp->drawn = 1;
 	}
 
+	gpPerfUpdate(gp);
+
 	gpTakeScreen(gp);
 	gpYankScreen(gp);
 
@@ -5192,15 +5827,18 @@ void gp_SaveSVG(gpcon_t *gp, const char *file)
 
 		g = svgOpenNew(gp->tempfile, gp->surface->w, gp->surface->h);
 
-		g->font_family = "monospace";
-		g->font_pt = pl->layout_font_pt;
+		if (g != NULL) {
+
+			g->font_family = "monospace";
+			g->font_pt = pl->layout_font_pt;
 
-		gp->surface->userdata = (void *) g;
+			gp->surface->userdata = (void *) g;
 
-		gp->screen_take = GP_TAKE_SVG;
-		gp->unfinished = 1;
+			gp->screen_take = GP_TAKE_SVG;
+			gp->unfinished = 1;
 
-		(void) gp_Draw(gp);
+			(void) gp_Draw(gp);
+		}
 	}
 }
 
@@ -5217,10 +5855,14 @@ gpUsageHelp()
 		"  -l[n]          Color scheme number\n"
 		"  -pcn[n]        Select and combine pages\n"
 		"  -a[n] min max  Axis zoom to specified range\n"
-		"  -g    file     Save to PNG/SVG file\n"
+		"  -g    file     Save to PNG/SVG/SVGZ file\n"
+		"  -b[n] file     Render manifest lines on n threads\n"
 		"  -q             Do not open window\n");
 }
 
+static void
+gpBatchRun(gpcon_t *gp, const char *file, int job_N);
+
 static void
 gpGetCMD(gpcon_t *gp, int argn, char *argv[])
 {
@@ -5260,6 +5902,53 @@ gpGetCMD(gpcon_t *gp, int argn, char *argv[])
 					break;
 				}
 			}
+			else if (*op == 'b') {
+
+				int		job_N;
+
+				op++;
+
+				job_N = SDL_GetCPUCount();
+
+				if (*op != 0) {
+
+					if (stoi(&rd->mk_config, &argi, op) == NULL)
+						goto gpGetCMD_END;
+
+					if (argi < 1)
+						goto gpGetCMD_END;
+
+					job_N = argi;
+				}
+
+				if (n + 1 >= argn)
+					goto gpGetCMD_END;
+
+				failed = 0;
+				n++;
+
+				if (gp->batch != 0) {
+
+					ERROR("CMD: nested batch \"%.80s\"\n", argv[n]);
+
+					goto gpGetCMD_NEXT;
+				}
+
+				if (strlen(argv[n]) >= READ_FILE_PATH_MAX) {
+
+					ERROR("CMD: too long input file name \"%.80s\"\n", argv[n]);
+
+					goto gpGetCMD_NEXT;
+				}
+#ifdef _WINDOWS
+				legacy_ACP_to_UTF8(gp->tempfile, argv[n], READ_FILE_PATH_MAX);
+#else /* _WINDOWS */
+				strcpy(gp->tempfile, argv[n]);
+#endif
+				gpBatchRun(gp, gp->tempfile, job_N);
+
+				gp->quit = 1;
+			}
 			else if (*op == 'k') {
 
 				op++;
@@ -5515,7 +6204,8 @@ gpGetCMD(gpcon_t *gp, int argn, char *argv[])
 							goto gpGetCMD_NEXT;
 						}
 					}
-					else if (strcmp(op, ".svg") == 0) {
+					else if (	strcmp(op, ".svg") == 0
+							|| (len > 4 && strcmp(op - 1, ".svgz") == 0)) {
 
 						if (gp_PageSafe(gp) != 0) {
 
@@ -5576,6 +6266,235 @@ gpGetCMD_NEXT:
 	}
 }
 
+typedef struct {
+
+	const char	*file;
+	const char	*config;
+
+	SDL_mutex	*font_lock;
+	int		thread_N;
+
+	char		line[GP_BATCH_LINE_MAX];
+	int		line_N;
+
+	ptask_t		task;
+}
+gpbatch_t;
+
+static char *
+gpBatchConfig(const char *file)
+{
+	FILE		*fd;
+	char		*config;
+	long		len;
+
+	fd = unified_fopen(file, "rb");
+
+	if (fd == NULL)
+		return NULL;
+
+	fseek(fd, 0, SEEK_END);
+	len = ftell(fd);
+	fseek(fd, 0, SEEK_SET);
+
+	config = (len >= 0) ? (char *) malloc(len + 1) : NULL;
+
+	if (config != NULL) {
+
+		len = fread(config, 1, len, fd);
+		config[len] = 0;
+	}
+
+	fclose(fd);
+
+	return config;
+}
+
+static int
+gpBatchSplit(char *line, char *argv[])
+{
+	char		*s = line;
+	int		argn = 1;
+
+	argv[0] = "gp";
+
+	do {
+		while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n')
+			s++;
+
+		if (*s == 0 || *s == '#')
+			break;
+
+		if (argn >= GP_BATCH_ARG_MAX - 1)
+			break;
+
+		if (*s == '"') {
+
+			argv[argn++] = ++s;
+
+			while (*s != 0 && *s != '"')
+				s++;
+		}
+		else {
+			argv[argn++] = s;
+
+			while (		*s != 0 && *s != ' ' && *s != '\t'
+					&& *s != '\r' && *s != '\n')
+				s++;
+		}
+
+		if (*s != 0) {
+
+			*s++ = 0;
+		}
+	}
+	while (1);
+
+	argv[argn] = NULL;
+
+	return argn;
+}
+
+static void
+gpBatchJOB(gpbatch_t *jb)
+{
+	gpcon_t		*gp;
+	plot_t		*pl;
+
+	char		*argv[GP_BATCH_ARG_MAX];
+	int		argn;
+
+	argn = gpBatchSplit(jb->line, argv);
+
+	if (argn < 2)
+		return ;
+
+	gp = gpAllocBase();
+	pl = gp->pl;
+
+	gp->batch = 1;
+
+	/* Jobs are already running in parallel so each context gets only
+	 * its share of threads to draw.
+	 * */
+	if (pl->pool != NULL) {
+
+		poolClean(pl->pool);
+	}
+
+	pl->pool = (jb->thread_N > 1) ? poolAlloc(jb->thread_N) : NULL;
+	pl->font_lock = jb->font_lock;
+
+	if (jb->config != NULL) {
+
+		readConfigIN(gp->rd, jb->config, 0);
+	}
+
+	gpGetCMD(gp, argn, argv);
+
+	gp_Clean(gp);
+}
+
+static void
+gpBatchRun(gpcon_t *gp, const char *file, int job_N)
+{
+	gpbatch_t	*ba, *jb;
+	pool_t		*pool;
+	FILE		*fd;
+	char		*config;
+	SDL_mutex	*font_lock;
+	int		N, line_N, cpu_N, thread_N;
+
+	fd = unified_fopen(file, "r");
+
+	if (fd == NULL) {
+
+		ERROR("fopen(\"%s\"): %s\n", file, strerror(errno));
+		return ;
+	}
+
+	job_N = (job_N < 1) ? 1 : (job_N > POOL_THREAD_MAX) ? POOL_THREAD_MAX : job_N;
+
+	ba = (gpbatch_t *) calloc(job_N, sizeof(gpbatch_t));
+
+	if (ba == NULL) {
+
+		ERROR("No memory allocated for batch jobs\n");
+
+		fclose(fd);
+		return ;
+	}
+
+	/* We parse the configuration file once and give its content to
+	 * each context. The embedded fonts are shared as is.
+	 * */
+	config = (gp->rcfile[0] != 0) ? gpBatchConfig(gp->rcfile) : NULL;
+
+	cpu_N = SDL_GetCPUCount();
+	thread_N = (cpu_N > job_N) ? cpu_N / job_N : 0;
+
+	pool = poolAlloc(job_N);
+	font_lock = SDL_CreateMutex();
+
+	N = 0;
+	line_N = 0;
+
+	do {
+		jb = &ba[N % job_N];
+
+		/* Wait for the job that used this slot before.
+		 * */
+		poolWait(pool, &jb->task);
+
+		if (fgets(jb->line, GP_BATCH_LINE_MAX, fd) == NULL)
+			break;
+
+		line_N++;
+
+		if (		strchr(jb->line, '\n') == NULL
+				&& strlen(jb->line) == GP_BATCH_LINE_MAX - 1) {
+
+			ERROR("%s:%i: too long manifest line\n", file, line_N);
+
+			do {
+				if (fgets(jb->line, GP_BATCH_LINE_MAX, fd) == NULL)
+					break;
+			}
+			while (strchr(jb->line, '\n') == NULL);
+
+			continue;
+		}
+
+		jb->file = file;
+		jb->config = config;
+		jb->font_lock = font_lock;
+		jb->thread_N = thread_N;
+		jb->line_N = line_N;
+
+		poolSubmit(pool, &jb->task, (void (*) (void *)) &gpBatchJOB, jb);
+
+		N++;
+	}
+	while (1);
+
+	for (N = 0; N < job_N; ++N) {
+
+		poolWait(pool, &ba[N].task);
+	}
+
+	poolClean(pool);
+
+	SDL_DestroyMutex(font_lock);
+
+	if (config != NULL) {
+
+		free(config);
+	}
+
+	free(ba);
+	fclose(fd);
+}
+
 static void
 gpHelloPage(gpcon_t *gp)
 {
@@ -31,6 +31,17 @@ enum {
 	GP_PAGE_NO_REMAP
 };
 
+typedef struct {
+
+	int		accepted;
+	int		dropped;
+	int		blocked;
+
+	int		fill_N;
+	int		size_N;
+}
+gpstat_t;
+
 gpcon_t *gp_Alloc();
 void gp_Clean(gpcon_t *gp);
 
@@ -41,6 +52,19 @@ SDL_Surface *gp_GetSurface(gpcon_t *gp);
 Uint32 gp_OpenWindow(gpcon_t *gp);
 
 int gp_DataAdd(gpcon_t *gp, int dN, const double *payload);
+
+/* Add NROWS rows of stub dataset at once. It is safe to call from several
+ * threads. Returns the number of rows accepted, the rest are dropped if the
+ * ring is full (or after timeout if backpressure is enabled).
+ * */
+int gp_DataAddBlock(gpcon_t *gp, int dN, const double *payload, int nrows);
+
+/* Get the number of rows accepted, dropped, producer waits and the current
+ * ring fill of stub dataset. For socket dataset the number of datagrams
+ * accepted and lost is given.
+ * */
+int gp_DataStat(gpcon_t *gp, int dN, gpstat_t *st);
+
 void gp_FileReload(gpcon_t *gp);
 void gp_PageCombine(gpcon_t *gp, int pN, int remap);
 int gp_PageSafe(gpcon_t *gp);
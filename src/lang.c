@@ -90,7 +90,7 @@ void langFill(lang_t *la, int lang)
 		la->dataset_menu[2] = " Time unwrap  [ %s ]";
 		la->dataset_menu[3] = " Data median  [ %s ]";
 		la->dataset_menu[4] = " Time scale   [ %s ]";
-		la->dataset_menu[5] = " Length       [ %3i ]  %iM (%i%%) cache %iM";
+		la->dataset_menu[5] = " Length       [ %3i ]  %iM (%i%%) cache %iM (%i%%)";
 		la->dataset_menu[6] = " [ Close ]";
 
 		la->axis_menu =
@@ -297,7 +297,7 @@ void langFill(lang_t *la, int lang)
 		la->dataset_menu[2] = " Разворот времени  [ %s ]";
 		la->dataset_menu[3] = " Медиана данных    [ %s ]";
 		la->dataset_menu[4] = " Масштаб времени   [ %s ]";
-		la->dataset_menu[5] = " Длина             [ %3i ]  %iM (%i%%) кэш %iM";
+		la->dataset_menu[5] = " Длина             [ %3i ]  %iM (%i%%) кэш %iM (%i%%)";
 		la->dataset_menu[6] = " [ Закрыть ]";
 
 		la->axis_menu =
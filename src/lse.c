@@ -461,7 +461,9 @@ void lse_merge(lse_t *ls, lse_t *lb)
 	lse_float_t	*d = um->d;
 #endif /* LSE_FAST_GIVENS */
 
-	int		i;
+	lse_float_t	xz[LSE_FULL_MAX];
+
+	int		i, j;
 
 	lse_qrflush(lb);
 
@@ -473,16 +475,22 @@ void lse_merge(lse_t *ls, lse_t *lb)
 		 * */
 
 		/* We extract one by one the row-vectors from \lb instance and
-		 * merge them into the \ls instance.
+		 * merge them into the \ls instance. The copy of row-vector is
+		 * destroyed so \lb can be merged again.
 		 * */
+		for (j = i; j < um->len; ++j)
+			xz[j] = m[j];
+
 #if LSE_FAST_GIVENS != 0
-		lse_qrupdate(ls, ls->rm, m, d[i], i);
+		lse_qrupdate(ls, ls->rm, xz, d[i], i);
 #else /* LSE_FAST_GIVENS */
-		lse_qrupdate(ls, ls->rm, m, i);
+		lse_qrupdate(ls, ls->rm, xz, i);
 #endif
 
 		m += um->len;
 	}
+
+	ls->n_total += lb->n_total;
 }
 
 void lse_solve(lse_t *ls)
@@ -162,7 +162,8 @@ void lse_ridge(lse_t *ls, lse_float_t la);
 void lse_forget(lse_t *ls, lse_float_t la);
 
 /* The function updates \rm of \ls instance with data rows from \rm of \lb
- * instance. This is a merge of two LSE instances.
+ * instance. This is a merge of two LSE instances. The data of \lb is kept so
+ * it can be merged again.
  * */
 void lse_merge(lse_t *ls, lse_t *lb);
 
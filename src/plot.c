@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <math.h>
 
 #include <SDL2/SDL.h>
@@ -27,9 +28,11 @@
 
 #include "plot.h"
 #include "read.h"
+#include "async.h"
 #include "draw.h"
 #include "lse.h"
 #include "lz4.h"
+#include "pool.h"
 #include "scheme.h"
 
 extern SDL_RWops *TTF_RW_roboto_mono_normal();
@@ -67,10 +70,23 @@ plot_t *plotAlloc(draw_t *dw, scheme_t *sch)
 	pl->dw = dw;
 	pl->sch = sch;
 
-	for (N = 0; N < PLOT_SKETCH_MAX - 1; ++N)
+	pl->pool = poolAlloc(SDL_GetCPUCount());
+	pl->sketch_lock = SDL_CreateMutex();
+
+	pl->sketch = (psketch_t *) calloc(PLOT_SKETCH_MIN, sizeof(psketch_t));
+
+	if (pl->sketch == NULL) {
+
+		ERROR("No memory allocated for sketch\n");
+		return NULL;
+	}
+
+	pl->sketch_N = PLOT_SKETCH_MIN;
+
+	for (N = 0; N < PLOT_SKETCH_MIN - 1; ++N)
 		pl->sketch[N].linked = N + 1;
 
-	pl->sketch[PLOT_SKETCH_MAX - 1].linked = -1;
+	pl->sketch[PLOT_SKETCH_MIN - 1].linked = -1;
 
 	pl->sketch_list_garbage = 0;
 	pl->sketch_list_todraw = -1;
@@ -105,6 +121,12 @@ plot_t *plotAlloc(draw_t *dw, scheme_t *sch)
 	pl->fprecision = 9;
 	pl->fhexadecimal = 1;
 	pl->lz4_compress = 1;
+	pl->lz4_filter = 1;
+	pl->cache_size = PLOT_CHUNK_CACHE_DEFAULT;
+	pl->spill_budget = 0;
+	pl->columnar = 0;
+	pl->lod = 1;
+	pl->incremental = 1;
 
 	return pl;
 }
@@ -116,7 +138,7 @@ plotSketchFree(plot_t *pl)
 
 	plotSketchClean(pl);
 
-	for (N = 0; N < PLOT_SKETCH_MAX; ++N) {
+	for (N = 0; N < pl->sketch_N; ++N) {
 
 		if (pl->sketch[N].chunk != NULL) {
 
@@ -125,21 +147,83 @@ plotSketchFree(plot_t *pl)
 			pl->sketch[N].chunk = NULL;
 		}
 	}
+
+	free(pl->sketch);
+
+	pl->sketch = NULL;
+	pl->sketch_N = 0;
 }
 
 void plotClean(plot_t *pl)
 {
-	int		dN;
+	int		N, dN, xN, kN;
+
+	if (pl->export_job != NULL) {
+
+		ERROR("Unfinished export was interrupted\n");
+		plotFigureExportClose(pl);
+	}
 
 	drawPixmapClean(pl->dw);
 	plotSketchFree(pl);
 
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+		if (pl->trial[N].pixmap != NULL)
+			free(pl->trial[N].pixmap);
+	}
+
 	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
 		if (pl->data[dN].column_N != 0)
 			plotDataClean(pl, dN);
 	}
 
+	for (xN = 0; xN < PLOT_RCACHE_SIZE; ++xN) {
+
+		for (kN = 0; kN < pl->rcache[xN].chunk_MAX; ++kN) {
+
+			if (pl->rcache[xN].chunk[kN].lod != NULL)
+				free(pl->rcache[xN].chunk[kN].lod);
+		}
+
+		if (pl->rcache[xN].chunk != NULL)
+			free(pl->rcache[xN].chunk);
+	}
+
+	for (kN = 0; kN < pl->polyfit_MAX; ++kN) {
+
+		if (pl->polyfit[kN] != NULL)
+			free(pl->polyfit[kN]);
+	}
+
+	if (pl->polyfit != NULL) {
+
+		free(pl->polyfit);
+		free(pl->polyfit_list);
+	}
+
+	if (pl->pool != NULL) {
+
+		poolClean(pl->pool);
+	}
+
+	if (pl->sketch_lock != NULL) {
+
+		SDL_DestroyMutex(pl->sketch_lock);
+	}
+
+	if (pl->font != NULL) {
+
+		if (pl->font_lock != NULL)
+			SDL_LockMutex(pl->font_lock);
+
+		TTF_CloseFont(pl->font);
+
+		if (pl->font_lock != NULL)
+			SDL_UnlockMutex(pl->font_lock);
+	}
+
 	free(pl);
 }
 
@@ -161,6 +245,11 @@ plotFontLayout(plot_t *pl)
 
 void plotFontDefault(plot_t *pl, int ttfnum, int ptsize, int style)
 {
+	drawTextFlush(pl->dw);
+
+	if (pl->font_lock != NULL)
+		SDL_LockMutex(pl->font_lock);
+
 	if (pl->font != NULL) {
 
 		TTF_CloseFont(pl->font);
@@ -182,6 +271,9 @@ void plotFontDefault(plot_t *pl, int ttfnum, int ptsize, int style)
 			break;
 	}
 
+	if (pl->font_lock != NULL)
+		SDL_UnlockMutex(pl->font_lock);
+
 	TTF_SetFontStyle(pl->font, style);
 
 	pl->layout_font_ttf = ttfnum;
@@ -192,6 +284,11 @@ void plotFontDefault(plot_t *pl, int ttfnum, int ptsize, int style)
 
 int plotFontOpen(plot_t *pl, const char *ttf, int ptsize, int style)
 {
+	drawTextFlush(pl->dw);
+
+	if (pl->font_lock != NULL)
+		SDL_LockMutex(pl->font_lock);
+
 	if (pl->font != NULL) {
 
 		TTF_CloseFont(pl->font);
@@ -201,6 +298,9 @@ int plotFontOpen(plot_t *pl, const char *ttf, int ptsize, int style)
 
 	pl->font = TTF_OpenFont(ttf, ptsize);
 
+	if (pl->font_lock != NULL)
+		SDL_UnlockMutex(pl->font_lock);
+
 	if (pl->font == NULL) {
 
 		ERROR("TTF_OpenFont: \"%s\"\n", TTF_GetError());
@@ -217,6907 +317,10973 @@ int plotFontOpen(plot_t *pl, const char *ttf, int ptsize, int style)
 	return 0;
 }
 
-static void
-plotDataChunkAlloc(plot_t *pl, int dN, int lN)
+static int
+plotLZ4PackedSize(lz4job_t *jb)
 {
-	int		N, kN, lSHIFT;
-
-	lSHIFT = pl->data[dN].chunk_SHIFT;
+	int		bSIZE;
 
-	kN = (lN & pl->data[dN].chunk_MASK) ? 1 : 0;
-	kN += lN >> lSHIFT;
+	bSIZE = (jb->storage == STORAGE_FP32) ? (int) sizeof(float) * jb->column_N
+		: (int) sizeof(fval_t) * jb->column_N;
 
-	if (kN > PLOT_CHUNK_MAX) {
+	bSIZE += (int) sizeof(fval_t) * PLOT_SUBTRACT;
 
-		kN = PLOT_CHUNK_MAX;
-		lN = kN * (1UL << lSHIFT);
-	}
+	return bSIZE * jb->row_N;
+}
 
-	if (pl->data[dN].lz4_compress != 0) {
+static void
+plotLZ4Pack(lz4job_t *jb)
+{
+	const fval_t	*src;
+	char		*pk = (char *) jb->packed;
 
-		for (N = kN; N < PLOT_CHUNK_MAX; ++N) {
+	int		N, jN;
 
-			if (pl->data[dN].compress[N].raw != NULL) {
+	/* Pack the chunk column by column. Each value is XORed with the
+	 * previous value of the same column so that slow changing data gives
+	 * long runs of zero bits that LZ4 is able to match.
+	 * */
+	for (N = 0; N < jb->column_N + PLOT_SUBTRACT; ++N) {
 
-				free(pl->data[dN].compress[N].raw);
+		src = jb->raw + N * jb->column_STEP;
 
-				pl->data[dN].compress[N].raw = NULL;
-			}
-		}
-	}
-	else {
-		for (N = 0; N < kN; ++N) {
+		if (N < jb->column_N && jb->storage == STORAGE_FP32) {
 
-			if (pl->data[dN].raw[N] == NULL) {
+			Uint32		*dst = (Uint32 *) pk;
+			Uint32		bits, prev = 0;
+			float		fval;
 
-				pl->data[dN].raw[N] = (fval_t *) malloc(pl->data[dN].chunk_bSIZE);
+			for (jN = 0; jN < jb->row_N; ++jN) {
 
-				if (pl->data[dN].raw[N] == NULL) {
+				fval = (float) src[jN * jb->row_STEP];
 
-					lN = N * (1UL << lSHIFT);
+				memcpy(&bits, &fval, sizeof(Uint32));
 
-					ERROR("Unable to allocate raw memory of %i dataset\n", dN);
-					break;
-				}
+				dst[jN] = (jb->filter != 0) ? bits ^ prev : bits;
+				prev = bits;
 			}
-		}
 
-		for (N = kN; N < PLOT_CHUNK_MAX; ++N) {
+			pk += sizeof(Uint32) * jb->row_N;
+		}
+		else {
+			Uint64		*dst = (Uint64 *) pk;
+			Uint64		bits, prev = 0;
 
-			if (pl->data[dN].raw[N] != NULL) {
+			for (jN = 0; jN < jb->row_N; ++jN) {
 
-				free(pl->data[dN].raw[N]);
+				memcpy(&bits, &src[jN * jb->row_STEP], sizeof(Uint64));
 
-				pl->data[dN].raw[N] = NULL;
+				dst[jN] = (jb->filter != 0) ? bits ^ prev : bits;
+				prev = bits;
 			}
+
+			pk += sizeof(Uint64) * jb->row_N;
 		}
 	}
-
-	pl->data[dN].length_N = lN;
 }
 
-unsigned long long plotDataMemoryUsage(plot_t *pl, int dN)
+static void
+plotLZ4Unpack(lz4job_t *jb)
 {
-	int			N;
-	unsigned long long	bUSAGE;
+	fval_t		*dst;
+	const char	*pk = (const char *) jb->packed;
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+	int		N, jN;
 
-		ERROR("Dataset number is out of range\n");
-		return 0;
-	}
+	for (N = 0; N < jb->column_N + PLOT_SUBTRACT; ++N) {
 
-	bUSAGE = 0;
+		dst = jb->raw + N * jb->column_STEP;
 
-	for (N = 0; N < PLOT_CHUNK_MAX; ++N) {
+		if (N < jb->column_N && jb->storage == STORAGE_FP32) {
 
-		if (pl->data[dN].raw[N] != NULL) {
+			const Uint32	*src = (const Uint32 *) pk;
+			Uint32		bits, prev = 0;
+			float		fval;
 
-			bUSAGE += pl->data[dN].chunk_bSIZE;
+			for (jN = 0; jN < jb->row_N; ++jN) {
+
+				bits = (jb->filter != 0) ? src[jN] ^ prev : src[jN];
+				prev = bits;
+
+				memcpy(&fval, &bits, sizeof(Uint32));
+
+				dst[jN * jb->row_STEP] = (fval_t) fval;
+			}
+
+			pk += sizeof(Uint32) * jb->row_N;
 		}
+		else {
+			const Uint64	*src = (const Uint64 *) pk;
+			Uint64		bits, prev = 0;
 
-		if (pl->data[dN].compress[N].raw != NULL) {
+			for (jN = 0; jN < jb->row_N; ++jN) {
 
-			bUSAGE += pl->data[dN].compress[N].length;
+				bits = (jb->filter != 0) ? src[jN] ^ prev : src[jN];
+				prev = bits;
+
+				memcpy(&dst[jN * jb->row_STEP], &bits, sizeof(Uint64));
+			}
+
+			pk += sizeof(Uint64) * jb->row_N;
 		}
 	}
-
-	return bUSAGE;
 }
 
-unsigned long long plotDataMemoryUncompressed(plot_t *pl, int dN)
+static void
+plotLZ4Compress(lz4job_t *jb)
 {
-	int			N;
-	unsigned long long	bUSAGE;
+	const char	*src = (const char *) jb->raw;
+	int		lzLEN, bSIZE = jb->bSIZE;
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+	jb->lz4 = NULL;
+	jb->length = 0;
 
-		ERROR("Dataset number is out of range\n");
-		return 0;
-	}
+	if (jb->storage != STORAGE_FP64 || jb->filter != 0) {
 
-	bUSAGE = 0;
+		if (jb->packed == NULL) {
 
-	for (N = 0; N < PLOT_CHUNK_MAX; ++N) {
+			jb->packed = (void *) malloc(jb->bSIZE);
+		}
 
-		if (		pl->data[dN].raw[N] != NULL
-				|| pl->data[dN].compress[N].raw != NULL) {
+		if (jb->packed == NULL) {
 
-			bUSAGE += pl->data[dN].chunk_bSIZE;
+			jb->rc = 0;
+			return ;
 		}
-	}
 
-	return bUSAGE;
-}
+		plotLZ4Pack(jb);
 
-unsigned long long plotDataMemoryCached(plot_t *pl, int dN)
-{
-	int			N;
-	unsigned long long	bUSAGE;
+		src = (const char *) jb->packed;
+		bSIZE = plotLZ4PackedSize(jb);
+	}
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+	lzLEN = LZ4_compressBound(bSIZE);
 
-		ERROR("Dataset number is out of range\n");
-		return 0;
+	if (jb->reserved == NULL) {
+
+		jb->reserved = (void *) malloc(LZ4_compressBound(jb->bSIZE));
 	}
 
-	bUSAGE = 0;
+	if (jb->reserved != NULL) {
 
-	for (N = 0; N < PLOT_CHUNK_CACHE; ++N) {
+		lzLEN = LZ4_compress_fast(src, (char *) jb->reserved, bSIZE, lzLEN, 1);
 
-		if (pl->data[dN].cache[N].raw != NULL) {
+		jb->lz4 = (void *) malloc(lzLEN);
 
-			bUSAGE += pl->data[dN].chunk_bSIZE;
+		if (jb->lz4 != NULL) {
+
+			memcpy(jb->lz4, jb->reserved, lzLEN);
+
+			jb->length = lzLEN;
 		}
 	}
 
-	return bUSAGE;
+	jb->rc = jb->length;
 }
 
-static int
-plotDataCacheGetNode(plot_t *pl, int dN)
+static void
+plotLZ4Decompress(lz4job_t *jb)
 {
-	int		N, kNOT, xN = -1;
+	int		bSIZE;
 
-	for (N = 0; N < PLOT_CHUNK_CACHE; ++N) {
+	if (jb->storage != STORAGE_FP64 || jb->filter != 0) {
 
-		if (pl->data[dN].cache[N].raw == NULL) {
+		if (jb->packed == NULL) {
 
-			xN = N;
-			break;
+			jb->packed = (void *) malloc(jb->bSIZE);
 		}
-	}
 
-	if (xN < 0) {
+		if (jb->packed == NULL) {
 
-		kNOT = pl->data[dN].tail_N >> pl->data[dN].chunk_SHIFT;
+			jb->rc = 0;
+			return ;
+		}
 
-		N = (pl->data[dN].cache_ID < PLOT_CHUNK_CACHE - 1)
-			? pl->data[dN].cache_ID + 1 : 0;
+		bSIZE = plotLZ4PackedSize(jb);
 
-		if (pl->data[dN].cache[N].chunk_N == kNOT) {
+		jb->rc = LZ4_decompress_safe((const char *) jb->lz4, (char *) jb->packed,
+				jb->length, bSIZE);
 
-			N = (N < PLOT_CHUNK_CACHE - 1) ? N + 1 : 0;
-		}
+		if (jb->rc == bSIZE) {
 
-		xN = N;
+			plotLZ4Unpack(jb);
 
-		pl->data[dN].cache_ID = N;
+			jb->rc = jb->bSIZE;
+		}
+	}
+	else {
+		jb->rc = LZ4_decompress_safe((const char *) jb->lz4, (char *) jb->raw,
+				jb->length, jb->bSIZE);
 	}
+}
 
-	return xN;
+static int
+plotDataSpillSeek(FILE *fd, long long offset)
+{
+#ifdef _WINDOWS
+	return _fseeki64(fd, offset, SEEK_SET);
+#else /* _WINDOWS */
+	return fseeko(fd, (off_t) offset, SEEK_SET);
+#endif /* _WINDOWS */
 }
 
 static void
-plotDataCacheFetch(plot_t *pl, int dN, int kN)
+plotDataSpillLink(plot_t *pl, int dN, int kN)
 {
-	int		xN, kNZ, lzLEN;
+	int		kT = pl->data[dN].spill_tail;
 
-	xN = plotDataCacheGetNode(pl, dN);
+	pl->data[dN].compress[kN].lru_prev = (pl->data[dN].spill_resident > 0) ? kT : -1;
+	pl->data[dN].compress[kN].lru_next = -1;
 
-	if (pl->data[dN].cache[xN].raw != NULL) {
+	if (pl->data[dN].spill_resident > 0) {
 
-		kNZ = pl->data[dN].cache[xN].chunk_N;
+		pl->data[dN].compress[kT].lru_next = kN;
+	}
+	else {
+		pl->data[dN].spill_head = kN;
+	}
 
-		if (pl->data[dN].cache[xN].dirty != 0) {
+	pl->data[dN].spill_tail = kN;
+	pl->data[dN].spill_resident += 1;
 
-			lzLEN = LZ4_compressBound(pl->data[dN].chunk_bSIZE);
+	pl->spill_usage += pl->data[dN].compress[kN].length;
+}
 
-			if (pl->data[dN].compress[kNZ].raw != NULL) {
+static void
+plotDataSpillUnlink(plot_t *pl, int dN, int kN)
+{
+	int		kP, kX;
 
-				free(pl->data[dN].compress[kNZ].raw);
+	kP = pl->data[dN].compress[kN].lru_prev;
+	kX = pl->data[dN].compress[kN].lru_next;
 
-				pl->data[dN].compress[kNZ].raw = NULL;
-			}
+	if (kP >= 0) {
 
-			pl->data[dN].compress[kNZ].length = 0;
+		pl->data[dN].compress[kP].lru_next = kX;
+	}
+	else {
+		pl->data[dN].spill_head = kX;
+	}
 
-			if (pl->data[dN].lz4_reserved == NULL) {
+	if (kX >= 0) {
 
-				pl->data[dN].lz4_reserved = (void *) malloc(lzLEN);
-			}
+		pl->data[dN].compress[kX].lru_prev = kP;
+	}
+	else {
+		pl->data[dN].spill_tail = kP;
+	}
 
-			if (pl->data[dN].lz4_reserved != NULL) {
+	pl->data[dN].spill_resident -= 1;
 
-				lzLEN = LZ4_compress_fast((const char *) pl->data[dN].cache[xN].raw,
-						(char *) pl->data[dN].lz4_reserved,
-						pl->data[dN].chunk_bSIZE, lzLEN, 1);
+	pl->spill_usage -= pl->data[dN].compress[kN].length;
+}
 
-				pl->data[dN].compress[kNZ].raw = (void *) malloc(lzLEN);
+static int
+plotDataSpillWrite(plot_t *pl, int dN, int kN)
+{
+	FILE		*fd;
+	int		length;
 
-				if (pl->data[dN].compress[kNZ].raw != NULL) {
+	length = pl->data[dN].compress[kN].length;
 
-					memcpy(pl->data[dN].compress[kNZ].raw,
-							pl->data[dN].lz4_reserved, lzLEN);
+	if (pl->data[dN].compress[kN].spilled == 0) {
 
-					pl->data[dN].compress[kNZ].length = lzLEN;
-				}
-				else {
-					ERROR("Unable to allocate LZ4 memory of %i dataset\n", dN);
-				}
-			}
-			else {
-				ERROR("Unable to allocate reserved memory of %i dataset\n", dN);
-			}
-		}
+		if (pl->data[dN].spill_failed != 0)
+			return 0;
 
-		pl->data[dN].raw[kNZ] = NULL;
-	}
-	else {
-		pl->data[dN].cache[xN].raw = (fval_t *) malloc(pl->data[dN].chunk_bSIZE);
+		if (pl->data[dN].spill_fd == NULL) {
 
-		if (pl->data[dN].cache[xN].raw == NULL) {
+			pl->data[dN].spill_fd = file_tempfile();
+			pl->data[dN].spill_end = 0;
+
+			if (pl->data[dN].spill_fd == NULL) {
 
-			ERROR("Unable to allocate cache of %i dataset\n", dN);
+				ERROR("Unable to open spill file of %i dataset\n", dN);
+
+				pl->data[dN].spill_failed = 1;
+				return 0;
+			}
 		}
-	}
 
-	pl->data[dN].cache[xN].chunk_N = kN;
-	pl->data[dN].cache[xN].dirty = 0;
+		fd = pl->data[dN].spill_fd;
 
-	pl->data[dN].raw[kN] = pl->data[dN].cache[xN].raw;
+		/* Take a new place at the end of file if the chunk does not
+		 * fit into its previous one.
+		 * */
+		if (pl->data[dN].compress[kN].capacity < length) {
 
-	if (pl->data[dN].compress[kN].raw != NULL) {
+			pl->data[dN].compress[kN].offset = pl->data[dN].spill_end;
+			pl->data[dN].compress[kN].capacity = length;
+
+			pl->data[dN].spill_end += length;
+		}
 
-		lzLEN = LZ4_decompress_safe((const char *) pl->data[dN].compress[kN].raw,
-				(char *) pl->data[dN].raw[kN], pl->data[dN].compress[kN].length,
-				pl->data[dN].chunk_bSIZE);
+		if (		plotDataSpillSeek(fd, pl->data[dN].compress[kN].offset) != 0
+				|| fwrite(pl->data[dN].compress[kN].raw, 1, length, fd)
+					!= (size_t) length) {
 
-		if (lzLEN != pl->data[dN].chunk_bSIZE) {
+			ERROR("Unable to write spill file of %i dataset\n", dN);
 
-			ERROR("Unable to decompress LZ4 memory of %i dataset\n", dN);
+			pl->data[dN].spill_failed = 1;
+			return 0;
 		}
+
+		pl->data[dN].compress[kN].spilled = 1;
 	}
-}
 
-static void
-plotDataChunkFetch(plot_t *pl, int dN, int kN)
-{
-	if (		   pl->data[dN].raw[kN] == NULL
-			&& pl->data[dN].length_N != 0) {
+	plotDataSpillUnlink(pl, dN, kN);
 
-		plotDataCacheFetch(pl, dN, kN);
-	}
+	free(pl->data[dN].compress[kN].raw);
+
+	pl->data[dN].compress[kN].raw = NULL;
+
+	return 1;
 }
 
 static void
-plotDataChunkWrite(plot_t *pl, int dN, int kN)
+plotDataSpillEvict(plot_t *pl, int dN_keep, int kN_keep)
 {
-	int		N;
+	unsigned long long	bBUDGET;
+	int			dN, kN, jN, xN_dN, xN_kN;
 
-	if (		   pl->data[dN].raw[kN] == NULL
-			&& pl->data[dN].length_N != 0) {
+	if (pl->spill_budget < 1)
+		return ;
 
-		plotDataCacheFetch(pl, dN, kN);
-	}
+	bBUDGET = (unsigned long long) pl->spill_budget * 1048576U;
 
-	if (pl->data[dN].raw[kN] != NULL) {
+	while (pl->spill_usage > bBUDGET) {
+
+		xN_dN = -1;
+		xN_kN = -1;
 
-		for (N = 0; N < PLOT_CHUNK_CACHE; ++N) {
+		for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-			if (pl->data[dN].cache[N].chunk_N == kN) {
+			if (		pl->data[dN].spill_resident < 1
+					|| pl->data[dN].spill_failed != 0)
+				continue;
 
-				pl->data[dN].cache[N].dirty = 1;
-				break;
+			/* Take the oldest chunk of dataset. Chunk that is
+			 * owned by background job cannot be spilled, there
+			 * are only a few of them to skip.
+			 * */
+			for (kN = pl->data[dN].spill_head; kN >= 0;
+					kN = pl->data[dN].compress[kN].lru_next) {
+
+				if (dN == dN_keep && kN == kN_keep)
+					continue;
+
+				for (jN = 0; jN < PLOT_LZ4_JOB_MAX; ++jN) {
+
+					if (		pl->data[dN].lz4_job[jN].busy != LZ4_JOB_FREE
+							&& pl->data[dN].lz4_job[jN].chunk_N == kN)
+						break;
+				}
+
+				if (jN == PLOT_LZ4_JOB_MAX)
+					break;
+			}
+
+			if (kN < 0)
+				continue;
+
+			if (		xN_dN < 0
+					|| pl->data[dN].compress[kN].stamp
+					< pl->data[xN_dN].compress[xN_kN].stamp) {
+
+				xN_dN = dN;
+				xN_kN = kN;
 			}
 		}
+
+		if (xN_dN < 0)
+			break;
+
+		/* On failure the dataset is skipped by the next pass and
+		 * keeps its chunks in RAM.
+		 * */
+		(void) plotDataSpillWrite(pl, xN_dN, xN_kN);
 	}
 }
 
-void plotDataAlloc(plot_t *pl, int dN, int cN, int lN)
+static void
+plotDataSpillLoad(plot_t *pl, int dN, int kN)
 {
-	int		*map;
+	void		*raw;
+	int		length;
 
-	int		N, bSIZE;
+	pl->data[dN].compress[kN].stamp = ++pl->spill_clock;
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+	if (pl->data[dN].compress[kN].raw != NULL) {
 
-		ERROR("Dataset number is out of range\n");
+		/* Move the chunk to the tail as the most recent one.
+		 * */
+		plotDataSpillUnlink(pl, dN, kN);
+		plotDataSpillLink(pl, dN, kN);
 		return ;
 	}
 
-	if (cN < 1) {
-
-		ERROR("Number of columns is too few\n");
+	if (pl->data[dN].compress[kN].spilled == 0)
 		return ;
-	}
 
-	if (lN < 1) {
+	length = pl->data[dN].compress[kN].length;
 
-		ERROR("Length of dataset is too short\n");
+	raw = malloc(length);
+
+	if (raw == NULL) {
+
+		ERROR("Unable to allocate LZ4 memory of %i dataset\n", dN);
 		return ;
 	}
 
-	if (pl->data[dN].column_N != 0) {
-
-		if (pl->data[dN].column_N != cN) {
+	if (		plotDataSpillSeek(pl->data[dN].spill_fd,
+				pl->data[dN].compress[kN].offset) != 0
+			|| fread(raw, 1, length, pl->data[dN].spill_fd)
+				!= (size_t) length) {
 
-			ERROR("Number of columns cannot be changed\n");
-			return ;
-		}
+		ERROR("Unable to read spill file of %i dataset\n", dN);
 
-		if (plotFigureHaveData(pl, dN) != 0) {
+		free(raw);
+		return ;
+	}
 
-			plotSketchClean(pl);
-		}
+	pl->data[dN].compress[kN].raw = raw;
 
-		plotDataRangeCacheClean(pl, dN);
-		plotDataChunkAlloc(pl, dN, lN);
+	plotDataSpillLink(pl, dN, kN);
+	plotDataSpillEvict(pl, dN, kN);
+}
 
-		pl->data[dN].head_N = 0;
-		pl->data[dN].tail_N = 0;
-		pl->data[dN].id_N = 0;
-		pl->data[dN].sub_N = 0;
-	}
-	else {
-		pl->data[dN].column_N = cN;
+static void
+plotDataJobCollect(plot_t *pl, int dN, int jN)
+{
+	lz4job_t	*jb = &pl->data[dN].lz4_job[jN];
+	int		kNZ;
 
-		for (N = 0; N < 30; ++N) {
+	if (jb->busy == LZ4_JOB_COMPRESS) {
 
-			bSIZE = (int) sizeof(fval_t) * (cN + PLOT_SUBTRACT) * (1UL << N);
+		kNZ = jb->chunk_N;
 
-			if (bSIZE >= PLOT_CHUNK_SIZE) {
+		if (jb->reserved == NULL) {
 
-				pl->data[dN].chunk_SHIFT = N;
-				pl->data[dN].chunk_MASK = (1UL << N) - 1UL;
-				pl->data[dN].chunk_bSIZE = bSIZE;
-				break;
-			}
+			ERROR("Unable to allocate reserved memory of %i dataset\n", dN);
 		}
+		else if (jb->lz4 == NULL) {
 
-		pl->data[dN].lz4_compress = pl->lz4_compress;
-
-		plotDataChunkAlloc(pl, dN, lN);
-
-		pl->data[dN].cache_ID = 0;
+			ERROR("Unable to allocate LZ4 memory of %i dataset\n", dN);
+		}
 
-		pl->data[dN].head_N = 0;
-		pl->data[dN].tail_N = 0;
-		pl->data[dN].id_N = 0;
-		pl->data[dN].sub_N = 0;
+		if (pl->data[dN].compress[kNZ].raw != NULL) {
 
-		for (N = 0; N < PLOT_SUBTRACT; ++N) {
+			plotDataSpillUnlink(pl, dN, kNZ);
 
-			pl->data[dN].sub[N].busy = SUBTRACT_FREE;
+			free(pl->data[dN].compress[kNZ].raw);
 		}
 
-		map = (int *) malloc(sizeof(int) * (cN + PLOT_SUBTRACT + 1));
+		pl->data[dN].compress[kNZ].raw = jb->lz4;
+		pl->data[dN].compress[kNZ].length = jb->length;
+		pl->data[dN].compress[kNZ].spilled = 0;
+		pl->data[dN].compress[kNZ].stamp = ++pl->spill_clock;
 
-		if (map == NULL) {
+		if (jb->lz4 != NULL) {
 
-			ERROR("No memory allocated for %i map\n", dN);
-			return ;
+			plotDataSpillLink(pl, dN, kNZ);
 		}
 
-		pl->data[dN].map = (int *) map + 1;
+		jb->busy = LZ4_JOB_FREE;
+		jb->lz4 = NULL;
 
-		for (N = -1; N < cN + PLOT_SUBTRACT; ++N) {
+		plotDataSpillEvict(pl, -1, -1);
+	}
+	else if (jb->busy == LZ4_JOB_DECOMPRESS) {
 
-			pl->data[dN].map[N] = -1;
+		if (jb->rc != pl->data[dN].chunk_bSIZE) {
+
+			ERROR("Unable to decompress LZ4 memory of %i dataset\n", dN);
 		}
 	}
 }
 
-void plotDataResize(plot_t *pl, int dN, int lN)
+static void
+plotDataJobDrain(plot_t *pl, int dN)
 {
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
-
-		ERROR("Dataset number is out of range\n");
-		return ;
-	}
-
-	if (lN < 1) {
+	int		N;
 
-		ERROR("Length of dataset is too short\n");
-		return ;
-	}
+	for (N = 0; N < PLOT_LZ4_JOB_MAX; ++N) {
 
-	if (pl->data[dN].column_N != 0) {
+		if (pl->data[dN].lz4_job[N].busy != LZ4_JOB_FREE) {
 
-		if (lN < pl->data[dN].length_N) {
+			poolWait(pl->pool, &pl->data[dN].lz4_job[N].task);
+			plotDataJobCollect(pl, dN, N);
 
-			pl->data[dN].head_N = 0;
-			pl->data[dN].tail_N = 0;
-			pl->data[dN].id_N = 0;
-			pl->data[dN].sub_N = 0;
+			pl->data[dN].lz4_job[N].busy = LZ4_JOB_FREE;
 		}
-
-		plotDataChunkAlloc(pl, dN, lN);
 	}
 }
 
-int plotDataLength(plot_t *pl, int dN)
+static int
+plotDataJobGetFree(plot_t *pl, int dN, int spare, int reclaim)
 {
-	int		N;
+	lz4job_t	*jb;
+	int		N, xN = -1;
 
-	N = pl->data[dN].tail_N - pl->data[dN].head_N;
-	N += (N < 0) ? pl->data[dN].length_N : 0;
+	for (N = 0; N < PLOT_LZ4_JOB_MAX; ++N) {
 
-	return N;
-}
+		jb = &pl->data[dN].lz4_job[N];
 
-int plotDataSpaceLeft(plot_t *pl, int dN)
-{
-	return pl->data[dN].length_N - plotDataLength(pl, dN);
-}
+		if (		jb->busy == LZ4_JOB_COMPRESS
+				&& poolIsDone(&jb->task) != 0) {
 
-void plotDataGrowUp(plot_t *pl, int dN)
-{
-	int			lSHIFT, lN;
+			plotDataJobCollect(pl, dN, N);
+		}
 
-	lSHIFT = pl->data[dN].chunk_SHIFT;
+		if (jb->busy == LZ4_JOB_FREE) {
 
-	lN = pl->data[dN].length_N;
-	lN = ((lN >> lSHIFT) + 1) << lSHIFT;
+			if (xN < 0 || (jb->raw != NULL) == (spare != 0)) {
 
-	plotDataResize(pl, dN, lN);
-}
+				xN = N;
+			}
+		}
+	}
 
-static const fval_t *
-plotDataGet(plot_t *pl, int dN, int *rN)
-{
-	const fval_t	*row = NULL;
+	if (xN < 0 && reclaim != 0) {
 
-	int		lN, kN, jN;
+		/* All of jobs are busy. We drop the read ahead job if any or
+		 * wait for the compression to finish.
+		 * */
+		for (N = 0; N < PLOT_LZ4_JOB_MAX; ++N) {
 
-	if (*rN != pl->data[dN].tail_N) {
+			if (pl->data[dN].lz4_job[N].busy == LZ4_JOB_DECOMPRESS) {
 
-		kN = *rN >> pl->data[dN].chunk_SHIFT;
-		jN = *rN & pl->data[dN].chunk_MASK;
+				xN = N;
+				break;
+			}
+		}
 
-		if (pl->data[dN].lz4_compress != 0) {
+		xN = (xN < 0) ? 0 : xN;
 
-			plotDataChunkFetch(pl, dN, kN);
-		}
+		poolWait(pl->pool, &pl->data[dN].lz4_job[xN].task);
+		plotDataJobCollect(pl, dN, xN);
 
-		row = pl->data[dN].raw[kN];
+		pl->data[dN].lz4_job[xN].busy = LZ4_JOB_FREE;
+	}
 
-		if (row != NULL) {
+	return xN;
+}
+
+static int
+plotDataJobGetByChunk(plot_t *pl, int dN, int kN)
+{
+	int		N, xN = -1;
 
-			row += (pl->data[dN].column_N + PLOT_SUBTRACT) * jN;
+	for (N = 0; N < PLOT_LZ4_JOB_MAX; ++N) {
 
-			lN = pl->data[dN].length_N;
-			*rN = (*rN < lN - 1) ? *rN + 1 : 0;
+		if (		pl->data[dN].lz4_job[N].busy != LZ4_JOB_FREE
+				&& pl->data[dN].lz4_job[N].chunk_N == kN) {
+
+			xN = N;
+			break;
 		}
 	}
 
-	return row;
+	return xN;
 }
 
 static void
-plotDataRangeCacheWipe(plot_t *pl, int dN, int kN)
+plotDataJobSpare(plot_t *pl, int dN, fval_t *raw)
 {
 	int		N;
 
-	for (N = 0; N < PLOT_RCACHE_SIZE; ++N) {
+	for (N = 0; N < PLOT_LZ4_JOB_MAX; ++N) {
 
-		if (		pl->rcache[N].busy != 0
-				&& pl->rcache[N].data_N == dN) {
+		if (		pl->data[dN].lz4_job[N].busy == LZ4_JOB_FREE
+				&& pl->data[dN].lz4_job[N].raw == NULL) {
 
-			pl->rcache[N].chunk[kN].computed = 0;
-			pl->rcache[N].cached = 0;
+			pl->data[dN].lz4_job[N].raw = raw;
+			return ;
 		}
 	}
+
+	free(raw);
 }
 
 static fval_t *
-plotDataWrite(plot_t *pl, int dN, int *rN)
+plotDataJobTake(plot_t *pl, int dN)
 {
-	fval_t		*row = NULL;
-	int		lN, kN, jN;
+	fval_t		*raw;
+	int		N;
 
-	if (*rN != pl->data[dN].tail_N) {
+	for (N = 0; N < PLOT_LZ4_JOB_MAX; ++N) {
 
-		kN = *rN >> pl->data[dN].chunk_SHIFT;
-		jN = *rN & pl->data[dN].chunk_MASK;
+		if (		pl->data[dN].lz4_job[N].busy == LZ4_JOB_FREE
+				&& pl->data[dN].lz4_job[N].raw != NULL) {
 
-		if (pl->data[dN].lz4_compress != 0) {
+			raw = pl->data[dN].lz4_job[N].raw;
+			pl->data[dN].lz4_job[N].raw = NULL;
 
-			plotDataChunkWrite(pl, dN, kN);
+			return raw;
 		}
+	}
 
-		if (		   pl->rcache_wipe_data_N != dN
-				|| pl->rcache_wipe_chunk_N != kN) {
-
-			plotDataRangeCacheWipe(pl, dN, kN);
-
-			pl->rcache_wipe_data_N = dN;
-			pl->rcache_wipe_chunk_N = kN;
-		}
+	return (fval_t *) malloc(pl->data[dN].chunk_bSIZE);
+}
 
-		row = pl->data[dN].raw[kN];
+static fval_t *
+plotDataJobFinish(plot_t *pl, int dN, int jN)
+{
+	lz4job_t	*jb = &pl->data[dN].lz4_job[jN];
+	fval_t		*raw;
 
-		if (row != NULL) {
+	poolWait(pl->pool, &jb->task);
+	plotDataJobCollect(pl, dN, jN);
 
-			row += (pl->data[dN].column_N + PLOT_SUBTRACT) * jN;
+	raw = jb->raw;
 
-			lN = pl->data[dN].length_N;
-			*rN = (*rN < lN - 1) ? *rN + 1 : 0;
-		}
-	}
+	jb->busy = LZ4_JOB_FREE;
+	jb->raw = NULL;
 
-	return row;
+	return raw;
 }
 
 static void
-plotDataSkip(plot_t *pl, int dN, int *rN, int *id_N, int iN)
+plotDataJobLayout(plot_t *pl, int dN, lz4job_t *jb)
 {
-	int		N, lN, tN;
+	jb->bSIZE = pl->data[dN].chunk_bSIZE;
 
-	lN = pl->data[dN].length_N;
-
-	N = *rN - pl->data[dN].head_N;
-	N = (N < 0) ? N + lN : N;
+	jb->column_N = pl->data[dN].column_N;
+	jb->row_N = 1UL << pl->data[dN].chunk_SHIFT;
+	jb->row_STEP = pl->data[dN].row_STEP;
+	jb->column_STEP = pl->data[dN].column_STEP;
 
-	tN = pl->data[dN].tail_N - pl->data[dN].head_N;
-	tN = (tN < 0) ? tN + lN : tN;
+	jb->storage = pl->data[dN].storage;
+	jb->filter = pl->data[dN].lz4_filter;
+}
 
-	iN = (N + iN < 0) ? - N : iN;
-	iN = (N + iN > tN) ? tN - N : iN;
+static void
+plotDataJobCompress(plot_t *pl, int dN, int kN, fval_t *raw)
+{
+	lz4job_t	*jb;
+	int		jN;
 
-	N += iN;
+	jN = plotDataJobGetFree(pl, dN, 0, 1);
+	jb = &pl->data[dN].lz4_job[jN];
 
-	N = pl->data[dN].head_N + N;
-	N = (N > lN - 1) ? N - lN : N;
+	jb->busy = LZ4_JOB_COMPRESS;
 
-	if (rN != NULL) {
+	if (jb->raw != NULL) {
 
-		*rN = N;
-	}
+		fval_t		*spare = jb->raw;
 
-	if (id_N != NULL) {
+		jb->raw = NULL;
 
-		*id_N += iN;
+		plotDataJobSpare(pl, dN, spare);
 	}
-}
-
-static int
-plotDataChunkN(plot_t *pl, int dN, int rN)
-{
-	int		kN;
-
-	kN = rN >> pl->data[dN].chunk_SHIFT;
+	jb->chunk_N = kN;
+	plotDataJobLayout(pl, dN, jb);
+	jb->raw = raw;
 
-	return kN;
+	poolSubmit(pl->pool, &jb->task, (void (*) (void *)) &plotLZ4Compress, jb);
 }
 
 static void
-plotDataChunkSkip(plot_t *pl, int dN, int *rN, int *id_N)
+plotDataJobReadAhead(plot_t *pl, int dN, int kN, int ahead)
 {
-	int		skip_N, wrap_N;
+	lz4job_t	*jb;
+	int		jN, kMAX;
 
-	skip_N = (1UL << pl->data[dN].chunk_SHIFT)
-		- (*rN & pl->data[dN].chunk_MASK);
+	if (pl->pool == NULL || pl->pool->thread_N < 1)
+		return ;
 
-	wrap_N = pl->data[dN].length_N - *rN;
-	skip_N = (wrap_N < skip_N) ? wrap_N : skip_N;
+	kMAX = pl->data[dN].length_N >> pl->data[dN].chunk_SHIFT;
+	kMAX += (pl->data[dN].length_N & pl->data[dN].chunk_MASK) ? 1 : 0;
 
-	plotDataSkip(pl, dN, rN, id_N, skip_N);
-}
+	if (ahead < 0) {
 
-static tuple_t
-plotDataMedianAdd(plot_t *pl, int dN, int sN, double fval, double fpay)
-{
-	int		index[PLOT_MEDIAN_MAX];
-	int		N, Nq, N0, N1, length, keep, tail, total;
+		kN = (kN > 0) ? kN - 1 : kMAX - 1;
+	}
+	else {
+		kN = (kN < kMAX - 1) ? kN + 1 : 0;
+	}
 
-	tuple_t		mN = { -1, -1 };
+	if (		pl->data[dN].raw[kN] != NULL
+			|| (pl->data[dN].compress[kN].raw == NULL
+				&& pl->data[dN].compress[kN].spilled == 0))
+		return ;
 
-	length = pl->data[dN].sub[sN].op.median.length;
-	keep = pl->data[dN].sub[sN].op.median.keep;
-	tail = pl->data[dN].sub[sN].op.median.tail;
+	if (plotDataJobGetByChunk(pl, dN, kN) >= 0)
+		return ;
+
+	jN = plotDataJobGetFree(pl, dN, 1, 0);
 
-	pl->data[dN].sub[sN].op.median.window[tail].fval = fval;
-	pl->data[dN].sub[sN].op.median.window[tail].fpay = fpay;
+	if (jN < 0)
+		return ;
 
-	keep = (keep < length - 1) ? keep + 1 : length;
-	tail = (tail < length - 1) ? tail + 1 : 0;
+	jb = &pl->data[dN].lz4_job[jN];
 
-	pl->data[dN].sub[sN].op.median.keep = keep;
-	pl->data[dN].sub[sN].op.median.tail = tail;
+	if (jb->raw == NULL) {
 
-	for (N = 0, total = 0; N < keep; ++N) {
+		jb->raw = (fval_t *) malloc(pl->data[dN].chunk_bSIZE);
 
-		fval = pl->data[dN].sub[sN].op.median.window[N].fval;
+		if (jb->raw == NULL)
+			return ;
+	}
 
-		if (fp_isfinite(fval)) {
+	plotDataSpillLoad(pl, dN, kN);
 
-			index[total++] = N;
+	if (pl->data[dN].compress[kN].raw == NULL)
+		return ;
 
-			for (Nq = total - 1; Nq > 0; --Nq) {
+	jb->busy = LZ4_JOB_DECOMPRESS;
+	jb->chunk_N = kN;
+	plotDataJobLayout(pl, dN, jb);
+	jb->lz4 = pl->data[dN].compress[kN].raw;
+	jb->length = pl->data[dN].compress[kN].length;
 
-				N0 = index[Nq - 1];
-				N1 = index[Nq];
+	poolSubmit(pl->pool, &jb->task, (void (*) (void *)) &plotLZ4Decompress, jb);
+}
 
-				fval = pl->data[dN].sub[sN].op.median.window[N0].fval;
-				fpay = pl->data[dN].sub[sN].op.median.window[N1].fval;
+static int
+plotDataChunkTable(plot_t *pl, int dN, int kN)
+{
+	void		*compress, *raw, *stat;
+	int		kMAX, kLIM;
 
-				if (fval < fpay) {
+	if (kN <= pl->data[dN].chunk_MAX)
+		return kN;
 
-					index[Nq - 1] = N1;
-					index[Nq] = N0;
-				}
-			}
-		}
-	}
+	/* The row numbers are int so the length of dataset is limited.
+	 * */
+	kLIM = INT_MAX >> pl->data[dN].chunk_SHIFT;
 
-	if (total > 2 || (length < 3 && total > 0)) {
+	if (kN > kLIM) {
 
-		mN.X = index[total / 2];
-		mN.Y = mN.X;
+		ERROR("Length of %i dataset is limited to %i rows\n",
+				dN, kLIM << pl->data[dN].chunk_SHIFT);
 	}
 
-	if (pl->data[dN].sub[sN].op.median.opdata != 0) {
+	kMAX = (pl->data[dN].chunk_MAX > 0) ? pl->data[dN].chunk_MAX : PLOT_CHUNK_TABLE_MIN;
 
-		for (N = 0, total = 0; N < keep; ++N) {
+	while (kMAX < kN && kMAX < kLIM)
+		kMAX *= 2;
 
-			fval = pl->data[dN].sub[sN].op.median.window[N].fval;
-			fpay = pl->data[dN].sub[sN].op.median.window[N].fpay;
+	kMAX = (kMAX > kLIM) ? kLIM : kMAX;
 
-			if (fp_isfinite(fval) && fp_isfinite(fpay)) {
+	if (kMAX <= pl->data[dN].chunk_MAX)
+		return pl->data[dN].chunk_MAX;
 
-				index[total++] = N;
+	compress = realloc(pl->data[dN].compress, sizeof(pl->data[dN].compress[0]) * kMAX);
 
-				for (Nq = total - 1; Nq > 0; --Nq) {
+	if (compress != NULL)
+		pl->data[dN].compress = compress;
 
-					N0 = index[Nq - 1];
-					N1 = index[Nq];
+	raw = realloc(pl->data[dN].raw, sizeof(pl->data[dN].raw[0]) * kMAX);
 
-					fval = pl->data[dN].sub[sN].op.median.window[N0].fpay;
-					fpay = pl->data[dN].sub[sN].op.median.window[N1].fpay;
+	if (raw != NULL)
+		pl->data[dN].raw = raw;
 
-					if (fval < fpay) {
+	stat = realloc(pl->data[dN].stat, sizeof(pl->data[dN].stat[0]) * kMAX);
 
-						index[Nq - 1] = N1;
-						index[Nq] = N0;
-					}
-				}
-			}
-		}
+	if (stat != NULL)
+		pl->data[dN].stat = stat;
 
-		if (total > 2 || (length < 3 && total > 0)) {
+	if (compress == NULL || raw == NULL || stat == NULL) {
 
-			mN.Y = index[total / 2];
-		}
+		ERROR("Unable to allocate chunk table of %i dataset\n", dN);
+		return pl->data[dN].chunk_MAX;
 	}
 
-	return mN;
+	kN = pl->data[dN].chunk_MAX;
+
+	memset(pl->data[dN].compress + kN, 0, sizeof(pl->data[dN].compress[0]) * (kMAX - kN));
+	memset(pl->data[dN].raw + kN, 0, sizeof(pl->data[dN].raw[0]) * (kMAX - kN));
+	memset(pl->data[dN].stat + kN, 0, sizeof(pl->data[dN].stat[0]) * (kMAX - kN));
+
+	pl->data[dN].chunk_MAX = kMAX;
+
+	return kMAX;
 }
 
 static void
-plotDataResample(plot_t *pl, int dN, int cNX, int cNY, int in_dN, int in_cNX, int in_cNY)
+plotDataChunkAlloc(plot_t *pl, int dN, int lN)
 {
-	fval_t		*row, X, Y, X2, Y2, prev_X2, prev_Y2, Qf;
-	const fval_t	*prey;
+	int		N, kN, kMAX, lSHIFT;
 
-	int		rN, id_N, rN2, id_N2;
+	lSHIFT = pl->data[dN].chunk_SHIFT;
 
-	rN = pl->data[dN].head_N;
-	id_N = pl->data[dN].id_N;
+	kN = (lN & pl->data[dN].chunk_MASK) ? 1 : 0;
+	kN += lN >> lSHIFT;
 
-	rN2 = pl->data[in_dN].head_N;
-	id_N2 = pl->data[in_dN].id_N;
+	/* The number of chunks is limited by the memory to keep them in
+	 * and by the row numbers that must fit in int. The compressed chunks
+	 * can be spilled to the disk.
+	 * */
+	kMAX = plotDataChunkTable(pl, dN, kN);
 
-	do {
-		prey = plotDataGet(pl, in_dN, &rN2);
+	if (kN > kMAX) {
 
-		if (prey == NULL)
-			break;
+		kN = kMAX;
+		lN = kN * (1UL << lSHIFT);
+	}
 
-		X2 = (in_cNX < 0) ? id_N2 : prey[in_cNX];
-		Y2 = (in_cNY < 0) ? id_N2 : prey[in_cNY];
+	if (pl->data[dN].lz4_compress != 0) {
 
-		id_N2++;
+		plotDataJobDrain(pl, dN);
 
-		if (fp_isfinite(X2))
-			break;
-	}
-	while (1);
+		for (N = kN; N < pl->data[dN].chunk_MAX; ++N) {
 
-	if (id_N2 != pl->data[in_dN].id_N) {
-
-		prev_X2 = X2;
-		prev_Y2 = Y2;
-	}
-	else {
-		ERROR("No data to resample in dataset %i column %i\n", in_dN, in_cNX);
-		return ;
-	}
+			if (pl->data[dN].compress[N].raw != NULL) {
 
-	do {
-		row = plotDataWrite(pl, dN, &rN);
+				plotDataSpillUnlink(pl, dN, N);
 
-		if (row == NULL)
-			break;
+				free(pl->data[dN].compress[N].raw);
 
-		X = (cNX < 0) ? id_N : row[cNX];
+				pl->data[dN].compress[N].raw = NULL;
+			}
 
-		if (fp_isfinite(X)) {
+			pl->data[dN].compress[N].spilled = 0;
+		}
+	}
+	else {
+		for (N = 0; N < kN; ++N) {
 
-			do {
-				if (X2 >= X)
-					break;
+			if (pl->data[dN].raw[N] == NULL) {
 
-				prey = plotDataGet(pl, in_dN, &rN2);
+				pl->data[dN].raw[N] = (fval_t *) malloc(pl->data[dN].chunk_bSIZE);
 
-				if (prey == NULL)
-					break;
+				if (pl->data[dN].raw[N] == NULL) {
 
-				if (fp_isfinite(X2)) {
+					lN = N * (1UL << lSHIFT);
 
-					prev_X2 = X2;
-					prev_Y2 = Y2;
+					ERROR("Unable to allocate raw memory of %i dataset\n", dN);
+					break;
 				}
-
-				X2 = (in_cNX < 0) ? id_N2 : prey[in_cNX];
-				Y2 = (in_cNY < 0) ? id_N2 : prey[in_cNY];
-
-				id_N2++;
 			}
-			while (1);
+		}
 
-			if (prev_X2 + (fval_t) pl->defungap > X2) {
+		for (N = kN; N < pl->data[dN].chunk_MAX; ++N) {
 
-				if (		pl->interpolation != 0
-						&& X2 >= X) {
+			if (pl->data[dN].raw[N] != NULL) {
 
-					if (		prev_X2 <= X
-							&& prev_X2 < X2) {
+				free(pl->data[dN].raw[N]);
 
-						Qf = (X - prev_X2) / (X2 - prev_X2);
-						Y = prev_Y2 + (Y2 - prev_Y2) * Qf;
-					}
-					else {
-						Y = prev_Y2;
-					}
-				}
-				else {
-					Y = Y2;
-				}
-			}
-			else {
-				Y = FP_NAN;
+				pl->data[dN].raw[N] = NULL;
 			}
 		}
-		else {
-			Y = FP_NAN;
-		}
-
-		row[cNY] = Y;
-
-		id_N++;
 	}
-	while (1);
+
+	pl->data[dN].length_N = lN;
 }
 
-static void
-plotDataPolyfit(plot_t *pl, int dN, int cNX, int cNY,
-		double scale_X, double offset_X,
-		double scale_Y, double offset_Y, int N0, int N1)
+unsigned long long plotDataMemoryUsage(plot_t *pl, int dN)
 {
-	const fval_t	*row;
-
-	double		fval_X, fval_Y, fvec[LSE_FULL_MAX];
-	int		N, xN, yN, kN, rN, id_N, job;
-
-	lse_construct(&pl->lsq, LSE_CASCADE_MAX, N1 - N0 + 1, 1);
+	int			N;
+	unsigned long long	bUSAGE;
 
-	xN = plotDataRangeCacheFetch(pl, dN, cNX);
-	yN = plotDataRangeCacheFetch(pl, dN, cNY);
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
 
-	rN = pl->data[dN].head_N;
-	id_N = pl->data[dN].id_N;
+		ERROR("Dataset number is out of range\n");
+		return 0;
+	}
 
-	do {
-		kN = plotDataChunkN(pl, dN, rN);
-		job = 1;
+	bUSAGE = 0;
 
-		if (xN >= 0 && pl->rcache[xN].chunk[kN].computed != 0) {
+	for (N = 0; N < pl->data[dN].chunk_MAX; ++N) {
 
-			if (pl->rcache[xN].chunk[kN].finite != 0) {
+		if (pl->data[dN].raw[N] != NULL) {
 
-				fvec[0] = pl->rcache[xN].chunk[kN].fmin * scale_X + offset_X;
-				fvec[1] = pl->rcache[xN].chunk[kN].fmax * scale_X + offset_X;
+			bUSAGE += pl->data[dN].chunk_bSIZE;
+		}
 
-				if (fvec[0] > 1. || fvec[1] < 0.) {
+		if (pl->data[dN].compress[N].raw != NULL) {
 
-					job = 0;
-				}
-			}
-			else {
-				job = 0;
-			}
+			bUSAGE += pl->data[dN].compress[N].length;
 		}
+	}
 
-		if (yN >= 0 && pl->rcache[yN].chunk[kN].computed != 0) {
+	return bUSAGE;
+}
 
-			if (pl->rcache[yN].chunk[kN].finite != 0) {
+unsigned long long plotDataMemoryUncompressed(plot_t *pl, int dN)
+{
+	int			N;
+	unsigned long long	bUSAGE;
 
-				fvec[0] = pl->rcache[yN].chunk[kN].fmin * scale_Y + offset_Y;
-				fvec[1] = pl->rcache[yN].chunk[kN].fmax * scale_Y + offset_Y;
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
 
-				if (fvec[0] > 1. || fvec[1] < 0.) {
+		ERROR("Dataset number is out of range\n");
+		return 0;
+	}
 
-					job = 0;
-				}
-			}
-			else {
-				job = 0;
-			}
-		}
+	bUSAGE = 0;
 
-		if (job != 0) {
+	for (N = 0; N < pl->data[dN].chunk_MAX; ++N) {
 
-			do {
-				if (kN != plotDataChunkN(pl, dN, rN))
-					break;
+		if (		pl->data[dN].raw[N] != NULL
+				|| pl->data[dN].compress[N].raw != NULL
+				|| pl->data[dN].compress[N].spilled != 0) {
 
-				row = plotDataGet(pl, dN, &rN);
+			bUSAGE += pl->data[dN].chunk_bSIZE;
+		}
+	}
 
-				if (row == NULL)
-					break;
+	return bUSAGE;
+}
 
-				fval_X = (cNX < 0) ? id_N : row[cNX];
-				fval_Y = (cNY < 0) ? id_N : row[cNY];
+unsigned long long plotDataMemoryCached(plot_t *pl, int dN)
+{
+	int			N;
+	unsigned long long	bUSAGE;
 
-				if (fp_isfinite(fval_X) && fp_isfinite(fval_Y)) {
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
 
-					fvec[0] = fval_X * scale_X + offset_X;
-					fvec[1] = fval_Y * scale_Y + offset_Y;
+		ERROR("Dataset number is out of range\n");
+		return 0;
+	}
 
-					if (		   fvec[0] >= 0. && fvec[0] <= 1.
-							&& fvec[1] >= 0. && fvec[1] <= 1.) {
+	bUSAGE = 0;
 
-						fvec[0] = 1.;
+	for (N = 0; N < PLOT_CHUNK_CACHE; ++N) {
 
-						for (N = 0; N < N1; ++N)
-							fvec[N + 1] = fvec[N] * fval_X;
+		if (pl->data[dN].cache[N].raw != NULL) {
 
-						for (N = 0; N < N1 - N0 + 1; ++N)
-							fvec[N] = fvec[N + N0];
+			bUSAGE += pl->data[dN].chunk_bSIZE;
+		}
+	}
 
-						fvec[N1 - N0 + 1] = fval_Y;
+	for (N = 0; N < PLOT_LZ4_JOB_MAX; ++N) {
 
-						lse_insert(&pl->lsq, fvec);
-					}
-				}
+		if (pl->data[dN].lz4_job[N].raw != NULL) {
 
-				id_N++;
-			}
-			while (1);
-		}
-		else {
-			plotDataChunkSkip(pl, dN, &rN, &id_N);
+			bUSAGE += pl->data[dN].chunk_bSIZE;
 		}
+	}
 
-		if (rN == pl->data[dN].tail_N)
-			break;
+	return bUSAGE;
+}
+
+unsigned long long plotDataCacheHit(plot_t *pl, int dN)
+{
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return 0;
 	}
-	while (1);
 
-	lse_solve(&pl->lsq);
-	lse_std(&pl->lsq);
+	return pl->data[dN].cache_hit;
 }
 
-static void
-plotDataFileCSV(plot_t *pl, int *list_dN, int *list_cN, int len_N, FILE *fd_csv)
+unsigned long long plotDataCacheMiss(plot_t *pl, int dN)
 {
-	const read_t	*rd = (const read_t *) pl->ld;
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
 
-	char		numfmt[PLOT_STRING_MAX];
+		ERROR("Dataset number is out of range\n");
+		return 0;
+	}
 
-	double		fval;
-	int		N, bN, dN, job;
+	return pl->data[dN].cache_miss;
+}
+
+static int
+plotDataCacheGetNode(plot_t *pl, int dN)
+{
+	int		N, kNOT, xN = -1;
 
-	struct {
+	for (N = 0; N < pl->data[dN].cache_size; ++N) {
 
-		const fval_t	*row;
+		if (pl->data[dN].cache[N].raw == NULL) {
 
-		int		rN;
-		int		id_N;
+			xN = N;
+			break;
+		}
 	}
-	local[PLOT_DATASET_MAX];
 
-	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+	if (xN < 0) {
 
-		job = 0;
+		/* Evict the least recently used chunk but keep the tail chunk
+		 * that is written on each insert.
+		 * */
+		kNOT = pl->data[dN].tail_N >> pl->data[dN].chunk_SHIFT;
 
-		if (pl->data[dN].column_N != 0) {
+		for (N = 0; N < pl->data[dN].cache_size; ++N) {
 
-			for (N = 0; N < len_N; ++N) {
+			if (pl->data[dN].cache[N].chunk_N == kNOT)
+				continue;
 
-				if (list_dN[N] == dN) {
+			if (		xN < 0
+					|| pl->data[dN].cache[N].stamp < pl->data[dN].cache[xN].stamp) {
 
-					job = 1;
-					break;
-				}
+				xN = N;
 			}
 		}
 
-		if (job != 0) {
-
-			local[dN].row = (const fval_t *) 1;
-			local[dN].rN = pl->data[dN].head_N;
-			local[dN].id_N = pl->data[dN].id_N;
-		}
-		else {
-			local[dN].row = NULL;
-		}
+		xN = (xN < 0) ? 0 : xN;
 	}
 
-	do {
-		job = 0;
-
-		for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
-
-			if (local[dN].row != NULL) {
+	return xN;
+}
 
-				local[dN].row = plotDataGet(pl, dN, &local[dN].rN);
-			}
+static int
+plotDataCacheFetch(plot_t *pl, int dN, int kN)
+{
+	fval_t		*raw = NULL;
+	int		xN, jN, kNZ;
 
-			if (local[dN].row != NULL)
-				job = 1;
-		}
+	jN = plotDataJobGetByChunk(pl, dN, kN);
 
-		if (job == 0)
-			break;
+	if (jN >= 0) {
 
-		bN = 0;
+		/* The chunk is still owned by background job (being read
+		 * ahead or compressed) so we take its buffer as is.
+		 * */
+		raw = plotDataJobFinish(pl, dN, jN);
+	}
 
-		for (N = 0; N < len_N; ++N) {
+	xN = plotDataCacheGetNode(pl, dN);
 
-			dN = list_dN[N];
+	if (pl->data[dN].cache[xN].raw != NULL) {
 
-			if (local[dN].row != NULL) {
+		kNZ = pl->data[dN].cache[xN].chunk_N;
 
-				fval = (list_cN[N] < 0) ? local[dN].id_N
-					: local[dN].row[list_cN[N]];
+		if (pl->data[dN].cache[xN].dirty != 0) {
 
-				if (fp_isfinite(fval))
-					bN++;
-			}
+			plotDataJobCompress(pl, dN, kNZ, pl->data[dN].cache[xN].raw);
 
-			if (bN >= 1)
-				break;
+			pl->data[dN].cache[xN].raw = NULL;
 		}
 
-		if (bN < 1)
-			goto plotDataFileCSV_SKIP;
+		pl->data[dN].raw[kNZ] = NULL;
+	}
 
-		for (N = 0; N < len_N; ++N) {
+	if (raw != NULL) {
 
-			job = 0;
+		if (pl->data[dN].cache[xN].raw != NULL) {
 
-			dN = list_dN[N];
+			plotDataJobSpare(pl, dN, pl->data[dN].cache[xN].raw);
+		}
 
-			if (local[dN].row != NULL) {
+		pl->data[dN].cache[xN].raw = raw;
+	}
+	else {
+		if (pl->data[dN].cache[xN].raw == NULL) {
 
-				fval = (list_cN[N] < 0) ? local[dN].id_N
-					: local[dN].row[list_cN[N]];
+			pl->data[dN].cache[xN].raw = plotDataJobTake(pl, dN);
 
-				if (fp_isfinite(fval))
-					job = 1;
+			if (pl->data[dN].cache[xN].raw == NULL) {
+
+				ERROR("Unable to allocate cache of %i dataset\n", dN);
 			}
+		}
 
-			if (job != 0) {
+		if (		pl->data[dN].cache[xN].raw != NULL
+				&& (pl->data[dN].compress[kN].raw != NULL
+					|| pl->data[dN].compress[kN].spilled != 0)) {
 
-				int		fexp = 1;
+			lz4job_t		*jb;
+			fval_t			*spare;
 
-				if (fval != 0.) {
+			/* Decompress in place by means of free job as it
+			 * keeps the scratch buffer we need to unpack.
+			 * */
+			jN = plotDataJobGetFree(pl, dN, 0, 1);
+			jb = &pl->data[dN].lz4_job[jN];
 
-					fexp += (int) floor(log10(fabs(fval)));
-				}
+			/* Page in the spilled chunk only when the job is
+			 * taken so nothing could evict it until we are done.
+			 * */
+			plotDataSpillLoad(pl, dN, kN);
 
-				if (fexp >= -2 && fexp < pl->fprecision) {
+			spare = jb->raw;
 
-					fexp = (fexp < 1) ? 1 : fexp;
+			plotDataJobLayout(pl, dN, jb);
 
-					sprintf(numfmt, "%%.%df%%c", pl->fprecision - fexp);
-				}
-				else {
-					sprintf(numfmt, "%%.%dE%%c", pl->fprecision - 1);
-				}
+			jb->raw = pl->data[dN].cache[xN].raw;
+			jb->lz4 = pl->data[dN].compress[kN].raw;
+			jb->length = pl->data[dN].compress[kN].length;
+
+			if (jb->lz4 != NULL) {
 
-				fprintf(fd_csv, numfmt, fval, rd->mk_text.space[0]);
+				plotLZ4Decompress(jb);
 			}
 			else {
-				fprintf(fd_csv, "NaN%c", rd->mk_text.space[0]);
+				jb->rc = 0;
 			}
-		}
-
-		fprintf(fd_csv, "\n");
 
-plotDataFileCSV_SKIP:
+			jb->raw = spare;
+			jb->lz4 = NULL;
 
-		for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+			if (jb->rc != pl->data[dN].chunk_bSIZE) {
 
-			if (local[dN].row != NULL)
-				local[dN].id_N++;
+				ERROR("Unable to decompress LZ4 memory of %i dataset\n", dN);
+			}
 		}
 	}
-	while (1);
+
+	pl->data[dN].cache[xN].chunk_N = kN;
+	pl->data[dN].cache[xN].dirty = 0;
+
+	pl->data[dN].raw[kN] = pl->data[dN].cache[xN].raw;
+
+	return xN;
 }
 
 static void
-plotDataSubtractWrite(plot_t *pl, int dN, int sN, int rN_beg, int id_N_beg, int rN_end)
+plotDataCacheTouch(plot_t *pl, int dN, int kN)
 {
-	fval_t		*row, X1, X2, X3, X4;
-	double		scale, offset, gain;
-	int		cN, rN, id_N, cNX, cNY, cNT, mode;
+	int		N, xN = -1, kMAX, kLAST;
 
-	mode = pl->data[dN].sub[sN].busy;
+	kMAX = pl->data[dN].length_N >> pl->data[dN].chunk_SHIFT;
+	kMAX += (pl->data[dN].length_N & pl->data[dN].chunk_MASK) ? 1 : 0;
 
-	if (mode != SUBTRACT_FREE) {
+	kLAST = pl->data[dN].cache_last;
 
-		cN = sN + pl->data[dN].column_N;
+	/* Guess the direction of sequential access to read ahead the next
+	 * chunk. Any random jump keeps the previous direction.
+	 * */
+	if (kLAST >= 0) {
 
-		rN = rN_beg;
-		id_N = id_N_beg;
-	}
+		if (kN == kLAST + 1 || (kN == 0 && kLAST == kMAX - 1)) {
 
-	if (mode == SUBTRACT_TIME_MEDIAN) {
+			pl->data[dN].cache_ahead = 1;
+		}
+		else if (kN == kLAST - 1 || (kLAST == 0 && kN == kMAX - 1)) {
 
-		/* Do not to calculate HERE */
+			pl->data[dN].cache_ahead = -1;
+		}
 	}
-	else if (mode == SUBTRACT_DATA_MEDIAN) {
 
-		tuple_t		mN;
+	if (pl->data[dN].raw[kN] != NULL) {
 
-		if (rN_beg == pl->data[dN].head_N) {
+		for (N = 0; N < pl->data[dN].cache_size; ++N) {
 
-			pl->data[dN].sub[sN].op.median.keep = 0;
-			pl->data[dN].sub[sN].op.median.tail = 0;
+			if (		pl->data[dN].cache[N].raw != NULL
+					&& pl->data[dN].cache[N].chunk_N == kN) {
 
-			pl->data[dN].sub[sN].op.median.offset = (double) 0.;
-			pl->data[dN].sub[sN].op.median.prev[0] = FP_NAN;
-			pl->data[dN].sub[sN].op.median.prev[1] = FP_NAN;
+				xN = N;
+				break;
+			}
 		}
 
-		cNX = pl->data[dN].sub[sN].op.median.column_X;
-		cNY = pl->data[dN].sub[sN].op.median.column_Y;
-		cNT = pl->data[dN].sub[sN].op.median.column_T;
+		pl->data[dN].cache_hit++;
+	}
+	else {
+		xN = plotDataCacheFetch(pl, dN, kN);
 
-		offset = pl->data[dN].sub[sN].op.median.offset;
+		pl->data[dN].cache_miss++;
+	}
 
-		if (pl->data[dN].sub[sN].op.median.unwrap != UNWRAP_NONE) {
+	if (xN >= 0 && pl->data[dN].raw[kN] != NULL) {
 
-			X3 = (fval_t) pl->data[dN].sub[sN].op.median.prev[0];
-			X4 = (fval_t) pl->data[dN].sub[sN].op.median.prev[1];
-		}
+		pl->data[dN].cache[xN].stamp = ++pl->data[dN].cache_clock;
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+		pl->data[dN].cache_last = kN;
+		pl->data[dN].cache_last_ID = xN;
+	}
+	else {
+		pl->data[dN].cache_last = -1;
+	}
 
-			if (row == NULL)
-				break;
+	plotDataJobReadAhead(pl, dN, kN, pl->data[dN].cache_ahead);
+}
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
-			X2 = (cNY < 0) ? id_N : row[cNY];
+static void
+plotDataChunkFetch(plot_t *pl, int dN, int kN)
+{
+	if (		   pl->data[dN].cache_last != kN
+			&& pl->data[dN].length_N != 0) {
 
-			mN = plotDataMedianAdd(pl, dN, sN, X1, X2);
+		plotDataCacheTouch(pl, dN, kN);
+	}
+}
 
-			if (mN.X < 0) {
+static void
+plotDataChunkWrite(plot_t *pl, int dN, int kN)
+{
+	plotDataChunkFetch(pl, dN, kN);
 
-				X1 = FP_NAN;
-				X2 = FP_NAN;
-			}
-			else {
-				X1 = pl->data[dN].sub[sN].op.median.window[mN.X].fval;
-				X2 = pl->data[dN].sub[sN].op.median.window[mN.Y].fpay;
-			}
+	if (pl->data[dN].cache_last == kN) {
 
-			if (pl->data[dN].sub[sN].op.median.unwrap == UNWRAP_OVERFLOW) {
+		pl->data[dN].cache[pl->data[dN].cache_last_ID].dirty = 1;
+	}
+}
 
-				if (X1 + (fval_t) pl->defungap < X3) {
+void plotDataCacheResize(plot_t *pl, int dN, int size)
+{
+	int		N, kNZ;
 
-					offset += X3 - X1;
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
 
-					if (X4 < X3) {
+		ERROR("Dataset number is out of range\n");
+		return ;
+	}
 
-						offset += X3 - X4;
-					}
-				}
+	size = (size < 2) ? 2 : (size > PLOT_CHUNK_CACHE) ? PLOT_CHUNK_CACHE : size;
 
-				if (fp_isfinite(X1)) {
+	if (pl->data[dN].lz4_compress != 0) {
 
-					X4 = X3;
-					X3 = X1;
-				}
-			}
-			else if (pl->data[dN].sub[sN].op.median.unwrap == UNWRAP_BURST) {
+		for (N = size; N < pl->data[dN].cache_size; ++N) {
 
-				if (X1 < X3) {
+			if (pl->data[dN].cache[N].raw != NULL) {
 
-					X1 = FP_NAN;
-				}
-				else if (X1 - (fval_t) pl->defungap > X3) {
+				kNZ = pl->data[dN].cache[N].chunk_N;
 
-					X1 = FP_NAN;
-				}
-				else if (fp_isfinite(X1)) {
+				if (pl->data[dN].cache[N].dirty != 0) {
 
-					X3 = X1;
+					plotDataJobCompress(pl, dN, kNZ, pl->data[dN].cache[N].raw);
+				}
+				else {
+					plotDataJobSpare(pl, dN, pl->data[dN].cache[N].raw);
 				}
-			}
-
-			row[cNT] = X1 + offset;
-			row[cN] = X2;
-
-			id_N++;
 
-			if (rN == rN_end)
-				break;
+				pl->data[dN].cache[N].raw = NULL;
+				pl->data[dN].raw[kNZ] = NULL;
+			}
 		}
-		while (1);
-
-		pl->data[dN].sub[sN].op.median.offset = offset;
-
-		if (pl->data[dN].sub[sN].op.median.unwrap != UNWRAP_NONE) {
 
-			pl->data[dN].sub[sN].op.median.prev[0] = (double) X3;
-			pl->data[dN].sub[sN].op.median.prev[1] = (double) X4;
-		}
+		pl->data[dN].cache_last = -1;
 	}
-	else if (mode == SUBTRACT_SCALE) {
-
-		cNX = pl->data[dN].sub[sN].op.scale.column_X;
-
-		scale = pl->data[dN].sub[sN].op.scale.scale;
-		offset = pl->data[dN].sub[sN].op.scale.offset;
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+	pl->data[dN].cache_size = size;
+}
 
-			if (row == NULL)
-				break;
+static void
+plotDataMonotonicReset(plot_t *pl, int dN)
+{
+	int		N;
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
-			X1 = X1 * scale + offset;
+	for (N = 0; N < pl->data[dN].column_N; ++N) {
 
-			row[cN] = X1;
+		pl->data[dN].mono[N].monotonic = 1;
+		pl->data[dN].mono[N].started = 0;
+	}
+}
 
-			id_N++;
+static void
+plotDataStatChunkReset(plot_t *pl, int dN, int kN)
+{
+	pstat_t		*st;
+	int		N, sN;
 
-			if (rN == rN_end)
-				break;
-		}
-		while (1);
+	st = pl->data[dN].stat[kN].column;
+	sN = pl->data[dN].column_N + PLOT_SUBTRACT + 1;
 
-		pl->data[dN].sub[sN].op.scale.modified = 0;
-	}
-	else if (mode == SUBTRACT_RESAMPLE) {
+	for (N = 0; N < sN; ++N) {
 
-		/* Do not to calculate HERE */
+		st[N].finite = 0;
+		st[N].row_N = 0;
 	}
-	else if (mode == SUBTRACT_POLYFIT) {
 
-		const double	*coefs;
-		int		N, N0, N1;
+	pl->data[dN].stat[kN].fill = 0;
+}
 
-		cNX = pl->data[dN].sub[sN].op.polyfit.column_X;
+static void
+plotDataStatAlloc(plot_t *pl, int dN)
+{
+	int		N, kN, lN, sN;
 
-		N0 = pl->data[dN].sub[sN].op.polyfit.poly_N0;
-		N1 = pl->data[dN].sub[sN].op.polyfit.poly_N1;
-		coefs = pl->data[dN].sub[sN].op.polyfit.coefs;
+	lN = pl->data[dN].length_N;
+	sN = pl->data[dN].column_N + PLOT_SUBTRACT + 1;
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+	kN = (lN & pl->data[dN].chunk_MASK) ? 1 : 0;
+	kN += lN >> pl->data[dN].chunk_SHIFT;
 
-			if (row == NULL)
-				break;
+	for (N = 0; N < pl->data[dN].chunk_MAX; ++N) {
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
-			X2 = coefs[N1 - N0];
+		if (N < kN) {
 
-			for (N = N1 - N0 - 1; N >= 0; --N)
-				X2 = X2 * X1 + coefs[N];
+			if (pl->data[dN].stat[N].column == NULL) {
 
-			for (N = N0 - 1; N >= 0; --N)
-				X2 = X2 * X1;
+				pl->data[dN].stat[N].column = (pstat_t *) malloc(sizeof(pstat_t) * sN);
 
-			row[cN] = X2;
+				if (pl->data[dN].stat[N].column == NULL) {
 
-			id_N++;
+					ERROR("Unable to allocate range memory of %i dataset\n", dN);
+					break;
+				}
 
-			if (rN == rN_end)
-				break;
+				plotDataStatChunkReset(pl, dN, N);
+			}
 		}
-		while (1);
-	}
-	else if (mode == SUBTRACT_BINARY_SUBTRACTION) {
-
-		cNX = pl->data[dN].sub[sN].op.binary.column_X;
-		cNY = pl->data[dN].sub[sN].op.binary.column_Y;
+		else if (pl->data[dN].stat[N].column != NULL) {
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+			free(pl->data[dN].stat[N].column);
 
-			if (row == NULL)
-				break;
+			pl->data[dN].stat[N].column = NULL;
+		}
+	}
+}
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
-			X2 = (cNY < 0) ? id_N : row[cNY];
+static void
+plotDataStatReset(plot_t *pl, int dN)
+{
+	int		N;
 
-			row[cN] = X1 - X2;
+	for (N = 0; N < pl->data[dN].chunk_MAX; ++N) {
 
-			id_N++;
+		if (pl->data[dN].stat[N].column != NULL) {
 
-			if (rN == rN_end)
-				break;
+			plotDataStatChunkReset(pl, dN, N);
 		}
-		while (1);
 	}
-	else if (mode == SUBTRACT_BINARY_ADDITION) {
 
-		cNX = pl->data[dN].sub[sN].op.binary.column_X;
-		cNY = pl->data[dN].sub[sN].op.binary.column_Y;
+	pl->data[dN].stat_head_N = -1;
+}
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+static void
+plotDataStatWipe(plot_t *pl, int dN, int kN, int jN, int cN)
+{
+	pstat_t		*st;
+	int		N, sN;
 
-			if (row == NULL)
-				break;
+	sN = pl->data[dN].column_N + PLOT_SUBTRACT + 1;
+	st = pl->data[dN].stat[kN].column;
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
-			X2 = (cNY < 0) ? id_N : row[cNY];
+	/* Drop the ranges of columns from cN that are changed at row jN of
+	 * chunk kN. The whole chunk is dropped if jN is negative.
+	 * */
+	if (st != NULL) {
 
-			row[cN] = X1 + X2;
+		for (N = cN + 1; N < sN; ++N) {
 
-			id_N++;
+			if (st[N].row_N > jN) {
 
-			if (rN == rN_end)
-				break;
+				st[N].finite = 0;
+				st[N].row_N = 0;
+			}
 		}
-		while (1);
 	}
-	else if (mode == SUBTRACT_BINARY_MULTIPLICATION) {
-
-		cNX = pl->data[dN].sub[sN].op.binary.column_X;
-		cNY = pl->data[dN].sub[sN].op.binary.column_Y;
-
-		do {
-			row = plotDataWrite(pl, dN, &rN);
-
-			if (row == NULL)
-				break;
-
-			X1 = (cNX < 0) ? id_N : row[cNX];
-			X2 = (cNY < 0) ? id_N : row[cNY];
-
-			row[cN] = X1 * X2;
 
-			id_N++;
+	if (		pl->data[dN].stat_head != NULL
+			&& kN == pl->data[dN].stat_head_N
+			&& (jN < 0 || jN >= pl->data[dN].stat[kN].fill)) {
 
-			if (rN == rN_end)
-				break;
-		}
-		while (1);
+		pl->data[dN].stat_head_from = -1;
 	}
-	else if (mode == SUBTRACT_BINARY_HYPOTENUSE) {
+}
 
-		cNX = pl->data[dN].sub[sN].op.binary.column_X;
-		cNY = pl->data[dN].sub[sN].op.binary.column_Y;
+static void
+plotDataStatAppend(plot_t *pl, int dN, int kN, int jN, const fval_t *rows, int n)
+{
+	pstat_t		*st;
+	fval_t		fval, fmin, fmax;
+	int		N, rN, cN, finite;
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+	st = pl->data[dN].stat[kN].column;
 
-			if (row == NULL)
-				break;
+	if (st == NULL)
+		return ;
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
-			X2 = (cNY < 0) ? id_N : row[cNY];
+	cN = pl->data[dN].column_N;
 
-			row[cN] = sqrt(X1 * X1 + X2 * X2);
+	if (jN < pl->data[dN].stat[kN].fill) {
 
-			id_N++;
+		/* The tail goes over the older rows of chunk. Their ranges
+		 * are scanned separately from the head row on the next range
+		 * fetch until the chunk is overwritten entirely.
+		 * */
+		pl->data[dN].stat_head_N = kN;
+		pl->data[dN].stat_head_fill = pl->data[dN].stat[kN].fill;
+		pl->data[dN].stat_head_from = -1;
 
-			if (rN == rN_end)
-				break;
-		}
-		while (1);
+		plotDataStatChunkReset(pl, dN, kN);
 	}
-	else if (mode == SUBTRACT_FILTER_DIFFERENCE) {
+	else if (pl->data[dN].stat_head_N != kN) {
 
-		if (rN_beg == pl->data[dN].head_N) {
-
-			pl->data[dN].sub[sN].op.filter.state[0] = FP_NAN;
-			pl->data[dN].sub[sN].op.filter.state[1] = FP_NAN;
-		}
+		pl->data[dN].stat_head_N = -1;
+	}
 
-		cNX = pl->data[dN].sub[sN].op.filter.column_X;
-		cNY = pl->data[dN].sub[sN].op.filter.column_Y;
+	/* Data columns are taken into ranges right away when they are in
+	 * order. The rest are scanned on the next range fetch.
+	 * */
+	for (N = 0; N < cN; ++N) {
 
-		X3 = (fval_t) pl->data[dN].sub[sN].op.filter.state[0];
-		X4 = (fval_t) pl->data[dN].sub[sN].op.filter.state[1];
+		if (st[N + 1].row_N != jN)
+			continue;
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+		finite = st[N + 1].finite;
+		fmin = st[N + 1].fmin;
+		fmax = st[N + 1].fmax;
 
-			if (row == NULL)
-				break;
+		for (rN = 0; rN < n; ++rN) {
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
-			X2 = (cNY < 0) ? id_N : row[cNY];
+			fval = rows[rN * cN + N];
 
-			row[cN] = (X2 - X4) / (X1 - X3);
+			if (fp_isfinite(fval)) {
 
-			X3 = X1;
-			X4 = X2;
+				if (finite != 0) {
 
-			id_N++;
+					fmin = (fval < fmin) ? fval : fmin;
+					fmax = (fval > fmax) ? fval : fmax;
+				}
+				else {
+					fmin = fval;
+					fmax = fval;
+				}
 
-			if (rN == rN_end)
-				break;
+				finite++;
+			}
 		}
-		while (1);
 
-		pl->data[dN].sub[sN].op.filter.state[0] = (double) X3;
-		pl->data[dN].sub[sN].op.filter.state[1] = (double) X4;
+		st[N + 1].finite = finite;
+		st[N + 1].row_N = jN + n;
+		st[N + 1].fmin = fmin;
+		st[N + 1].fmax = fmax;
 	}
-	else if (mode == SUBTRACT_FILTER_CUMULATIVE) {
 
-		if (rN_beg == pl->data[dN].head_N) {
+	pl->data[dN].stat[kN].fill = jN + n;
+}
 
-			pl->data[dN].sub[sN].op.filter.state[0] = FP_NAN;
-			pl->data[dN].sub[sN].op.filter.state[1] = 0.;
-		}
+static void
+plotDataStatScan(plot_t *pl, int dN, int kN, int cN, pstat_t *st, int fill)
+{
+	const fval_t	*raw;
+	fval_t		fval, fmin, fmax;
+	int		jN, rSTEP, finite;
 
-		cNX = pl->data[dN].sub[sN].op.filter.column_X;
-		cNY = pl->data[dN].sub[sN].op.filter.column_Y;
+	if (st->row_N >= fill)
+		return ;
 
-		X3 = (fval_t) pl->data[dN].sub[sN].op.filter.state[0];
-		X4 = (fval_t) pl->data[dN].sub[sN].op.filter.state[1];
+	if (pl->data[dN].lz4_compress != 0) {
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+		plotDataChunkFetch(pl, dN, kN);
+	}
 
-			if (row == NULL)
-				break;
+	raw = pl->data[dN].raw[kN];
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
-			X2 = (cNY < 0) ? id_N : row[cNY];
+	if (raw == NULL)
+		return ;
 
-			X2 *= X1 - X3;
+	rSTEP = pl->data[dN].row_STEP;
+	raw += cN * pl->data[dN].column_STEP;
 
-			if (fp_isfinite(X2)) {
+	finite = st->finite;
+	fmin = st->fmin;
+	fmax = st->fmax;
 
-				X4 += X2;
-			}
+	for (jN = st->row_N; jN < fill; ++jN) {
 
-			X3 = X1;
+		fval = raw[jN * rSTEP];
 
-			row[cN] = X4;
+		if (fp_isfinite(fval)) {
 
-			id_N++;
+			if (finite != 0) {
 
-			if (rN == rN_end)
-				break;
-		}
-		while (1);
+				fmin = (fval < fmin) ? fval : fmin;
+				fmax = (fval > fmax) ? fval : fmax;
+			}
+			else {
+				fmin = fval;
+				fmax = fval;
+			}
 
-		pl->data[dN].sub[sN].op.filter.state[0] = (double) X3;
-		pl->data[dN].sub[sN].op.filter.state[1] = (double) X4;
+			finite++;
+		}
 	}
-	else if (mode == SUBTRACT_FILTER_BITMASK) {
-
-		unsigned long	shift, mask, ulval;
 
-		cNX = pl->data[dN].sub[sN].op.filter.column_Y;
-		ulval = (unsigned long) pl->data[dN].sub[sN].op.filter.gain;
+	st->finite = finite;
+	st->row_N = fill;
+	st->fmin = fmin;
+	st->fmax = fmax;
+}
 
-		shift = ulval & 0xFFU;
-		ulval = ulval >> 8;
+void plotDataAlloc(plot_t *pl, int dN, int cN, int lN, int storage)
+{
+	int		*map;
 
-		mask = ((1U << (ulval - shift + 1U)) - 1U) << shift;
+	int		N, bSIZE;
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
 
-			if (row == NULL)
-				break;
+		ERROR("Dataset number is out of range\n");
+		return ;
+	}
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
+	if (cN < 1) {
 
-			ulval = ((unsigned long) X1 & mask) >> shift;
-			row[cN] = (fval_t) ulval;
+		ERROR("Number of columns is too few\n");
+		return ;
+	}
 
-			id_N++;
+	if (lN < 1) {
 
-			if (rN == rN_end)
-				break;
-		}
-		while (1);
+		ERROR("Length of dataset is too short\n");
+		return ;
 	}
-	else if (mode == SUBTRACT_FILTER_LOW_PASS) {
 
-		if (rN_beg == pl->data[dN].head_N) {
+	if (pl->data[dN].column_N != 0) {
+
+		if (pl->data[dN].column_N != cN) {
 
-			pl->data[dN].sub[sN].op.filter.state[0] = FP_NAN;
+			ERROR("Number of columns cannot be changed\n");
+			return ;
 		}
 
-		cNX = pl->data[dN].sub[sN].op.filter.column_Y;
-		gain = pl->data[dN].sub[sN].op.filter.gain;
+		if (plotFigureHaveData(pl, dN) != 0) {
 
-		X2 = (fval_t) pl->data[dN].sub[sN].op.filter.state[0];
+			plotSketchClean(pl);
+		}
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+		plotDataRangeCacheClean(pl, dN);
+		plotDataChunkAlloc(pl, dN, lN);
+		plotDataStatAlloc(pl, dN);
+		plotDataStatReset(pl, dN);
+		plotDataMonotonicReset(pl, dN);
 
-			if (row == NULL)
-				break;
+		pl->data[dN].head_N = 0;
+		pl->data[dN].tail_N = 0;
+		pl->data[dN].id_N = 0;
+		pl->data[dN].sub_N = 0;
+	}
+	else {
+		pl->data[dN].column_N = cN;
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
+		for (N = 0; N < 30; ++N) {
 
-			if (fp_isfinite(X1)) {
+			bSIZE = (int) sizeof(fval_t) * (cN + PLOT_SUBTRACT) * (1UL << N);
 
-				if (fp_isfinite(X2)) {
+			if (bSIZE >= PLOT_CHUNK_SIZE) {
 
-					X2 += (X1 - X2) * gain;
-				}
-				else {
-					X2 = X1;
-				}
+				pl->data[dN].chunk_SHIFT = N;
+				pl->data[dN].chunk_MASK = (1UL << N) - 1UL;
+				pl->data[dN].chunk_bSIZE = bSIZE;
+				break;
 			}
+		}
 
-			row[cN] = X2;
+		pl->data[dN].columnar = pl->columnar;
 
-			id_N++;
+		if (pl->data[dN].columnar != 0) {
 
-			if (rN == rN_end)
-				break;
+			pl->data[dN].row_STEP = 1;
+			pl->data[dN].column_STEP = 1UL << pl->data[dN].chunk_SHIFT;
+		}
+		else {
+			pl->data[dN].row_STEP = cN + PLOT_SUBTRACT;
+			pl->data[dN].column_STEP = 1;
 		}
-		while (1);
 
-		pl->data[dN].sub[sN].op.filter.state[0] = (double) X2;
-	}
-	else if (mode == SUBTRACT_FILTER_MEDIAN) {
+		pl->data[dN].lz4_compress = pl->lz4_compress;
+		pl->data[dN].lz4_filter = pl->lz4_filter;
+		pl->data[dN].storage = storage;
 
-		tuple_t		mN;
+		plotDataChunkAlloc(pl, dN, lN);
+		plotDataStatAlloc(pl, dN);
 
-		if (rN_beg == pl->data[dN].head_N) {
+		pl->data[dN].cache_clock = 0;
+		pl->data[dN].cache_last = -1;
+		pl->data[dN].cache_ahead = 1;
 
-			pl->data[dN].sub[sN].op.median.keep = 0;
-			pl->data[dN].sub[sN].op.median.tail = 0;
-		}
+		pl->data[dN].cache_hit = 0;
+		pl->data[dN].cache_miss = 0;
 
-		cNX = pl->data[dN].sub[sN].op.median.column_Y;
+		plotDataCacheResize(pl, dN, pl->cache_size);
 
-		do {
-			row = plotDataWrite(pl, dN, &rN);
+		pl->data[dN].head_N = 0;
+		pl->data[dN].tail_N = 0;
+		pl->data[dN].id_N = 0;
+		pl->data[dN].sub_N = 0;
 
-			if (row == NULL)
-				break;
+		pl->data[dN].stat_head_N = -1;
 
-			X1 = (cNX < 0) ? id_N : row[cNX];
+		for (N = 0; N < PLOT_SUBTRACT; ++N) {
 
-			mN = plotDataMedianAdd(pl, dN, sN, X1, X1);
+			pl->data[dN].sub[N].busy = SUBTRACT_FREE;
+		}
 
-			if (mN.X < 0) {
+		map = (int *) malloc(sizeof(int) * (cN + PLOT_SUBTRACT + 1));
 
-				X2 = FP_NAN;
-			}
-			else {
-				X2 = pl->data[dN].sub[sN].op.median.window[mN.X].fval;
-			}
+		if (map == NULL) {
+
+			ERROR("No memory allocated for %i map\n", dN);
+			return ;
+		}
 
-			row[cN] = X2;
+		pl->data[dN].map = (int *) map + 1;
 
-			id_N++;
+		for (N = -1; N < cN + PLOT_SUBTRACT; ++N) {
 
-			if (rN == rN_end)
-				break;
+			pl->data[dN].map[N] = -1;
 		}
-		while (1);
-	}
-}
 
-static void
-plotDataSubtractResample(plot_t *pl, int dN, int sN)
-{
-	int		cNX, cNY, in_dN, in_cNX, in_cNY;
+		pl->data[dN].mono = (pmono_t *) malloc(sizeof(pmono_t) * cN);
 
-	if (pl->data[dN].sub[sN].busy == SUBTRACT_RESAMPLE) {
+		if (pl->data[dN].mono == NULL) {
 
-		cNX = pl->data[dN].sub[sN].op.resample.column_X;
-		cNY = sN + pl->data[dN].column_N;
+			ERROR("No memory allocated for %i mono\n", dN);
+			return ;
+		}
 
-		in_dN = pl->data[dN].sub[sN].op.resample.in_data_N;
-		in_cNX = pl->data[dN].sub[sN].op.resample.in_column_X;
-		in_cNY = pl->data[dN].sub[sN].op.resample.in_column_Y;
+		plotDataMonotonicReset(pl, dN);
 
-		plotDataResample(pl, dN, cNX, cNY, in_dN, in_cNX, in_cNY);
-	}
-}
+		pl->data[dN].stat_head = (pstat_t *) malloc(sizeof(pstat_t)
+				* (cN + PLOT_SUBTRACT + 1) * 2);
 
-static void
-plotDataSubtractWriteSeq(plot_t *pl, int dN, int rN_beg, int id_N_beg, int rN_end)
-{
-	int		N;
+		if (pl->data[dN].stat_head == NULL) {
 
-	for (N = 0; N < PLOT_SUBTRACT; ++N) {
+			ERROR("No memory allocated for %i range\n", dN);
+			return ;
+		}
 
-		plotDataSubtractWrite(pl, dN, N, rN_beg, id_N_beg, rN_end);
+		pl->data[dN].stat_split = pl->data[dN].stat_head + cN + PLOT_SUBTRACT + 1;
+
+		plotDataStatReset(pl, dN);
 	}
 }
 
 static void
-plotDataSubtractResampleSeq(plot_t *pl, int dN)
+plotSketchStreamBreak(plot_t *pl, int dN, int rN)
 {
-	int		N;
+	int		fN, lN, hN, N, sN;
 
-	for (N = 0; N < PLOT_SUBTRACT; ++N) {
+	lN = pl->data[dN].length_N;
+	hN = pl->data[dN].head_N;
 
-		plotDataSubtractResample(pl, dN, N);
+	N = rN - hN;
+	N += (N < 0) ? lN : 0;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->draw[fN].stream.on != 0
+				&& pl->draw[fN].stream.data_N == dN) {
+
+			/* The rows that are not drawn yet can be rewritten
+			 * without any effect to the sketch.
+			 * */
+			if (rN >= 0) {
+
+				sN = pl->draw[fN].rN - hN;
+				sN += (sN < 0) ? lN : 0;
+
+				if (N >= sN)
+					continue;
+			}
+
+			pl->draw[fN].stream.on = 0;
+		}
 	}
 }
 
-void plotDataSubtractCompute(plot_t *pl, int dN, int sN)
+void plotDataResize(plot_t *pl, int dN, int lN)
 {
-	int		rN, id_N, rN_end;
-
 	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
 
 		ERROR("Dataset number is out of range\n");
 		return ;
 	}
 
-	if (sN < 0 || sN >= PLOT_SUBTRACT) {
+	if (lN < 1) {
 
-		ERROR("Subtract number %i is out of range\n", sN);
+		ERROR("Length of dataset is too short\n");
 		return ;
 	}
 
-	if (pl->data[dN].sub_paused != 0)
-		return ;
-
-	rN = pl->data[dN].head_N;
-	id_N = pl->data[dN].id_N;
-
-	rN_end = pl->data[dN].tail_N;
+	if (pl->data[dN].column_N != 0) {
 
-	if (rN == rN_end)
-		return ;
+		if (lN < pl->data[dN].length_N) {
 
-	plotDataSubtractWrite(pl, dN, sN, rN, id_N, rN_end);
-	plotDataSubtractResample(pl, dN, sN);
-}
+			plotSketchStreamBreak(pl, dN, -1);
 
-void plotDataSubtractResidual(plot_t *pl, int dN)
-{
-	int		rN, id_N, rN_end;
+			pl->data[dN].head_N = 0;
+			pl->data[dN].tail_N = 0;
+			pl->data[dN].id_N = 0;
+			pl->data[dN].sub_N = 0;
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+			plotDataStatReset(pl, dN);
+		}
 
-		ERROR("Dataset number is out of range\n");
-		return ;
+		plotDataChunkAlloc(pl, dN, lN);
+		plotDataStatAlloc(pl, dN);
 	}
+}
 
-	rN = pl->data[dN].sub_N;
-	id_N = pl->data[dN].id_N;
-
-	rN_end = pl->data[dN].tail_N;
+int plotDataLength(plot_t *pl, int dN)
+{
+	int		N;
 
-	if (rN == rN_end)
-		return ;
+	N = pl->data[dN].tail_N - pl->data[dN].head_N;
+	N += (N < 0) ? pl->data[dN].length_N : 0;
 
-	plotDataSubtractWriteSeq(pl, dN, rN, id_N, rN_end);
+	return N;
+}
 
-	pl->data[dN].sub_N = rN_end;
+int plotDataSpaceLeft(plot_t *pl, int dN)
+{
+	return pl->data[dN].length_N - plotDataLength(pl, dN);
 }
 
-void plotDataSubtractClean(plot_t *pl)
+int plotDataGrowUp(plot_t *pl, int dN)
 {
-	int		dN, N;
+	int			lSHIFT, lN;
 
-	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+	lSHIFT = pl->data[dN].chunk_SHIFT;
 
-		if (pl->data[dN].column_N != 0) {
+	lN = pl->data[dN].length_N >> lSHIFT;
 
-			for (N = 0; N < PLOT_SUBTRACT; ++N) {
+	if (lN >= INT_MAX >> lSHIFT) {
 
-				pl->data[dN].sub[N].busy = SUBTRACT_FREE;
-			}
-		}
+		/* There is no room for one more chunk so the oldest rows
+		 * will be dropped.
+		 * */
+		return -1;
 	}
-}
 
-void plotDataSubtractPaused(plot_t *pl)
-{
-	int		dN;
+	lN = (lN + 1) << lSHIFT;
 
-	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+	plotDataResize(pl, dN, lN);
 
-		if (pl->data[dN].column_N != 0) {
+	if (pl->data[dN].length_N < lN)
+		return -1;
 
-			pl->data[dN].sub_paused = 1;
-		}
+	if ((lN >> lSHIFT) >= INT_MAX >> lSHIFT) {
+
+		ERROR("Length of %i dataset reached the limit of %i rows\n", dN, lN);
 	}
+
+	return 0;
 }
 
-void plotDataSubtractAlternate(plot_t *pl)
+static const fval_t *
+plotDataGet(plot_t *pl, int dN, int *rN)
 {
-	int		dN, rN, id_N, rN_end, id_N_end, lCHUNK;
-
-	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
-
-		if (pl->data[dN].column_N != 0) {
+	const fval_t	*row = NULL;
 
-			rN = pl->data[dN].head_N;
-			id_N = pl->data[dN].id_N;
+	int		lN, kN, jN;
 
-			if (rN != pl->data[dN].tail_N) {
+	if (*rN != pl->data[dN].tail_N) {
 
-				lCHUNK = (1UL << pl->data[dN].chunk_SHIFT);
+		kN = *rN >> pl->data[dN].chunk_SHIFT;
+		jN = *rN & pl->data[dN].chunk_MASK;
 
-				rN_end = rN;
-				id_N_end = id_N;
+		if (pl->data[dN].lz4_compress != 0) {
 
-				do {
-					plotDataSkip(pl, dN, &rN_end, &id_N_end, lCHUNK);
-					plotDataSubtractWriteSeq(pl, dN, rN, id_N, rN_end);
+			plotDataChunkFetch(pl, dN, kN);
+		}
 
-					rN = rN_end;
-					id_N = id_N_end;
-				}
-				while (rN != pl->data[dN].tail_N);
+		row = pl->data[dN].raw[kN];
 
-				pl->data[dN].sub_N = rN_end;
+		if (row != NULL) {
 
-				plotDataSubtractResampleSeq(pl, dN);
-			}
+			row += pl->data[dN].row_STEP * jN;
 
-			pl->data[dN].sub_paused = 0;
+			lN = pl->data[dN].length_N;
+			*rN = (*rN < lN - 1) ? *rN + 1 : 0;
 		}
 	}
+
+	return row;
 }
 
-void plotDataInsert(plot_t *pl, int dN, const fval_t *row)
+static void
+plotDataPolyfitWipe(plot_t *pl, int dN, int kN, int cN)
 {
-	fval_t		*place;
-	int		cN, lN, hN, tN, kN, jN, sN;
+	ppolyfit_t	*pf;
+	int		N;
 
-	cN = pl->data[dN].column_N;
-	lN = pl->data[dN].length_N;
-	hN = pl->data[dN].head_N;
-	tN = pl->data[dN].tail_N;
+	/* Drop the partial factorizations of chunk kN that are fitted over the
+	 * columns from cN and above.
+	 * */
+	for (N = 0; N < pl->polyfit_MAX; ++N) {
 
-	kN = tN >> pl->data[dN].chunk_SHIFT;
-	jN = tN & pl->data[dN].chunk_MASK;
+		pf = pl->polyfit[N];
 
-	if (pl->data[dN].lz4_compress != 0) {
+		if (		pf != NULL && pf->data_N == dN
+				&& (kN < 0 || pf->chunk_N == kN)
+				&& (pf->column_X >= cN || pf->column_Y >= cN)) {
 
-		plotDataChunkWrite(pl, dN, kN);
+			pf->computed = 0;
+		}
 	}
+}
 
-	if (		   pl->rcache_wipe_data_N != dN
-			|| pl->rcache_wipe_chunk_N != kN) {
-
-		plotDataRangeCacheWipe(pl, dN, kN);
-
-		pl->rcache_wipe_data_N = dN;
-		pl->rcache_wipe_chunk_N = kN;
-	}
+static void
+plotDataRangeCacheWipe(plot_t *pl, int dN, int kN)
+{
+	int		N;
 
-	place = pl->data[dN].raw[kN];
+	for (N = 0; N < PLOT_RCACHE_SIZE; ++N) {
 
-	if (place != NULL) {
+		if (		pl->rcache[N].busy != 0
+				&& pl->rcache[N].data_N == dN
+				&& kN < pl->rcache[N].chunk_MAX) {
 
-		place += (cN + PLOT_SUBTRACT) * jN;
+			pl->rcache[N].chunk[kN].lod_N = 0;
+		}
+	}
+}
 
-		memcpy(place, row, cN * sizeof(fval_t));
-		memset(place + cN, 0, PLOT_SUBTRACT * sizeof(fval_t));
+static void
+plotDataRangeCacheAppend(plot_t *pl, int dN, int kN, int jN)
+{
+	int		N, bN;
 
-		tN = (tN < lN - 1) ? tN + 1 : 0;
+	/* The rows are appended from jN so the pyramid buckets before are
+	 * still valid.
+	 * */
+	bN = jN >> PLOT_LOD_SHIFT;
 
-		if (hN == tN) {
+	plotDataPolyfitWipe(pl, dN, kN, -1);
 
-			pl->data[dN].id_N++;
+	for (N = 0; N < PLOT_RCACHE_SIZE; ++N) {
 
-			hN = (hN < lN - 1) ? hN + 1 : 0;
-			pl->data[dN].head_N = hN;
+		if (		pl->rcache[N].busy != 0
+				&& pl->rcache[N].data_N == dN
+				&& kN < pl->rcache[N].chunk_MAX) {
 
-			sN = pl->data[dN].sub_N;
-			pl->data[dN].sub_N = (sN == tN) ? hN : sN;
+			if (pl->rcache[N].chunk[kN].lod_N > bN)
+				pl->rcache[N].chunk[kN].lod_N = bN;
 		}
-
-		pl->data[dN].tail_N = tN;
 	}
 }
 
-void plotDataClean(plot_t *pl, int dN)
+static fval_t *
+plotDataWrite(plot_t *pl, int dN, int *rN)
 {
-	int		N;
+	fval_t		*row = NULL;
+	int		lN, kN, jN;
 
-	if (pl->data[dN].column_N != 0) {
+	if (*rN != pl->data[dN].tail_N) {
 
-		pl->data[dN].column_N = 0;
-		pl->data[dN].length_N = 0;
+		kN = *rN >> pl->data[dN].chunk_SHIFT;
+		jN = *rN & pl->data[dN].chunk_MASK;
 
 		if (pl->data[dN].lz4_compress != 0) {
 
-			for (N = 0; N < PLOT_CHUNK_CACHE; ++N) {
+			plotDataChunkWrite(pl, dN, kN);
+		}
 
-				if (pl->data[dN].cache[N].raw) {
+		if (		   pl->rcache_wipe_data_N != dN
+				|| pl->rcache_wipe_chunk_N != kN) {
 
-					free(pl->data[dN].cache[N].raw);
+			plotSketchStreamBreak(pl, dN, *rN);
+			plotDataRangeCacheWipe(pl, dN, kN);
+			plotDataStatWipe(pl, dN, kN, -1, -1);
+			plotDataPolyfitWipe(pl, dN, kN, -1);
 
-					pl->data[dN].cache[N].raw = NULL;
-				}
-			}
+			pl->rcache_wipe_data_N = dN;
+			pl->rcache_wipe_chunk_N = kN;
+		}
 
-			for (N = 0; N < PLOT_CHUNK_MAX; ++N) {
+		row = pl->data[dN].raw[kN];
 
-				pl->data[dN].raw[N] = NULL;
+		if (row != NULL) {
 
-				if (pl->data[dN].compress[N].raw != NULL) {
+			row += pl->data[dN].row_STEP * jN;
 
-					free(pl->data[dN].compress[N].raw);
+			lN = pl->data[dN].length_N;
+			*rN = (*rN < lN - 1) ? *rN + 1 : 0;
+		}
+	}
 
-					pl->data[dN].compress[N].raw = NULL;
-				}
-			}
+	return row;
+}
 
-			if (pl->data[dN].lz4_reserved != NULL) {
+static void
+plotDataSkip(plot_t *pl, int dN, int *rN, int *id_N, int iN)
+{
+	int		N, lN, tN;
 
-				free(pl->data[dN].lz4_reserved);
+	lN = pl->data[dN].length_N;
 
-				pl->data[dN].lz4_reserved = NULL;
-			}
-		}
-		else {
-			for (N = 0; N < PLOT_CHUNK_MAX; ++N) {
+	N = *rN - pl->data[dN].head_N;
+	N = (N < 0) ? N + lN : N;
 
-				if (pl->data[dN].raw[N] != NULL) {
+	tN = pl->data[dN].tail_N - pl->data[dN].head_N;
+	tN = (tN < 0) ? tN + lN : tN;
 
-					free(pl->data[dN].raw[N]);
+	iN = (N + iN < 0) ? - N : iN;
+	iN = (N + iN > tN) ? tN - N : iN;
 
-					pl->data[dN].raw[N] = NULL;
-				}
-			}
-		}
+	N += iN;
 
-		free(pl->data[dN].map - 1);
+	N = pl->data[dN].head_N + N;
+	N = (N > lN - 1) ? N - lN : N;
 
-		pl->data[dN].map = NULL;
+	if (rN != NULL) {
+
+		*rN = N;
+	}
+
+	if (id_N != NULL) {
+
+		*id_N += iN;
 	}
 }
 
 static int
-plotDataRangeCacheGetNode(plot_t *pl, int dN, int cN)
+plotDataChunkN(plot_t *pl, int dN, int rN)
 {
-	int		N, xN = -1;
+	int		kN;
 
-	for (N = 0; N < PLOT_RCACHE_SIZE; ++N) {
+	kN = rN >> pl->data[dN].chunk_SHIFT;
 
-		if (		pl->rcache[N].busy != 0
-				&& pl->rcache[N].data_N == dN
-				&& pl->rcache[N].column_N == cN) {
+	return kN;
+}
 
-			xN = N;
-			break;
-		}
-	}
+static void
+plotDataChunkSkip(plot_t *pl, int dN, int *rN, int *id_N)
+{
+	int		skip_N, wrap_N;
 
-	return xN;
+	skip_N = (1UL << pl->data[dN].chunk_SHIFT)
+		- (*rN & pl->data[dN].chunk_MASK);
+
+	wrap_N = pl->data[dN].length_N - *rN;
+	skip_N = (wrap_N < skip_N) ? wrap_N : skip_N;
+
+	plotDataSkip(pl, dN, rN, id_N, skip_N);
 }
 
-void plotDataRangeCacheClean(plot_t *pl, int dN)
+static void
+plotDataStatMerge(pstat_t *sum, const pstat_t *st)
 {
-	int		N;
+	if (st->finite != 0) {
 
-	for (N = 0; N < PLOT_RCACHE_SIZE; ++N) {
+		if (sum->finite != 0) {
 
-		if (pl->rcache[N].data_N == dN)
-			pl->rcache[N].busy = 0;
+			sum->fmin = (st->fmin < sum->fmin) ? st->fmin : sum->fmin;
+			sum->fmax = (st->fmax > sum->fmax) ? st->fmax : sum->fmax;
+		}
+		else {
+			sum->fmin = st->fmin;
+			sum->fmax = st->fmax;
+		}
+
+		sum->finite += st->finite;
 	}
 }
 
-void plotDataRangeCacheSubtractClean(plot_t *pl)
+static void
+plotDataStatHead(plot_t *pl, int dN)
 {
-	int		N, dN;
+	pstat_t		*st;
+	int		N, sN, kN, jN;
 
-	for (N = 0; N < PLOT_RCACHE_SIZE; ++N) {
+	kN = plotDataChunkN(pl, dN, pl->data[dN].head_N);
+	jN = pl->data[dN].head_N & pl->data[dN].chunk_MASK;
 
-		if (pl->rcache[N].busy != 0) {
+	if (		kN != pl->data[dN].stat_head_N
+			&& jN != 0) {
 
-			dN = pl->rcache[N].data_N;
+		/* The tail has come up to the head chunk but has not
+		 * written over its older rows yet.
+		 * */
+		if (pl->data[dN].stat[kN].column == NULL)
+			return ;
 
-			if (		dN >= 0 && dN < PLOT_DATASET_MAX
-					&& pl->data[dN].column_N != 0) {
+		pl->data[dN].stat_head_N = kN;
+		pl->data[dN].stat_head_fill = pl->data[dN].stat[kN].fill;
+		pl->data[dN].stat_head_from = -1;
 
-				if (pl->rcache[N].column_N >= pl->data[dN].column_N)
-					pl->rcache[N].busy = 0;
-			}
-		}
+		plotDataStatChunkReset(pl, dN, kN);
 	}
-}
 
-int plotDataRangeCacheFetch(plot_t *pl, int dN, int cN)
-{
-	const fval_t	*row;
+	if (kN != pl->data[dN].stat_head_N)
+		return ;
 
-	double		fval, fmin, fmax, ymin, ymax;
-	int		N, xN, rN, id_N, kN;
-	int		job, finite, started;
+	/* The older rows of the head chunk are gone up to the head row so
+	 * their ranges are scanned again each time the head moves on.
+	 * */
+	if (jN != pl->data[dN].stat_head_from) {
 
-	xN = plotDataRangeCacheGetNode(pl, dN, cN);
+		sN = pl->data[dN].column_N + PLOT_SUBTRACT + 1;
+		st = pl->data[dN].stat_head;
 
-	if (xN >= 0) {
+		for (N = 0; N < sN; ++N) {
+
+			st[N].finite = 0;
+			st[N].row_N = jN;
+		}
 
-		if (pl->rcache[xN].cached != 0)
-			return xN;
+		pl->data[dN].stat_head_from = jN;
 	}
-	else {
-		xN = pl->rcache_ID;
+}
 
-		pl->rcache_ID = (pl->rcache_ID < PLOT_RCACHE_SIZE - 1)
-			? pl->rcache_ID + 1 : 0;
+static int
+plotDataStatFetch(plot_t *pl, int dN, int cN, double *pmin, double *pmax)
+{
+	pstat_t		*st, *split, total;
+	int		rN, id_N, kN, kN_head, id_beg;
 
-		for (N = 0; N < PLOT_CHUNK_MAX; ++N) {
+	kN_head = -1;
+	split = NULL;
 
-			pl->rcache[xN].chunk[N].computed = 0;
-		}
+	if (pl->data[dN].stat_head != NULL) {
+
+		plotDataStatHead(pl, dN);
+
+		kN_head = pl->data[dN].stat_head_N;
+		split = pl->data[dN].stat_split + cN + 1;
+
+		split->finite = 0;
+		split->row_N = 0;
 	}
 
+	total.finite = 0;
+	total.fmin = 0.;
+	total.fmax = 0.;
+
 	rN = pl->data[dN].head_N;
 	id_N = pl->data[dN].id_N;
 
-	fmin = 0.;
-	fmax = 0.;
-
-	started = 0;
+	/* Only the rows that are added or changed since the last fetch are
+	 * scanned so it takes about one pass over the chunks.
+	 * */
+	while (rN != pl->data[dN].tail_N) {
 
-	do {
 		kN = plotDataChunkN(pl, dN, rN);
+		id_beg = id_N;
 
-		if (pl->rcache[xN].chunk[kN].computed != 0) {
+		plotDataChunkSkip(pl, dN, &rN, &id_N);
 
-			if (kN == plotDataChunkN(pl, dN, pl->data[dN].tail_N)) {
-
-				job = 1;
+		st = pl->data[dN].stat[kN].column;
 
-				finite = pl->rcache[xN].chunk[kN].finite;
-				ymin = pl->rcache[xN].chunk[kN].fmin;
-				ymax = pl->rcache[xN].chunk[kN].fmax;
-			}
-			else {
-				job = 0;
-			}
-		}
-		else {
-			finite = 0;
-			job = 1;
-		}
+		if (st == NULL)
+			continue;
 
-		if (job != 0) {
+		st += cN + 1;
 
-			do {
-				if (kN != plotDataChunkN(pl, dN, rN))
-					break;
+		if (cN < 0) {
 
-				row = plotDataGet(pl, dN, &rN);
+			st->finite = id_N - id_beg;
+			st->fmin = id_beg;
+			st->fmax = id_N - 1;
 
-				if (row == NULL)
-					break;
+			if (kN == kN_head) {
 
-				fval = (cN < 0) ? id_N : row[cN];
+				plotDataStatMerge(split, st);
+			}
 
-				if (fp_isfinite(fval)) {
+			plotDataStatMerge(&total, st);
+		}
+		else if (kN == kN_head) {
 
-					if (finite != 0) {
+			/* The chunk is visited twice if the ring buffer is
+			 * wrapped inside of it.
+			 * */
+			if (split->row_N == 0) {
 
-						ymin = (fval < ymin) ? fval : ymin;
-						ymax = (fval > ymax) ? fval : ymax;
-					}
-					else {
-						finite = 1;
+				plotDataStatScan(pl, dN, kN, cN, st, pl->data[dN].stat[kN].fill);
+				plotDataStatMerge(split, st);
 
-						ymin = fval;
-						ymax = fval;
-					}
-				}
+				if (plotDataChunkN(pl, dN, pl->data[dN].head_N) == kN) {
 
-				id_N++;
-			}
-			while (1);
+					st = pl->data[dN].stat_head + cN + 1;
 
-			pl->rcache[xN].chunk[kN].computed = 1;
-			pl->rcache[xN].chunk[kN].finite = finite;
+					plotDataStatScan(pl, dN, kN, cN, st, pl->data[dN].stat_head_fill);
+					plotDataStatMerge(split, st);
+				}
 
-			if (finite != 0) {
+				split->row_N = 1;
 
-				pl->rcache[xN].chunk[kN].fmin = ymin;
-				pl->rcache[xN].chunk[kN].fmax = ymax;
+				plotDataStatMerge(&total, split);
 			}
 		}
 		else {
-			plotDataChunkSkip(pl, dN, &rN, &id_N);
+			plotDataStatScan(pl, dN, kN, cN, st, pl->data[dN].stat[kN].fill);
+			plotDataStatMerge(&total, st);
 		}
+	}
 
-		if (pl->rcache[xN].chunk[kN].finite != 0) {
-
-			if (started != 0) {
+	pl->rcache_wipe_data_N = -1;
+	pl->rcache_wipe_chunk_N = -1;
+	pl->rcache_append_data_N = -1;
+	pl->rcache_append_chunk_N = -1;
 
-				fmin = (pl->rcache[xN].chunk[kN].fmin < fmin)
-					? pl->rcache[xN].chunk[kN].fmin : fmin;
+	if (pmin != NULL) {
 
-				fmax = (pl->rcache[xN].chunk[kN].fmax > fmax)
-					? pl->rcache[xN].chunk[kN].fmax : fmax;
-			}
-			else {
-				started = 1;
+		*pmin = (double) total.fmin;
+	}
 
-				fmin = pl->rcache[xN].chunk[kN].fmin;
-				fmax = pl->rcache[xN].chunk[kN].fmax;
-			}
-		}
+	if (pmax != NULL) {
 
-		if (rN == pl->data[dN].tail_N)
-			break;
+		*pmax = (double) total.fmax;
 	}
-	while (1);
 
-	pl->rcache[xN].busy = 1;
-	pl->rcache[xN].data_N = dN;
-	pl->rcache[xN].column_N = cN;
-	pl->rcache[xN].cached = 1;
-	pl->rcache[xN].fmin = fmin;
-	pl->rcache[xN].fmax = fmax;
+	return (total.finite != 0) ? 1 : 0;
+}
 
-	pl->rcache_wipe_data_N = -1;
-	pl->rcache_wipe_chunk_N = -1;
+static const pstat_t *
+plotDataStatChunk(plot_t *pl, int dN, int kN, int cN)
+{
+	const pstat_t	*st;
 
-	return xN;
+	if (		pl->data[dN].stat_head != NULL
+			&& kN == pl->data[dN].stat_head_N) {
+
+		st = pl->data[dN].stat_split + cN + 1;
+	}
+	else {
+		st = pl->data[dN].stat[kN].column;
+		st = (st != NULL) ? st + cN + 1 : NULL;
+	}
+
+	return st;
+}
+
+static int
+plotMedianBefore(const double *key, int a, int b)
+{
+	/* The window is ordered by descending value and by slot number in case
+	 * of equal values that gives the same median as the sorted index.
+	 * */
+	return (key[a] > key[b] || (key[a] == key[b] && a < b)) ? 1 : 0;
 }
 
 static void
-plotDataRangeGet(plot_t *pl, int dN, int cN, double *pmin, double *pmax)
+plotMedianSet(pmheap_t *hp, int lo, int i, int slot)
 {
-	int		xN;
+	if (lo != 0) {
 
-	xN = plotDataRangeCacheFetch(pl, dN, cN);
+		hp->lo[i] = slot;
+		hp->pos[slot] = i + 1;
+	}
+	else {
+		hp->hi[i] = slot;
+		hp->pos[slot] = - (i + 1);
+	}
+}
 
-	*pmin = (double) pl->rcache[xN].fmin;
-	*pmax = (double) pl->rcache[xN].fmax;
+static int
+plotMedianAbove(const double *key, int lo, int a, int b)
+{
+	return (lo != 0) ? plotMedianBefore(key, a, b) : plotMedianBefore(key, b, a);
 }
 
 static void
-plotDataRangeCond(plot_t *pl, int dN, int cN, int cN_cond, int *pflag,
-		double scale, double offset, double *pmin, double *pmax)
+plotMedianSiftUp(pmheap_t *hp, const double *key, int lo, int i)
 {
-	const fval_t	*row;
+	int		*h = (lo != 0) ? hp->lo : hp->hi;
+	int		slot, p;
 
-	double		fval, fmin, fmax, fcond, vmin, vmax;
-	int		xN, yN, kN, rN, id_N, job, started;
+	slot = h[i];
 
-	started = *pflag;
-	fmin = *pmin;
-	fmax = *pmax;
+	while (i > 0) {
 
-	xN = plotDataRangeCacheFetch(pl, dN, cN_cond);
-	yN = plotDataRangeCacheFetch(pl, dN, cN);
+		p = (i - 1) / 2;
 
-	if (xN >= 0 && yN >= 0) {
+		if (plotMedianAbove(key, lo, slot, h[p]) == 0)
+			break;
 
-		vmin = pl->rcache[xN].fmin * scale + offset;
-		vmax = pl->rcache[xN].fmax * scale + offset;
+		plotMedianSet(hp, lo, i, h[p]);
+		i = p;
+	}
 
-		if (		   vmin >= 0. && vmin <= 1.
-				&& vmax >= 0. && vmax <= 1.) {
+	plotMedianSet(hp, lo, i, slot);
+}
 
-			if (started != 0) {
+static void
+plotMedianSiftDown(pmheap_t *hp, const double *key, int lo, int i)
+{
+	int		*h = (lo != 0) ? hp->lo : hp->hi;
+	int		N = (lo != 0) ? hp->lo_N : hp->hi_N;
+	int		slot, c;
 
-				fmin = (pl->rcache[yN].fmin < fmin)
-					? pl->rcache[yN].fmin : fmin;
+	slot = h[i];
 
-				fmax = (pl->rcache[yN].fmax > fmax)
-					? pl->rcache[yN].fmax : fmax;
-			}
-			else {
-				started = 1;
+	while (2 * i + 1 < N) {
 
-				fmin = pl->rcache[yN].fmin;
-				fmax = pl->rcache[yN].fmax;
-			}
+		c = 2 * i + 1;
 
-			*pflag = started;
-			*pmin = fmin;
-			*pmax = fmax;
+		if (		c + 1 < N
+				&& plotMedianAbove(key, lo, h[c + 1], h[c]) != 0) {
 
-			return ;
+			c = c + 1;
 		}
-	}
 
-	rN = pl->data[dN].head_N;
-	id_N = pl->data[dN].id_N;
+		if (plotMedianAbove(key, lo, h[c], slot) == 0)
+			break;
 
-	do {
-		kN = plotDataChunkN(pl, dN, rN);
-		job = 1;
+		plotMedianSet(hp, lo, i, h[c]);
+		i = c;
+	}
 
-		if (xN >= 0 && pl->rcache[xN].chunk[kN].computed != 0) {
+	plotMedianSet(hp, lo, i, slot);
+}
 
-			if (pl->rcache[xN].chunk[kN].finite != 0) {
+static void
+plotMedianPush(pmheap_t *hp, const double *key, int lo, int slot)
+{
+	int		i;
 
-				vmin = pl->rcache[xN].chunk[kN].fmin * scale + offset;
-				vmax = pl->rcache[xN].chunk[kN].fmax * scale + offset;
+	i = (lo != 0) ? hp->lo_N++ : hp->hi_N++;
 
-				if (yN >= 0	&& pl->rcache[yN].chunk[kN].computed != 0
-						&& vmin >= 0. && vmin <= 1.
-						&& vmax >= 0. && vmax <= 1.) {
+	plotMedianSet(hp, lo, i, slot);
+	plotMedianSiftUp(hp, key, lo, i);
+}
 
-					job = 0;
+static void
+plotMedianRemove(pmheap_t *hp, const double *key, int slot)
+{
+	int		*h, i, N, lo, last;
 
-					if (pl->rcache[yN].chunk[kN].finite != 0) {
+	lo = (hp->pos[slot] > 0) ? 1 : 0;
+	i = (lo != 0) ? hp->pos[slot] - 1 : - hp->pos[slot] - 1;
 
-						if (started != 0) {
+	h = (lo != 0) ? hp->lo : hp->hi;
+	N = (lo != 0) ? --hp->lo_N : --hp->hi_N;
 
-							fmin = (pl->rcache[yN].chunk[kN].fmin < fmin)
-								? pl->rcache[yN].chunk[kN].fmin : fmin;
+	hp->pos[slot] = 0;
 
-							fmax = (pl->rcache[yN].chunk[kN].fmax > fmax)
-								? pl->rcache[yN].chunk[kN].fmax : fmax;
-						}
-						else {
-							started = 1;
+	if (i < N) {
 
-							fmin = pl->rcache[yN].chunk[kN].fmin;
-							fmax = pl->rcache[yN].chunk[kN].fmax;
-						}
-					}
-				}
-				else if (vmin > 1. || vmax < 0.) {
+		/* Put the last one in place of removed and restore the heap
+		 * order in either direction.
+		 * */
+		last = h[N];
 
-					job = 0;
-				}
-			}
-			else {
-				job = 0;
-			}
-		}
+		plotMedianSet(hp, lo, i, last);
+		plotMedianSiftDown(hp, key, lo, i);
 
-		if (job != 0) {
+		i = (lo != 0) ? hp->pos[last] - 1 : - hp->pos[last] - 1;
 
-			do {
-				if (kN != plotDataChunkN(pl, dN, rN))
-					break;
+		plotMedianSiftUp(hp, key, lo, i);
+	}
+}
 
-				row = plotDataGet(pl, dN, &rN);
+static void
+plotMedianInsert(pmheap_t *hp, const double *key, int slot)
+{
+	if (		hp->lo_N > 0
+			&& plotMedianBefore(key, slot, hp->lo[0]) != 0) {
 
-				if (row == NULL)
-					break;
+		plotMedianPush(hp, key, 0, slot);
+	}
+	else {
+		plotMedianPush(hp, key, 1, slot);
+	}
+}
 
-				fval = (cN < 0) ? id_N : row[cN];
-				fcond = (cN_cond < 0) ? id_N : row[cN_cond];
+static void
+plotMedianBalance(pmheap_t *hp, const double *key)
+{
+	int		slot;
 
-				fcond = fcond * scale + offset;
+	/* Keep exactly (total / 2) values above the median.
+	 * */
+	while (hp->hi_N > (hp->lo_N + hp->hi_N) / 2) {
 
-				if (fcond >= 0. && fcond <= 1.) {
+		slot = hp->hi[0];
 
-					if (fp_isfinite(fval)) {
+		plotMedianRemove(hp, key, slot);
+		plotMedianPush(hp, key, 1, slot);
+	}
 
-						if (started != 0) {
+	while (hp->hi_N < (hp->lo_N + hp->hi_N) / 2) {
 
-							fmin = (fval < fmin) ? fval : fmin;
-							fmax = (fval > fmax) ? fval : fmax;
-						}
-						else {
-							started = 1;
+		slot = hp->lo[0];
 
-							fmin = fval;
-							fmax = fval;
-						}
-					}
-				}
+		plotMedianRemove(hp, key, slot);
+		plotMedianPush(hp, key, 0, slot);
+	}
+}
 
-				id_N++;
-			}
-			while (1);
-		}
-		else {
-			plotDataChunkSkip(pl, dN, &rN, &id_N);
-		}
+static void
+plotDataMedianFree(pmedian_t *mw)
+{
+	if (mw->fval != NULL) {
 
-		if (rN == pl->data[dN].tail_N)
-			break;
+		free(mw->fval);
 	}
-	while (1);
 
-	*pflag = started;
-	*pmin = fmin;
-	*pmax = fmax;
+	if (mw->hval.lo != NULL) {
+
+		free(mw->hval.lo);
+	}
+
+	memset(mw, 0, sizeof(pmedian_t));
 }
 
 static int
-plotDataRangeAxis(plot_t *pl, int dN, int cN, int aN, double *pmin, double *pmax)
+plotDataMedianReset(plot_t *pl, int dN, int sN)
 {
-	double		scale, offset, fmin, fmax;
-	int		xN, yN, fN, cN_cond, job, started;
+	pmedian_t	*mw = &pl->data[dN].sub[sN].window;
+	int		length, *heap;
 
-	started = 0;
+	length = pl->data[dN].sub[sN].op.median.length;
 
-	fmin = 0.;
-	fmax = 0.;
+	if (mw->size < length) {
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+		plotDataMedianFree(mw);
 
-		job = 0;
+		mw->fval = (double *) malloc(sizeof(double) * length * 2);
+		heap = (int *) malloc(sizeof(int) * length * 6);
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0
-				&& pl->figure[fN].data_N == dN) {
+		if (mw->fval == NULL || heap == NULL) {
 
-			if (		pl->figure[fN].axis_X == aN
-					&& pl->figure[fN].column_Y == cN) {
+			ERROR("No memory allocated for median window %i\n", length);
 
-				scale = 1.;
-				offset = 0.;
+			if (heap != NULL)
+				free(heap);
 
-				cN_cond = pl->figure[fN].column_X;
-				job = 1;
-			}
-			else if (	pl->figure[fN].axis_Y == aN
-					&& pl->figure[fN].column_X == cN) {
+			plotDataMedianFree(mw);
 
-				scale = 1.;
-				offset = 0.;
+			return -1;
+		}
 
-				cN_cond = pl->figure[fN].column_Y;
-				job = 1;
-			}
+		mw->fpay = mw->fval + length;
 
-			xN = pl->figure[fN].axis_X;
-			yN = pl->figure[fN].axis_Y;
+		mw->hval.lo = heap;
+		mw->hval.hi = heap + length;
+		mw->hval.pos = heap + length * 2;
 
-			if (		pl->axis[xN].slave != 0
-					&& pl->axis[xN].slave_N == aN
-					&& pl->figure[fN].column_Y == cN) {
+		mw->hpay.lo = heap + length * 3;
+		mw->hpay.hi = heap + length * 4;
+		mw->hpay.pos = heap + length * 5;
 
-				scale = pl->axis[xN].scale;
-				offset = pl->axis[xN].offset;
+		mw->size = length;
+	}
 
-				cN_cond = pl->figure[fN].column_X;
-				job = 1;
-			}
-			else if (	pl->axis[yN].slave != 0
-					&& pl->axis[yN].slave_N == aN
-					&& pl->figure[fN].column_X == cN) {
+	memset(mw->hval.pos, 0, sizeof(int) * mw->size);
+	memset(mw->hpay.pos, 0, sizeof(int) * mw->size);
 
-				scale = pl->axis[yN].scale;
-				offset = pl->axis[yN].offset;
+	mw->hval.lo_N = 0;
+	mw->hval.hi_N = 0;
+	mw->hpay.lo_N = 0;
+	mw->hpay.hi_N = 0;
 
-				cN_cond = pl->figure[fN].column_Y;
-				job = 1;
-			}
-		}
+	mw->keep = 0;
+	mw->tail = 0;
 
-		if (job != 0) {
+	return 0;
+}
 
-			scale *= pl->axis[aN].scale;
-			offset = offset * pl->axis[aN].scale + pl->axis[aN].offset;
+static tuple_t
+plotDataMedianAdd(plot_t *pl, int dN, int sN, double fval, double fpay)
+{
+	pmedian_t	*mw = &pl->data[dN].sub[sN].window;
+	int		length, opdata, tail, total;
 
-			plotDataRangeCond(pl, dN, cN, cN_cond, &started,
-					scale, offset, &fmin, &fmax);
-		}
-	}
+	tuple_t		mN = { -1, -1 };
 
-	*pmin = fmin;
-	*pmax = fmax;
+	length = pl->data[dN].sub[sN].op.median.length;
+	opdata = pl->data[dN].sub[sN].op.median.opdata;
 
-	return started;
-}
+	if (mw->size < length) {
 
-static const fval_t *
-plotDataSliceGet(plot_t *pl, int dN, int cN, double fdot, int *m_id_N)
-{
-	const fval_t	*row;
+		if (plotDataMedianReset(pl, dN, sN) != 0)
+			return mN;
+	}
 
-	double		fval, fbest, fmin, fmax, fneard;
-	int		xN, lN, rN, id_N, kN, kN_rep, best_N;
-	int		job, started, span;
+	tail = mw->tail;
 
-	xN = plotDataRangeCacheFetch(pl, dN, cN);
+	/* Drop the oldest value that is replaced.
+	 * */
+	if (mw->hval.pos[tail] != 0) {
 
-	rN = pl->data[dN].head_N;
-	id_N = pl->data[dN].id_N;
+		plotMedianRemove(&mw->hval, mw->fval, tail);
+	}
 
-	kN_rep = -1;
+	if (mw->hpay.pos[tail] != 0) {
 
-	started = 0;
-	span = 0;
+		plotMedianRemove(&mw->hpay, mw->fpay, tail);
+	}
 
-	do {
-		kN = plotDataChunkN(pl, dN, rN);
-		job = 1;
+	plotMedianBalance(&mw->hval, mw->fval);
+	plotMedianBalance(&mw->hpay, mw->fpay);
 
-		if (xN >= 0 && pl->rcache[xN].chunk[kN].computed != 0) {
+	mw->fval[tail] = fval;
+	mw->fpay[tail] = fpay;
 
-			if (pl->rcache[xN].chunk[kN].finite != 0) {
+	if (fp_isfinite(fval)) {
 
-				fmin = pl->rcache[xN].chunk[kN].fmin;
-				fmax = pl->rcache[xN].chunk[kN].fmax;
+		plotMedianInsert(&mw->hval, mw->fval, tail);
+		plotMedianBalance(&mw->hval, mw->fval);
 
-				if (fdot < fmin || fdot > fmax) {
+		if (opdata != 0 && fp_isfinite(fpay)) {
 
-					job = 0;
+			plotMedianInsert(&mw->hpay, mw->fpay, tail);
+			plotMedianBalance(&mw->hpay, mw->fpay);
+		}
+	}
 
-					fmin = fabs(fmin - fdot);
-					fmax = fabs(fmax - fdot);
+	mw->keep = (mw->keep < length - 1) ? mw->keep + 1 : length;
+	mw->tail = (tail < length - 1) ? tail + 1 : 0;
 
-					if (kN_rep >= 0) {
+	total = mw->hval.lo_N + mw->hval.hi_N;
 
-						if (fmin < fneard) {
+	if (total > 2 || (length < 3 && total > 0)) {
 
-							fneard = fmin;
-							kN_rep = kN;
-						}
+		mN.X = mw->hval.lo[0];
+		mN.Y = mN.X;
+	}
 
-						if (fmax < fneard) {
+	if (opdata != 0) {
 
-							fneard = fmax;
-							kN_rep = kN;
-						}
-					}
-					else {
-						fneard = (fmin < fmax)
-							? fmin : fmax;
+		total = mw->hpay.lo_N + mw->hpay.hi_N;
 
-						kN_rep = kN;
-					}
-				}
-			}
-			else {
-				job = 0;
-			}
+		if (total > 2 || (length < 3 && total > 0)) {
+
+			mN.Y = mw->hpay.lo[0];
 		}
+	}
 
-		if (job != 0) {
+	return mN;
+}
 
-			span++;
+static int
+plotDataMonotonic(plot_t *pl, int dN, int cN)
+{
+	int		rc = 0;
 
-			do {
-				if (kN != plotDataChunkN(pl, dN, rN))
-					break;
+	if (cN < 0) {
 
-				row = plotDataGet(pl, dN, &rN);
+		rc = 1;
+	}
+	else if (	   cN < pl->data[dN].column_N
+			&& pl->data[dN].mono != NULL) {
 
-				if (row == NULL)
-					break;
+		rc = pl->data[dN].mono[cN].monotonic;
+	}
 
-				fval = (cN < 0) ? id_N : row[cN];
+	return rc;
+}
 
-				if (fp_isfinite(fval)) {
+static double
+plotDataMonotonicValue(plot_t *pl, int dN, int cN, int iN)
+{
+	const fval_t	*row;
+	int		rN, lN;
 
-					fval = fabs(fdot - fval);
+	if (cN < 0)
+		return (double) (pl->data[dN].id_N + iN);
 
-					if (started != 0) {
+	lN = pl->data[dN].length_N;
 
-						if (fval < fbest) {
+	rN = pl->data[dN].head_N + iN;
+	rN = (rN > lN - 1) ? rN - lN : rN;
 
-							fbest = fval;
-							best_N = id_N;
-						}
-					}
-					else {
-						started = 1;
+	row = plotDataGet(pl, dN, &rN);
 
-						fbest = fval;
-						best_N = id_N;
-					}
-				}
+	return (row != NULL) ? row[cN * pl->data[dN].column_STEP] : FP_NAN;
+}
 
-				id_N++;
-			}
-			while (1);
+static int
+plotDataMonotonicFind(plot_t *pl, int dN, int cN, int ranged, double fval)
+{
+	const pstat_t	*st;
 
-			if (span >= PLOT_SLICE_SPAN)
-				break;
-		}
-		else {
-			plotDataChunkSkip(pl, dN, &rN, &id_N);
-		}
+	double		fmin, fmax;
+	int		N, lN, rN, iN, kN, bN, hN_kN, lo, hi, split;
 
-		if (rN == pl->data[dN].tail_N)
-			break;
-	}
-	while (1);
+	lN = pl->data[dN].length_N;
 
-	if (		started == 0
-			&& kN_rep >= 0) {
+	lo = 0;
+	hi = plotDataLength(pl, dN);
+
+	/* The head chunk keeps both the oldest and the newest rows if the
+	 * ring buffer is wrapped inside of it.
+	 * */
+	hN_kN = plotDataChunkN(pl, dN, pl->data[dN].head_N);
+	split = (	   pl->data[dN].tail_N < pl->data[dN].head_N
+			&& plotDataChunkN(pl, dN, pl->data[dN].tail_N) == hN_kN) ? 1 : 0;
+
+	if (ranged != 0) {
 
 		rN = pl->data[dN].head_N;
-		id_N = pl->data[dN].id_N;
+		iN = 0;
+
+		/* Use the chunk ranges as sparse index so we have to fetch
+		 * only the chunk that contains the row.
+		 * */
+		while (iN < hi) {
 
-		do {
 			kN = plotDataChunkN(pl, dN, rN);
-			job = 1;
 
-			if (kN == kN_rep) {
+			bN = pl->data[dN].chunk_MASK + 1 - (rN & pl->data[dN].chunk_MASK);
+			bN = (bN > lN - rN) ? lN - rN : bN;
+			bN = (bN > hi - iN) ? hi - iN : bN;
 
-				do {
-					if (kN != plotDataChunkN(pl, dN, rN))
-						break;
+			st = plotDataStatChunk(pl, dN, kN, cN);
 
-					row = plotDataGet(pl, dN, &rN);
-
-					if (row == NULL)
-						break;
-
-					fval = (cN < 0) ? id_N : row[cN];
-
-					if (fp_isfinite(fval)) {
-
-						fval = fabs(fdot - fval);
-
-						if (started != 0) {
-
-							if (fval < fbest) {
+			if (		st != NULL && st->finite != 0
+					&& (split == 0 || kN != hN_kN)) {
 
-								fbest = fval;
-								best_N = id_N;
-							}
-						}
-						else {
-							started = 1;
+				fmin = st->fmin;
+				fmax = st->fmax;
 
-							fbest = fval;
-							best_N = id_N;
-						}
-					}
+				if (fmax < fval) {
 
-					id_N++;
+					lo = iN + bN;
+				}
+				else {
+					hi = (fmin < fval) ? iN + bN : iN;
+					break;
 				}
-				while (1);
-			}
-			else {
-				plotDataChunkSkip(pl, dN, &rN, &id_N);
 			}
 
-			if (rN == pl->data[dN].tail_N)
-				break;
+			rN = (rN + bN < lN) ? rN + bN : 0;
+			iN += bN;
 		}
-		while (1);
 	}
 
-	if (started != 0) {
-
-		*m_id_N = best_N;
+	while (lo < hi) {
 
-		lN = pl->data[dN].length_N;
+		N = lo + (hi - lo) / 2;
 
-		rN = pl->data[dN].head_N + (best_N - pl->data[dN].id_N);
-		rN = (rN > lN - 1) ? rN - lN : rN;
+		if (plotDataMonotonicValue(pl, dN, cN, N) < fval) {
 
-		row = plotDataGet(pl, dN, &rN);
-	}
-	else {
-		row = NULL;
+			lo = N + 1;
+		}
+		else {
+			hi = N;
+		}
 	}
 
-	return row;
+	return lo;
 }
 
-static const fval_t *
-plotDataPickGet(plot_t *pl, int dN, int cNX, int cNY,
-		double fdot_X, double fdot_Y,
-		double tol_X, double tol_Y, int *m_id_N)
+static void
+plotDataResample(plot_t *pl, int dN, int cNX, int cNY, int in_dN, int in_cNX, int in_cNY)
 {
-	const fval_t	*row;
-
-	double		fval_X, fval_Y, fbest, fmin, fmax;
-	int		xNX, xNY, lN, rN, id_N, kN, best_N;
-	int		job, started, span;
+	fval_t		*row, X, Y, X2, Y2, prev_X2, prev_Y2, Qf;
+	const fval_t	*prey;
 
-	xNX = plotDataRangeCacheFetch(pl, dN, cNX);
-	xNY = plotDataRangeCacheFetch(pl, dN, cNY);
+	int		N, rN, id_N, rN2, id_N2, cSTEP, pSTEP;
 
 	rN = pl->data[dN].head_N;
 	id_N = pl->data[dN].id_N;
 
-	started = 0;
-	span = 0;
+	rN2 = pl->data[in_dN].head_N;
+	id_N2 = pl->data[in_dN].id_N;
 
-	do {
-		kN = plotDataChunkN(pl, dN, rN);
-		job = 1;
+	cSTEP = pl->data[dN].column_STEP;
+	pSTEP = pl->data[in_dN].column_STEP;
 
-		if (xNX >= 0 && pl->rcache[xNX].chunk[kN].computed != 0) {
+	if (plotDataMonotonic(pl, in_dN, in_cNX) != 0) {
 
-			if (pl->rcache[xNX].chunk[kN].finite != 0) {
+		row = (fval_t *) plotDataGet(pl, dN, &rN);
 
-				fmin = pl->rcache[xNX].chunk[kN].fmin;
-				fmax = pl->rcache[xNX].chunk[kN].fmax;
+		rN = pl->data[dN].head_N;
 
-				if (		   fdot_X < fmin - tol_X
-						|| fdot_X > fmax + tol_X) {
+		if (row != NULL) {
 
-					job = 0;
-				}
-			}
-			else {
-				job = 0;
+			X = (cNX < 0) ? id_N : row[cNX * cSTEP];
+
+			/* Skip the input rows before the first one although keep
+			 * the previous row for interpolation.
+			 * */
+			if (fp_isfinite(X)) {
+
+				N = plotDataMonotonicFind(pl, in_dN, in_cNX, 0, X);
+
+				plotDataSkip(pl, in_dN, &rN2, &id_N2, N - 1);
 			}
 		}
+	}
 
-		if (xNY >= 0 && pl->rcache[xNY].chunk[kN].computed != 0) {
+	do {
+		prey = plotDataGet(pl, in_dN, &rN2);
 
-			if (pl->rcache[xNY].chunk[kN].finite != 0) {
+		if (prey == NULL)
+			break;
 
-				fmin = pl->rcache[xNY].chunk[kN].fmin;
-				fmax = pl->rcache[xNY].chunk[kN].fmax;
+		X2 = (in_cNX < 0) ? id_N2 : prey[in_cNX * pSTEP];
+		Y2 = (in_cNY < 0) ? id_N2 : prey[in_cNY * pSTEP];
 
-				if (		   fdot_Y < fmin - tol_Y
-						|| fdot_Y > fmax + tol_Y) {
+		id_N2++;
 
-					job = 0;
-				}
-			}
-			else {
-				job = 0;
-			}
-		}
+		if (fp_isfinite(X2))
+			break;
+	}
+	while (1);
 
-		if (job != 0) {
+	if (id_N2 != pl->data[in_dN].id_N) {
 
-			span++;
+		prev_X2 = X2;
+		prev_Y2 = Y2;
+	}
+	else {
+		ERROR("No data to resample in dataset %i column %i\n", in_dN, in_cNX);
+		return ;
+	}
 
-			do {
-				if (kN != plotDataChunkN(pl, dN, rN))
-					break;
+	do {
+		row = plotDataWrite(pl, dN, &rN);
 
-				row = plotDataGet(pl, dN, &rN);
+		if (row == NULL)
+			break;
 
-				if (row == NULL)
+		X = (cNX < 0) ? id_N : row[cNX * cSTEP];
+
+		if (fp_isfinite(X)) {
+
+			do {
+				if (X2 >= X)
 					break;
 
-				fval_X = (cNX < 0) ? id_N : row[cNX];
-				fval_Y = (cNY < 0) ? id_N : row[cNY];
+				prey = plotDataGet(pl, in_dN, &rN2);
 
-				if (		   fp_isfinite(fval_X)
-						&& fp_isfinite(fval_Y)) {
+				if (prey == NULL)
+					break;
 
-					fval_X = fabs(fdot_X - fval_X);
-					fval_Y = fabs(fdot_Y - fval_Y);
+				if (fp_isfinite(X2)) {
 
-					if (		   fval_X < tol_X
-							&& fval_Y < tol_Y) {
+					prev_X2 = X2;
+					prev_Y2 = Y2;
+				}
 
-						fval_X /= tol_X;
-						fval_Y /= tol_Y;
+				X2 = (in_cNX < 0) ? id_N2 : prey[in_cNX * pSTEP];
+				Y2 = (in_cNY < 0) ? id_N2 : prey[in_cNY * pSTEP];
 
-						fval_X =  fval_X * fval_X
-							+ fval_Y * fval_Y;
+				id_N2++;
+			}
+			while (1);
 
-						if (started != 0) {
+			if (prev_X2 + (fval_t) pl->defungap > X2) {
 
-							if (fval_X < fbest) {
+				if (		pl->interpolation != 0
+						&& X2 >= X) {
 
-								fbest = fval_X;
-								best_N = id_N;
-							}
-						}
-						else {
-							started = 1;
+					if (		prev_X2 <= X
+							&& prev_X2 < X2) {
 
-							fbest = fval_X;
-							best_N = id_N;
-						}
+						Qf = (X - prev_X2) / (X2 - prev_X2);
+						Y = prev_Y2 + (Y2 - prev_Y2) * Qf;
+					}
+					else {
+						Y = prev_Y2;
 					}
 				}
-
-				id_N++;
+				else {
+					Y = Y2;
+				}
+			}
+			else {
+				Y = FP_NAN;
 			}
-			while (1);
-
-			if (span >= PLOT_SLICE_SPAN)
-				break;
 		}
 		else {
-			plotDataChunkSkip(pl, dN, &rN, &id_N);
+			Y = FP_NAN;
 		}
 
-		if (rN == pl->data[dN].tail_N)
-			break;
+		row[cNY * cSTEP] = Y;
+
+		id_N++;
 	}
 	while (1);
+}
 
-	if (started != 0) {
-
-		*m_id_N = best_N;
+static void
+plotDataPolyfitJob(ppolyfit_t *pf)
+{
+	plot_t		*pl = (plot_t *) pf->pl;
+	const fval_t	*row;
 
-		lN = pl->data[dN].length_N;
+	double		fval_X, fval_Y, fvec[LSE_FULL_MAX];
+	int		N, N0, N1, dN, cNX, cNY, jN, id_N, rSTEP, cSTEP;
 
-		rN = pl->data[dN].head_N + (best_N - pl->data[dN].id_N);
-		rN = (rN > lN - 1) ? rN - lN : rN;
+	dN = pf->data_N;
+	cNX = pf->column_X;
+	cNY = pf->column_Y;
 
-		row = plotDataGet(pl, dN, &rN);
-	}
-	else {
-		row = NULL;
-	}
+	N0 = pf->poly_N0;
+	N1 = pf->poly_N1;
 
-	return row;
-}
+	lse_construct(&pf->lsq, LSE_CASCADE_MAX, N1 - N0 + 1, 1);
 
-static void
-plotDataErase(plot_t *pl, int dN, int cNX, int cNY,
-		double fmin_X, double fmin_Y,
-		double fmax_X, double fmax_Y)
-{
-	fval_t		*row;
+	pf->clip_N = 0;
+	pf->finite = 0;
 
-	double		fval_X, fval_Y, fmin, fmax;
-	int		xNX, xNY, rN, id_N, kN, job;
+	row = pl->data[dN].raw[pf->chunk_N];
 
-	xNX = plotDataRangeCacheFetch(pl, dN, cNX);
-	xNY = plotDataRangeCacheFetch(pl, dN, cNY);
+	if (row == NULL)
+		return ;
 
-	rN = pl->data[dN].head_N;
-	id_N = pl->data[dN].id_N;
+	rSTEP = pl->data[dN].row_STEP;
+	cSTEP = pl->data[dN].column_STEP;
 
-	do {
-		kN = plotDataChunkN(pl, dN, rN);
-		job = 1;
+	row += rSTEP * pf->row_N;
+	id_N = pf->id_N;
 
-		if (xNX >= 0 && pl->rcache[xNX].chunk[kN].computed != 0) {
+	for (jN = 0; jN < pf->length; ++jN, row += rSTEP) {
 
-			if (pl->rcache[xNX].chunk[kN].finite != 0) {
+		fval_X = (cNX < 0) ? id_N : row[cNX * cSTEP];
+		fval_Y = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-				fmin = pl->rcache[xNX].chunk[kN].fmin;
-				fmax = pl->rcache[xNX].chunk[kN].fmax;
+		if (fp_isfinite(fval_X) && fp_isfinite(fval_Y)) {
 
-				if (		   fmax_X < fmin
-						|| fmin_X > fmax) {
+			if (pf->finite != 0) {
 
-					job = 0;
-				}
+				pf->fmin_X = (fval_X < pf->fmin_X) ? fval_X : pf->fmin_X;
+				pf->fmax_X = (fval_X > pf->fmax_X) ? fval_X : pf->fmax_X;
+				pf->fmin_Y = (fval_Y < pf->fmin_Y) ? fval_Y : pf->fmin_Y;
+				pf->fmax_Y = (fval_Y > pf->fmax_Y) ? fval_Y : pf->fmax_Y;
 			}
 			else {
-				job = 0;
+				pf->fmin_X = fval_X;
+				pf->fmax_X = fval_X;
+				pf->fmin_Y = fval_Y;
+				pf->fmax_Y = fval_Y;
+
+				pf->finite = 1;
 			}
-		}
 
-		if (xNY >= 0 && pl->rcache[xNY].chunk[kN].computed != 0) {
+			fvec[0] = fval_X * pf->scale_X + pf->offset_X;
+			fvec[1] = fval_Y * pf->scale_Y + pf->offset_Y;
 
-			if (pl->rcache[xNY].chunk[kN].finite != 0) {
+			if (		   fvec[0] >= 0. && fvec[0] <= 1.
+					&& fvec[1] >= 0. && fvec[1] <= 1.) {
 
-				fmin = pl->rcache[xNY].chunk[kN].fmin;
-				fmax = pl->rcache[xNY].chunk[kN].fmax;
+				fvec[0] = 1.;
 
-				if (		   fmax_Y < fmin
-						|| fmin_Y > fmax) {
+				for (N = 0; N < N1; ++N)
+					fvec[N + 1] = fvec[N] * fval_X;
 
-					job = 0;
-				}
+				for (N = 0; N < N1 - N0 + 1; ++N)
+					fvec[N] = fvec[N + N0];
+
+				fvec[N1 - N0 + 1] = fval_Y;
+
+				lse_insert(&pf->lsq, fvec);
 			}
 			else {
-				job = 0;
+				pf->clip_N++;
 			}
 		}
 
-		if (job != 0) {
+		id_N++;
+	}
 
-			do {
-				if (kN != plotDataChunkN(pl, dN, rN))
-					break;
+	pf->computed = 1;
+}
 
-				row = plotDataWrite(pl, dN, &rN);
+static int
+plotDataPolyfitInside(const ppolyfit_t *pf,
+		double scale_X, double offset_X,
+		double scale_Y, double offset_Y)
+{
+	double		fmin, fmax;
 
-				if (row == NULL)
-					break;
+	if (pf->clip_N != 0)
+		return 0;
 
-				fval_X = (cNX < 0) ? id_N : row[cNX];
-				fval_Y = (cNY < 0) ? id_N : row[cNY];
+	if (pf->finite == 0)
+		return 1;
 
-				if (		   fp_isfinite(fval_X)
-						&& fp_isfinite(fval_Y)) {
+	fmin = pf->fmin_X * scale_X + offset_X;
+	fmax = pf->fmax_X * scale_X + offset_X;
 
-					if (		   fval_X > fmin_X && fval_X < fmax_X
-							&& fval_Y > fmin_Y && fval_Y < fmax_Y) {
+	if (fmin < 0. || fmin > 1. || fmax < 0. || fmax > 1.)
+		return 0;
 
-						row[cNX] = FP_NAN;
-						row[cNY] = FP_NAN;
-					}
-				}
+	fmin = pf->fmin_Y * scale_Y + offset_Y;
+	fmax = pf->fmax_Y * scale_Y + offset_Y;
 
-				id_N++;
-			}
-			while (1);
-		}
-		else {
-			plotDataChunkSkip(pl, dN, &rN, &id_N);
-		}
+	if (fmin < 0. || fmin > 1. || fmax < 0. || fmax > 1.)
+		return 0;
 
-		if (rN == pl->data[dN].tail_N)
-			break;
-	}
-	while (1);
+	return 1;
 }
 
 static int
-plotDataCompareMatch(plot_t *pl, int dN, int cN1, int cN2)
+plotDataPolyfitTable(plot_t *pl, int kMAX)
 {
-	const fval_t	*row;
+	ppolyfit_t	**polyfit, **list;
 
-	double		X, Y;
-	int		N, rN, id_N;
+	if (kMAX <= pl->polyfit_MAX)
+		return 1;
 
-	rN = pl->data[dN].head_N;
-	id_N = pl->data[dN].id_N;
+	polyfit = (ppolyfit_t **) realloc(pl->polyfit, sizeof(ppolyfit_t *) * kMAX);
 
-	N = 0;
+	if (polyfit != NULL)
+		pl->polyfit = polyfit;
 
-	do {
-		row = plotDataGet(pl, dN, &rN);
+	list = (ppolyfit_t **) realloc(pl->polyfit_list, sizeof(ppolyfit_t *) * kMAX);
 
-		if (row == NULL)
-			break;
+	if (list != NULL)
+		pl->polyfit_list = list;
 
-		X = (cN1 < 0) ? id_N : row[cN1];
-		Y = (cN2 < 0) ? id_N : row[cN2];
+	if (polyfit == NULL || list == NULL) {
 
-		if (fp_isfinite(X)) {
+		ERROR("No memory allocated for polyfit table\n");
+		return 0;
+	}
 
-			if (fp_isfinite(Y)) {
+	memset(pl->polyfit + pl->polyfit_MAX, 0, sizeof(ppolyfit_t *)
+			* (kMAX - pl->polyfit_MAX));
 
-				if (X != Y) {
+	pl->polyfit_MAX = kMAX;
 
-					N++;
-				}
-			}
-			else {
-				N++;
-			}
-		}
-		else {
-			if (fp_isfinite(Y)) {
+	return 1;
+}
 
-				N++;
-			}
-		}
+static void
+plotDataPolyfit(plot_t *pl, int dN, int cNX, int cNY,
+		double scale_X, double offset_X,
+		double scale_Y, double offset_Y, int N0, int N1)
+{
+	ppolyfit_t	*pf, **list;
+	const pstat_t	*st_X, *st_Y;
 
-		if (N >= 1)
-			break;
+	double		fmin, fmax;
+	int		N, kN, pN, rN, id_N, lN, bN, job, list_N, serial;
 
-		id_N++;
-	}
-	while (1);
+	lse_construct(&pl->lsq, LSE_CASCADE_MAX, N1 - N0 + 1, 1);
 
-	return N;
-}
+	if (plotDataPolyfitTable(pl, pl->data[dN].chunk_MAX + 1) == 0)
+		return ;
 
+	list = pl->polyfit_list;
 
-void plotAxisLabel(plot_t *pl, int aN, const char *label)
-{
-	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+	plotDataStatFetch(pl, dN, cNX, NULL, NULL);
+	plotDataStatFetch(pl, dN, cNY, NULL, NULL);
 
-		ERROR("Axis number is out of range\n");
-		return ;
-	}
+	rN = pl->data[dN].head_N;
+	id_N = pl->data[dN].id_N;
 
-	if (label[0] != 0) {
+	lN = pl->data[dN].length_N;
 
-		strcpy(pl->axis[aN].label, label);
+	/* Compressed chunks are fetched one by one so we fit them in place.
+	 * */
+	serial = (	   pl->data[dN].lz4_compress != 0
+			|| pl->pool == NULL
+			|| pl->pool->thread_N < 1) ? 1 : 0;
 
-		pl->axis[aN].compact = (strlen(pl->axis[aN].label) >= 4) ? 0 : 1;
-	}
-}
+	list_N = 0;
 
-int plotAxisRangeGet(plot_t *pl, int aN, double *pmin, double *pmax)
-{
-	double		min, max, fmin, fmax, scale, offset;
-	int		fN, dN, cN, xN, yN, started = 0;
+	while (rN != pl->data[dN].tail_N) {
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+		kN = plotDataChunkN(pl, dN, rN);
+		job = 1;
 
-		if (pl->figure[fN].busy != 0 && pl->figure[fN].hidden == 0) {
+		st_X = plotDataStatChunk(pl, dN, kN, cNX);
+		st_Y = plotDataStatChunk(pl, dN, kN, cNY);
 
-			dN = pl->figure[fN].data_N;
+		if (st_X != NULL) {
 
-			do {
-				if (pl->figure[fN].axis_X == aN) {
+			if (st_X->finite != 0) {
 
-					cN = pl->figure[fN].column_X;
-				}
-				else if (pl->figure[fN].axis_Y == aN) {
+				fmin = st_X->fmin * scale_X + offset_X;
+				fmax = st_X->fmax * scale_X + offset_X;
 
-					cN = pl->figure[fN].column_Y;
+				if (fmin > 1. || fmax < 0.) {
+
+					job = 0;
 				}
-				else
-					break;
+			}
+			else {
+				job = 0;
+			}
+		}
 
-				plotDataRangeGet(pl, dN, cN, &min, &max);
+		if (st_Y != NULL) {
 
-				if (started != 0) {
+			if (st_Y->finite != 0) {
 
-					fmin = (min < fmin) ? min : fmin;
-					fmax = (max > fmax) ? max : fmax;
-				}
-				else {
-					started = 1;
+				fmin = st_Y->fmin * scale_Y + offset_Y;
+				fmax = st_Y->fmax * scale_Y + offset_Y;
 
-					fmin = min;
-					fmax = max;
+				if (fmin > 1. || fmax < 0.) {
+
+					job = 0;
 				}
 			}
-			while (0);
+			else {
+				job = 0;
+			}
+		}
 
-			do {
-				xN = pl->figure[fN].axis_X;
-				yN = pl->figure[fN].axis_Y;
+		/* Take the rest of chunk but do not go across the end of ring
+		 * buffer.
+		 * */
+		bN = pl->data[dN].chunk_MASK + 1 - (rN & pl->data[dN].chunk_MASK);
+		bN = (bN > lN - rN) ? lN - rN : bN;
 
-				if (		pl->axis[xN].slave != 0
-						&& pl->axis[xN].slave_N == aN) {
+		N = pl->data[dN].tail_N - rN;
+		bN = (N > 0 && N < bN) ? N : bN;
 
-					cN = pl->figure[fN].column_X;
+		if (job != 0) {
 
-					scale = pl->axis[xN].scale;
-					offset = pl->axis[xN].offset;
-				}
-				else if (	pl->axis[yN].slave != 0
-						&& pl->axis[yN].slave_N == aN) {
+			pN = (		kN == plotDataChunkN(pl, dN, pl->data[dN].head_N)
+					&& rN < pl->data[dN].head_N) ? 0 : kN + 1;
 
-					cN = pl->figure[fN].column_Y;
+			pf = pl->polyfit[pN];
 
-					scale = pl->axis[yN].scale;
-					offset = pl->axis[yN].offset;
-				}
-				else
-					break;
+			if (pf == NULL) {
 
-				plotDataRangeGet(pl, dN, cN, &min, &max);
+				pf = (ppolyfit_t *) calloc(1, sizeof(ppolyfit_t));
 
-				min = min * scale + offset;
-				max = max * scale + offset;
+				if (pf == NULL) {
 
-				if (started != 0) {
+					ERROR("No memory allocated for polyfit\n");
+					break;
+				}
 
-					fmin = (min < fmin) ? min : fmin;
-					fmax = (max > fmax) ? max : fmax;
+				pl->polyfit[pN] = pf;
+			}
+
+			/* Reuse the partial factorization that was computed from
+			 * the same rows if the window still contains all of them.
+			 * */
+			if (		pf->computed == 0
+					|| pf->data_N != dN
+					|| pf->chunk_N != kN
+					|| pf->row_N != (rN & pl->data[dN].chunk_MASK)
+					|| pf->length != bN
+					|| pf->id_N != id_N
+					|| pf->column_X != cNX
+					|| pf->column_Y != cNY
+					|| pf->poly_N0 != N0
+					|| pf->poly_N1 != N1
+					|| ((	   pf->scale_X != scale_X
+						|| pf->offset_X != offset_X
+						|| pf->scale_Y != scale_Y
+						|| pf->offset_Y != offset_Y)
+						&& plotDataPolyfitInside(pf, scale_X, offset_X,
+							scale_Y, offset_Y) == 0)) {
+
+				pf->pl = pl;
+				pf->computed = 0;
+
+				pf->data_N = dN;
+				pf->chunk_N = kN;
+				pf->row_N = rN & pl->data[dN].chunk_MASK;
+				pf->length = bN;
+				pf->id_N = id_N;
+
+				pf->column_X = cNX;
+				pf->column_Y = cNY;
+				pf->poly_N0 = N0;
+				pf->poly_N1 = N1;
+
+				pf->scale_X = scale_X;
+				pf->offset_X = offset_X;
+				pf->scale_Y = scale_Y;
+				pf->offset_Y = offset_Y;
+
+				if (serial != 0) {
+
+					if (pl->data[dN].lz4_compress != 0) {
+
+						plotDataChunkFetch(pl, dN, kN);
+					}
+
+					plotDataPolyfitJob(pf);
 				}
 				else {
-					started = 1;
-
-					fmin = min;
-					fmax = max;
+					poolSubmit(pl->pool, &pf->task, (void (*) (void *))
+							&plotDataPolyfitJob, pf);
 				}
 			}
-			while (0);
+
+			list[list_N++] = pf;
 		}
+
+		rN = (rN + bN < lN) ? rN + bN : 0;
+		id_N += bN;
 	}
 
-	*pmin = fmin;
-	*pmax = fmax;
+	/* Merge partial factorizations in order of rows so the result does
+	 * not depend on the number of threads.
+	 * */
+	for (N = 0; N < list_N; ++N) {
 
-	return started;
+		poolWait(pl->pool, &list[N]->task);
+		lse_merge(&pl->lsq, &list[N]->lsq);
+	}
+
+	/* Chunks that are changed after this should be wiped again to drop
+	 * the partial factorizations.
+	 * */
+	pl->rcache_wipe_data_N = -1;
+	pl->rcache_wipe_chunk_N = -1;
+	pl->rcache_append_data_N = -1;
+	pl->rcache_append_chunk_N = -1;
+
+	lse_solve(&pl->lsq);
+	lse_std(&pl->lsq);
 }
 
 static int
-plotAxisRangeCond(plot_t *pl, int aN, int bN, double *pmin, double *pmax)
+plotExportNumber(char *text, double fval, int fprecision)
 {
-	double		min, max, fmin, fmax, scale, offset;
-	int		fN, dN, cN, xN, yN, nN, started, cond;
+	const double	pow10[] = { 1E+0, 1E+1, 1E+2, 1E+3, 1E+4, 1E+5, 1E+6,
+		1E+7, 1E+8, 1E+9, 1E+10, 1E+11, 1E+12, 1E+13, 1E+14, 1E+15, 1E+16 };
 
-	started = 0;
+	char		dbuf[40];
+	double		fint, frac;
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	unsigned long long	ival;
+	int			N, fexp = 1, len = 0;
 
-		if (pl->figure[fN].busy != 0 && pl->figure[fN].hidden == 0) {
+	if (fval != 0.) {
 
-			dN = pl->figure[fN].data_N;
+		fexp += (int) floor(log10(fabs(fval)));
+	}
 
-			do {
-				if (pl->figure[fN].axis_X == aN) {
+	if (fexp >= -2 && fexp < fprecision) {
 
-					cN = pl->figure[fN].column_X;
-					nN = pl->figure[fN].axis_Y;
-				}
-				else if (pl->figure[fN].axis_Y == aN) {
+		fexp = (fexp < 1) ? 1 : fexp;
+		fexp = fprecision - fexp;
 
-					cN = pl->figure[fN].column_Y;
-					nN = pl->figure[fN].axis_X;
+		fint = fabs(fval) * pow10[fexp];
+
+		/* Print the rounded integer digits directly unless it is too
+		 * close to the halfway case to be sure of rounding.
+		 * */
+		if (fint < 1E+13) {
+
+			frac = fint - floor(fint);
+
+			if (fabs(frac - .5) > 1. / 256.) {
+
+				ival = (unsigned long long) fint + ((frac > .5) ? 1 : 0);
+
+				if (signbit(fval) != 0) {
+
+					text[len++] = '-';
 				}
-				else
-					break;
 
-				if (bN >= 0) {
+				N = 0;
 
-					cond = plotDataRangeAxis(pl, dN, cN, bN, &min, &max);
+				do {
+					dbuf[N++] = '0' + (int) (ival % 10U);
+					ival /= 10U;
 				}
-				else {
-					cond = plotDataRangeAxis(pl, dN, cN, nN, &min, &max);
+				while (ival != 0U || N < fexp + 1);
+
+				while (N > fexp) {
+
+					text[len++] = dbuf[--N];
 				}
 
-				if (cond != 0) {
+				if (fexp > 0) {
 
-					if (started != 0) {
+					text[len++] = '.';
 
-						fmin = (min < fmin) ? min : fmin;
-						fmax = (max > fmax) ? max : fmax;
-					}
-					else {
-						started = 1;
+					while (N > 0) {
 
-						fmin = min;
-						fmax = max;
+						text[len++] = dbuf[--N];
 					}
 				}
+
+				return len;
 			}
-			while (0);
+		}
 
-			do {
-				xN = pl->figure[fN].axis_X;
-				yN = pl->figure[fN].axis_Y;
+		len = sprintf(text, "%.*f", fexp, fval);
+	}
+	else {
+		len = sprintf(text, "%.*E", fprecision - 1, fval);
+	}
 
-				if (		pl->axis[xN].slave != 0
-						&& pl->axis[xN].slave_N == aN) {
+	return len;
+}
 
-					cN = pl->figure[fN].column_X;
-					nN = pl->figure[fN].axis_Y;
+static void
+plotExportFormat(pexjob_t *jb)
+{
+	const pexport_t	*ex = (const pexport_t *) jb->ex;
 
-					scale = pl->axis[xN].scale;
-					offset = pl->axis[xN].offset;
-				}
-				else if (	pl->axis[yN].slave != 0
-						&& pl->axis[yN].slave_N == aN) {
+	const double	*fval = jb->fval;
+	char		*text = jb->text;
 
-					cN = pl->figure[fN].column_Y;
-					nN = pl->figure[fN].axis_X;
+	int		N, rN;
 
-					scale = pl->axis[yN].scale;
-					offset = pl->axis[yN].offset;
-				}
-				else
-					break;
+	if (ex->format == EXPORT_CSV) {
 
+		for (rN = 0; rN < jb->row_N; ++rN) {
 
-				if (bN >= 0) {
+			for (N = 0; N < ex->len_N; ++N) {
 
-					cond = plotDataRangeAxis(pl, dN, cN, bN, &min, &max);
+				if (fp_isfinite(fval[N]) == 0) {
+
+					text[0] = 'N';
+					text[1] = 'a';
+					text[2] = 'N';
+
+					text += 3;
+				}
+				else if (	   ex->list_hint[N] == DATA_HINT_HEX
+						&& fval[N] >= 0. && fval[N] < 18446744073709551616.) {
+
+					text += sprintf(text, "0x%08llX", (unsigned long long) fval[N]);
+				}
+				else if (	   ex->list_hint[N] == DATA_HINT_OCT
+						&& fval[N] >= 0. && fval[N] < 18446744073709551616.) {
+
+					text += sprintf(text, "%011llo", (unsigned long long) fval[N]);
 				}
 				else {
-					cond = plotDataRangeAxis(pl, dN, cN, nN, &min, &max);
+					text += plotExportNumber(text, fval[N], ex->fprecision);
 				}
 
-				if (cond != 0) {
+				*text++ = (char) ex->space;
+			}
 
-					min = min * scale + offset;
-					max = max * scale + offset;
+			*text++ = '\n';
 
-					if (started != 0) {
+			fval += ex->len_N;
+		}
+	}
+	else if (ex->format == EXPORT_FP32) {
 
-						fmin = (min < fmin) ? min : fmin;
-						fmax = (max > fmax) ? max : fmax;
-					}
-					else {
-						started = 1;
+		float		*fp32 = (float *) text;
 
-						fmin = min;
-						fmax = max;
-					}
-				}
-			}
-			while (0);
+		for (N = 0; N < jb->row_N * ex->len_N; ++N) {
+
+			fp32[N] = (float) fval[N];
 		}
+
+		text += sizeof(float) * jb->row_N * ex->len_N;
 	}
+	else {
+		memcpy(text, fval, sizeof(double) * jb->row_N * ex->len_N);
 
-	*pmin = fmin;
-	*pmax = fmax;
+		text += sizeof(double) * jb->row_N * ex->len_N;
+	}
 
-	return started;
+	jb->text_N = (int) (text - jb->text);
 }
 
-void plotAxisScaleManual(plot_t *pl, int aN, double min, double max)
+static void
+plotExportGather(plot_t *pl, pexport_t *ex, pexjob_t *jb)
 {
-	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+	const fval_t	*row[PLOT_DATASET_MAX];
 
-		ERROR("Axis number is out of range\n");
-		return ;
-	}
+	double		*fval = jb->fval;
+	int		N, dN, cN, finite;
 
-	if (pl->axis[aN].busy == AXIS_FREE)
-		return ;
+	jb->row_N = 0;
 
-	if (pl->axis[aN].slave != 0)
-		return ;
+	while (		jb->row_N < PLOT_EXPORT_ROWS
+			&& ex->done_N < ex->total_N) {
 
-	pl->axis[aN].scale = 1. / (max - min);
-	pl->axis[aN].offset = - min / (max - min);
-}
+		for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-void plotAxisScaleAuto(plot_t *pl, int aN)
-{
-	double		fmin, fmax;
+			row[dN] = NULL;
 
-	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+			if (		ex->local[dN].busy != 0
+					&& ex->local[dN].row_N > 0) {
 
-		ERROR("Axis number is out of range\n");
-		return ;
-	}
+				row[dN] = plotDataGet(pl, dN, &ex->local[dN].rN);
 
-	if (pl->axis[aN].busy == AXIS_FREE)
-		return ;
+				ex->local[dN].row_N--;
+			}
+		}
 
-	if (pl->axis[aN].slave != 0)
-		return ;
+		finite = 0;
 
-	if (plotAxisRangeGet(pl, aN, &fmin, &fmax) != 0) {
+		for (N = 0; N < ex->len_N; ++N) {
 
-		if (fmin == fmax) {
+			dN = ex->list_dN[N];
+			cN = ex->list_cN[N];
 
-			fmin += (double) - 1.;
-			fmax += (double) + 1.;
-		}
+			if (row[dN] != NULL) {
 
-		plotAxisScaleManual(pl, aN, fmin, fmax);
+				fval[N] = (cN < 0) ? ex->local[dN].id_N
+					: row[dN][cN * pl->data[dN].column_STEP];
 
-		if (pl->axis[aN].busy == AXIS_BUSY_X) {
+				finite += fp_isfinite(fval[N]) ? 1 : 0;
+			}
+			else {
+				fval[N] = FP_NAN;
+			}
+		}
 
-			fmin = plotAxisConvBackward(pl, aN, pl->viewport.min_x - pl->layout_mark_size);
-			fmax = plotAxisConvBackward(pl, aN, pl->viewport.max_x + pl->layout_mark_size);
+		/* Skip the row that has no finite values at all.
+		 * */
+		if (finite != 0) {
 
-			plotAxisScaleManual(pl, aN, fmin, fmax);
+			fval += ex->len_N;
+			jb->row_N++;
 		}
-		else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
 
-			fmin = plotAxisConvBackward(pl, aN, pl->viewport.max_y + pl->layout_mark_size);
-			fmax = plotAxisConvBackward(pl, aN, pl->viewport.min_y - pl->layout_mark_size);
+		for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-			plotAxisScaleManual(pl, aN, fmin, fmax);
+			if (row[dN] != NULL)
+				ex->local[dN].id_N++;
 		}
 
-		pl->axis[aN].lock_scale = LOCK_AUTO;
-		pl->axis[aN].lock_tick = 0;
+		ex->done_N++;
 	}
 }
 
-void plotAxisScaleAutoCond(plot_t *pl, int aN, int bN)
+static void
+plotExportWrite(pexport_t *ex, const char *text, int len)
 {
-	double		fmin, fmax;
-
-	if (aN < 0 || aN >= PLOT_AXES_MAX) {
-
-		ERROR("Axis number is out of range\n");
-		return ;
-	}
-
-	if (bN < -1 || bN >= PLOT_AXES_MAX) {
-
-		ERROR("Conditional axis number is out of range\n");
-		return ;
-	}
-
-	if (pl->axis[aN].busy == AXIS_FREE)
-		return ;
+	int		n;
 
-	if (pl->axis[aN].slave != 0)
-		return ;
+	while (len > 0) {
 
-	if (plotAxisRangeCond(pl, aN, bN, &fmin, &fmax) != 0) {
+		n = len;
 
-		if (fmin == fmax) {
+		if (async_write_block(ex->afd, text, 1, &n) == ASYNC_OK) {
 
-			fmin += (double) - 1.;
-			fmax += (double) + 1.;
+			text += n;
+			len -= n;
 		}
+		else {
+			SDL_Delay(1);
+		}
+	}
+}
 
-		plotAxisScaleManual(pl, aN, fmin, fmax);
-
-		if (pl->axis[aN].busy == AXIS_BUSY_X) {
-
-			fmin = plotAxisConvBackward(pl, aN, pl->viewport.min_x - pl->layout_mark_size);
-			fmax = plotAxisConvBackward(pl, aN, pl->viewport.max_x + pl->layout_mark_size);
+static int
+plotExportCheck(plot_t *pl, pexport_t *ex)
+{
+	int		dN;
 
-			plotAxisScaleManual(pl, aN, fmin, fmax);
-		}
-		else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+	/* The rows we are going to export must not be dropped or moved by
+	 * the dataset changes in between of steps.
+	 * */
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-			fmin = plotAxisConvBackward(pl, aN, pl->viewport.max_y + pl->layout_mark_size);
-			fmax = plotAxisConvBackward(pl, aN, pl->viewport.min_y - pl->layout_mark_size);
+		if (ex->local[dN].busy != 0) {
 
-			plotAxisScaleManual(pl, aN, fmin, fmax);
+			if (		pl->data[dN].column_N == 0
+					|| pl->data[dN].length_N != ex->local[dN].length_N
+					|| (ex->local[dN].row_N > 0
+						&& pl->data[dN].id_N > ex->local[dN].id_N))
+				return 0;
 		}
-
-		pl->axis[aN].lock_scale = LOCK_FREE;
-		pl->axis[aN].lock_tick = 0;
 	}
+
+	return 1;
 }
 
-void plotAxisScaleLock(plot_t *pl, int knob)
+static void
+plotDataSubtractReset(plot_t *pl, int dN, int sN)
 {
-	int		aN;
+	int		mode;
 
-	for (aN = 0; aN < PLOT_AXES_MAX; ++aN)
-		pl->axis[aN].lock_scale = knob;
-}
+	mode = pl->data[dN].sub[sN].busy;
 
-void plotAxisScaleDefault(plot_t *pl)
-{
-	int		aN;
+	if (mode == SUBTRACT_DATA_MEDIAN) {
 
-	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+		(void) plotDataMedianReset(pl, dN, sN);
 
-		if (		pl->axis[aN].busy != AXIS_FREE
-				&& pl->axis[aN].lock_scale == LOCK_AUTO) {
+		pl->data[dN].sub[sN].op.median.offset = (double) 0.;
+		pl->data[dN].sub[sN].op.median.prev[0] = FP_NAN;
+		pl->data[dN].sub[sN].op.median.prev[1] = FP_NAN;
+	}
+	else if (mode == SUBTRACT_FILTER_DIFFERENCE) {
 
-			plotAxisScaleAuto(pl, aN);
-		}
+		pl->data[dN].sub[sN].op.filter.state[0] = FP_NAN;
+		pl->data[dN].sub[sN].op.filter.state[1] = FP_NAN;
 	}
+	else if (mode == SUBTRACT_FILTER_CUMULATIVE) {
 
-	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+		pl->data[dN].sub[sN].op.filter.state[0] = FP_NAN;
+		pl->data[dN].sub[sN].op.filter.state[1] = 0.;
+	}
+	else if (mode == SUBTRACT_FILTER_LOW_PASS) {
 
-		if (		pl->axis[aN].busy == AXIS_BUSY_Y
-				&& pl->axis[aN].lock_scale == LOCK_STACKED) {
+		pl->data[dN].sub[sN].op.filter.state[0] = FP_NAN;
+	}
+	else if (mode == SUBTRACT_FILTER_MEDIAN) {
 
-			plotAxisScaleStacked(pl, -1);
-			break;
-		}
+		(void) plotDataMedianReset(pl, dN, sN);
 	}
 }
 
-void plotAxisScaleZoom(plot_t *pl, int aN, int origin, double zoom)
+static void
+plotDataSubtractRows(plot_t *pl, int dN, int sN, fval_t *row, int row_N, int id_N)
 {
-	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+	fval_t		X1, X2, X3, X4;
+	double		scale, offset, gain;
+	int		cN, jN, cNX, cNY, cNT, mode, rSTEP, cSTEP;
 
-		ERROR("Axis number is out of range\n");
-		return ;
-	}
+	mode = pl->data[dN].sub[sN].busy;
 
-	if (pl->axis[aN].slave != 0)
-		return ;
+	cN = sN + pl->data[dN].column_N;
 
-	if (pl->axis[aN].busy == AXIS_BUSY_X) {
+	rSTEP = pl->data[dN].row_STEP;
+	cSTEP = pl->data[dN].column_STEP;
 
-		pl->axis[aN].scale *= zoom;
-		pl->axis[aN].offset = pl->axis[aN].offset * zoom
-			+ (double) (pl->viewport.min_x - origin) /
-			(double) (pl->viewport.max_x - pl->viewport.min_x) * (zoom - 1.);
-	}
-	else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+	if (mode == SUBTRACT_DATA_MEDIAN) {
 
-		pl->axis[aN].scale *= zoom;
-		pl->axis[aN].offset = pl->axis[aN].offset * zoom
-			+ (double) (pl->viewport.max_y - origin) /
-			(double) (pl->viewport.min_y - pl->viewport.max_y) * (zoom - 1.);
-	}
+		tuple_t		mN;
 
-	pl->axis[aN].lock_scale = LOCK_FREE;
-}
+		cNX = pl->data[dN].sub[sN].op.median.column_X;
+		cNY = pl->data[dN].sub[sN].op.median.column_Y;
+		cNT = pl->data[dN].sub[sN].op.median.column_T;
 
-void plotAxisScaleMove(plot_t *pl, int aN, double move)
-{
-	double		span;
+		offset = pl->data[dN].sub[sN].op.median.offset;
 
-	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+		if (pl->data[dN].sub[sN].op.median.unwrap != UNWRAP_NONE) {
 
-		ERROR("Axis number is out of range\n");
-		return ;
-	}
+			X3 = (fval_t) pl->data[dN].sub[sN].op.median.prev[0];
+			X4 = (fval_t) pl->data[dN].sub[sN].op.median.prev[1];
+		}
 
-	if (pl->axis[aN].slave != 0)
-		return ;
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-	if (pl->axis[aN].busy == AXIS_BUSY_X) {
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
+			X2 = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-		span = (double) (pl->viewport.max_x - pl->viewport.min_x);
-		pl->axis[aN].offset += move / span;
-	}
-	else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+			mN = plotDataMedianAdd(pl, dN, sN, X1, X2);
 
-		span = (double) (pl->viewport.min_y - pl->viewport.max_y);
-		pl->axis[aN].offset += move / span;
-	}
+			if (mN.X < 0) {
 
-	pl->axis[aN].lock_scale = LOCK_FREE;
-}
+				X1 = FP_NAN;
+				X2 = FP_NAN;
+			}
+			else {
+				X1 = pl->data[dN].sub[sN].window.fval[mN.X];
+				X2 = pl->data[dN].sub[sN].window.fpay[mN.Y];
+			}
 
-void plotAxisScaleEqual(plot_t *pl)
-{
-	double		zoom, aspect_x, aspect_y;
+			if (pl->data[dN].sub[sN].op.median.unwrap == UNWRAP_OVERFLOW) {
 
-	if (pl->on_X < 0 || pl->on_X >= PLOT_AXES_MAX)
-		return ;
+				if (X1 + (fval_t) pl->defungap < X3) {
 
-	if (pl->on_Y < 0 || pl->on_Y >= PLOT_AXES_MAX)
-		return ;
+					offset += X3 - X1;
 
-	aspect_x = (double) (pl->viewport.max_x - pl->viewport.min_x);
-	aspect_y = (double) (pl->viewport.max_y - pl->viewport.min_y);
+					if (X4 < X3) {
 
-	if (pl->axis[pl->on_Y].scale < pl->axis[pl->on_X].scale) {
+						offset += X3 - X4;
+					}
+				}
 
-		zoom = pl->axis[pl->on_Y].scale / pl->axis[pl->on_X].scale;
-		zoom *= aspect_y / aspect_x;
+				if (fp_isfinite(X1)) {
 
-		pl->axis[pl->on_X].offset *= zoom;
-		pl->axis[pl->on_X].offset += (1. - zoom) / 2.;
-		pl->axis[pl->on_X].scale *= zoom;
-	}
-	else {
-		zoom = pl->axis[pl->on_X].scale / pl->axis[pl->on_Y].scale;
-		zoom *= aspect_x / aspect_y;
+					X4 = X3;
+					X3 = X1;
+				}
+			}
+			else if (pl->data[dN].sub[sN].op.median.unwrap == UNWRAP_BURST) {
 
-		pl->axis[pl->on_Y].offset *= zoom;
-		pl->axis[pl->on_Y].offset += (1. - zoom) / 2.;
-		pl->axis[pl->on_Y].scale *= zoom;
-	}
+				if (X1 < X3) {
 
-	pl->axis[pl->on_X].lock_scale = LOCK_FREE;
-	pl->axis[pl->on_Y].lock_scale = LOCK_FREE;
+					X1 = FP_NAN;
+				}
+				else if (X1 - (fval_t) pl->defungap > X3) {
 
-	pl->axis[pl->on_X].lock_tick = 0;
-	pl->axis[pl->on_Y].lock_tick = 0;
-}
+					X1 = FP_NAN;
+				}
+				else if (fp_isfinite(X1)) {
 
-static void
-plotAxisGridPairwiseAlign(plot_t *pl, int aN, int bN)
-{
-	double		scale, offset;
+					X3 = X1;
+				}
+			}
 
-	if (pl->axis[aN].slave != 0)
-		return ;
+			row[cNT * cSTEP] = X1 + offset;
+			row[cN * cSTEP] = X2;
 
-	if (aN != bN) {
+			id_N++;
+		}
 
-		scale = pl->axis[bN].ruler_tih / pl->axis[aN].ruler_tih;
-		offset = pl->axis[bN].ruler_tis - pl->axis[aN].ruler_tis;
+		pl->data[dN].sub[sN].op.median.offset = offset;
 
-		pl->axis[aN].scale *= scale;
-		pl->axis[aN].offset = pl->axis[aN].offset * scale
-			+ offset - pl->axis[aN].ruler_tis * (scale - 1.);
+		if (pl->data[dN].sub[sN].op.median.unwrap != UNWRAP_NONE) {
 
-		pl->axis[aN].lock_scale = LOCK_FREE;
-		pl->axis[aN].lock_tick = 0;
+			pl->data[dN].sub[sN].op.median.prev[0] = (double) X3;
+			pl->data[dN].sub[sN].op.median.prev[1] = (double) X4;
+		}
 	}
-}
+	else if (mode == SUBTRACT_SCALE) {
 
-void plotAxisScaleGridAlign(plot_t *pl)
-{
-	int		aN;
+		cNX = pl->data[dN].sub[sN].op.scale.column_X;
 
-	if (pl->on_X < 0 || pl->on_Y < 0)
-		return ;
+		scale = pl->data[dN].sub[sN].op.scale.scale;
+		offset = pl->data[dN].sub[sN].op.scale.offset;
 
-	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-		if (pl->axis[aN].busy == AXIS_BUSY_X) {
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
+			X1 = X1 * scale + offset;
 
-			plotAxisGridPairwiseAlign(pl, aN, pl->on_X);
-		}
-		else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+			row[cN * cSTEP] = X1;
 
-			plotAxisGridPairwiseAlign(pl, aN, pl->on_Y);
+			id_N++;
 		}
 	}
+	else if (mode == SUBTRACT_POLYFIT) {
 
-	pl->axis[pl->on_X].lock_scale = LOCK_FREE;
-	pl->axis[pl->on_Y].lock_scale = LOCK_FREE;
+		const double	*coefs;
+		int		N, N0, N1;
 
-	pl->axis[pl->on_X].lock_tick = 0;
-	pl->axis[pl->on_Y].lock_tick = 0;
-}
+		cNX = pl->data[dN].sub[sN].op.polyfit.column_X;
 
-void plotAxisScaleGridLock(plot_t *pl, int aN)
-{
-	double		scale, offset, ymin, ymax, fmin, fmax;
-	int		bN;
+		N0 = pl->data[dN].sub[sN].op.polyfit.poly_N0;
+		N1 = pl->data[dN].sub[sN].op.polyfit.poly_N1;
+		coefs = pl->data[dN].sub[sN].op.polyfit.coefs;
 
-	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-		ERROR("Axis number is out of range\n");
-		return ;
-	}
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
+			X2 = coefs[N1 - N0];
 
-	scale = pl->axis[aN].scale;
-	offset = pl->axis[aN].offset;
+			for (N = N1 - N0 - 1; N >= 0; --N)
+				X2 = X2 * X1 + coefs[N];
 
-	if (pl->axis[aN].slave != 0) {
+			for (N = N0 - 1; N >= 0; --N)
+				X2 = X2 * X1;
 
-		bN = pl->axis[aN].slave_N;
-		scale *= pl->axis[bN].scale;
-		offset = offset * pl->axis[bN].scale + pl->axis[bN].offset;
+			row[cN * cSTEP] = X2;
+
+			id_N++;
+		}
 	}
+	else if (mode == SUBTRACT_BINARY_SUBTRACTION) {
 
-	ymin = - offset / scale;
-	ymax = 1. / scale + ymin;
+		cNX = pl->data[dN].sub[sN].op.binary.column_X;
+		cNY = pl->data[dN].sub[sN].op.binary.column_Y;
 
-	if (plotAxisRangeCond(pl, aN, -1, &fmin, &fmax) != 0) {
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-		if (fmin == fmax) {
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
+			X2 = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-			fmin += (double) - 1.;
-			fmax += (double) + 1.;
+			row[cN * cSTEP] = X1 - X2;
+
+			id_N++;
 		}
+	}
+	else if (mode == SUBTRACT_BINARY_ADDITION) {
 
-		if (pl->axis[aN].busy == AXIS_BUSY_X) {
+		cNX = pl->data[dN].sub[sN].op.binary.column_X;
+		cNY = pl->data[dN].sub[sN].op.binary.column_Y;
 
-			fmin = plotAxisConvBackward(pl, aN, plotAxisConvForward(pl, aN, fmin) - pl->layout_mark_size);
-			fmax = plotAxisConvBackward(pl, aN, plotAxisConvForward(pl, aN, fmax) + pl->layout_mark_size);
-		}
-		else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-			fmin = plotAxisConvBackward(pl, aN, plotAxisConvForward(pl, aN, fmin) + pl->layout_mark_size);
-			fmax = plotAxisConvBackward(pl, aN, plotAxisConvForward(pl, aN, fmax) - pl->layout_mark_size);
-		}
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
+			X2 = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-		ymin = (ymin < fmin) ? (fmin < ymax) ? fmin : ymax : ymin;
-		ymax = (ymax > fmax) ? (fmax > ymin) ? fmax : ymin : ymax;
+			row[cN * cSTEP] = X1 + X2;
+
+			id_N++;
+		}
 	}
+	else if (mode == SUBTRACT_BINARY_MULTIPLICATION) {
 
-	pl->axis[aN].lock_tick = 1;
+		cNX = pl->data[dN].sub[sN].op.binary.column_X;
+		cNY = pl->data[dN].sub[sN].op.binary.column_Y;
 
-	pl->axis[aN].ruler_min = ymin;
-	pl->axis[aN].ruler_max = ymax;
-}
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-typedef struct {
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
+			X2 = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-	int		aN;
-	double		yval;
+			row[cN * cSTEP] = X1 * X2;
 
-	double		fmin;
-	double		fmax;
-}
-yaxis_t;
+			id_N++;
+		}
+	}
+	else if (mode == SUBTRACT_BINARY_HYPOTENUSE) {
 
-static int
-plotAxisGetSorted(plot_t *pl, int bN, yaxis_t *map)
-{
-	int		aN, N, job, cond, yN = 0;
+		cNX = pl->data[dN].sub[sN].op.binary.column_X;
+		cNY = pl->data[dN].sub[sN].op.binary.column_Y;
 
-	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-		if (		pl->axis[aN].busy == AXIS_BUSY_Y
-				&& pl->axis[aN].slave == 0) {
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
+			X2 = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-			job = 0;
+			row[cN * cSTEP] = sqrt(X1 * X1 + X2 * X2);
 
-			if (bN >= 0) {
+			id_N++;
+		}
+	}
+	else if (mode == SUBTRACT_FILTER_DIFFERENCE) {
 
-				job = 1;
-			}
-			else if (pl->axis[aN].lock_scale == LOCK_STACKED) {
+		cNX = pl->data[dN].sub[sN].op.filter.column_X;
+		cNY = pl->data[dN].sub[sN].op.filter.column_Y;
 
-				job = 1;
-			}
+		X3 = (fval_t) pl->data[dN].sub[sN].op.filter.state[0];
+		X4 = (fval_t) pl->data[dN].sub[sN].op.filter.state[1];
 
-			if (job != 0) {
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-				cond = plotAxisRangeCond(pl, aN, -1, &map[yN].fmin, &map[yN].fmax);
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
+			X2 = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-				if (cond != 0) {
+			row[cN * cSTEP] = (X2 - X4) / (X1 - X3);
 
-					map[yN].aN = aN;
-					map[yN].yval = plotAxisConvForward(pl, aN,
-							(map[yN].fmin + map[yN].fmax) / 2.);
+			X3 = X1;
+			X4 = X2;
 
-					yN++;
-				}
-			}
+			id_N++;
 		}
+
+		pl->data[dN].sub[sN].op.filter.state[0] = (double) X3;
+		pl->data[dN].sub[sN].op.filter.state[1] = (double) X4;
 	}
+	else if (mode == SUBTRACT_FILTER_CUMULATIVE) {
 
-	do {
-		yaxis_t		ybackup;
+		cNX = pl->data[dN].sub[sN].op.filter.column_X;
+		cNY = pl->data[dN].sub[sN].op.filter.column_Y;
 
-		job = 0;
+		X3 = (fval_t) pl->data[dN].sub[sN].op.filter.state[0];
+		X4 = (fval_t) pl->data[dN].sub[sN].op.filter.state[1];
 
-		for (N = 1; N < yN; ++N) {
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-			if (map[N - 1].yval < map[N].yval) {
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
+			X2 = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-				memcpy(&ybackup, &map[N - 1], sizeof(yaxis_t));
-				memcpy(&map[N - 1], &map[N], sizeof(yaxis_t));
-				memcpy(&map[N], &ybackup, sizeof(yaxis_t));
+			X2 *= X1 - X3;
 
-				job = 1;
+			if (fp_isfinite(X2)) {
+
+				X4 += X2;
 			}
+
+			X3 = X1;
+
+			row[cN * cSTEP] = X4;
+
+			id_N++;
 		}
-	}
-	while (job != 0);
 
-	return yN;
-}
+		pl->data[dN].sub[sN].op.filter.state[0] = (double) X3;
+		pl->data[dN].sub[sN].op.filter.state[1] = (double) X4;
+	}
+	else if (mode == SUBTRACT_FILTER_BITMASK) {
 
-void plotAxisScaleStacked(plot_t *pl, int bN)
-{
-	double		scale, offset, ypad, yself;
-	int		aN, yN, N;
+		unsigned long	shift, mask, ulval;
 
-	yaxis_t		ymap[PLOT_AXES_MAX];
+		cNX = pl->data[dN].sub[sN].op.filter.column_Y;
+		ulval = (unsigned long) pl->data[dN].sub[sN].op.filter.gain;
 
-	yN = plotAxisGetSorted(pl, bN, ymap);
+		shift = ulval & 0xFFU;
+		ulval = ulval >> 8;
 
-	if (yN >= 2) {
+		mask = ((1U << (ulval - shift + 1U)) - 1U) << shift;
 
-		scale = 1. / (double) yN;
-		offset = 0.;
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-		for (N = 0; N < yN; ++N) {
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
 
-			aN = ymap[N].aN;
+			ulval = ((unsigned long) X1 & mask) >> shift;
+			row[cN * cSTEP] = (fval_t) ulval;
 
-			if (ymap[N].fmin == ymap[N].fmax) {
+			id_N++;
+		}
+	}
+	else if (mode == SUBTRACT_FILTER_LOW_PASS) {
 
-				ymap[N].fmin += (double) - 1.;
-				ymap[N].fmax += (double) + 1.;
-			}
+		cNX = pl->data[dN].sub[sN].op.filter.column_Y;
+		gain = pl->data[dN].sub[sN].op.filter.gain;
 
-			ypad = (double) pl->layout_mark_size / (double)
-				(pl->viewport.max_y - pl->viewport.min_y);
+		X2 = (fval_t) pl->data[dN].sub[sN].op.filter.state[0];
 
-			ypad *= (ymap[N].fmax - ymap[N].fmin) / (scale - ypad * 2.);
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-			ymap[N].fmin += (double) - ypad;
-			ymap[N].fmax += (double) + ypad;
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
 
-			yself = ymap[N].fmin / (ymap[N].fmax - ymap[N].fmin);
+			if (fp_isfinite(X1)) {
 
-			pl->axis[aN].scale = scale / (ymap[N].fmax - ymap[N].fmin);
-			pl->axis[aN].offset = offset - yself * scale;
+				if (fp_isfinite(X2)) {
 
-			pl->axis[aN].lock_scale = LOCK_STACKED;
-			pl->axis[aN].lock_tick = 1;
+					X2 += (X1 - X2) * gain;
+				}
+				else {
+					X2 = X1;
+				}
+			}
 
-			pl->axis[aN].ruler_min = ymap[N].fmin;
-			pl->axis[aN].ruler_max = ymap[N].fmax;
+			row[cN * cSTEP] = X2;
 
-			offset += scale;
+			id_N++;
 		}
-	}
-	else {
-		for (N = 0; N < PLOT_AXES_MAX; ++N) {
 
-			if (pl->axis[N].lock_scale == LOCK_STACKED)
-				pl->axis[N].lock_scale = LOCK_FREE;
-		}
+		pl->data[dN].sub[sN].op.filter.state[0] = (double) X2;
 	}
-}
+	else if (mode == SUBTRACT_FILTER_MEDIAN) {
 
-int plotAxisGetByClick(plot_t *pl, int cur_X, int cur_Y)
-{
-	int		aN, len, rN = -1;
+		tuple_t		mN;
 
-	cur_X = pl->viewport.min_x - pl->layout_border - cur_X;
-	cur_Y = cur_Y - pl->viewport.max_y - pl->layout_border;
+		cNX = pl->data[dN].sub[sN].op.median.column_Y;
 
-	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+		for (jN = 0; jN < row_N; ++jN, row += rSTEP) {
 
-		if (pl->axis[aN].busy == AXIS_BUSY_X) {
+			X1 = (cNX < 0) ? id_N : row[cNX * cSTEP];
 
-			len = pl->layout_ruler_box;
-			len += (pl->axis[aN].compact == 0) ? pl->layout_label_box : 0;
+			mN = plotDataMedianAdd(pl, dN, sN, X1, X1);
 
-			if (		cur_Y < pl->axis[aN].layout_pos + len
-					&& cur_Y > pl->axis[aN].layout_pos) {
+			if (mN.X < 0) {
 
-				rN = aN;
-				break;
+				X2 = FP_NAN;
+			}
+			else {
+				X2 = pl->data[dN].sub[sN].window.fval[mN.X];
 			}
-		}
-
-		if (pl->axis[aN].busy == AXIS_BUSY_Y) {
-
-			len = pl->layout_ruler_box;
-			len += (pl->axis[aN].compact == 0) ? pl->layout_label_box : 0;
 
-			if (		cur_X < pl->axis[aN].layout_pos + len
-					&& cur_X > pl->axis[aN].layout_pos) {
+			row[cN * cSTEP] = X2;
 
-				rN = aN;
-				break;
-			}
+			id_N++;
 		}
 	}
-
-	pl->hover_axis = rN;
-
-	return rN;
 }
 
-double plotAxisConvForward(plot_t *pl, int aN, double fval)
+static int
+plotDataSubtractInput(plot_t *pl, int dN, int sN, int input[2])
 {
-	double		scale, offset, length;
-	int		bN;
+	int		mode, rc = 1;
 
-	scale = pl->axis[aN].scale;
-	offset = pl->axis[aN].offset;
+	mode = pl->data[dN].sub[sN].busy;
 
-	if (pl->axis[aN].slave != 0) {
+	input[0] = -1;
+	input[1] = -1;
 
-		bN = pl->axis[aN].slave_N;
-		scale *= pl->axis[bN].scale;
-		offset = offset * pl->axis[bN].scale + pl->axis[bN].offset;
+	if (mode == SUBTRACT_DATA_MEDIAN) {
+
+		input[0] = pl->data[dN].sub[sN].op.median.column_X;
+		input[1] = pl->data[dN].sub[sN].op.median.column_Y;
 	}
+	else if (mode == SUBTRACT_FILTER_MEDIAN) {
 
-	if (pl->axis[aN].busy == AXIS_BUSY_X) {
+		input[1] = pl->data[dN].sub[sN].op.median.column_Y;
+	}
+	else if (mode == SUBTRACT_SCALE) {
 
-		length = (double) (pl->viewport.max_x - pl->viewport.min_x);
-		scale *= length;
-		offset = offset * length + pl->viewport.min_x;
+		input[0] = pl->data[dN].sub[sN].op.scale.column_X;
 	}
-	else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+	else if (mode == SUBTRACT_POLYFIT) {
 
-		length = (double) (pl->viewport.min_y - pl->viewport.max_y);
-		scale *= length;
-		offset = offset * length + pl->viewport.max_y;
+		input[0] = pl->data[dN].sub[sN].op.polyfit.column_X;
 	}
+	else if (	mode == SUBTRACT_BINARY_SUBTRACTION
+			|| mode == SUBTRACT_BINARY_ADDITION
+			|| mode == SUBTRACT_BINARY_MULTIPLICATION
+			|| mode == SUBTRACT_BINARY_HYPOTENUSE) {
 
-	return fval * scale + offset;
+		input[0] = pl->data[dN].sub[sN].op.binary.column_X;
+		input[1] = pl->data[dN].sub[sN].op.binary.column_Y;
+	}
+	else if (	mode == SUBTRACT_FILTER_DIFFERENCE
+			|| mode == SUBTRACT_FILTER_CUMULATIVE) {
+
+		input[0] = pl->data[dN].sub[sN].op.filter.column_X;
+		input[1] = pl->data[dN].sub[sN].op.filter.column_Y;
+	}
+	else if (	mode == SUBTRACT_FILTER_BITMASK
+			|| mode == SUBTRACT_FILTER_LOW_PASS) {
+
+		input[1] = pl->data[dN].sub[sN].op.filter.column_Y;
+	}
+	else {
+		/* Nothing to calculate HERE */
+		rc = 0;
+	}
+
+	return rc;
 }
 
-double plotAxisConvBackward(plot_t *pl, int aN, double xval)
+static int
+plotDataSubtractStateless(int mode)
 {
-	double		scale, offset, length;
-	int		bN;
+	return (	   mode == SUBTRACT_SCALE
+			|| mode == SUBTRACT_POLYFIT
+			|| mode == SUBTRACT_BINARY_SUBTRACTION
+			|| mode == SUBTRACT_BINARY_ADDITION
+			|| mode == SUBTRACT_BINARY_MULTIPLICATION
+			|| mode == SUBTRACT_BINARY_HYPOTENUSE
+			|| mode == SUBTRACT_FILTER_BITMASK) ? 1 : 0;
+}
 
-	scale = pl->axis[aN].scale;
-	offset = pl->axis[aN].offset;
+static int
+plotDataSubtractStage(plot_t *pl, int dN, int sN_min, int sN_max)
+{
+	int		source[PLOT_SUBTRACT], input[2];
+	int		cN, sN, pN, N, stage, stage_max, serial;
 
-	if (pl->axis[aN].slave != 0) {
+	cN = pl->data[dN].column_N;
 
-		bN = pl->axis[aN].slave_N;
-		scale *= pl->axis[bN].scale;
-		offset = offset * pl->axis[bN].scale + pl->axis[bN].offset;
-	}
+	/* Without worker threads or with compressed chunks that are fetched
+	 * one by one we go through the dataset only once in order.
+	 * */
+	serial = (	   pl->data[dN].lz4_compress != 0
+			|| pl->pool == NULL
+			|| pl->pool->thread_N < 1) ? 1 : 0;
 
-	if (pl->axis[aN].busy == AXIS_BUSY_X) {
+	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
 
-		length = (double) (pl->viewport.max_x - pl->viewport.min_x);
-		scale *= length;
-		offset = offset * length + pl->viewport.min_x;
+		source[sN] = sN;
 	}
-	else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
 
-		length = (double) (pl->viewport.min_y - pl->viewport.max_y);
-		scale *= length;
-		offset = offset * length + pl->viewport.max_y;
-	}
+	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
 
-	return (xval - offset) / scale;
-}
+		if (pl->data[dN].sub[sN].busy == SUBTRACT_DATA_MEDIAN) {
 
-void plotAxisSlave(plot_t *pl, int aN, int bN, double scale, double offset, int action)
-{
-	int		N, base = 0;
+			/* The time column of median is written by data median.
+			 * */
+			N = pl->data[dN].sub[sN].op.median.column_T - cN;
 
-	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+			if (N >= 0 && N < PLOT_SUBTRACT) {
 
-		ERROR("Slave axis number is out of range\n");
-		return ;
+				source[N] = sN;
+			}
+		}
 	}
 
-	if (action == AXIS_SLAVE_DISABLE) {
+	stage_max = -1;
 
-		bN = pl->axis[aN].slave_N;
-	}
+	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
 
-	if (bN < 0 || bN >= PLOT_AXES_MAX) {
+		if (		sN < sN_min || sN > sN_max
+				|| plotDataSubtractInput(pl, dN, sN, input) == 0) {
 
-		ERROR("Base axis number is out of range\n");
-		return ;
-	}
+			stage = -1;
+		}
+		else if (serial != 0) {
 
-	if (bN == aN) {
+			stage = 1;
+		}
+		else {
+			stage = 0;
 
-		ERROR("Axes must not be the same\n");
-		return ;
-	}
+			/* Subtract follows the stages of its input columns. The
+			 * columns of subtracts that go later in the list are
+			 * taken as they are.
+			 * */
+			for (N = 0; N < 2; ++N) {
 
-	if (pl->axis[bN].slave != 0) {
+				pN = input[N] - cN;
 
-		ERROR("Base axis must not be slave\n");
-		return ;
-	}
+				if (pN >= 0 && pN < PLOT_SUBTRACT) {
 
-	for (N = 0; N < PLOT_AXES_MAX; ++N) {
+					pN = source[pN];
 
-		if (pl->axis[N].busy != AXIS_FREE
-				&& pl->axis[N].slave != 0) {
+					if (		pN < sN
+							&& pl->data[dN].sub[pN].stage > stage) {
 
-			if (pl->axis[N].slave_N == aN) {
+						stage = pl->data[dN].sub[pN].stage;
+					}
+				}
+			}
 
-				base = 1;
-				break;
+			if (plotDataSubtractStateless(pl->data[dN].sub[sN].busy) != 0) {
+
+				stage += (stage & 1) ? 1 : 0;
+			}
+			else {
+				stage += (stage & 1) ? 0 : 1;
 			}
 		}
-	}
 
-	if (base) {
+		pl->data[dN].sub[sN].stage = stage;
 
-		ERROR("The axis is base for another slave\n");
-		return ;
+		stage_max = (stage > stage_max) ? stage : stage_max;
 	}
 
-	if (action == AXIS_SLAVE_ENABLE) {
+	return stage_max;
+}
 
-		if (pl->axis[aN].slave == 0) {
+static int
+plotDataSubtractSegment(plot_t *pl, int dN, psubjob_t *jb, int *rN, int *id_N, int rN_end)
+{
+	int		lN, bN, N;
 
-			pl->axis[aN].slave = 1;
-			pl->axis[aN].slave_N = bN;
-			pl->axis[aN].scale = scale;
-			pl->axis[aN].offset = offset;
+	if (*rN == pl->data[dN].tail_N)
+		return 0;
 
-			pl->on_X = (aN == pl->on_X) ? bN : pl->on_X;
-			pl->on_Y = (aN == pl->on_Y) ? bN : pl->on_Y;
-		}
-	}
-	else if (action == AXIS_SLAVE_HOLD_AS_IS) {
+	lN = pl->data[dN].length_N;
 
-		if (bN < 0 || bN >= PLOT_AXES_MAX) {
+	jb->chunk_N = *rN >> pl->data[dN].chunk_SHIFT;
+	jb->row_N = *rN & pl->data[dN].chunk_MASK;
+	jb->id_N = *id_N;
 
-			ERROR("Base axis number is out of range\n");
-			return ;
-		}
+	/* Take the rest of chunk but do not go across the end of ring
+	 * buffer or over the end of range.
+	 * */
+	bN = pl->data[dN].chunk_MASK + 1 - jb->row_N;
+	bN = (bN > lN - *rN) ? lN - *rN : bN;
 
-		if (pl->axis[aN].slave == 0) {
+	N = rN_end - *rN;
+	bN = (N > 0 && N < bN) ? N : bN;
 
-			pl->axis[aN].slave = 1;
-			pl->axis[aN].slave_N = bN;
+	N = pl->data[dN].tail_N - *rN;
+	bN = (N > 0 && N < bN) ? N : bN;
 
-			pl->axis[aN].scale = pl->axis[aN].scale / pl->axis[bN].scale;
-			pl->axis[aN].offset = (pl->axis[aN].offset - pl->axis[bN].offset)
-				/ pl->axis[bN].scale;
+	jb->length = bN;
 
-			pl->on_X = (aN == pl->on_X) ? bN : pl->on_X;
-			pl->on_Y = (aN == pl->on_Y) ? bN : pl->on_Y;
-		}
+	if (pl->data[dN].lz4_compress != 0) {
+
+		plotDataChunkWrite(pl, dN, jb->chunk_N);
 	}
-	else {
-		if (pl->axis[aN].slave != 0) {
 
-			pl->axis[aN].slave = 0;
+	/* The ranges are kept if the rows are written in order.
+	 * */
+	plotDataStatWipe(pl, dN, jb->chunk_N, *rN & pl->data[dN].chunk_MASK,
+			pl->data[dN].column_N);
 
-			pl->axis[aN].scale = pl->axis[aN].scale * pl->axis[bN].scale;
-			pl->axis[aN].offset = pl->axis[aN].offset * pl->axis[bN].scale
-				+ pl->axis[bN].offset;
-		}
+	if (		   pl->rcache_wipe_data_N != dN
+			|| pl->rcache_wipe_chunk_N != jb->chunk_N) {
+
+		plotSketchStreamBreak(pl, dN, *rN);
+		plotDataRangeCacheWipe(pl, dN, jb->chunk_N);
+
+		/* Subtracts do not change the data columns.
+		 * */
+		plotDataPolyfitWipe(pl, dN, jb->chunk_N, pl->data[dN].column_N);
+
+		pl->rcache_wipe_data_N = dN;
+		pl->rcache_wipe_chunk_N = jb->chunk_N;
 	}
+
+	*rN = (*rN + bN < lN) ? *rN + bN : 0;
+	*id_N += bN;
+
+	return 1;
 }
 
-void plotAxisRemove(plot_t *pl, int aN)
+static void
+plotDataSubtractJob(psubjob_t *jb)
 {
-	int		N, cN;
+	plot_t		*pl = (plot_t *) jb->pl;
+	fval_t		*row;
+	int		dN, sN, jN, jN_end, bN, id_N;
 
-	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+	dN = jb->data_N;
+	row = pl->data[dN].raw[jb->chunk_N];
 
-		ERROR("Axis number is out of range\n");
+	if (row == NULL)
 		return ;
-	}
 
-	if (aN == pl->on_X || aN == pl->on_Y) {
+	jN = jb->row_N;
+	jN_end = jb->row_N + jb->length;
 
-		ERROR("Unable to remove active axis\n");
-		return ;
-	}
+	id_N = jb->id_N;
 
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+	/* Go through the block of rows with all subtracts of the stage while
+	 * the block is still in cache.
+	 * */
+	while (jN < jN_end) {
 
-		if (pl->figure[N].busy != 0) {
+		bN = (jN_end - jN > PLOT_SUBTRACT_BLOCK) ? PLOT_SUBTRACT_BLOCK : jN_end - jN;
 
-			if (pl->figure[N].axis_X == aN) {
+		for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
 
-				if (pl->axis[aN].slave != 0) {
+			if (pl->data[dN].sub[sN].stage == jb->stage_N) {
 
-					cN = plotGetSubtractScale(pl, pl->figure[N].data_N,
-							pl->figure[N].column_X,
-							pl->axis[aN].scale,
-							pl->axis[aN].offset);
+				plotDataSubtractRows(pl, dN, sN, row + pl->data[dN].row_STEP * jN, bN, id_N);
+			}
+		}
 
-					if (cN != -1) {
+		jN += bN;
+		id_N += bN;
+	}
+}
 
-						pl->figure[N].column_X = cN;
-					}
+static void
+plotDataSubtractWrite(plot_t *pl, int dN, int sN_min, int sN_max, int rN_beg, int id_N_beg, int rN_end)
+{
+	psubjob_t	*jb, seg;
+	int		sN, rN, id_N, stage, stage_max, job_N, N;
 
-					pl->figure[N].axis_X = pl->axis[aN].slave_N;
-				}
-				else {
-					pl->figure[N].axis_X = pl->on_X;
-				}
-			}
+	Uint64		tSTART;
 
-			if (pl->figure[N].axis_Y == aN) {
+	stage_max = plotDataSubtractStage(pl, dN, sN_min, sN_max);
 
-				if (pl->axis[aN].slave != 0) {
+	if (stage_max < 0)
+		return ;
 
-					cN = plotGetSubtractScale(pl, pl->figure[N].data_N,
-							pl->figure[N].column_Y,
-							pl->axis[aN].scale,
-							pl->axis[aN].offset);
+	tSTART = SDL_GetPerformanceCounter();
 
-					if (cN != -1) {
+	if (rN_beg == pl->data[dN].head_N) {
 
-						pl->figure[N].column_Y = cN;
-					}
+		for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
 
-					pl->figure[N].axis_Y = pl->axis[aN].slave_N;
-				}
-				else {
-					pl->figure[N].axis_Y = pl->on_Y;
-				}
+			if (pl->data[dN].sub[sN].stage >= 0) {
+
+				plotDataSubtractReset(pl, dN, sN);
 			}
 		}
 	}
 
-	for (N = 0; N < PLOT_AXES_MAX; ++N) {
-
-		if (pl->axis[N].busy != AXIS_FREE
-				&& pl->axis[N].slave != 0) {
+	job_N = (pl->pool != NULL) ? pl->pool->thread_N + 1 : 1;
+	job_N = (job_N > PLOT_SUBTRACT_JOB_MAX) ? PLOT_SUBTRACT_JOB_MAX : job_N;
 
-			if (pl->axis[N].slave_N == aN) {
+	seg.pl = pl;
+	seg.data_N = dN;
 
-				plotAxisSlave(pl, N, -1, 0., 0., AXIS_SLAVE_DISABLE);
-			}
-		}
-	}
+	/* Stateless subtracts of even stage are computed on chunks in parallel.
+	 * Filters that keep the state between rows make odd stage that goes
+	 * through chunks in order.
+	 * */
+	for (stage = 0; stage <= stage_max; ++stage) {
 
-	pl->axis[aN].busy = AXIS_FREE;
-	pl->axis[aN].slave = 0;
-	pl->axis[aN].label[0] = 0;
-	pl->axis[aN].compact = 1;
-	pl->axis[aN].exponential = 0;
-}
+		rN = rN_beg;
+		id_N = id_N_beg;
 
-void plotFigureAdd(plot_t *pl, int fN, int dN, int nX, int nY, int aX, int aY, const char *label)
-{
-	int		gN;
+		seg.stage_N = stage;
 
-	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+		N = 0;
 
-		ERROR("Figure number is out of range\n");
-		return ;
-	}
+		do {
+			if (plotDataSubtractSegment(pl, dN, &seg, &rN, &id_N, rN_end) == 0)
+				break;
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+			if (stage & 1) {
 
-		ERROR("Dataset number is out of range\n");
-		return ;
-	}
+				plotDataSubtractJob(&seg);
+			}
+			else {
+				jb = &pl->subjob[N % job_N];
 
-	if (pl->data[dN].column_N < 1) {
+				poolWait(pl->pool, &jb->task);
 
-		ERROR("Dataset %i has no DATA\n", dN);
-		return ;
-	}
+				jb->pl = seg.pl;
+				jb->data_N = seg.data_N;
+				jb->stage_N = seg.stage_N;
+				jb->chunk_N = seg.chunk_N;
+				jb->row_N = seg.row_N;
+				jb->length = seg.length;
+				jb->id_N = seg.id_N;
 
-	if (nX < -1 || nX >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+				poolSubmit(pl->pool, &jb->task, (void (*) (void *))
+						&plotDataSubtractJob, jb);
 
-		ERROR("X column number %i is out of range\n", nX);
-		return ;
-	}
+				N++;
+			}
+		}
+		while (rN != rN_end);
 
-	if (nY < -1 || nY >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+		for (N = 0; N < job_N; ++N) {
 
-		ERROR("Y column number %i is out of range\n", nY);
-		return ;
+			poolWait(pl->pool, &pl->subjob[N].task);
+		}
 	}
 
-	if (aX < 0 || aX >= PLOT_AXES_MAX) {
+	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
 
-		ERROR("X axis number %i is out of range\n", aX);
-		return ;
-	}
-
-	if (aY < 0 || aY >= PLOT_AXES_MAX) {
+		if (		pl->data[dN].sub[sN].stage >= 0
+				&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
 
-		ERROR("Y axis number %i is out of range\n", aY);
-		return ;
+			pl->data[dN].sub[sN].op.scale.modified = 0;
+		}
 	}
 
-	if (aX == aY || pl->axis[aX].busy == AXIS_BUSY_Y
-		|| pl->axis[aY].busy == AXIS_BUSY_X) {
+	pl->perf.subtract += SDL_GetPerformanceCounter() - tSTART;
+}
 
-		ERROR("Invalid axes mapping %i %i\n", aX, aY);
-		return ;
-	}
+static void
+plotDataSubtractResample(plot_t *pl, int dN, int sN)
+{
+	int		cNX, cNY, in_dN, in_cNX, in_cNY;
 
-	pl->draw[fN].sketch = SKETCH_FINISHED;
+	if (pl->data[dN].sub[sN].busy == SUBTRACT_RESAMPLE) {
 
-	pl->figure[fN].busy = 1;
-	pl->figure[fN].hidden = 0;
-	pl->figure[fN].drawing = pl->default_drawing;
-	pl->figure[fN].width = pl->default_width;
-	pl->figure[fN].data_N = dN;
-	pl->figure[fN].column_X = nX;
-	pl->figure[fN].column_Y = nY;
-	pl->figure[fN].axis_X = aX;
-	pl->figure[fN].axis_Y = aY;
+		cNX = pl->data[dN].sub[sN].op.resample.column_X;
+		cNY = sN + pl->data[dN].column_N;
 
-	if (pl->axis[aX].busy == AXIS_FREE) {
+		in_dN = pl->data[dN].sub[sN].op.resample.in_data_N;
+		in_cNX = pl->data[dN].sub[sN].op.resample.in_column_X;
+		in_cNY = pl->data[dN].sub[sN].op.resample.in_column_Y;
 
-		pl->axis[aX].busy = AXIS_BUSY_X;
-		pl->axis[aX].lock_scale = LOCK_AUTO;
-		pl->axis[aX].compact = 1;
+		plotDataResample(pl, dN, cNX, cNY, in_dN, in_cNX, in_cNY);
 	}
+}
 
-	if (pl->axis[aY].busy == AXIS_FREE) {
+static void
+plotDataSubtractResampleSeq(plot_t *pl, int dN)
+{
+	int		N;
 
-		pl->axis[aY].busy = AXIS_BUSY_Y;
-		pl->axis[aY].lock_scale = LOCK_AUTO;
-		pl->axis[aY].compact = 1;
+	for (N = 0; N < PLOT_SUBTRACT; ++N) {
+
+		plotDataSubtractResample(pl, dN, N);
 	}
+}
 
-	gN = pl->data[dN].map[nX];
+void plotDataSubtractCompute(plot_t *pl, int dN, int sN)
+{
+	int		rN, id_N, rN_end;
 
-	if (gN != -1) {
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
 
-		plotAxisLabel(pl, aX, pl->group[gN].label);
+		ERROR("Dataset number is out of range\n");
+		return ;
 	}
 
-	gN = pl->data[dN].map[nY];
-
-	if (gN != -1) {
+	if (sN < 0 || sN >= PLOT_SUBTRACT) {
 
-		plotAxisLabel(pl, aY, pl->group[gN].label);
+		ERROR("Subtract number %i is out of range\n", sN);
+		return ;
 	}
 
-	strcpy(pl->figure[fN].label, label);
+	if (pl->data[dN].sub_paused != 0)
+		return ;
 
-	pl->on_X = (pl->on_X < 0) ? aX : pl->on_X;
-	pl->on_Y = (pl->on_Y < 0) ? aY : pl->on_Y;
-}
+	rN = pl->data[dN].head_N;
+	id_N = pl->data[dN].id_N;
 
-static void
-plotDataBoxTextFmt(plot_t *pl, int fN, double val)
-{
-	char		tfmt[PLOT_STRING_MAX];
-	char		tbuf[PLOT_STRING_MAX];
+	rN_end = pl->data[dN].tail_N;
 
-	int		fexp = 1;
+	if (rN == rN_end)
+		return ;
 
-	if (val != 0.) {
+	plotSketchStreamBreak(pl, dN, -1);
 
-		fexp += (int) floor(log10(fabs(val)));
-	}
+	plotDataSubtractWrite(pl, dN, sN, sN, rN, id_N, rN_end);
+	plotDataSubtractResample(pl, dN, sN);
+}
 
-	if (fexp >= -2 && fexp < pl->fprecision) {
+void plotDataSubtractResidual(plot_t *pl, int dN)
+{
+	int		rN, id_N, rN_end;
 
-		fexp = (fexp < 1) ? 1 : fexp;
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
 
-		sprintf(tfmt, "%% .%df ", pl->fprecision - fexp);
-	}
-	else {
-		sprintf(tfmt, "%% .%dE ", pl->fprecision - 1);
+		ERROR("Dataset number is out of range\n");
+		return ;
 	}
 
-	sprintf(tbuf, tfmt, val);
-	strcat(pl->data_box_text[fN], tbuf);
-}
+	rN = pl->data[dN].sub_N;
+	id_N = pl->data[dN].id_N;
 
-static void
-plotDataBoxTextHex(plot_t *pl, int fN, double val)
-{
-	char		tbuf[PLOT_STRING_MAX];
+	rN_end = pl->data[dN].tail_N;
 
-	sprintf(tbuf, " 0x%08lX", (unsigned long) val);
-	strcat(pl->data_box_text[fN], tbuf);
+	if (rN == rN_end)
+		return ;
+
+	plotDataSubtractWrite(pl, dN, 0, PLOT_SUBTRACT - 1, rN, id_N, rN_end);
+
+	pl->data[dN].sub_N = rN_end;
 }
 
-static int
-plotCheckColumnLinked(plot_t *pl, int dN, int cN)
+void plotDataSubtractClean(plot_t *pl)
 {
-	int		sN, fN, dNf, linked = 0;
+	int		dN, N;
 
-	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-		if (pl->data[dN].sub[sN].busy == SUBTRACT_TIME_MEDIAN) {
+		if (pl->data[dN].column_N != 0) {
 
-			if (cN == pl->data[dN].sub[sN].op.median.column_X) {
+			for (N = 0; N < PLOT_SUBTRACT; ++N) {
 
-				linked = 1;
-				break;
+				pl->data[dN].sub[N].busy = SUBTRACT_FREE;
 			}
 		}
-		else if (pl->data[dN].sub[sN].busy == SUBTRACT_DATA_MEDIAN) {
+	}
+}
 
-			if (cN == pl->data[dN].sub[sN].op.median.column_Y) {
+void plotDataSubtractPaused(plot_t *pl)
+{
+	int		dN;
 
-				linked = 1;
-				break;
-			}
-		}
-		else if (pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-			if (cN == pl->data[dN].sub[sN].op.scale.column_X) {
+		if (pl->data[dN].column_N != 0) {
 
-				linked = 1;
-				break;
-			}
+			pl->data[dN].sub_paused = 1;
 		}
-		else if (pl->data[dN].sub[sN].busy == SUBTRACT_RESAMPLE) {
-
-			if (cN == pl->data[dN].sub[sN].op.resample.column_X) {
+	}
+}
 
-				linked = 1;
-				break;
-			}
-		}
-		else if (pl->data[dN].sub[sN].busy == SUBTRACT_POLYFIT) {
+void plotDataSubtractAlternate(plot_t *pl)
+{
+	int		dN, rN, id_N, rN_end;
 
-			if (cN == pl->data[dN].sub[sN].op.polyfit.column_X) {
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-				linked = 1;
-				break;
-			}
-		}
-		else if (	pl->data[dN].sub[sN].busy == SUBTRACT_BINARY_SUBTRACTION
-				|| pl->data[dN].sub[sN].busy == SUBTRACT_BINARY_ADDITION
-				|| pl->data[dN].sub[sN].busy == SUBTRACT_BINARY_MULTIPLICATION
-				|| pl->data[dN].sub[sN].busy == SUBTRACT_BINARY_HYPOTENUSE) {
+		if (pl->data[dN].column_N != 0) {
 
-			if (		cN == pl->data[dN].sub[sN].op.binary.column_X
-					|| cN == pl->data[dN].sub[sN].op.binary.column_Y) {
+			rN = pl->data[dN].head_N;
+			id_N = pl->data[dN].id_N;
 
-				linked = 1;
-				break;
-			}
-		}
-		else if (	pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_DIFFERENCE
-				|| pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_CUMULATIVE) {
+			rN_end = pl->data[dN].tail_N;
 
-			if (		cN == pl->data[dN].sub[sN].op.filter.column_X
-					|| cN == pl->data[dN].sub[sN].op.filter.column_Y) {
+			if (rN != rN_end) {
 
-				linked = 1;
-				break;
-			}
-		}
-		else if (	pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_BITMASK
-				|| pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_LOW_PASS) {
+				/* All subtracts are computed in one pass per chunk
+				 * so each compressed chunk is fetched only once.
+				 * */
+				plotDataSubtractWrite(pl, dN, 0, PLOT_SUBTRACT - 1, rN, id_N, rN_end);
 
-			if (cN == pl->data[dN].sub[sN].op.filter.column_Y) {
+				pl->data[dN].sub_N = rN_end;
 
-				linked = 1;
-				break;
+				plotDataSubtractResampleSeq(pl, dN);
 			}
-		}
-		else if (pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_MEDIAN) {
-
-			if (cN == pl->data[dN].sub[sN].op.median.column_Y) {
 
-				linked = 1;
-				break;
-			}
+			pl->data[dN].sub_paused = 0;
 		}
 	}
+}
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
-
-		if (pl->figure[fN].busy != 0) {
+static void
+plotDataMonotonicTrack(plot_t *pl, int dN, const fval_t *rows, int n)
+{
+	pmono_t		*mo;
+	double		last;
+	int		cN, rN, N;
 
-			if (		cN == pl->figure[fN].column_X
-					|| cN == pl->figure[fN].column_Y) {
+	cN = pl->data[dN].column_N;
 
-				linked = 1;
-				break;
-			}
+	for (N = 0; N < cN; ++N) {
 
-			dNf = pl->figure[fN].data_N;
+		mo = &pl->data[dN].mono[N];
 
-			for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+		if (mo->monotonic == 0)
+			continue;
 
-				if (pl->data[dNf].sub[sN].busy == SUBTRACT_RESAMPLE) {
+		last = mo->last;
 
-					if (		dN == pl->data[dNf].sub[sN].op.resample.in_data_N
-							&& cN == pl->data[dNf].sub[sN].op.resample.in_column_X) {
+		for (rN = 0; rN < n; ++rN) {
 
-						linked = 1;
-						break;
-					}
-					else if (	dN == pl->data[dNf].sub[sN].op.resample.in_data_N
-							&& cN == pl->data[dNf].sub[sN].op.resample.in_column_Y) {
+			if (		   fp_isfinite(rows[rN * cN + N]) == 0
+					|| (mo->started != 0 && rows[rN * cN + N] < last)) {
 
-						linked = 1;
-						break;
-					}
-				}
+				mo->monotonic = 0;
+				break;
 			}
 
-			if (linked != 0)
-				break;
+			last = rows[rN * cN + N];
+			mo->started = 1;
 		}
-	}
 
-	return linked;
+		mo->last = last;
+	}
 }
 
-static void
-plotSubtractGarbage(plot_t *pl, int dN)
+void plotDataInsertBlock(plot_t *pl, int dN, const fval_t *rows, int n)
 {
-	int		sN, cN, N;
+	fval_t		*place;
+	int		cN, lN, hN, tN, kN, jN, sN, bN, N;
 
-	do {
-		N = 0;
+	cN = pl->data[dN].column_N;
+	lN = pl->data[dN].length_N;
+	tN = pl->data[dN].tail_N;
 
-		for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+	if (pl->data[dN].mono != NULL) {
 
-			if (pl->data[dN].sub[sN].busy != SUBTRACT_FREE) {
+		plotDataMonotonicTrack(pl, dN, rows, n);
+	}
 
-				cN = sN + pl->data[dN].column_N;
+	while (n > 0) {
 
-				if (plotCheckColumnLinked(pl, dN, cN) == 0) {
+		kN = tN >> pl->data[dN].chunk_SHIFT;
+		jN = tN & pl->data[dN].chunk_MASK;
 
-					pl->data[dN].sub[sN].busy = SUBTRACT_FREE;
+		/* Take the rest of chunk but do not go across the end of ring
+		 * buffer. So the chunk is prepared only once per segment.
+		 * */
+		bN = pl->data[dN].chunk_MASK + 1 - jN;
+		bN = (bN > lN - tN) ? lN - tN : bN;
+		bN = (bN > n) ? n : bN;
 
-					N++;
-				}
-			}
+		if (pl->data[dN].lz4_compress != 0) {
+
+			plotDataChunkWrite(pl, dN, kN);
 		}
-	}
-	while (N != 0);
-}
 
-static int
-plotSubtractOriginal(plot_t *pl, int dN, int cN)
-{
-	int		fN, sN, cN1, modified;
+		if (		   pl->rcache_append_data_N != dN
+				|| pl->rcache_append_chunk_N != kN) {
 
-	sN = cN - pl->data[dN].column_N;
+			plotDataRangeCacheAppend(pl, dN, kN, jN);
 
-	if (		sN >= 0 && sN < PLOT_SUBTRACT
-			&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+			pl->rcache_append_data_N = dN;
+			pl->rcache_append_chunk_N = kN;
+		}
 
-		cN1 = pl->data[dN].sub[sN].op.scale.column_X;
-		modified = pl->data[dN].sub[sN].op.scale.modified;
+		place = pl->data[dN].raw[kN];
 
-		if (modified == 0) {
+		if (place == NULL)
+			break;
 
-			if (		pl->data[dN].sub[sN].op.scale.scale == (double) 1.
-					&& pl->data[dN].sub[sN].op.scale.offset == (double) 0.) {
+		if (pl->data[dN].columnar != 0) {
 
-				cN = cN1;
-				goto plotSubtractMerge_END;
-			}
-		}
+			fval_t		*column;
+			int		rN, cSTEP;
 
-		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+			cSTEP = pl->data[dN].column_STEP;
+			place += jN;
 
-			if (		pl->figure[fN].busy != 0
-					&& dN == pl->figure[fN].data_N
-					&& cN != pl->figure[fN].column_X) {
+			for (N = 0; N < cN; ++N) {
 
-				sN = pl->figure[fN].column_X - pl->data[dN].column_N;
+				column = place + N * cSTEP;
 
-				if (		sN >= 0 && sN < PLOT_SUBTRACT
-						&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+				for (rN = 0; rN < bN; ++rN)
+					column[rN] = rows[rN * cN + N];
+			}
 
-					if (		cN1 == pl->data[dN].sub[sN].op.scale.column_X
-							&& modified == pl->data[dN].sub[sN].op.scale.modified) {
+			for (N = cN; N < cN + PLOT_SUBTRACT; ++N)
+				memset(place + N * cSTEP, 0, bN * sizeof(fval_t));
+		}
+		else {
+			place += (cN + PLOT_SUBTRACT) * jN;
 
-						if (plotDataCompareMatch(pl, dN, cN, pl->figure[fN].column_X) == 0) {
+			for (N = 0; N < bN; ++N) {
 
-							cN = pl->figure[fN].column_X;
-							goto plotSubtractMerge_END;
-						}
-					}
-				}
+				memcpy(place, rows + N * cN, cN * sizeof(fval_t));
+				memset(place + cN, 0, PLOT_SUBTRACT * sizeof(fval_t));
+
+				place += cN + PLOT_SUBTRACT;
 			}
+		}
 
-			if (		pl->figure[fN].busy != 0
-					&& dN == pl->figure[fN].data_N
-					&& cN != pl->figure[fN].column_Y) {
+		if (pl->data[dN].stat_head != NULL) {
 
-				sN = pl->figure[fN].column_Y - pl->data[dN].column_N;
+			plotDataStatAppend(pl, dN, kN, jN, rows, bN);
+		}
 
-				if (		sN >= 0 && sN < PLOT_SUBTRACT
-						&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+		for (N = 0; N < bN; ++N) {
 
-					if (		cN1 == pl->data[dN].sub[sN].op.scale.column_X
-							&& modified == pl->data[dN].sub[sN].op.scale.modified) {
+			tN = (tN < lN - 1) ? tN + 1 : 0;
+			hN = pl->data[dN].head_N;
 
-						if (plotDataCompareMatch(pl, dN, cN, pl->figure[fN].column_Y) == 0) {
+			if (hN == tN) {
 
-							cN = pl->figure[fN].column_Y;
-							goto plotSubtractMerge_END;
-						}
-					}
-				}
+				pl->data[dN].id_N++;
+
+				hN = (hN < lN - 1) ? hN + 1 : 0;
+				pl->data[dN].head_N = hN;
+
+				sN = pl->data[dN].sub_N;
+				pl->data[dN].sub_N = (sN == tN) ? hN : sN;
 			}
 		}
-	}
 
-plotSubtractMerge_END:
+		pl->data[dN].tail_N = tN;
 
-	return cN;
+		rows += bN * cN;
+		n -= bN;
+	}
 }
 
-void plotTotalSubtractGarbage(plot_t *pl)
+void plotDataInsert(plot_t *pl, int dN, const fval_t *row)
 {
-	int		N, fN, dN, sN, cNX, cNY;
+	plotDataInsertBlock(pl, dN, row, 1);
+}
 
-	do {
-		N = 0;
+void plotDataClean(plot_t *pl, int dN)
+{
+	int		N;
 
-		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	if (pl->data[dN].column_N != 0) {
 
-			if (pl->figure[fN].busy != 0) {
+		pl->data[dN].column_N = 0;
+		pl->data[dN].length_N = 0;
 
-				dN = pl->figure[fN].data_N;
+		if (pl->data[dN].lz4_compress != 0) {
 
-				cNX = pl->figure[fN].column_X;
-				cNY = pl->figure[fN].column_Y;
+			plotDataJobDrain(pl, dN);
 
-				cNX = plotSubtractOriginal(pl, dN, cNX);
-				cNY = plotSubtractOriginal(pl, dN, cNY);
+			for (N = 0; N < PLOT_CHUNK_CACHE; ++N) {
 
-				pl->figure[fN].column_X = cNX;
-				pl->figure[fN].column_Y = cNY;
+				if (pl->data[dN].cache[N].raw) {
+
+					free(pl->data[dN].cache[N].raw);
+
+					pl->data[dN].cache[N].raw = NULL;
+				}
 			}
-		}
 
-		for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+			for (N = 0; N < pl->data[dN].chunk_MAX; ++N) {
 
-			if (pl->data[dN].sub[sN].busy != SUBTRACT_FREE) {
+				pl->data[dN].raw[N] = NULL;
 
-				cNX = sN + pl->data[dN].column_N;
+				if (pl->data[dN].compress[N].raw != NULL) {
 
-				if (plotCheckColumnLinked(pl, dN, cNX) == 0) {
+					plotDataSpillUnlink(pl, dN, N);
 
-					pl->data[dN].sub[sN].busy = SUBTRACT_FREE;
+					free(pl->data[dN].compress[N].raw);
 
-					N++;
+					pl->data[dN].compress[N].raw = NULL;
 				}
 			}
-		}
-	}
-	while (N != 0);
-}
 
-void plotFigureRemove(plot_t *pl, int fN)
-{
-	int		N, aN, on_X = 1, on_Y = 1;
-
-	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
-
-		ERROR("Figure number is out of range\n");
-		return ;
-	}
-
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
-
-		if (pl->figure[N].busy != 0 && N != fN) {
+			for (N = 0; N < PLOT_LZ4_JOB_MAX; ++N) {
 
-			if (pl->figure[N].axis_X == pl->figure[fN].axis_X)
-				on_X = 0;
+				if (pl->data[dN].lz4_job[N].raw != NULL) {
 
-			if (pl->figure[N].axis_Y == pl->figure[fN].axis_Y)
-				on_Y = 0;
-		}
-	}
+					free(pl->data[dN].lz4_job[N].raw);
 
-	pl->figure[fN].busy = 0;
+					pl->data[dN].lz4_job[N].raw = NULL;
+				}
 
-	if (on_X != 0) {
+				if (pl->data[dN].lz4_job[N].reserved != NULL) {
 
-		aN = pl->figure[fN].axis_X;
+					free(pl->data[dN].lz4_job[N].reserved);
 
-		if (pl->on_X == aN) {
+					pl->data[dN].lz4_job[N].reserved = NULL;
+				}
 
-			for (N = 0; N < PLOT_AXES_MAX; ++N) {
+				if (pl->data[dN].lz4_job[N].packed != NULL) {
 
-				if (N != aN && pl->axis[N].busy == AXIS_BUSY_X
-						&& pl->axis[N].slave == 0) {
+					free(pl->data[dN].lz4_job[N].packed);
 
-					pl->on_X = N;
-					break;
+					pl->data[dN].lz4_job[N].packed = NULL;
 				}
 			}
 		}
+		else {
+			for (N = 0; N < pl->data[dN].chunk_MAX; ++N) {
 
-		if (pl->on_X != aN) {
-
-			plotAxisRemove(pl, aN);
-		}
-	}
-
-	if (on_Y != 0) {
-
-		aN = pl->figure[fN].axis_Y;
-
-		if (pl->on_Y == aN) {
-
-			for (N = 0; N < PLOT_AXES_MAX; ++N) {
+				if (pl->data[dN].raw[N] != NULL) {
 
-				if (N != aN && pl->axis[N].busy == AXIS_BUSY_Y
-						&& pl->axis[N].slave == 0) {
+					free(pl->data[dN].raw[N]);
 
-					pl->on_Y = N;
-					break;
+					pl->data[dN].raw[N] = NULL;
 				}
 			}
 		}
 
-		if (pl->on_Y != aN) {
+		for (N = 0; N < PLOT_SUBTRACT; ++N) {
 
-			plotAxisRemove(pl, aN);
+			plotDataMedianFree(&pl->data[dN].sub[N].window);
 		}
-	}
 
-	plotSubtractGarbage(pl, pl->figure[fN].data_N);
-}
+		free(pl->data[dN].map - 1);
 
-void plotFigureGarbage(plot_t *pl, int dN)
-{
-	int		fN;
+		pl->data[dN].map = NULL;
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+		if (pl->data[dN].mono != NULL) {
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].data_N == dN) {
+			free(pl->data[dN].mono);
 
-			plotFigureRemove(pl, fN);
+			pl->data[dN].mono = NULL;
 		}
-	}
-}
-
-void plotFigureMoveAxes(plot_t *pl, int fN)
-{
-	int		N, aN, rX = 1, rY = 1;
 
-	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
-
-		ERROR("Figure number is out of range\n");
-		return ;
-	}
+		for (N = 0; N < pl->data[dN].chunk_MAX; ++N) {
 
-	if (pl->on_X < 0 || pl->on_X >= PLOT_AXES_MAX)
-		return ;
+			if (pl->data[dN].stat[N].column != NULL) {
 
-	if (pl->on_Y < 0 || pl->on_Y >= PLOT_AXES_MAX)
-		return ;
+				free(pl->data[dN].stat[N].column);
 
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+				pl->data[dN].stat[N].column = NULL;
+			}
+		}
 
-		if (pl->figure[N].busy != 0 && N != fN) {
+		if (pl->data[dN].stat_head != NULL) {
 
-			if (pl->figure[N].axis_X == pl->figure[fN].axis_X)
-				rX = 0;
+			free(pl->data[dN].stat_head);
 
-			if (pl->figure[N].axis_Y == pl->figure[fN].axis_Y)
-				rY = 0;
+			pl->data[dN].stat_head = NULL;
+			pl->data[dN].stat_split = NULL;
 		}
-	}
-
-	if (pl->figure[fN].axis_X != pl->on_X) {
 
-		aN = pl->figure[fN].axis_X;
-		pl->figure[fN].axis_X = pl->on_X;
+		if (pl->data[dN].spill_fd != NULL) {
 
-		if (rX != 0) {
+			fclose(pl->data[dN].spill_fd);
 
-			plotAxisRemove(pl, aN);
+			pl->data[dN].spill_fd = NULL;
+			pl->data[dN].spill_end = 0;
 		}
-	}
 
-	if (pl->figure[fN].axis_Y != pl->on_Y) {
+		pl->data[dN].spill_failed = 0;
 
-		aN = pl->figure[fN].axis_Y;
-		pl->figure[fN].axis_Y = pl->on_Y;
+		free(pl->data[dN].compress);
+		free(pl->data[dN].raw);
+		free(pl->data[dN].stat);
 
-		if (rY != 0) {
+		pl->data[dN].compress = NULL;
+		pl->data[dN].raw = NULL;
+		pl->data[dN].stat = NULL;
 
-			plotAxisRemove(pl, aN);
-		}
+		pl->data[dN].chunk_MAX = 0;
 	}
 }
 
 static int
-plotGetFreeAxis(plot_t *pl)
+plotDataRangeCacheGetNode(plot_t *pl, int dN, int cN)
 {
-	int		N, aN = -1;
+	int		N, xN = -1;
 
-	for (N = 0; N < PLOT_AXES_MAX; ++N) {
+	for (N = 0; N < PLOT_RCACHE_SIZE; ++N) {
 
-		if (pl->axis[N].busy == AXIS_FREE) {
+		if (		pl->rcache[N].busy != 0
+				&& pl->rcache[N].data_N == dN
+				&& pl->rcache[N].column_N == cN) {
 
-			aN = N;
+			xN = N;
 			break;
 		}
 	}
 
-	return aN;
+	return xN;
 }
 
-void plotFigureMakeIndividualAxes(plot_t *pl, int fN)
+void plotDataRangeCacheClean(plot_t *pl, int dN)
 {
-	int		N, aN, rX = 1, rY = 1;
-
-	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+	int		N;
 
-		ERROR("Figure number is out of range\n");
-		return ;
-	}
+	plotSketchStreamBreak(pl, dN, -1);
+	plotDataPolyfitWipe(pl, dN, -1, -1);
 
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+	for (N = 0; N < pl->data[dN].chunk_MAX; ++N) {
 
-		if (pl->figure[N].busy != 0 && N != fN) {
+		plotDataStatWipe(pl, dN, N, -1, -1);
+	}
 
-			if (pl->figure[N].axis_X == pl->figure[fN].axis_X)
-				rX = 0;
+	for (N = 0; N < PLOT_RCACHE_SIZE; ++N) {
 
-			if (pl->figure[N].axis_Y == pl->figure[fN].axis_Y)
-				rY = 0;
-		}
+		if (pl->rcache[N].data_N == dN)
+			pl->rcache[N].busy = 0;
 	}
+}
 
-	if (rX == 0) {
+void plotDataRangeCacheSubtractClean(plot_t *pl)
+{
+	int		N, dN;
 
-		aN = plotGetFreeAxis(pl);
+	for (N = 0; N < PLOT_RCACHE_SIZE; ++N) {
 
-		if (aN != -1) {
+		if (pl->rcache[N].busy != 0) {
 
-			N = pl->figure[fN].axis_X;
+			dN = pl->rcache[N].data_N;
 
-			pl->axis[aN].busy = AXIS_BUSY_X;
-			pl->figure[fN].axis_X = aN;
+			if (		dN >= 0 && dN < PLOT_DATASET_MAX
+					&& pl->data[dN].column_N != 0) {
 
-			plotAxisScaleAuto(pl, aN);
-			plotAxisLabel(pl, aN, pl->axis[N].label);
-		}
-		else {
-			ERROR("Unable to get free axis on X\n");
-			return ;
+				if (pl->rcache[N].column_N >= pl->data[dN].column_N)
+					pl->rcache[N].busy = 0;
+			}
 		}
 	}
 
-	if (rY == 0) {
-
-		aN = plotGetFreeAxis(pl);
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-		if (aN != -1) {
+		if (pl->data[dN].column_N != 0) {
 
-			N = pl->figure[fN].axis_Y;
+			plotDataPolyfitWipe(pl, dN, -1, pl->data[dN].column_N);
 
-			pl->axis[aN].busy = AXIS_BUSY_Y;
-			pl->figure[fN].axis_Y = aN;
+			for (N = 0; N < pl->data[dN].chunk_MAX; ++N) {
 
-			plotAxisScaleAuto(pl, aN);
-			plotAxisLabel(pl, aN, pl->axis[N].label);
-		}
-		else {
-			ERROR("Unable to get free axis on Y\n");
-			return ;
+				plotDataStatWipe(pl, dN, N, -1, pl->data[dN].column_N);
+			}
 		}
 	}
 }
 
-void plotFigureExchange(plot_t *pl, int fN, int fN_1)
+int plotDataRangeCacheFetch(plot_t *pl, int dN, int cN)
 {
-	char		backup[sizeof(pl->figure[0])];
-
-	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
-
-		ERROR("Figure number is out of range\n");
-		return ;
-	}
-
-	if (fN_1 < 0 || fN_1 >= PLOT_FIGURE_MAX) {
+	void		*chunk;
+	int		N, xN, kMAX;
 
-		ERROR("Figure number (exchange) is out of range\n");
-		return ;
-	}
+	xN = plotDataRangeCacheGetNode(pl, dN, cN);
 
-	memcpy(backup, &pl->figure[fN_1], sizeof(pl->figure[0]));
-	memcpy(&pl->figure[fN_1], &pl->figure[fN], sizeof(pl->figure[0]));
-	memcpy(&pl->figure[fN], backup, sizeof(pl->figure[0]));
-}
+	if (xN < 0) {
 
-int plotFigureSelected(plot_t *pl)
-{
-	int		fN, N = 0;
+		xN = pl->rcache_ID;
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+		pl->rcache_ID = (pl->rcache_ID < PLOT_RCACHE_SIZE - 1)
+			? pl->rcache_ID + 1 : 0;
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0) {
+		for (N = 0; N < pl->rcache[xN].chunk_MAX; ++N) {
 
-			N++;
+			pl->rcache[xN].chunk[N].lod_N = 0;
 		}
-	}
 
-	return N;
-}
+		pl->rcache[xN].busy = 1;
+		pl->rcache[xN].data_N = dN;
+		pl->rcache[xN].column_N = cN;
+	}
 
-int plotFigureAnyData(plot_t *pl)
-{
-	int		fN, dN = 0;
+	kMAX = pl->data[dN].chunk_MAX;
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	if (pl->rcache[xN].chunk_MAX < kMAX) {
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0) {
+		chunk = realloc(pl->rcache[xN].chunk, sizeof(pl->rcache[0].chunk[0]) * kMAX);
 
-			dN = pl->figure[fN].data_N;
-			break;
-		}
-	}
+		if (chunk == NULL) {
 
-	return dN;
-}
+			ERROR("Unable to allocate LOD table of %i dataset\n", dN);
 
-int plotFigureHaveData(plot_t *pl, int dN)
-{
-	int		fN, N = 0;
+			pl->rcache[xN].busy = 0;
+			return -1;
+		}
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+		pl->rcache[xN].chunk = chunk;
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].data_N == dN) {
+		memset(pl->rcache[xN].chunk + pl->rcache[xN].chunk_MAX, 0,
+				sizeof(pl->rcache[0].chunk[0]) * (kMAX - pl->rcache[xN].chunk_MAX));
 
-			N++;
-		}
+		pl->rcache[xN].chunk_MAX = kMAX;
 	}
 
-	return N;
+	return xN;
 }
 
 static int
-plotGetSubtractTimeMedianByMatch(plot_t *pl, int dN, int cNX, int length, int unwrap)
+plotDataLodFetch(plot_t *pl, int xN, int kN)
 {
-	int		sN, rN = -1;
+	const fval_t	*raw;
+	fval_t		*lod, *low, fval, fmin, fmax;
 
-	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+	int		dN, cN, N, jN, bN, lN, hN, rSTEP, cSTEP, finite;
 
-		if (		pl->data[dN].sub[sN].busy == SUBTRACT_TIME_MEDIAN
-				&& pl->data[dN].sub[sN].op.median.column_X == cNX
-				&& pl->data[dN].sub[sN].op.median.length == length
-				&& pl->data[dN].sub[sN].op.median.unwrap == unwrap) {
+	Uint64		tSTART;
 
-			rN = sN;
-			break;
-		}
-	}
+	dN = pl->rcache[xN].data_N;
+	cN = pl->rcache[xN].column_N;
 
-	return rN;
-}
+	hN = (pl->data[dN].chunk_MASK + 1) >> PLOT_LOD_SHIFT;
 
-static int
-plotGetSubtractScaleByMatch(plot_t *pl, int dN, int cN, double scale, double offset)
-{
-	int		sN, rN = -1;
+	if (cN < 0 || hN < 1)
+		return 0;
 
-	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+	/* Only the complete buckets of lowest level are built.
+	 * */
+	lN = pl->data[dN].length_N - (kN << pl->data[dN].chunk_SHIFT);
+	lN = (lN > pl->data[dN].chunk_MASK + 1) ? pl->data[dN].chunk_MASK + 1 : lN;
 
-		if (		pl->data[dN].sub[sN].busy == SUBTRACT_SCALE
-				&& pl->data[dN].sub[sN].op.scale.column_X == cN
-				&& pl->data[dN].sub[sN].op.scale.scale == scale
-				&& pl->data[dN].sub[sN].op.scale.offset == offset) {
+	if (kN == plotDataChunkN(pl, dN, pl->data[dN].tail_N)) {
 
-			rN = sN;
-			break;
-		}
+		lN = pl->data[dN].tail_N & pl->data[dN].chunk_MASK;
 	}
 
-	return rN;
-}
+	bN = lN >> PLOT_LOD_SHIFT;
 
-static int
-plotGetFreeSubtract(plot_t *pl, int dN)
-{
-	int		sN, rN = -1;
+	if (pl->rcache[xN].chunk[kN].lod_N >= bN)
+		return pl->rcache[xN].chunk[kN].lod_N;
 
-	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+	tSTART = SDL_GetPerformanceCounter();
 
-		if (pl->data[dN].sub[sN].busy == 0) {
+	if (pl->rcache[xN].chunk[kN].lod_size < hN * 8) {
 
-			rN = sN;
-			break;
-		}
-	}
+		if (pl->rcache[xN].chunk[kN].lod != NULL)
+			free(pl->rcache[xN].chunk[kN].lod);
 
-	return rN;
-}
+		pl->rcache[xN].chunk[kN].lod = (fval_t *) malloc(sizeof(fval_t) * hN * 8);
+		pl->rcache[xN].chunk[kN].lod_size = 0;
+		pl->rcache[xN].chunk[kN].lod_N = 0;
 
-tuple_t plotGetSubtractTimeMedian(plot_t *pl, int dN, int cNX, int cNY, int length, int unwrap, int opdata)
-{
-	tuple_t		uN = { -1, -1 };
-	int		sNX, sNY;
+		if (pl->rcache[xN].chunk[kN].lod == NULL) {
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+			ERROR("Unable to allocate memory of %i LOD chunk\n", kN);
+			return 0;
+		}
 
-		ERROR("Dataset number is out of range\n");
-		return uN;
+		pl->rcache[xN].chunk[kN].lod_size = hN * 8;
 	}
 
-	if (length < 1 || length > PLOT_MEDIAN_MAX) {
+	if (pl->data[dN].lz4_compress != 0) {
 
-		ERROR("Median length %i is out of range\n", length);
-		return uN;
+		plotDataChunkFetch(pl, dN, kN);
 	}
 
-	sNX = plotGetSubtractTimeMedianByMatch(pl, dN, cNX, length, unwrap);
-
-	if (sNX < 0) {
-
-		sNX = plotGetFreeSubtract(pl, dN);
-
-		if (sNX < 0) {
+	raw = pl->data[dN].raw[kN];
 
-			ERROR("Unable to get free subtract\n");
-			return uN;
-		}
+	if (raw == NULL)
+		return 0;
 
-		pl->data[dN].sub[sNX].busy = SUBTRACT_TIME_MEDIAN;
-		pl->data[dN].sub[sNX].op.median.column_X = cNX;
-		pl->data[dN].sub[sNX].op.median.length = length;
-		pl->data[dN].sub[sNX].op.median.unwrap = unwrap;
-		pl->data[dN].sub[sNX].op.median.opdata = 0;
-	}
+	rSTEP = pl->data[dN].row_STEP;
+	cSTEP = pl->data[dN].column_STEP;
 
-	sNY = plotGetFreeSubtract(pl, dN);
+	lod = pl->rcache[xN].chunk[kN].lod;
+	lN = pl->rcache[xN].chunk[kN].lod_N;
 
-	if (sNY < 0) {
+	for (N = lN; N < bN; ++N) {
 
-		ERROR("Unable to get free subtract\n");
-		return uN;
-	}
+		const fval_t	*row = raw + (N << PLOT_LOD_SHIFT) * rSTEP + cN * cSTEP;
 
-	pl->data[dN].sub[sNY].busy = SUBTRACT_DATA_MEDIAN;
-	pl->data[dN].sub[sNY].op.median.column_X = cNX;
-	pl->data[dN].sub[sNY].op.median.column_Y = cNY;
-	pl->data[dN].sub[sNY].op.median.column_T = sNX + pl->data[dN].column_N;
-	pl->data[dN].sub[sNY].op.median.length = length;
-	pl->data[dN].sub[sNY].op.median.unwrap = unwrap;
-	pl->data[dN].sub[sNY].op.median.opdata = opdata;
+		finite = 1;
 
-	plotDataSubtractCompute(pl, dN, sNY);
+		fmin = row[0];
+		fmax = row[0];
 
-	uN.X = sNX + pl->data[dN].column_N;
-	uN.Y = sNY + pl->data[dN].column_N;
+		for (jN = 0; jN < (1 << PLOT_LOD_SHIFT); ++jN) {
 
-	return uN;
-}
+			fval = row[jN * rSTEP];
 
-int plotGetSubtractScale(plot_t *pl, int dN, int cN, double scale, double offset)
-{
-	int		sN;
+			if (fp_isfinite(fval)) {
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+				fmin = (fval < fmin) ? fval : fmin;
+				fmax = (fval > fmax) ? fval : fmax;
+			}
+			else {
+				finite = 0;
+			}
+		}
 
-		ERROR("Dataset number is out of range\n");
-		return -1;
+		lod[N * 4 + 0] = (finite != 0) ? fmin : FP_NAN;
+		lod[N * 4 + 1] = (finite != 0) ? fmax : FP_NAN;
+		lod[N * 4 + 2] = row[0];
+		lod[N * 4 + 3] = row[(jN - 1) * rSTEP];
 	}
 
-	sN = plotGetSubtractScaleByMatch(pl, dN, cN, scale, offset);
+	pl->rcache[xN].chunk[kN].lod_N = bN;
 
-	if (sN < 0) {
+	/* Merge the upper levels from pairs of the lower ones. Any bucket
+	 * with a non-finite value is marked by NaN.
+	 * */
+	while (hN > 1) {
 
-		sN = cN - pl->data[dN].column_N;
+		low = lod;
+		lod += hN * 4;
 
-		if (		sN >= 0 && sN < PLOT_SUBTRACT
-				&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+		hN >>= 1;
+		lN >>= 1;
+		bN >>= 1;
 
-			offset = scale * pl->data[dN].sub[sN].op.scale.offset + offset;
-			scale *= pl->data[dN].sub[sN].op.scale.scale;
+		for (N = lN; N < bN; ++N) {
 
-			pl->data[dN].sub[sN].op.scale.scale = scale;
-			pl->data[dN].sub[sN].op.scale.offset = offset;
-		}
-		else {
-			sN = plotGetFreeSubtract(pl, dN);
+			if (		fp_isfinite(low[N * 8 + 0])
+					&& fp_isfinite(low[N * 8 + 4])) {
 
-			if (sN < 0) {
+				fmin = low[N * 8 + 0];
+				fmax = low[N * 8 + 1];
 
-				ERROR("Unable to get free subtract\n");
-				return -1;
+				fmin = (low[N * 8 + 4] < fmin) ? low[N * 8 + 4] : fmin;
+				fmax = (low[N * 8 + 5] > fmax) ? low[N * 8 + 5] : fmax;
+
+				lod[N * 4 + 0] = fmin;
+				lod[N * 4 + 1] = fmax;
+			}
+			else {
+				lod[N * 4 + 0] = FP_NAN;
+				lod[N * 4 + 1] = FP_NAN;
 			}
 
-			pl->data[dN].sub[sN].busy = SUBTRACT_SCALE;
-			pl->data[dN].sub[sN].op.scale.column_X = cN;
-			pl->data[dN].sub[sN].op.scale.modified = 0;
-			pl->data[dN].sub[sN].op.scale.scale = scale;
-			pl->data[dN].sub[sN].op.scale.offset = offset;
+			lod[N * 4 + 2] = low[N * 8 + 2];
+			lod[N * 4 + 3] = low[N * 8 + 7];
 		}
-
-		plotDataSubtractCompute(pl, dN, sN);
 	}
 
-	cN = sN + pl->data[dN].column_N;
+	pl->rcache_wipe_data_N = -1;
+	pl->rcache_wipe_chunk_N = -1;
+	pl->rcache_append_data_N = -1;
+	pl->rcache_append_chunk_N = -1;
 
-	return cN;
+	pl->perf.rcache += SDL_GetPerformanceCounter() - tSTART;
+
+	return pl->rcache[xN].chunk[kN].lod_N;
 }
 
 static int
-plotGetSubtractClone(plot_t *pl, int dN, int cN)
+plotDataLodGet(plot_t *pl, int dN, int xNR, int yNR, int rN, int id_N,
+		double scale_X, double scale_Y, double vbox[8])
 {
-	int		sN, modified = 0;
+	const fval_t	*lod_X, *lod_Y;
+	fval_t		fbox[8];
 
-	sN = cN - pl->data[dN].column_N;
-
-	if (		sN >= 0 && sN < PLOT_SUBTRACT
-			&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+	int		xN, yN, kN, jN, hN, bN, tN, lN, N, size, lod_N = 0;
 
-		modified = pl->data[dN].sub[sN].op.scale.modified;
-	}
+	if (xNR < 0 || yNR < 0)
+		return 0;
 
-	sN = plotGetFreeSubtract(pl, dN);
+	jN = rN & pl->data[dN].chunk_MASK;
 
-	if (sN < 0) {
+	if ((jN & ((1 << PLOT_LOD_SHIFT) - 1)) != 0)
+		return 0;
 
-		ERROR("Unable to get free subtract\n");
-		return -1;
-	}
+	kN = plotDataChunkN(pl, dN, rN);
 
-	pl->data[dN].sub[sN].busy = SUBTRACT_SCALE;
-	pl->data[dN].sub[sN].op.scale.column_X = cN;
-	pl->data[dN].sub[sN].op.scale.modified = modified;
-	pl->data[dN].sub[sN].op.scale.scale = (double) 1.;
-	pl->data[dN].sub[sN].op.scale.offset = (double) 0.;
+	tN = pl->data[dN].tail_N - rN;
+	tN += (tN < 0) ? pl->data[dN].length_N : 0;
 
-	plotDataSubtractCompute(pl, dN, sN);
+	xN = pl->rcache[xNR].column_N;
+	yN = pl->rcache[yNR].column_N;
 
-	cN = sN + pl->data[dN].column_N;
+	hN = (pl->data[dN].chunk_MASK + 1) >> PLOT_LOD_SHIFT;
+	bN = hN;
 
-	return cN;
-}
+	if (xN >= 0) {
 
-int plotGetSubtractResample(plot_t *pl, int dN, int cNX, int in_dN, int in_cNX, int in_cNY)
-{
-	int		sN, cN;
+		lN = plotDataLodFetch(pl, xNR, kN);
+		bN = (lN < bN) ? lN : bN;
+	}
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+	if (yN >= 0) {
 
-		ERROR("Dataset number is out of range\n");
-		return -1;
+		lN = plotDataLodFetch(pl, yNR, kN);
+		bN = (lN < bN) ? lN : bN;
 	}
 
-	sN = plotGetFreeSubtract(pl, dN);
-
-	if (sN < 0) {
+	lod_X = pl->rcache[xNR].chunk[kN].lod;
+	lod_Y = pl->rcache[yNR].chunk[kN].lod;
 
-		ERROR("Unable to get free subtract\n");
-		return -1;
-	}
+	jN >>= PLOT_LOD_SHIFT;
+	size = 1 << PLOT_LOD_SHIFT;
 
-	pl->data[dN].sub[sN].busy = SUBTRACT_RESAMPLE;
-	pl->data[dN].sub[sN].op.resample.column_X = cNX;
-	pl->data[dN].sub[sN].op.resample.in_data_N = in_dN;
-	pl->data[dN].sub[sN].op.resample.in_column_X = in_cNX;
-	pl->data[dN].sub[sN].op.resample.in_column_Y = in_cNY;
+	/* Go up to the coarsest bucket that starts at this row and is still
+	 * narrower than one pixel along one of the axes.
+	 * */
+	do {
+		if (jN >= bN || size > tN)
+			break;
 
-	plotDataSubtractCompute(pl, dN, sN);
+		if (xN >= 0) {
 
-	cN = sN + pl->data[dN].column_N;
+			fbox[0] = lod_X[jN * 4 + 0];
+			fbox[1] = lod_X[jN * 4 + 1];
+			fbox[4] = lod_X[jN * 4 + 2];
+			fbox[6] = lod_X[jN * 4 + 3];
+		}
+		else {
+			fbox[0] = (fval_t) id_N;
+			fbox[1] = (fval_t) (id_N + size - 1);
+			fbox[4] = fbox[0];
+			fbox[6] = fbox[1];
+		}
 
-	return cN;
-}
+		if (yN >= 0) {
 
-int plotGetSubtractBinary(plot_t *pl, int dN, int opSUB, int cN1, int cN2)
-{
-	int		sN, cN;
+			fbox[2] = lod_Y[jN * 4 + 0];
+			fbox[3] = lod_Y[jN * 4 + 1];
+			fbox[5] = lod_Y[jN * 4 + 2];
+			fbox[7] = lod_Y[jN * 4 + 3];
+		}
+		else {
+			fbox[2] = (fval_t) id_N;
+			fbox[3] = (fval_t) (id_N + size - 1);
+			fbox[5] = fbox[2];
+			fbox[7] = fbox[3];
+		}
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+		if (		fp_isfinite(fbox[0]) == 0
+				|| fp_isfinite(fbox[2]) == 0)
+			break;
 
-		ERROR("Dataset number is out of range\n");
-		return -1;
-	}
+		if (		(fbox[1] - fbox[0]) * fabs(scale_X) > 1.
+				&& (fbox[3] - fbox[2]) * fabs(scale_Y) > 1.)
+			break;
 
-	if (cN1 < -1 || cN1 >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+		for (N = 0; N < 8; ++N)
+			vbox[N] = fbox[N];
 
-		ERROR("Column number %i is out of range\n", cN1);
-		return -1;
-	}
+		lod_N = size;
 
-	if (cN2 < -1 || cN2 >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+		if ((jN & 1) != 0 || hN < 2)
+			break;
 
-		ERROR("Column number %i is out of range\n", cN2);
-		return -1;
-	}
+		if (xN >= 0)
+			lod_X += hN * 4;
 
-	sN = plotGetFreeSubtract(pl, dN);
+		if (yN >= 0)
+			lod_Y += hN * 4;
 
-	if (sN < 0) {
+		hN >>= 1;
+		jN >>= 1;
+		bN >>= 1;
 
-		ERROR("Unable to get free subtract\n");
-		return -1;
+		size <<= 1;
 	}
+	while (1);
 
-	pl->data[dN].sub[sN].busy = opSUB;
-	pl->data[dN].sub[sN].op.binary.column_X = cN1;
-	pl->data[dN].sub[sN].op.binary.column_Y = cN2;
-
-	plotDataSubtractCompute(pl, dN, sN);
-
-	cN = sN + pl->data[dN].column_N;
-
-	return cN;
+	return lod_N;
 }
 
-int plotGetSubtractFilter(plot_t *pl, int dN, int cNX, int cNY, int opSUB, double gain)
+static void
+plotDataRangeGet(plot_t *pl, int dN, int cN, double *pmin, double *pmax)
 {
-	int		sN;
-
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+	plotDataStatFetch(pl, dN, cN, pmin, pmax);
+}
 
-		ERROR("Dataset number is out of range\n");
-		return -1;
-	}
+static void
+plotDataRangeCond(plot_t *pl, int dN, int cN, int cN_cond, int *pflag,
+		double scale, double offset, double *pmin, double *pmax)
+{
+	const fval_t	*row;
+	const pstat_t	*st_X, *st_Y;
 
-	if (cNX < -1 || cNX >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+	double		fval, fmin, fmax, fcond, vmin, vmax, ymin, ymax;
+	int		kN, rN, id_N, job, started, cSTEP;
 
-		ERROR("Column number %i is out of range\n", cNX);
-		return -1;
-	}
+	cSTEP = pl->data[dN].column_STEP;
 
-	if (cNY < -1 || cNY >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+	started = *pflag;
+	fmin = *pmin;
+	fmax = *pmax;
 
-		ERROR("Column number %i is out of range\n", cNY);
-		return -1;
-	}
+	plotDataStatFetch(pl, dN, cN_cond, &vmin, &vmax);
+	plotDataStatFetch(pl, dN, cN, &ymin, &ymax);
 
-	sN = plotGetFreeSubtract(pl, dN);
+	vmin = vmin * scale + offset;
+	vmax = vmax * scale + offset;
 
-	if (sN < 0) {
+	if (		   vmin >= 0. && vmin <= 1.
+			&& vmax >= 0. && vmax <= 1.) {
 
-		ERROR("Unable to get free subtract\n");
-		return -1;
-	}
+		if (started != 0) {
 
-	pl->data[dN].sub[sN].busy = opSUB;
-	pl->data[dN].sub[sN].op.filter.column_X = cNX;
-	pl->data[dN].sub[sN].op.filter.column_Y = cNY;
-	pl->data[dN].sub[sN].op.filter.gain = gain;
+			fmin = (ymin < fmin) ? ymin : fmin;
+			fmax = (ymax > fmax) ? ymax : fmax;
+		}
+		else {
+			started = 1;
 
-	plotDataSubtractCompute(pl, dN, sN);
+			fmin = ymin;
+			fmax = ymax;
+		}
 
-	cNY = sN + pl->data[dN].column_N;
+		*pflag = started;
+		*pmin = fmin;
+		*pmax = fmax;
 
-	return cNY;
-}
+		return ;
+	}
 
-int plotGetSubtractMedian(plot_t *pl, int dN, int cN, int opSUB, int length)
-{
-	int		sN;
+	rN = pl->data[dN].head_N;
+	id_N = pl->data[dN].id_N;
 
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+	do {
+		kN = plotDataChunkN(pl, dN, rN);
+		job = 1;
 
-		ERROR("Dataset number is out of range\n");
-		return -1;
-	}
+		st_X = plotDataStatChunk(pl, dN, kN, cN_cond);
+		st_Y = plotDataStatChunk(pl, dN, kN, cN);
 
-	if (cN < -1 || cN >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+		if (st_X != NULL) {
 
-		ERROR("Column number %i is out of range\n", cN);
-		return -1;
-	}
+			if (st_X->finite != 0) {
 
-	if (length < 1 || length > PLOT_MEDIAN_MAX) {
+				vmin = st_X->fmin * scale + offset;
+				vmax = st_X->fmax * scale + offset;
 
-		ERROR("Median length %i is out of range\n", length);
-		return -1;
-	}
+				if (		st_Y != NULL
+						&& vmin >= 0. && vmin <= 1.
+						&& vmax >= 0. && vmax <= 1.) {
 
-	sN = plotGetFreeSubtract(pl, dN);
+					job = 0;
 
-	if (sN < 0) {
+					if (st_Y->finite != 0) {
 
-		ERROR("Unable to get free subtract\n");
-		return -1;
-	}
+						if (started != 0) {
 
-	pl->data[dN].sub[sN].busy = opSUB;
-	pl->data[dN].sub[sN].op.median.column_Y = cN;
-	pl->data[dN].sub[sN].op.median.length = length;
-	pl->data[dN].sub[sN].op.median.unwrap = 0;
-	pl->data[dN].sub[sN].op.median.opdata = 0;
+							fmin = (st_Y->fmin < fmin)
+								? st_Y->fmin : fmin;
 
-	plotDataSubtractCompute(pl, dN, sN);
+							fmax = (st_Y->fmax > fmax)
+								? st_Y->fmax : fmax;
+						}
+						else {
+							started = 1;
 
-	cN = sN + pl->data[dN].column_N;
+							fmin = st_Y->fmin;
+							fmax = st_Y->fmax;
+						}
+					}
+				}
+				else if (vmin > 1. || vmax < 0.) {
 
-	return cN;
-}
+					job = 0;
+				}
+			}
+			else {
+				job = 0;
+			}
+		}
 
-int plotGetFreeFigure(plot_t *pl)
-{
-	int		N, fN = -1;
+		if (job != 0) {
 
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+			do {
+				if (kN != plotDataChunkN(pl, dN, rN))
+					break;
 
-		if (pl->figure[N].busy == 0) {
+				row = plotDataGet(pl, dN, &rN);
 
-			fN = N;
-			break;
-		}
-	}
+				if (row == NULL)
+					break;
 
-	return fN;
-}
+				fval = (cN < 0) ? id_N : row[cN * cSTEP];
+				fcond = (cN_cond < 0) ? id_N : row[cN_cond * cSTEP];
 
-int plotFigureSubtractGetMedianConfig(plot_t *pl, int fN, int *length, int *unwrap, int *opdata)
-{
-	int		dN, cN, sN;
+				fcond = fcond * scale + offset;
 
-	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+				if (fcond >= 0. && fcond <= 1.) {
 
-		ERROR("Figure number is out of range\n");
-		return -1;
-	}
+					if (fp_isfinite(fval)) {
 
-	dN = pl->figure[fN].data_N;
-	cN = pl->figure[fN].column_Y;
+						if (started != 0) {
 
-	sN = cN - pl->data[dN].column_N;
+							fmin = (fval < fmin) ? fval : fmin;
+							fmax = (fval > fmax) ? fval : fmax;
+						}
+						else {
+							started = 1;
 
-	if (		sN >= 0 && sN < PLOT_SUBTRACT
-			&& pl->data[dN].sub[sN].busy == SUBTRACT_DATA_MEDIAN) {
+							fmin = fval;
+							fmax = fval;
+						}
+					}
+				}
 
-		*length = pl->data[dN].sub[sN].op.median.length;
-		*unwrap = pl->data[dN].sub[sN].op.median.unwrap;
-		*opdata = pl->data[dN].sub[sN].op.median.opdata;
+				id_N++;
+			}
+			while (1);
+		}
+		else {
+			plotDataChunkSkip(pl, dN, &rN, &id_N);
+		}
 
-		return sN;
+		if (rN == pl->data[dN].tail_N)
+			break;
 	}
+	while (1);
 
-	return -1;
+	*pflag = started;
+	*pmin = fmin;
+	*pmax = fmax;
 }
 
-void plotFigureSubtractTimeMedian(plot_t *pl, int fN, int length, int unwrap, int opdata)
+static int
+plotDataRangeAxis(plot_t *pl, int dN, int cN, int aN, double *pmin, double *pmax)
 {
-	tuple_t		uN;
-	int		dN, cNX, cNY, sN;
-
-	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+	double		scale, offset, fmin, fmax;
+	int		xN, yN, fN, cN_cond, job, started;
 
-		ERROR("Figure number is out of range\n");
-		return ;
-	}
+	started = 0;
 
-	dN = pl->figure[fN].data_N;
-	cNX = pl->figure[fN].column_X;
-	cNY = pl->figure[fN].column_Y;
+	fmin = 0.;
+	fmax = 0.;
 
-	if (length < 1) {
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-		sN = cNY - pl->data[dN].column_N;
+		job = 0;
 
-		if (		sN >= 0 && sN < PLOT_SUBTRACT
-				&& pl->data[dN].sub[sN].busy == SUBTRACT_DATA_MEDIAN) {
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0
+				&& pl->figure[fN].data_N == dN) {
 
-			cNX = pl->data[dN].sub[sN].op.median.column_X;
-			cNY = pl->data[dN].sub[sN].op.median.column_Y;
+			if (		pl->figure[fN].axis_X == aN
+					&& pl->figure[fN].column_Y == cN) {
 
-			pl->figure[fN].column_X = cNX;
-			pl->figure[fN].column_Y = cNY;
+				scale = 1.;
+				offset = 0.;
 
-			plotSubtractGarbage(pl, dN);
-		}
-	}
-	else {
-		sN = cNY - pl->data[dN].column_N;
+				cN_cond = pl->figure[fN].column_X;
+				job = 1;
+			}
+			else if (	pl->figure[fN].axis_Y == aN
+					&& pl->figure[fN].column_X == cN) {
 
-		if (		sN >= 0 && sN < PLOT_SUBTRACT
-				&& pl->data[dN].sub[sN].busy == SUBTRACT_DATA_MEDIAN) {
+				scale = 1.;
+				offset = 0.;
 
-			if (		pl->data[dN].sub[sN].op.median.length != length
-					|| pl->data[dN].sub[sN].op.median.unwrap != unwrap
-					|| pl->data[dN].sub[sN].op.median.opdata != opdata) {
+				cN_cond = pl->figure[fN].column_Y;
+				job = 1;
+			}
 
-				cNX = pl->data[dN].sub[sN].op.median.column_X;
-				cNY = pl->data[dN].sub[sN].op.median.column_Y;
+			xN = pl->figure[fN].axis_X;
+			yN = pl->figure[fN].axis_Y;
 
-				pl->figure[fN].column_X = cNX;
-				pl->figure[fN].column_Y = cNY;
+			if (		pl->axis[xN].slave != 0
+					&& pl->axis[xN].slave_N == aN
+					&& pl->figure[fN].column_Y == cN) {
 
-				plotSubtractGarbage(pl, dN);
+				scale = pl->axis[xN].scale;
+				offset = pl->axis[xN].offset;
 
-				uN = plotGetSubtractTimeMedian(pl, dN, cNX, cNY, length, unwrap, opdata);
+				cN_cond = pl->figure[fN].column_X;
+				job = 1;
+			}
+			else if (	pl->axis[yN].slave != 0
+					&& pl->axis[yN].slave_N == aN
+					&& pl->figure[fN].column_X == cN) {
 
-				if (uN.X != -1) {
+				scale = pl->axis[yN].scale;
+				offset = pl->axis[yN].offset;
 
-					pl->figure[fN].column_X = uN.X;
-					pl->figure[fN].column_Y = uN.Y;
-				}
+				cN_cond = pl->figure[fN].column_Y;
+				job = 1;
 			}
 		}
-		else {
-			uN = plotGetSubtractTimeMedian(pl, dN, cNX, cNY, length, unwrap, opdata);
 
-			if (uN.X != -1) {
+		if (job != 0) {
 
-				pl->figure[fN].column_X = uN.X;
-				pl->figure[fN].column_Y = uN.Y;
-			}
+			scale *= pl->axis[aN].scale;
+			offset = offset * pl->axis[aN].scale + pl->axis[aN].offset;
+
+			plotDataRangeCond(pl, dN, cN, cN_cond, &started,
+					scale, offset, &fmin, &fmax);
 		}
 	}
+
+	*pmin = fmin;
+	*pmax = fmax;
+
+	return started;
 }
 
-void plotFigureSubtractScale(plot_t *pl, int fN, int aBUSY, double scale, double offset)
+static const fval_t *
+plotDataSliceGet(plot_t *pl, int dN, int cN, double fdot, int *m_id_N)
 {
-	int		dN, cN;
+	const fval_t	*row;
+	const pstat_t	*st;
 
-	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+	double		fval, fbest, fmin, fmax, fneard;
+	int		lN, rN, id_N, kN, kN_rep, best_N;
+	int		job, started, span, cSTEP, N, iN;
 
-		ERROR("Figure number is out of range\n");
-		return ;
-	}
+	cSTEP = pl->data[dN].column_STEP;
 
-	dN = pl->figure[fN].data_N;
+	plotDataStatFetch(pl, dN, cN, NULL, NULL);
 
-	if (aBUSY == AXIS_BUSY_X) {
+	if (plotDataMonotonic(pl, dN, cN) != 0) {
 
-		cN = plotGetSubtractScale(pl, dN, pl->figure[fN].column_X, scale, offset);
+		N = plotDataLength(pl, dN);
 
-		if (cN != -1) {
+		if (N < 1)
+			return NULL;
 
-			pl->figure[fN].column_X = cN;
-		}
-	}
-	else if (aBUSY == AXIS_BUSY_Y) {
+		iN = plotDataMonotonicFind(pl, dN, cN, 1, fdot);
 
-		cN = plotGetSubtractScale(pl, dN, pl->figure[fN].column_Y, scale, offset);
+		/* Take the nearest of two rows around the found one. In case of
+		 * equal values the first row is taken.
+		 * */
+		if (iN > 0) {
 
-		if (cN != -1) {
+			fval = plotDataMonotonicValue(pl, dN, cN, iN - 1);
 
-			pl->figure[fN].column_Y = cN;
-		}
-	}
-}
+			if (		iN >= N
+					|| fdot - fval <= plotDataMonotonicValue(pl, dN, cN, iN) - fdot) {
 
-static int
-plotFigureSubtractAdd(plot_t *pl, int fN, int fN_1, int fN_2, int opSUB)
-{
-	const char	*label_1, *label_2, *delim;
-	int		dN, aNX, aNY, cNX, cNY;
+				iN = plotDataMonotonicFind(pl, dN, cN, 1, fval);
+			}
+		}
 
-	dN = pl->figure[fN_1].data_N;
+		*m_id_N = pl->data[dN].id_N + iN;
 
-	cNX = pl->figure[fN_1].column_X;
-	aNX = pl->figure[fN_1].axis_X;
+		lN = pl->data[dN].length_N;
 
-	if (aNX != pl->figure[fN_2].axis_X) {
+		rN = pl->data[dN].head_N + iN;
+		rN = (rN > lN - 1) ? rN - lN : rN;
 
-		ERROR("Both figures must be on the same axis on X\n");
-		return 0;
+		return plotDataGet(pl, dN, &rN);
 	}
 
-	if (		dN != pl->figure[fN_2].data_N
-			|| cNX != pl->figure[fN_2].column_X) {
+	rN = pl->data[dN].head_N;
+	id_N = pl->data[dN].id_N;
 
-		cNY = plotGetSubtractResample(pl, dN, cNX,
-				pl->figure[fN_2].data_N,
-				pl->figure[fN_2].column_X,
-				pl->figure[fN_2].column_Y);
+	kN_rep = -1;
 
-		if (cNY < 0) {
+	started = 0;
+	span = 0;
 
-			ERROR("Unable to get resample subtract\n");
-			return 0;
-		}
-	}
-	else {
-		cNY = pl->figure[fN_2].column_Y;
-	}
+	do {
+		kN = plotDataChunkN(pl, dN, rN);
+		job = 1;
 
-	cNY = plotGetSubtractBinary(pl, dN, opSUB, pl->figure[fN_1].column_Y, cNY);
+		st = plotDataStatChunk(pl, dN, kN, cN);
 
-	if (cNY < 0) {
+		if (st != NULL) {
 
-		return 0;
-	}
+			if (st->finite != 0) {
 
-	aNY = plotGetFreeAxis(pl);
+				fmin = st->fmin;
+				fmax = st->fmax;
 
-	if (aNY != -1) {
+				if (fdot < fmin || fdot > fmax) {
 
-		pl->axis[aNY].busy = AXIS_BUSY_Y;
-		plotAxisLabel(pl, aNY, pl->axis[pl->figure[fN_1].axis_Y].label);
-	}
-	else {
-		aNY = pl->figure[fN_1].axis_Y;
-	}
+					job = 0;
 
-	plotFigureAdd(pl, fN, dN, cNX, cNY, aNX, aNY, "");
+					fmin = fabs(fmin - fdot);
+					fmax = fabs(fmax - fdot);
 
-	label_1 = pl->figure[fN_1].label;
-	label_2 = pl->figure[fN_2].label;
+					if (kN_rep >= 0) {
 
-	delim = strrchr(label_1, ' ');
-	label_1 = (delim != NULL) ? delim + 1 : label_1;
+						if (fmin < fneard) {
 
-	delim = strrchr(label_2, ' ');
-	label_2 = (delim != NULL) ? delim + 1 : label_2;
+							fneard = fmin;
+							kN_rep = kN;
+						}
 
-	if (opSUB == SUBTRACT_BINARY_SUBTRACTION) {
+						if (fmax < fneard) {
 
-		sprintf(pl->figure[fN].label, "R: %.35s - %.35s", label_1, label_2);
-	}
-	else if (opSUB == SUBTRACT_BINARY_ADDITION) {
+							fneard = fmax;
+							kN_rep = kN;
+						}
+					}
+					else {
+						fneard = (fmin < fmax)
+							? fmin : fmax;
 
-		sprintf(pl->figure[fN].label, "A: %.35s + %.35s", label_1, label_2);
-	}
-	else if (opSUB == SUBTRACT_BINARY_MULTIPLICATION) {
+						kN_rep = kN;
+					}
+				}
+			}
+			else {
+				job = 0;
+			}
+		}
 
-		sprintf(pl->figure[fN].label, "X: %.35s * %.35s", label_1, label_2);
-	}
-	else if (opSUB == SUBTRACT_BINARY_HYPOTENUSE) {
+		if (job != 0) {
 
-		sprintf(pl->figure[fN].label, "H: %.35s ~ %.35s", label_1, label_2);
-	}
+			span++;
 
-	pl->figure[fN].drawing = pl->figure[fN_1].drawing;
-	pl->figure[fN].width = pl->figure[fN_1].width;
+			do {
+				if (kN != plotDataChunkN(pl, dN, rN))
+					break;
 
-	return AXIS_BUSY_Y;
-}
+				row = plotDataGet(pl, dN, &rN);
 
-void plotFigureSubtractFilter(plot_t *pl, int fN_1, int opSUB, double gain)
-{
-	int		fN, dN, cNX, cNY, aN;
+				if (row == NULL)
+					break;
 
-	if (fN_1 < 0 || fN_1 >= PLOT_FIGURE_MAX) {
+				fval = (cN < 0) ? id_N : row[cN * cSTEP];
 
-		ERROR("Figure number is out of range\n");
-		return ;
-	}
+				if (fp_isfinite(fval)) {
 
-	dN = pl->figure[fN_1].data_N;
-	cNX = pl->figure[fN_1].column_X;
-	cNY = pl->figure[fN_1].column_Y;
+					fval = fabs(fdot - fval);
 
-	fN = plotGetFreeFigure(pl);
+					if (started != 0) {
 
-	if (fN < 0) {
+						if (fval < fbest) {
 
-		ERROR("Unable to get free figure to subtract\n");
-		return ;
-	}
+							fbest = fval;
+							best_N = id_N;
+						}
+					}
+					else {
+						started = 1;
 
-	if (opSUB == SUBTRACT_FILTER_MEDIAN) {
+						fbest = fval;
+						best_N = id_N;
+					}
+				}
 
-		cNY = plotGetSubtractMedian(pl, dN, cNY, opSUB, (int) gain);
-	}
-	else {
-		cNY = plotGetSubtractFilter(pl, dN, cNX, cNY, opSUB, gain);
-	}
+				id_N++;
+			}
+			while (1);
 
-	if (cNY < 0) {
+			if (span >= PLOT_SLICE_SPAN)
+				break;
+		}
+		else {
+			plotDataChunkSkip(pl, dN, &rN, &id_N);
+		}
 
-		return ;
+		if (rN == pl->data[dN].tail_N)
+			break;
 	}
+	while (1);
 
-	if (		opSUB == SUBTRACT_FILTER_LOW_PASS
-			|| opSUB == SUBTRACT_FILTER_MEDIAN) {
+	if (		started == 0
+			&& kN_rep >= 0) {
 
-		aN = pl->figure[fN_1].axis_Y;
-	}
-	else {
-		aN = plotGetFreeAxis(pl);
+		rN = pl->data[dN].head_N;
+		id_N = pl->data[dN].id_N;
 
-		if (aN != -1) {
+		do {
+			kN = plotDataChunkN(pl, dN, rN);
+			job = 1;
 
-			pl->axis[aN].busy = AXIS_BUSY_Y;
-			plotAxisLabel(pl, aN, pl->axis[pl->figure[fN_1].axis_Y].label);
-		}
-		else {
-			aN = pl->figure[fN_1].axis_Y;
-		}
-	}
+			if (kN == kN_rep) {
 
-	plotFigureAdd(pl, fN, dN, cNX, cNY, pl->figure[fN_1].axis_X, aN, "");
+				do {
+					if (kN != plotDataChunkN(pl, dN, rN))
+						break;
 
-	if (opSUB == SUBTRACT_FILTER_DIFFERENCE) {
+					row = plotDataGet(pl, dN, &rN);
 
-		sprintf(pl->figure[fN].label, "D: %.75s", pl->figure[fN_1].label);
-	}
-	else if (opSUB == SUBTRACT_FILTER_CUMULATIVE) {
+					if (row == NULL)
+						break;
 
-		sprintf(pl->figure[fN].label, "I: %.75s", pl->figure[fN_1].label);
-	}
-	else if (opSUB == SUBTRACT_FILTER_BITMASK) {
+					fval = (cN < 0) ? id_N : row[cN * cSTEP];
 
-		int	bf[2] = { 0, (int) gain };
+					if (fp_isfinite(fval)) {
 
-		bf[0] = bf[1] & 0xFFU;
-		bf[1] = bf[1] >> 8;
+						fval = fabs(fdot - fval);
 
-		if (bf[0] == bf[1]) {
+						if (started != 0) {
 
-			sprintf(pl->figure[fN].label, "B(%d): %.75s",
-					(int) bf[0], pl->figure[fN_1].label);
-		}
-		else {
-			sprintf(pl->figure[fN].label, "B(%d-%d): %.75s",
-					(int) bf[0], (int) bf[1], pl->figure[fN_1].label);
+							if (fval < fbest) {
+
+								fbest = fval;
+								best_N = id_N;
+							}
+						}
+						else {
+							started = 1;
+
+							fbest = fval;
+							best_N = id_N;
+						}
+					}
+
+					id_N++;
+				}
+				while (1);
+			}
+			else {
+				plotDataChunkSkip(pl, dN, &rN, &id_N);
+			}
+
+			if (rN == pl->data[dN].tail_N)
+				break;
 		}
+		while (1);
 	}
-	else if (opSUB == SUBTRACT_FILTER_LOW_PASS) {
 
-		sprintf(pl->figure[fN].label, "L(%.2E): %.75s",
-				gain, pl->figure[fN_1].label);
-	}
-	else if (opSUB == SUBTRACT_FILTER_MEDIAN) {
+	if (started != 0) {
 
-		sprintf(pl->figure[fN].label, "M(%d): %.75s",
-				(int) gain, pl->figure[fN_1].label);
-	}
+		*m_id_N = best_N;
 
-	pl->figure[fN].drawing = pl->figure[fN_1].drawing;
-	pl->figure[fN].width = pl->figure[fN_1].width;
+		lN = pl->data[dN].length_N;
 
-	if (opSUB == SUBTRACT_FILTER_LOW_PASS) {
+		rN = pl->data[dN].head_N + (best_N - pl->data[dN].id_N);
+		rN = (rN > lN - 1) ? rN - lN : rN;
 
-		/* Do nothing */
+		row = plotDataGet(pl, dN, &rN);
 	}
 	else {
-		plotAxisScaleAutoCond(pl, pl->figure[fN].axis_Y, pl->figure[fN].axis_X);
+		row = NULL;
+	}
 
-		pl->on_X = pl->figure[fN].axis_X;
-		pl->on_Y = pl->figure[fN].axis_Y;
+	return row;
+}
 
-		if (pl->axis[pl->on_X].slave != 0) {
+static const fval_t *
+plotDataPickGet(plot_t *pl, int dN, int cNX, int cNY,
+		double fdot_X, double fdot_Y,
+		double tol_X, double tol_Y, int *m_id_N)
+{
+	const fval_t	*row;
+	const pstat_t	*st_X, *st_Y;
 
-			pl->on_X = pl->axis[pl->on_X].slave_N;
-		}
+	double		fval_X, fval_Y, fbest, fmin, fmax;
+	int		lN, rN, id_N, id_N_end, kN, best_N;
+	int		job, started, span, cSTEP, iN;
 
-		if (pl->axis[pl->on_Y].slave != 0) {
+	cSTEP = pl->data[dN].column_STEP;
 
-			pl->on_Y = pl->axis[pl->on_Y].slave_N;
-		}
-	}
-}
+	plotDataStatFetch(pl, dN, cNX, NULL, NULL);
+	plotDataStatFetch(pl, dN, cNY, NULL, NULL);
 
-static void
-plotFigureSubtractBinaryLinked(plot_t *pl, int fN, int opSUB, int fNP[2])
-{
-	int		dN, dN1, sN, sE, cN, cN1, fN_1, fN_2;
+	rN = pl->data[dN].head_N;
+	id_N = pl->data[dN].id_N;
 
-	dN = pl->figure[fN].data_N;
-	sN = pl->figure[fN].column_Y - pl->data[dN].column_N;
+	id_N_end = id_N + plotDataLength(pl, dN);
 
-	fN_1 = -1;
-	fN_2 = -1;
+	if (plotDataMonotonic(pl, dN, cNX) != 0) {
 
-	if (		sN >= 0 && sN < PLOT_SUBTRACT
-			&& pl->data[dN].sub[sN].busy == opSUB) {
+		/* Look only through the rows that are within tolerance on X.
+		 * */
+		iN = plotDataMonotonicFind(pl, dN, cNX, 1, fdot_X - tol_X);
+		id_N_end = id_N + plotDataMonotonicFind(pl, dN, cNX, 1, fdot_X + tol_X);
 
-		cN = pl->data[dN].sub[sN].op.binary.column_X;
-		sE = cN - pl->data[dN].column_N;
+		plotDataSkip(pl, dN, &rN, &id_N, iN);
+	}
 
-		dN1 = dN;
-		cN1 = cN;
+	started = 0;
+	span = 0;
 
-		if (		sE >= 0 && sE < PLOT_SUBTRACT
-				&& pl->data[dN].sub[sE].busy == SUBTRACT_RESAMPLE) {
+	while (id_N < id_N_end) {
 
-			dN1 = pl->data[dN].sub[sE].op.resample.in_data_N;
-			cN1 = pl->data[dN].sub[sE].op.resample.in_column_Y;
-		}
+		kN = plotDataChunkN(pl, dN, rN);
+		job = 1;
 
-		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+		st_X = plotDataStatChunk(pl, dN, kN, cNX);
+		st_Y = plotDataStatChunk(pl, dN, kN, cNY);
 
-			if (pl->figure[fN].busy != 0) {
+		if (st_X != NULL) {
 
-				if (		dN == pl->figure[fN].data_N
-						&& cN == pl->figure[fN].column_Y) {
+			if (st_X->finite != 0) {
 
-					fN_1 = fN;
-					break;
-				}
+				fmin = st_X->fmin;
+				fmax = st_X->fmax;
 
-				if (		dN1 == pl->figure[fN].data_N
-						&& cN1 == pl->figure[fN].column_Y) {
+				if (		   fdot_X < fmin - tol_X
+						|| fdot_X > fmax + tol_X) {
 
-					fN_1 = fN;
-					break;
+					job = 0;
 				}
 			}
+			else {
+				job = 0;
+			}
 		}
 
-		cN = pl->data[dN].sub[sN].op.binary.column_Y;
-		sE = cN - pl->data[dN].column_N;
+		if (st_Y != NULL) {
 
-		dN1 = dN;
-		cN1 = cN;
+			if (st_Y->finite != 0) {
 
-		if (		sE >= 0 && sE < PLOT_SUBTRACT
-				&& pl->data[dN].sub[sE].busy == SUBTRACT_RESAMPLE) {
+				fmin = st_Y->fmin;
+				fmax = st_Y->fmax;
 
-			dN1 = pl->data[dN].sub[sE].op.resample.in_data_N;
-			cN1 = pl->data[dN].sub[sE].op.resample.in_column_Y;
-		}
+				if (		   fdot_Y < fmin - tol_Y
+						|| fdot_Y > fmax + tol_Y) {
 
-		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+					job = 0;
+				}
+			}
+			else {
+				job = 0;
+			}
+		}
 
-			if (pl->figure[fN].busy != 0) {
+		if (job != 0) {
 
-				if (		dN == pl->figure[fN].data_N
-						&& cN == pl->figure[fN].column_Y) {
+			span++;
 
-					fN_2 = fN;
+			do {
+				if (		   kN != plotDataChunkN(pl, dN, rN)
+						|| id_N >= id_N_end)
 					break;
-				}
 
-				if (		dN1 == pl->figure[fN].data_N
-						&& cN1 == pl->figure[fN].column_Y) {
+				row = plotDataGet(pl, dN, &rN);
 
-					fN_2 = fN;
+				if (row == NULL)
 					break;
-				}
-			}
-		}
-	}
 
-	fNP[0] = fN_1;
-	fNP[1] = fN_2;
-}
+				fval_X = (cNX < 0) ? id_N : row[cNX * cSTEP];
+				fval_Y = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-void plotFigureSubtractSwitch(plot_t *pl, int opSUB)
-{
-	int		fN, fN_1, fN_2, fNQ[2], rBUSY, N = 0;
+				if (		   fp_isfinite(fval_X)
+						&& fp_isfinite(fval_Y)) {
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+					fval_X = fabs(fdot_X - fval_X);
+					fval_Y = fabs(fdot_Y - fval_Y);
 
-		if (pl->figure[fN].busy != 0 && pl->figure[fN].hidden == 0) {
+					if (		   fval_X < tol_X
+							&& fval_Y < tol_Y) {
 
-			if (N < 2) {
+						fval_X /= tol_X;
+						fval_Y /= tol_Y;
 
-				fNQ[N] = fN;
+						fval_X =  fval_X * fval_X
+							+ fval_Y * fval_Y;
+
+						if (started != 0) {
+
+							if (fval_X < fbest) {
+
+								fbest = fval_X;
+								best_N = id_N;
+							}
+						}
+						else {
+							started = 1;
+
+							fbest = fval_X;
+							best_N = id_N;
+						}
+					}
+				}
+
+				id_N++;
 			}
+			while (1);
 
-			N++;
+			if (span >= PLOT_SLICE_SPAN)
+				break;
 		}
+		else {
+			plotDataChunkSkip(pl, dN, &rN, &id_N);
+		}
+
+		if (rN == pl->data[dN].tail_N)
+			break;
 	}
 
-	if (N == 1) {
+	if (started != 0) {
 
-		fN = fNQ[0];
+		*m_id_N = best_N;
 
-		plotFigureSubtractBinaryLinked(pl, fN, opSUB, fNQ);
+		lN = pl->data[dN].length_N;
 
-		fN_1 = fNQ[0];
-		fN_2 = fNQ[1];
+		rN = pl->data[dN].head_N + (best_N - pl->data[dN].id_N);
+		rN = (rN > lN - 1) ? rN - lN : rN;
 
-		if (fN_1 != -1 && fN_2 != -1) {
+		row = plotDataGet(pl, dN, &rN);
+	}
+	else {
+		row = NULL;
+	}
 
-			pl->figure[fN].hidden = 1;
+	return row;
+}
 
-			pl->figure[fN_1].hidden = 0;
-			pl->figure[fN_2].hidden = 0;
+static void
+plotDataErase(plot_t *pl, int dN, int cNX, int cNY,
+		double fmin_X, double fmin_Y,
+		double fmax_X, double fmax_Y)
+{
+	fval_t		*row;
+	const pstat_t	*st_X, *st_Y;
 
-			pl->on_X = pl->figure[fN_1].axis_X;
-			pl->on_Y = pl->figure[fN_1].axis_Y;
-		}
-	}
-	else if (N == 2) {
+	double		fval_X, fval_Y, fmin, fmax;
+	int		rN, id_N, id_N_end, kN, job, cSTEP, iN;
 
-		fN_1 = fNQ[0];
-		fN_2 = fNQ[1];
+	cSTEP = pl->data[dN].column_STEP;
 
-		fN = -1;
+	plotDataStatFetch(pl, dN, cNX, NULL, NULL);
+	plotDataStatFetch(pl, dN, cNY, NULL, NULL);
 
-		for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+	rN = pl->data[dN].head_N;
+	id_N = pl->data[dN].id_N;
 
-			if (pl->figure[N].busy != 0) {
+	id_N_end = id_N + plotDataLength(pl, dN);
 
-				plotFigureSubtractBinaryLinked(pl, N, opSUB, fNQ);
+	if (plotDataMonotonic(pl, dN, cNX) != 0) {
 
-				if (fNQ[0] == fN_1 && fNQ[1] == fN_2) {
+		/* Look only through the rows that are within selection on X.
+		 * */
+		iN = plotDataMonotonicFind(pl, dN, cNX, 1, fmin_X);
+		id_N_end = id_N + plotDataMonotonicFind(pl, dN, cNX, 1, fmax_X);
 
-					fN = N;
-					break;
-				}
-
-				if (fNQ[0] == fN_2 && fNQ[1] == fN_1) {
-
-					fN = N;
-					break;
-				}
-			}
-		}
-
-		if (fN != -1) {
-
-			pl->figure[fN].hidden = 0;
-
-			pl->figure[fN_1].hidden = 1;
-			pl->figure[fN_2].hidden = 1;
+		plotDataSkip(pl, dN, &rN, &id_N, iN);
+	}
 
-			if (		pl->figure[fN].axis_X == pl->figure[fN_1].axis_X
-					&& pl->figure[fN].axis_X == pl->figure[fN_2].axis_X) {
+	/* Erased values are replaced by NaN so the columns are not monotonic
+	 * anymore.
+	 * */
+	if (		cNX >= 0 && cNX < pl->data[dN].column_N
+			&& pl->data[dN].mono != NULL) {
 
-				plotAxisScaleAutoCond(pl, pl->figure[fN].axis_Y,
-						pl->figure[fN].axis_X);
-			}
-			else if (	pl->figure[fN].axis_Y == pl->figure[fN_1].axis_Y
-					&& pl->figure[fN].axis_Y == pl->figure[fN_2].axis_Y) {
+		pl->data[dN].mono[cNX].monotonic = 0;
+	}
 
-				plotAxisScaleAutoCond(pl, pl->figure[fN].axis_X,
-						pl->figure[fN].axis_Y);
-			}
+	if (		cNY >= 0 && cNY < pl->data[dN].column_N
+			&& pl->data[dN].mono != NULL) {
 
-			pl->on_X = pl->figure[fN].axis_X;
-			pl->on_Y = pl->figure[fN].axis_Y;
-		}
-		else {
-			fN = plotGetFreeFigure(pl);
+		pl->data[dN].mono[cNY].monotonic = 0;
+	}
 
-			if (fN < 0) {
+	while (id_N < id_N_end) {
 
-				ERROR("Unable to get free figure to subtract\n");
-				return ;
-			}
+		kN = plotDataChunkN(pl, dN, rN);
+		job = 1;
 
-			rBUSY = plotFigureSubtractAdd(pl, fN, fN_1, fN_2, opSUB);
+		st_X = plotDataStatChunk(pl, dN, kN, cNX);
+		st_Y = plotDataStatChunk(pl, dN, kN, cNY);
 
-			if (rBUSY != 0) {
+		if (st_X != NULL) {
 
-				pl->figure[fN_1].hidden = 1;
-				pl->figure[fN_2].hidden = 1;
+			if (st_X->finite != 0) {
 
-				if (rBUSY == AXIS_BUSY_X) {
+				fmin = st_X->fmin;
+				fmax = st_X->fmax;
 
-					plotAxisScaleAutoCond(pl, pl->figure[fN].axis_X,
-							pl->figure[fN].axis_Y);
-				}
-				else if (rBUSY == AXIS_BUSY_Y) {
+				if (		   fmax_X < fmin
+						|| fmin_X > fmax) {
 
-					plotAxisScaleAutoCond(pl, pl->figure[fN].axis_Y,
-							pl->figure[fN].axis_X);
-				}
-				else {
-					plotAxisScaleAuto(pl, pl->figure[fN].axis_X);
-					plotAxisScaleAuto(pl, pl->figure[fN].axis_Y);
+					job = 0;
 				}
-
-				pl->on_X = pl->figure[fN].axis_X;
-				pl->on_Y = pl->figure[fN].axis_Y;
+			}
+			else {
+				job = 0;
 			}
 		}
-	}
-
-	if (pl->axis[pl->on_X].slave != 0) {
-
-		pl->on_X = pl->axis[pl->on_X].slave_N;
-	}
-
-	if (pl->axis[pl->on_Y].slave != 0) {
-
-		pl->on_Y = pl->axis[pl->on_Y].slave_N;
-	}
-}
-
-void plotTotalSubtractResample(plot_t *pl, int dN, double tmin, double tmax)
-{
-	double		scale, offset;
-	int		N, cNX, cNY;
-
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
-
-		ERROR("Dataset number is out of range\n");
-		return ;
-	}
-
-	if (pl->data[dN].column_N < 1) {
 
-		ERROR("Dataset %i is not allocated\n", dN);
-		return ;
-	}
+		if (st_Y != NULL) {
 
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+			if (st_Y->finite != 0) {
 
-		if (		pl->figure[N].busy != 0
-				&& pl->figure[N].hidden == 0) {
+				fmin = st_Y->fmin;
+				fmax = st_Y->fmax;
 
-			if (pl->figure[N].axis_X != pl->on_X) {
+				if (		   fmax_Y < fmin
+						|| fmin_Y > fmax) {
 
-				ERROR("All figures must be on the active axis on X\n");
-				return ;
+					job = 0;
+				}
+			}
+			else {
+				job = 0;
 			}
 		}
-	}
-
-	N = plotDataLength(pl, dN);
-
-	scale = (tmax - tmin) / (double) (N - 1);
-	offset = tmin;
 
-	cNX = plotGetSubtractScale(pl, dN, -1, scale, offset);
+		if (job != 0) {
 
-	if (cNX < 0)
-		return ;
+			do {
+				if (		   id_N >= id_N_end
+						|| kN != plotDataChunkN(pl, dN, rN))
+					break;
 
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+				row = plotDataWrite(pl, dN, &rN);
 
-		if (		pl->figure[N].busy != 0
-				&& pl->figure[N].hidden == 0) {
+				if (row == NULL)
+					break;
 
-			if (		dN != pl->figure[N].data_N
-					|| cNX != pl->figure[N].column_X) {
+				fval_X = (cNX < 0) ? id_N : row[cNX * cSTEP];
+				fval_Y = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-				cNY = plotGetSubtractResample(pl, dN, cNX,
-						pl->figure[N].data_N,
-						pl->figure[N].column_X,
-						pl->figure[N].column_Y);
+				if (		   fp_isfinite(fval_X)
+						&& fp_isfinite(fval_Y)) {
 
-				if (cNY < 0) {
+					if (		   fval_X > fmin_X && fval_X < fmax_X
+							&& fval_Y > fmin_Y && fval_Y < fmax_Y) {
 
-					ERROR("Unable to get resample subtract\n");
-					return ;
+						row[cNX * cSTEP] = FP_NAN;
+						row[cNY * cSTEP] = FP_NAN;
+					}
 				}
 
-				pl->figure[N].data_N = dN;
-				pl->figure[N].column_X = cNX;
-				pl->figure[N].column_Y = cNY;
+				id_N++;
 			}
+			while (1);
+		}
+		else {
+			plotDataChunkSkip(pl, dN, &rN, &id_N);
 		}
 	}
 }
 
-int plotDataBoxPolyfit(plot_t *pl, int fN)
+static int
+plotDataCompareMatch(plot_t *pl, int dN, int cN1, int cN2)
 {
-	int		N, dN, sN, N0, N1;
-	double		*coefs, std;
-
-	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
-
-		ERROR("Figure number is out of range\n");
-		return 0;
-	}
-
-	dN = pl->figure[fN].data_N;
-	sN = pl->figure[fN].column_Y - pl->data[dN].column_N;
+	const fval_t	*row;
 
-	if (sN < 0 || sN >= PLOT_SUBTRACT) {
+	double		X, Y;
+	int		N, rN, id_N, cSTEP;
 
-		return 0;
-	}
-	else if (pl->data[dN].sub[sN].busy != SUBTRACT_POLYFIT) {
+	rN = pl->data[dN].head_N;
+	id_N = pl->data[dN].id_N;
 
-		return 0;
-	}
+	cSTEP = pl->data[dN].column_STEP;
 
-	N0 = pl->data[dN].sub[sN].op.polyfit.poly_N0;
-	N1 = pl->data[dN].sub[sN].op.polyfit.poly_N1;
+	N = 0;
 
-	coefs = pl->data[dN].sub[sN].op.polyfit.coefs;
-	std = pl->data[dN].sub[sN].op.polyfit.std;
+	do {
+		row = plotDataGet(pl, dN, &rN);
 
-	for (N = 0; N < PLOT_DATA_BOX_MAX; ++N) {
+		if (row == NULL)
+			break;
 
-		pl->data_box_text[N][0] = 0;
+		X = (cN1 < 0) ? id_N : row[cN1 * cSTEP];
+		Y = (cN2 < 0) ? id_N : row[cN2 * cSTEP];
 
-		if (N == 0 && N1 == 0) {
+		if (fp_isfinite(X)) {
 
-			sprintf(pl->data_box_text[N], " [%i] = ", N);
-			plotDataBoxTextFmt(pl, N, coefs[N]);
-		}
-		else if (N < N1 - N0 + 1) {
+			if (fp_isfinite(Y)) {
 
-			char		sfmt[PLOT_STRING_MAX];
+				if (X != Y) {
 
-			sprintf(sfmt, " [%%i] = %% .%iE ", pl->fprecision - 1);
-			sprintf(pl->data_box_text[N], sfmt, N + N0, coefs[N]);
+					N++;
+				}
+			}
+			else {
+				N++;
+			}
 		}
-		else if (N == N1 - N0 + 1) {
+		else {
+			if (fp_isfinite(Y)) {
 
-			sprintf(pl->data_box_text[N], " STD = ");
-			plotDataBoxTextFmt(pl, N, std);
+				N++;
+			}
 		}
-	}
 
-	if (pl->data_box_on != DATA_BOX_POLYFIT) {
+		if (N >= 1)
+			break;
 
-		pl->data_box_on = DATA_BOX_POLYFIT;
-		pl->data_box_X = pl->viewport.max_x;
-		pl->data_box_Y = 0;
+		id_N++;
 	}
+	while (1);
 
-	return 1;
+	return N;
 }
 
-void plotFigureSubtractPolyfit(plot_t *pl, int fN_1, int N0, int N1)
-{
-	int		N, fN, dN, sN, cN, aN, bN;
-	double		scale_X, offset_X, scale_Y, offset_Y;
 
-	if (fN_1 < 0 || fN_1 >= PLOT_FIGURE_MAX) {
+void plotAxisLabel(plot_t *pl, int aN, const char *label)
+{
+	if (aN < 0 || aN >= PLOT_AXES_MAX) {
 
-		ERROR("Figure number is out of range\n");
+		ERROR("Axis number is out of range\n");
 		return ;
 	}
 
-	if (N0 < 0 || N0 > N1) {
-
-		ERROR("Polynomial base %i is out of range\n", N0);
-		return ;
-	}
+	if (label[0] != 0) {
 
-	if (N1 < 0 || N1 > PLOT_POLYFIT_MAX) {
+		strcpy(pl->axis[aN].label, label);
 
-		ERROR("Polynomial degree %i is out of range\n", N1);
-		return ;
+		pl->axis[aN].compact = (strlen(pl->axis[aN].label) >= 4) ? 0 : 1;
 	}
+}
 
-	fN = plotGetFreeFigure(pl);
+int plotAxisRangeGet(plot_t *pl, int aN, double *pmin, double *pmax)
+{
+	double		min, max, fmin, fmax, scale, offset;
+	int		fN, dN, cN, xN, yN, started = 0;
 
-	if (fN < 0) {
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-		ERROR("Unable to get free figure to subtract\n");
-		return ;
-	}
+		if (pl->figure[fN].busy != 0 && pl->figure[fN].hidden == 0) {
 
-	dN = pl->figure[fN_1].data_N;
-	sN = plotGetFreeSubtract(pl, dN);
+			dN = pl->figure[fN].data_N;
 
-	if (sN < 0) {
+			do {
+				if (pl->figure[fN].axis_X == aN) {
 
-		ERROR("Unable to get free subtract\n");
-		return ;
+					cN = pl->figure[fN].column_X;
+				}
+				else if (pl->figure[fN].axis_Y == aN) {
+
+					cN = pl->figure[fN].column_Y;
+				}
+				else
+					break;
+
+				plotDataRangeGet(pl, dN, cN, &min, &max);
+
+				if (started != 0) {
+
+					fmin = (min < fmin) ? min : fmin;
+					fmax = (max > fmax) ? max : fmax;
+				}
+				else {
+					started = 1;
+
+					fmin = min;
+					fmax = max;
+				}
+			}
+			while (0);
+
+			do {
+				xN = pl->figure[fN].axis_X;
+				yN = pl->figure[fN].axis_Y;
+
+				if (		pl->axis[xN].slave != 0
+						&& pl->axis[xN].slave_N == aN) {
+
+					cN = pl->figure[fN].column_X;
+
+					scale = pl->axis[xN].scale;
+					offset = pl->axis[xN].offset;
+				}
+				else if (	pl->axis[yN].slave != 0
+						&& pl->axis[yN].slave_N == aN) {
+
+					cN = pl->figure[fN].column_Y;
+
+					scale = pl->axis[yN].scale;
+					offset = pl->axis[yN].offset;
+				}
+				else
+					break;
+
+				plotDataRangeGet(pl, dN, cN, &min, &max);
+
+				min = min * scale + offset;
+				max = max * scale + offset;
+
+				if (started != 0) {
+
+					fmin = (min < fmin) ? min : fmin;
+					fmax = (max > fmax) ? max : fmax;
+				}
+				else {
+					started = 1;
+
+					fmin = min;
+					fmax = max;
+				}
+			}
+			while (0);
+		}
 	}
 
-	aN = pl->figure[fN_1].axis_X;
+	*pmin = fmin;
+	*pmax = fmax;
 
-	scale_X = pl->axis[aN].scale;
-	offset_X = pl->axis[aN].offset;
+	return started;
+}
 
-	if (pl->axis[aN].slave != 0) {
+static int
+plotAxisRangeCond(plot_t *pl, int aN, int bN, double *pmin, double *pmax)
+{
+	double		min, max, fmin, fmax, scale, offset;
+	int		fN, dN, cN, xN, yN, nN, started, cond;
 
-		bN = pl->axis[aN].slave_N;
-		scale_X *= pl->axis[bN].scale;
-		offset_X = offset_X * pl->axis[bN].scale + pl->axis[bN].offset;
+	started = 0;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (pl->figure[fN].busy != 0 && pl->figure[fN].hidden == 0) {
+
+			dN = pl->figure[fN].data_N;
+
+			do {
+				if (pl->figure[fN].axis_X == aN) {
+
+					cN = pl->figure[fN].column_X;
+					nN = pl->figure[fN].axis_Y;
+				}
+				else if (pl->figure[fN].axis_Y == aN) {
+
+					cN = pl->figure[fN].column_Y;
+					nN = pl->figure[fN].axis_X;
+				}
+				else
+					break;
+
+				if (bN >= 0) {
+
+					cond = plotDataRangeAxis(pl, dN, cN, bN, &min, &max);
+				}
+				else {
+					cond = plotDataRangeAxis(pl, dN, cN, nN, &min, &max);
+				}
+
+				if (cond != 0) {
+
+					if (started != 0) {
+
+						fmin = (min < fmin) ? min : fmin;
+						fmax = (max > fmax) ? max : fmax;
+					}
+					else {
+						started = 1;
+
+						fmin = min;
+						fmax = max;
+					}
+				}
+			}
+			while (0);
+
+			do {
+				xN = pl->figure[fN].axis_X;
+				yN = pl->figure[fN].axis_Y;
+
+				if (		pl->axis[xN].slave != 0
+						&& pl->axis[xN].slave_N == aN) {
+
+					cN = pl->figure[fN].column_X;
+					nN = pl->figure[fN].axis_Y;
+
+					scale = pl->axis[xN].scale;
+					offset = pl->axis[xN].offset;
+				}
+				else if (	pl->axis[yN].slave != 0
+						&& pl->axis[yN].slave_N == aN) {
+
+					cN = pl->figure[fN].column_Y;
+					nN = pl->figure[fN].axis_X;
+
+					scale = pl->axis[yN].scale;
+					offset = pl->axis[yN].offset;
+				}
+				else
+					break;
+
+
+				if (bN >= 0) {
+
+					cond = plotDataRangeAxis(pl, dN, cN, bN, &min, &max);
+				}
+				else {
+					cond = plotDataRangeAxis(pl, dN, cN, nN, &min, &max);
+				}
+
+				if (cond != 0) {
+
+					min = min * scale + offset;
+					max = max * scale + offset;
+
+					if (started != 0) {
+
+						fmin = (min < fmin) ? min : fmin;
+						fmax = (max > fmax) ? max : fmax;
+					}
+					else {
+						started = 1;
+
+						fmin = min;
+						fmax = max;
+					}
+				}
+			}
+			while (0);
+		}
 	}
 
-	aN = pl->figure[fN_1].axis_Y;
+	*pmin = fmin;
+	*pmax = fmax;
 
-	scale_Y = pl->axis[aN].scale;
-	offset_Y = pl->axis[aN].offset;
+	return started;
+}
 
-	if (pl->axis[aN].slave != 0) {
+void plotAxisScaleManual(plot_t *pl, int aN, double min, double max)
+{
+	if (aN < 0 || aN >= PLOT_AXES_MAX) {
 
-		bN = pl->axis[aN].slave_N;
-		scale_Y *= pl->axis[bN].scale;
-		offset_Y = offset_X * pl->axis[bN].scale + pl->axis[bN].offset;
+		ERROR("Axis number is out of range\n");
+		return ;
 	}
 
-	plotDataPolyfit(pl, dN, pl->figure[fN_1].column_X, pl->figure[fN_1].column_Y,
-			scale_X, offset_X, scale_Y, offset_Y, N0, N1);
+	if (pl->axis[aN].busy == AXIS_FREE)
+		return ;
 
-	pl->data[dN].sub[sN].busy = SUBTRACT_POLYFIT;
-	pl->data[dN].sub[sN].op.polyfit.column_X = pl->figure[fN_1].column_X;
-	pl->data[dN].sub[sN].op.polyfit.column_Y = pl->figure[fN_1].column_Y;
-	pl->data[dN].sub[sN].op.polyfit.poly_N0 = N0;
-	pl->data[dN].sub[sN].op.polyfit.poly_N1 = N1;
+	if (pl->axis[aN].slave != 0)
+		return ;
 
-	for (N = 0; N < N1 - N0 + 1; ++N) {
+	pl->axis[aN].scale = 1. / (max - min);
+	pl->axis[aN].offset = - min / (max - min);
+}
 
-		pl->data[dN].sub[sN].op.polyfit.coefs[N] = pl->lsq.sol.m[N];
+void plotAxisScaleAuto(plot_t *pl, int aN)
+{
+	double		fmin, fmax;
+
+	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+
+		ERROR("Axis number is out of range\n");
+		return ;
 	}
 
-	pl->data[dN].sub[sN].op.polyfit.std = pl->lsq.std.m[0];
+	if (pl->axis[aN].busy == AXIS_FREE)
+		return ;
 
-	plotDataSubtractCompute(pl, dN, sN);
+	if (pl->axis[aN].slave != 0)
+		return ;
 
-	cN = sN + pl->data[dN].column_N;
-	aN = pl->figure[fN_1].axis_Y;
+	if (plotAxisRangeGet(pl, aN, &fmin, &fmax) != 0) {
 
-	plotFigureAdd(pl, fN, dN, pl->figure[fN_1].column_X, cN,
-			pl->figure[fN_1].axis_X, aN, "");
+		if (fmin == fmax) {
 
-	sprintf(pl->figure[fN].label, "P: %.75s", pl->figure[fN_1].label);
+			fmin += (double) - 1.;
+			fmax += (double) + 1.;
+		}
+
+		plotAxisScaleManual(pl, aN, fmin, fmax);
+
+		if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+			fmin = plotAxisConvBackward(pl, aN, pl->viewport.min_x - pl->layout_mark_size);
+			fmax = plotAxisConvBackward(pl, aN, pl->viewport.max_x + pl->layout_mark_size);
+
+			plotAxisScaleManual(pl, aN, fmin, fmax);
+		}
+		else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+			fmin = plotAxisConvBackward(pl, aN, pl->viewport.max_y + pl->layout_mark_size);
+			fmax = plotAxisConvBackward(pl, aN, pl->viewport.min_y - pl->layout_mark_size);
+
+			plotAxisScaleManual(pl, aN, fmin, fmax);
+		}
+
+		pl->axis[aN].lock_scale = LOCK_AUTO;
+		pl->axis[aN].lock_tick = 0;
+	}
+}
+
+void plotAxisScaleAutoCond(plot_t *pl, int aN, int bN)
+{
+	double		fmin, fmax;
+
+	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+
+		ERROR("Axis number is out of range\n");
+		return ;
+	}
+
+	if (bN < -1 || bN >= PLOT_AXES_MAX) {
+
+		ERROR("Conditional axis number is out of range\n");
+		return ;
+	}
+
+	if (pl->axis[aN].busy == AXIS_FREE)
+		return ;
+
+	if (pl->axis[aN].slave != 0)
+		return ;
+
+	if (plotAxisRangeCond(pl, aN, bN, &fmin, &fmax) != 0) {
+
+		if (fmin == fmax) {
+
+			fmin += (double) - 1.;
+			fmax += (double) + 1.;
+		}
+
+		plotAxisScaleManual(pl, aN, fmin, fmax);
+
+		if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+			fmin = plotAxisConvBackward(pl, aN, pl->viewport.min_x - pl->layout_mark_size);
+			fmax = plotAxisConvBackward(pl, aN, pl->viewport.max_x + pl->layout_mark_size);
+
+			plotAxisScaleManual(pl, aN, fmin, fmax);
+		}
+		else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+			fmin = plotAxisConvBackward(pl, aN, pl->viewport.max_y + pl->layout_mark_size);
+			fmax = plotAxisConvBackward(pl, aN, pl->viewport.min_y - pl->layout_mark_size);
+
+			plotAxisScaleManual(pl, aN, fmin, fmax);
+		}
+
+		pl->axis[aN].lock_scale = LOCK_FREE;
+		pl->axis[aN].lock_tick = 0;
+	}
+}
+
+void plotAxisScaleLock(plot_t *pl, int knob)
+{
+	int		aN;
+
+	for (aN = 0; aN < PLOT_AXES_MAX; ++aN)
+		pl->axis[aN].lock_scale = knob;
+}
+
+void plotAxisScaleDefault(plot_t *pl)
+{
+	int		aN;
+
+	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+
+		if (		pl->axis[aN].busy != AXIS_FREE
+				&& pl->axis[aN].lock_scale == LOCK_AUTO) {
+
+			plotAxisScaleAuto(pl, aN);
+		}
+	}
+
+	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+
+		if (		pl->axis[aN].busy == AXIS_BUSY_Y
+				&& pl->axis[aN].lock_scale == LOCK_STACKED) {
+
+			plotAxisScaleStacked(pl, -1);
+			break;
+		}
+	}
+}
+
+void plotAxisScaleZoom(plot_t *pl, int aN, int origin, double zoom)
+{
+	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+
+		ERROR("Axis number is out of range\n");
+		return ;
+	}
+
+	if (pl->axis[aN].slave != 0)
+		return ;
+
+	if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+		pl->axis[aN].scale *= zoom;
+		pl->axis[aN].offset = pl->axis[aN].offset * zoom
+			+ (double) (pl->viewport.min_x - origin) /
+			(double) (pl->viewport.max_x - pl->viewport.min_x) * (zoom - 1.);
+	}
+	else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+		pl->axis[aN].scale *= zoom;
+		pl->axis[aN].offset = pl->axis[aN].offset * zoom
+			+ (double) (pl->viewport.max_y - origin) /
+			(double) (pl->viewport.min_y - pl->viewport.max_y) * (zoom - 1.);
+	}
+
+	pl->axis[aN].lock_scale = LOCK_FREE;
+}
+
+void plotAxisScaleMove(plot_t *pl, int aN, double move)
+{
+	double		span;
+
+	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+
+		ERROR("Axis number is out of range\n");
+		return ;
+	}
+
+	if (pl->axis[aN].slave != 0)
+		return ;
+
+	if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+		span = (double) (pl->viewport.max_x - pl->viewport.min_x);
+		pl->axis[aN].offset += move / span;
+	}
+	else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+		span = (double) (pl->viewport.min_y - pl->viewport.max_y);
+		pl->axis[aN].offset += move / span;
+	}
+
+	pl->axis[aN].lock_scale = LOCK_FREE;
+}
+
+void plotAxisScaleEqual(plot_t *pl)
+{
+	double		zoom, aspect_x, aspect_y;
+
+	if (pl->on_X < 0 || pl->on_X >= PLOT_AXES_MAX)
+		return ;
+
+	if (pl->on_Y < 0 || pl->on_Y >= PLOT_AXES_MAX)
+		return ;
+
+	aspect_x = (double) (pl->viewport.max_x - pl->viewport.min_x);
+	aspect_y = (double) (pl->viewport.max_y - pl->viewport.min_y);
+
+	if (pl->axis[pl->on_Y].scale < pl->axis[pl->on_X].scale) {
+
+		zoom = pl->axis[pl->on_Y].scale / pl->axis[pl->on_X].scale;
+		zoom *= aspect_y / aspect_x;
+
+		pl->axis[pl->on_X].offset *= zoom;
+		pl->axis[pl->on_X].offset += (1. - zoom) / 2.;
+		pl->axis[pl->on_X].scale *= zoom;
+	}
+	else {
+		zoom = pl->axis[pl->on_X].scale / pl->axis[pl->on_Y].scale;
+		zoom *= aspect_x / aspect_y;
+
+		pl->axis[pl->on_Y].offset *= zoom;
+		pl->axis[pl->on_Y].offset += (1. - zoom) / 2.;
+		pl->axis[pl->on_Y].scale *= zoom;
+	}
+
+	pl->axis[pl->on_X].lock_scale = LOCK_FREE;
+	pl->axis[pl->on_Y].lock_scale = LOCK_FREE;
+
+	pl->axis[pl->on_X].lock_tick = 0;
+	pl->axis[pl->on_Y].lock_tick = 0;
+}
+
+static void
+plotAxisGridPairwiseAlign(plot_t *pl, int aN, int bN)
+{
+	double		scale, offset;
+
+	if (pl->axis[aN].slave != 0)
+		return ;
+
+	if (aN != bN) {
+
+		scale = pl->axis[bN].ruler_tih / pl->axis[aN].ruler_tih;
+		offset = pl->axis[bN].ruler_tis - pl->axis[aN].ruler_tis;
+
+		pl->axis[aN].scale *= scale;
+		pl->axis[aN].offset = pl->axis[aN].offset * scale
+			+ offset - pl->axis[aN].ruler_tis * (scale - 1.);
+
+		pl->axis[aN].lock_scale = LOCK_FREE;
+		pl->axis[aN].lock_tick = 0;
+	}
+}
+
+void plotAxisScaleGridAlign(plot_t *pl)
+{
+	int		aN;
+
+	if (pl->on_X < 0 || pl->on_Y < 0)
+		return ;
+
+	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+
+		if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+			plotAxisGridPairwiseAlign(pl, aN, pl->on_X);
+		}
+		else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+			plotAxisGridPairwiseAlign(pl, aN, pl->on_Y);
+		}
+	}
+
+	pl->axis[pl->on_X].lock_scale = LOCK_FREE;
+	pl->axis[pl->on_Y].lock_scale = LOCK_FREE;
+
+	pl->axis[pl->on_X].lock_tick = 0;
+	pl->axis[pl->on_Y].lock_tick = 0;
+}
+
+void plotAxisScaleGridLock(plot_t *pl, int aN)
+{
+	double		scale, offset, ymin, ymax, fmin, fmax;
+	int		bN;
+
+	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+
+		ERROR("Axis number is out of range\n");
+		return ;
+	}
+
+	scale = pl->axis[aN].scale;
+	offset = pl->axis[aN].offset;
+
+	if (pl->axis[aN].slave != 0) {
+
+		bN = pl->axis[aN].slave_N;
+		scale *= pl->axis[bN].scale;
+		offset = offset * pl->axis[bN].scale + pl->axis[bN].offset;
+	}
+
+	ymin = - offset / scale;
+	ymax = 1. / scale + ymin;
+
+	if (plotAxisRangeCond(pl, aN, -1, &fmin, &fmax) != 0) {
+
+		if (fmin == fmax) {
+
+			fmin += (double) - 1.;
+			fmax += (double) + 1.;
+		}
+
+		if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+			fmin = plotAxisConvBackward(pl, aN, plotAxisConvForward(pl, aN, fmin) - pl->layout_mark_size);
+			fmax = plotAxisConvBackward(pl, aN, plotAxisConvForward(pl, aN, fmax) + pl->layout_mark_size);
+		}
+		else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+			fmin = plotAxisConvBackward(pl, aN, plotAxisConvForward(pl, aN, fmin) + pl->layout_mark_size);
+			fmax = plotAxisConvBackward(pl, aN, plotAxisConvForward(pl, aN, fmax) - pl->layout_mark_size);
+		}
+
+		ymin = (ymin < fmin) ? (fmin < ymax) ? fmin : ymax : ymin;
+		ymax = (ymax > fmax) ? (fmax > ymin) ? fmax : ymin : ymax;
+	}
+
+	pl->axis[aN].lock_tick = 1;
+
+	pl->axis[aN].ruler_min = ymin;
+	pl->axis[aN].ruler_max = ymax;
+}
+
+typedef struct {
+
+	int		aN;
+	double		yval;
+
+	double		fmin;
+	double		fmax;
+}
+yaxis_t;
+
+static int
+plotAxisGetSorted(plot_t *pl, int bN, yaxis_t *map)
+{
+	int		aN, N, job, cond, yN = 0;
+
+	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+
+		if (		pl->axis[aN].busy == AXIS_BUSY_Y
+				&& pl->axis[aN].slave == 0) {
+
+			job = 0;
+
+			if (bN >= 0) {
+
+				job = 1;
+			}
+			else if (pl->axis[aN].lock_scale == LOCK_STACKED) {
+
+				job = 1;
+			}
+
+			if (job != 0) {
+
+				cond = plotAxisRangeCond(pl, aN, -1, &map[yN].fmin, &map[yN].fmax);
+
+				if (cond != 0) {
+
+					map[yN].aN = aN;
+					map[yN].yval = plotAxisConvForward(pl, aN,
+							(map[yN].fmin + map[yN].fmax) / 2.);
+
+					yN++;
+				}
+			}
+		}
+	}
+
+	do {
+		yaxis_t		ybackup;
+
+		job = 0;
+
+		for (N = 1; N < yN; ++N) {
+
+			if (map[N - 1].yval < map[N].yval) {
+
+				memcpy(&ybackup, &map[N - 1], sizeof(yaxis_t));
+				memcpy(&map[N - 1], &map[N], sizeof(yaxis_t));
+				memcpy(&map[N], &ybackup, sizeof(yaxis_t));
+
+				job = 1;
+			}
+		}
+	}
+	while (job != 0);
+
+	return yN;
+}
+
+void plotAxisScaleStacked(plot_t *pl, int bN)
+{
+	double		scale, offset, ypad, yself;
+	int		aN, yN, N;
+
+	yaxis_t		ymap[PLOT_AXES_MAX];
+
+	yN = plotAxisGetSorted(pl, bN, ymap);
+
+	if (yN >= 2) {
+
+		scale = 1. / (double) yN;
+		offset = 0.;
+
+		for (N = 0; N < yN; ++N) {
+
+			aN = ymap[N].aN;
+
+			if (ymap[N].fmin == ymap[N].fmax) {
+
+				ymap[N].fmin += (double) - 1.;
+				ymap[N].fmax += (double) + 1.;
+			}
+
+			ypad = (double) pl->layout_mark_size / (double)
+				(pl->viewport.max_y - pl->viewport.min_y);
+
+			ypad *= (ymap[N].fmax - ymap[N].fmin) / (scale - ypad * 2.);
+
+			ymap[N].fmin += (double) - ypad;
+			ymap[N].fmax += (double) + ypad;
+
+			yself = ymap[N].fmin / (ymap[N].fmax - ymap[N].fmin);
+
+			pl->axis[aN].scale = scale / (ymap[N].fmax - ymap[N].fmin);
+			pl->axis[aN].offset = offset - yself * scale;
+
+			pl->axis[aN].lock_scale = LOCK_STACKED;
+			pl->axis[aN].lock_tick = 1;
+
+			pl->axis[aN].ruler_min = ymap[N].fmin;
+			pl->axis[aN].ruler_max = ymap[N].fmax;
+
+			offset += scale;
+		}
+	}
+	else {
+		for (N = 0; N < PLOT_AXES_MAX; ++N) {
+
+			if (pl->axis[N].lock_scale == LOCK_STACKED)
+				pl->axis[N].lock_scale = LOCK_FREE;
+		}
+	}
+}
+
+int plotAxisGetByClick(plot_t *pl, int cur_X, int cur_Y)
+{
+	int		aN, len, rN = -1;
+
+	cur_X = pl->viewport.min_x - pl->layout_border - cur_X;
+	cur_Y = cur_Y - pl->viewport.max_y - pl->layout_border;
+
+	for (aN = 0; aN < PLOT_AXES_MAX; ++aN) {
+
+		if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+			len = pl->layout_ruler_box;
+			len += (pl->axis[aN].compact == 0) ? pl->layout_label_box : 0;
+
+			if (		cur_Y < pl->axis[aN].layout_pos + len
+					&& cur_Y > pl->axis[aN].layout_pos) {
+
+				rN = aN;
+				break;
+			}
+		}
+
+		if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+			len = pl->layout_ruler_box;
+			len += (pl->axis[aN].compact == 0) ? pl->layout_label_box : 0;
+
+			if (		cur_X < pl->axis[aN].layout_pos + len
+					&& cur_X > pl->axis[aN].layout_pos) {
+
+				rN = aN;
+				break;
+			}
+		}
+	}
+
+	pl->hover_axis = rN;
+
+	return rN;
+}
+
+double plotAxisConvForward(plot_t *pl, int aN, double fval)
+{
+	double		scale, offset, length;
+	int		bN;
+
+	scale = pl->axis[aN].scale;
+	offset = pl->axis[aN].offset;
+
+	if (pl->axis[aN].slave != 0) {
+
+		bN = pl->axis[aN].slave_N;
+		scale *= pl->axis[bN].scale;
+		offset = offset * pl->axis[bN].scale + pl->axis[bN].offset;
+	}
+
+	if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+		length = (double) (pl->viewport.max_x - pl->viewport.min_x);
+		scale *= length;
+		offset = offset * length + pl->viewport.min_x;
+	}
+	else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+		length = (double) (pl->viewport.min_y - pl->viewport.max_y);
+		scale *= length;
+		offset = offset * length + pl->viewport.max_y;
+	}
+
+	return fval * scale + offset;
+}
+
+double plotAxisConvBackward(plot_t *pl, int aN, double xval)
+{
+	double		scale, offset, length;
+	int		bN;
+
+	scale = pl->axis[aN].scale;
+	offset = pl->axis[aN].offset;
+
+	if (pl->axis[aN].slave != 0) {
+
+		bN = pl->axis[aN].slave_N;
+		scale *= pl->axis[bN].scale;
+		offset = offset * pl->axis[bN].scale + pl->axis[bN].offset;
+	}
+
+	if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+		length = (double) (pl->viewport.max_x - pl->viewport.min_x);
+		scale *= length;
+		offset = offset * length + pl->viewport.min_x;
+	}
+	else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+		length = (double) (pl->viewport.min_y - pl->viewport.max_y);
+		scale *= length;
+		offset = offset * length + pl->viewport.max_y;
+	}
+
+	return (xval - offset) / scale;
+}
+
+void plotAxisSlave(plot_t *pl, int aN, int bN, double scale, double offset, int action)
+{
+	int		N, base = 0;
+
+	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+
+		ERROR("Slave axis number is out of range\n");
+		return ;
+	}
+
+	if (action == AXIS_SLAVE_DISABLE) {
+
+		bN = pl->axis[aN].slave_N;
+	}
+
+	if (bN < 0 || bN >= PLOT_AXES_MAX) {
+
+		ERROR("Base axis number is out of range\n");
+		return ;
+	}
+
+	if (bN == aN) {
+
+		ERROR("Axes must not be the same\n");
+		return ;
+	}
+
+	if (pl->axis[bN].slave != 0) {
+
+		ERROR("Base axis must not be slave\n");
+		return ;
+	}
+
+	for (N = 0; N < PLOT_AXES_MAX; ++N) {
+
+		if (pl->axis[N].busy != AXIS_FREE
+				&& pl->axis[N].slave != 0) {
+
+			if (pl->axis[N].slave_N == aN) {
+
+				base = 1;
+				break;
+			}
+		}
+	}
+
+	if (base) {
+
+		ERROR("The axis is base for another slave\n");
+		return ;
+	}
+
+	if (action == AXIS_SLAVE_ENABLE) {
+
+		if (pl->axis[aN].slave == 0) {
+
+			pl->axis[aN].slave = 1;
+			pl->axis[aN].slave_N = bN;
+			pl->axis[aN].scale = scale;
+			pl->axis[aN].offset = offset;
+
+			pl->on_X = (aN == pl->on_X) ? bN : pl->on_X;
+			pl->on_Y = (aN == pl->on_Y) ? bN : pl->on_Y;
+		}
+	}
+	else if (action == AXIS_SLAVE_HOLD_AS_IS) {
+
+		if (bN < 0 || bN >= PLOT_AXES_MAX) {
+
+			ERROR("Base axis number is out of range\n");
+			return ;
+		}
+
+		if (pl->axis[aN].slave == 0) {
+
+			pl->axis[aN].slave = 1;
+			pl->axis[aN].slave_N = bN;
+
+			pl->axis[aN].scale = pl->axis[aN].scale / pl->axis[bN].scale;
+			pl->axis[aN].offset = (pl->axis[aN].offset - pl->axis[bN].offset)
+				/ pl->axis[bN].scale;
+
+			pl->on_X = (aN == pl->on_X) ? bN : pl->on_X;
+			pl->on_Y = (aN == pl->on_Y) ? bN : pl->on_Y;
+		}
+	}
+	else {
+		if (pl->axis[aN].slave != 0) {
+
+			pl->axis[aN].slave = 0;
+
+			pl->axis[aN].scale = pl->axis[aN].scale * pl->axis[bN].scale;
+			pl->axis[aN].offset = pl->axis[aN].offset * pl->axis[bN].scale
+				+ pl->axis[bN].offset;
+		}
+	}
+}
+
+void plotAxisRemove(plot_t *pl, int aN)
+{
+	int		N, cN;
+
+	if (aN < 0 || aN >= PLOT_AXES_MAX) {
+
+		ERROR("Axis number is out of range\n");
+		return ;
+	}
+
+	if (aN == pl->on_X || aN == pl->on_Y) {
+
+		ERROR("Unable to remove active axis\n");
+		return ;
+	}
+
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+		if (pl->figure[N].busy != 0) {
+
+			if (pl->figure[N].axis_X == aN) {
+
+				if (pl->axis[aN].slave != 0) {
+
+					cN = plotGetSubtractScale(pl, pl->figure[N].data_N,
+							pl->figure[N].column_X,
+							pl->axis[aN].scale,
+							pl->axis[aN].offset);
+
+					if (cN != -1) {
+
+						pl->figure[N].column_X = cN;
+					}
+
+					pl->figure[N].axis_X = pl->axis[aN].slave_N;
+				}
+				else {
+					pl->figure[N].axis_X = pl->on_X;
+				}
+			}
+
+			if (pl->figure[N].axis_Y == aN) {
+
+				if (pl->axis[aN].slave != 0) {
+
+					cN = plotGetSubtractScale(pl, pl->figure[N].data_N,
+							pl->figure[N].column_Y,
+							pl->axis[aN].scale,
+							pl->axis[aN].offset);
+
+					if (cN != -1) {
+
+						pl->figure[N].column_Y = cN;
+					}
+
+					pl->figure[N].axis_Y = pl->axis[aN].slave_N;
+				}
+				else {
+					pl->figure[N].axis_Y = pl->on_Y;
+				}
+			}
+		}
+	}
+
+	for (N = 0; N < PLOT_AXES_MAX; ++N) {
+
+		if (pl->axis[N].busy != AXIS_FREE
+				&& pl->axis[N].slave != 0) {
+
+			if (pl->axis[N].slave_N == aN) {
+
+				plotAxisSlave(pl, N, -1, 0., 0., AXIS_SLAVE_DISABLE);
+			}
+		}
+	}
+
+	pl->axis[aN].busy = AXIS_FREE;
+	pl->axis[aN].slave = 0;
+	pl->axis[aN].label[0] = 0;
+	pl->axis[aN].compact = 1;
+	pl->axis[aN].exponential = 0;
+}
+
+void plotFigureAdd(plot_t *pl, int fN, int dN, int nX, int nY, int aX, int aY, const char *label)
+{
+	int		gN;
+
+	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return ;
+	}
+
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return ;
+	}
+
+	if (pl->data[dN].column_N < 1) {
+
+		ERROR("Dataset %i has no DATA\n", dN);
+		return ;
+	}
+
+	if (nX < -1 || nX >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+
+		ERROR("X column number %i is out of range\n", nX);
+		return ;
+	}
+
+	if (nY < -1 || nY >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+
+		ERROR("Y column number %i is out of range\n", nY);
+		return ;
+	}
+
+	if (aX < 0 || aX >= PLOT_AXES_MAX) {
+
+		ERROR("X axis number %i is out of range\n", aX);
+		return ;
+	}
+
+	if (aY < 0 || aY >= PLOT_AXES_MAX) {
+
+		ERROR("Y axis number %i is out of range\n", aY);
+		return ;
+	}
+
+	if (aX == aY || pl->axis[aX].busy == AXIS_BUSY_Y
+		|| pl->axis[aY].busy == AXIS_BUSY_X) {
+
+		ERROR("Invalid axes mapping %i %i\n", aX, aY);
+		return ;
+	}
+
+	pl->draw[fN].sketch = SKETCH_FINISHED;
+
+	pl->figure[fN].busy = 1;
+	pl->figure[fN].hidden = 0;
+	pl->figure[fN].drawing = pl->default_drawing;
+	pl->figure[fN].width = pl->default_width;
+	pl->figure[fN].data_N = dN;
+	pl->figure[fN].column_X = nX;
+	pl->figure[fN].column_Y = nY;
+	pl->figure[fN].axis_X = aX;
+	pl->figure[fN].axis_Y = aY;
+
+	if (pl->axis[aX].busy == AXIS_FREE) {
+
+		pl->axis[aX].busy = AXIS_BUSY_X;
+		pl->axis[aX].lock_scale = LOCK_AUTO;
+		pl->axis[aX].compact = 1;
+	}
+
+	if (pl->axis[aY].busy == AXIS_FREE) {
+
+		pl->axis[aY].busy = AXIS_BUSY_Y;
+		pl->axis[aY].lock_scale = LOCK_AUTO;
+		pl->axis[aY].compact = 1;
+	}
+
+	gN = pl->data[dN].map[nX];
+
+	if (gN != -1) {
+
+		plotAxisLabel(pl, aX, pl->group[gN].label);
+	}
+
+	gN = pl->data[dN].map[nY];
+
+	if (gN != -1) {
+
+		plotAxisLabel(pl, aY, pl->group[gN].label);
+	}
+
+	strcpy(pl->figure[fN].label, label);
+
+	pl->on_X = (pl->on_X < 0) ? aX : pl->on_X;
+	pl->on_Y = (pl->on_Y < 0) ? aY : pl->on_Y;
+}
+
+static void
+plotDataBoxTextFmt(plot_t *pl, int fN, double val)
+{
+	char		tfmt[PLOT_STRING_MAX];
+	char		tbuf[PLOT_STRING_MAX];
+
+	int		fexp = 1;
+
+	if (val != 0.) {
+
+		fexp += (int) floor(log10(fabs(val)));
+	}
+
+	if (fexp >= -2 && fexp < pl->fprecision) {
+
+		fexp = (fexp < 1) ? 1 : fexp;
+
+		sprintf(tfmt, "%% .%df ", pl->fprecision - fexp);
+	}
+	else {
+		sprintf(tfmt, "%% .%dE ", pl->fprecision - 1);
+	}
+
+	sprintf(tbuf, tfmt, val);
+	strcat(pl->data_box_text[fN], tbuf);
+}
+
+static void
+plotDataBoxTextHex(plot_t *pl, int fN, double val)
+{
+	char		tbuf[PLOT_STRING_MAX];
+
+	sprintf(tbuf, " 0x%08lX", (unsigned long) val);
+	strcat(pl->data_box_text[fN], tbuf);
+}
+
+static int
+plotCheckColumnLinked(plot_t *pl, int dN, int cN)
+{
+	int		sN, fN, dNf, linked = 0;
+
+	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+
+		if (pl->data[dN].sub[sN].busy == SUBTRACT_TIME_MEDIAN) {
+
+			if (cN == pl->data[dN].sub[sN].op.median.column_X) {
+
+				linked = 1;
+				break;
+			}
+		}
+		else if (pl->data[dN].sub[sN].busy == SUBTRACT_DATA_MEDIAN) {
+
+			if (cN == pl->data[dN].sub[sN].op.median.column_Y) {
+
+				linked = 1;
+				break;
+			}
+		}
+		else if (pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+
+			if (cN == pl->data[dN].sub[sN].op.scale.column_X) {
+
+				linked = 1;
+				break;
+			}
+		}
+		else if (pl->data[dN].sub[sN].busy == SUBTRACT_RESAMPLE) {
+
+			if (cN == pl->data[dN].sub[sN].op.resample.column_X) {
+
+				linked = 1;
+				break;
+			}
+		}
+		else if (pl->data[dN].sub[sN].busy == SUBTRACT_POLYFIT) {
+
+			if (cN == pl->data[dN].sub[sN].op.polyfit.column_X) {
+
+				linked = 1;
+				break;
+			}
+		}
+		else if (	pl->data[dN].sub[sN].busy == SUBTRACT_BINARY_SUBTRACTION
+				|| pl->data[dN].sub[sN].busy == SUBTRACT_BINARY_ADDITION
+				|| pl->data[dN].sub[sN].busy == SUBTRACT_BINARY_MULTIPLICATION
+				|| pl->data[dN].sub[sN].busy == SUBTRACT_BINARY_HYPOTENUSE) {
+
+			if (		cN == pl->data[dN].sub[sN].op.binary.column_X
+					|| cN == pl->data[dN].sub[sN].op.binary.column_Y) {
+
+				linked = 1;
+				break;
+			}
+		}
+		else if (	pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_DIFFERENCE
+				|| pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_CUMULATIVE) {
+
+			if (		cN == pl->data[dN].sub[sN].op.filter.column_X
+					|| cN == pl->data[dN].sub[sN].op.filter.column_Y) {
+
+				linked = 1;
+				break;
+			}
+		}
+		else if (	pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_BITMASK
+				|| pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_LOW_PASS) {
+
+			if (cN == pl->data[dN].sub[sN].op.filter.column_Y) {
+
+				linked = 1;
+				break;
+			}
+		}
+		else if (pl->data[dN].sub[sN].busy == SUBTRACT_FILTER_MEDIAN) {
+
+			if (cN == pl->data[dN].sub[sN].op.median.column_Y) {
+
+				linked = 1;
+				break;
+			}
+		}
+	}
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (pl->figure[fN].busy != 0) {
+
+			if (		cN == pl->figure[fN].column_X
+					|| cN == pl->figure[fN].column_Y) {
+
+				linked = 1;
+				break;
+			}
+
+			dNf = pl->figure[fN].data_N;
+
+			for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+
+				if (pl->data[dNf].sub[sN].busy == SUBTRACT_RESAMPLE) {
+
+					if (		dN == pl->data[dNf].sub[sN].op.resample.in_data_N
+							&& cN == pl->data[dNf].sub[sN].op.resample.in_column_X) {
+
+						linked = 1;
+						break;
+					}
+					else if (	dN == pl->data[dNf].sub[sN].op.resample.in_data_N
+							&& cN == pl->data[dNf].sub[sN].op.resample.in_column_Y) {
+
+						linked = 1;
+						break;
+					}
+				}
+			}
+
+			if (linked != 0)
+				break;
+		}
+	}
+
+	return linked;
+}
+
+static void
+plotSubtractGarbage(plot_t *pl, int dN)
+{
+	int		sN, cN, N;
+
+	do {
+		N = 0;
+
+		for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+
+			if (pl->data[dN].sub[sN].busy != SUBTRACT_FREE) {
+
+				cN = sN + pl->data[dN].column_N;
+
+				if (plotCheckColumnLinked(pl, dN, cN) == 0) {
+
+					pl->data[dN].sub[sN].busy = SUBTRACT_FREE;
+
+					N++;
+				}
+			}
+		}
+	}
+	while (N != 0);
+}
+
+static int
+plotSubtractOriginal(plot_t *pl, int dN, int cN)
+{
+	int		fN, sN, cN1, modified;
+
+	sN = cN - pl->data[dN].column_N;
+
+	if (		sN >= 0 && sN < PLOT_SUBTRACT
+			&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+
+		cN1 = pl->data[dN].sub[sN].op.scale.column_X;
+		modified = pl->data[dN].sub[sN].op.scale.modified;
+
+		if (modified == 0) {
+
+			if (		pl->data[dN].sub[sN].op.scale.scale == (double) 1.
+					&& pl->data[dN].sub[sN].op.scale.offset == (double) 0.) {
+
+				cN = cN1;
+				goto plotSubtractMerge_END;
+			}
+		}
+
+		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+			if (		pl->figure[fN].busy != 0
+					&& dN == pl->figure[fN].data_N
+					&& cN != pl->figure[fN].column_X) {
+
+				sN = pl->figure[fN].column_X - pl->data[dN].column_N;
+
+				if (		sN >= 0 && sN < PLOT_SUBTRACT
+						&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+
+					if (		cN1 == pl->data[dN].sub[sN].op.scale.column_X
+							&& modified == pl->data[dN].sub[sN].op.scale.modified) {
+
+						if (plotDataCompareMatch(pl, dN, cN, pl->figure[fN].column_X) == 0) {
+
+							cN = pl->figure[fN].column_X;
+							goto plotSubtractMerge_END;
+						}
+					}
+				}
+			}
+
+			if (		pl->figure[fN].busy != 0
+					&& dN == pl->figure[fN].data_N
+					&& cN != pl->figure[fN].column_Y) {
+
+				sN = pl->figure[fN].column_Y - pl->data[dN].column_N;
+
+				if (		sN >= 0 && sN < PLOT_SUBTRACT
+						&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+
+					if (		cN1 == pl->data[dN].sub[sN].op.scale.column_X
+							&& modified == pl->data[dN].sub[sN].op.scale.modified) {
+
+						if (plotDataCompareMatch(pl, dN, cN, pl->figure[fN].column_Y) == 0) {
+
+							cN = pl->figure[fN].column_Y;
+							goto plotSubtractMerge_END;
+						}
+					}
+				}
+			}
+		}
+	}
+
+plotSubtractMerge_END:
+
+	return cN;
+}
+
+void plotTotalSubtractGarbage(plot_t *pl)
+{
+	int		N, fN, dN, sN, cNX, cNY;
+
+	do {
+		N = 0;
+
+		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+			if (pl->figure[fN].busy != 0) {
+
+				dN = pl->figure[fN].data_N;
+
+				cNX = pl->figure[fN].column_X;
+				cNY = pl->figure[fN].column_Y;
+
+				cNX = plotSubtractOriginal(pl, dN, cNX);
+				cNY = plotSubtractOriginal(pl, dN, cNY);
+
+				pl->figure[fN].column_X = cNX;
+				pl->figure[fN].column_Y = cNY;
+			}
+		}
+
+		for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+
+			if (pl->data[dN].sub[sN].busy != SUBTRACT_FREE) {
+
+				cNX = sN + pl->data[dN].column_N;
+
+				if (plotCheckColumnLinked(pl, dN, cNX) == 0) {
+
+					pl->data[dN].sub[sN].busy = SUBTRACT_FREE;
+
+					N++;
+				}
+			}
+		}
+	}
+	while (N != 0);
+}
+
+void plotFigureRemove(plot_t *pl, int fN)
+{
+	int		N, aN, on_X = 1, on_Y = 1;
+
+	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return ;
+	}
+
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+		if (pl->figure[N].busy != 0 && N != fN) {
+
+			if (pl->figure[N].axis_X == pl->figure[fN].axis_X)
+				on_X = 0;
+
+			if (pl->figure[N].axis_Y == pl->figure[fN].axis_Y)
+				on_Y = 0;
+		}
+	}
+
+	pl->figure[fN].busy = 0;
+
+	if (on_X != 0) {
+
+		aN = pl->figure[fN].axis_X;
+
+		if (pl->on_X == aN) {
+
+			for (N = 0; N < PLOT_AXES_MAX; ++N) {
+
+				if (N != aN && pl->axis[N].busy == AXIS_BUSY_X
+						&& pl->axis[N].slave == 0) {
+
+					pl->on_X = N;
+					break;
+				}
+			}
+		}
+
+		if (pl->on_X != aN) {
+
+			plotAxisRemove(pl, aN);
+		}
+	}
+
+	if (on_Y != 0) {
+
+		aN = pl->figure[fN].axis_Y;
+
+		if (pl->on_Y == aN) {
+
+			for (N = 0; N < PLOT_AXES_MAX; ++N) {
+
+				if (N != aN && pl->axis[N].busy == AXIS_BUSY_Y
+						&& pl->axis[N].slave == 0) {
+
+					pl->on_Y = N;
+					break;
+				}
+			}
+		}
+
+		if (pl->on_Y != aN) {
+
+			plotAxisRemove(pl, aN);
+		}
+	}
+
+	plotSubtractGarbage(pl, pl->figure[fN].data_N);
+}
+
+void plotFigureGarbage(plot_t *pl, int dN)
+{
+	int		fN;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].data_N == dN) {
+
+			plotFigureRemove(pl, fN);
+		}
+	}
+}
+
+void plotFigureMoveAxes(plot_t *pl, int fN)
+{
+	int		N, aN, rX = 1, rY = 1;
+
+	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return ;
+	}
+
+	if (pl->on_X < 0 || pl->on_X >= PLOT_AXES_MAX)
+		return ;
+
+	if (pl->on_Y < 0 || pl->on_Y >= PLOT_AXES_MAX)
+		return ;
+
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+		if (pl->figure[N].busy != 0 && N != fN) {
+
+			if (pl->figure[N].axis_X == pl->figure[fN].axis_X)
+				rX = 0;
+
+			if (pl->figure[N].axis_Y == pl->figure[fN].axis_Y)
+				rY = 0;
+		}
+	}
+
+	if (pl->figure[fN].axis_X != pl->on_X) {
+
+		aN = pl->figure[fN].axis_X;
+		pl->figure[fN].axis_X = pl->on_X;
+
+		if (rX != 0) {
+
+			plotAxisRemove(pl, aN);
+		}
+	}
+
+	if (pl->figure[fN].axis_Y != pl->on_Y) {
+
+		aN = pl->figure[fN].axis_Y;
+		pl->figure[fN].axis_Y = pl->on_Y;
+
+		if (rY != 0) {
+
+			plotAxisRemove(pl, aN);
+		}
+	}
+}
+
+static int
+plotGetFreeAxis(plot_t *pl)
+{
+	int		N, aN = -1;
+
+	for (N = 0; N < PLOT_AXES_MAX; ++N) {
+
+		if (pl->axis[N].busy == AXIS_FREE) {
+
+			aN = N;
+			break;
+		}
+	}
+
+	return aN;
+}
+
+void plotFigureMakeIndividualAxes(plot_t *pl, int fN)
+{
+	int		N, aN, rX = 1, rY = 1;
+
+	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return ;
+	}
+
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+		if (pl->figure[N].busy != 0 && N != fN) {
+
+			if (pl->figure[N].axis_X == pl->figure[fN].axis_X)
+				rX = 0;
+
+			if (pl->figure[N].axis_Y == pl->figure[fN].axis_Y)
+				rY = 0;
+		}
+	}
+
+	if (rX == 0) {
+
+		aN = plotGetFreeAxis(pl);
+
+		if (aN != -1) {
+
+			N = pl->figure[fN].axis_X;
+
+			pl->axis[aN].busy = AXIS_BUSY_X;
+			pl->figure[fN].axis_X = aN;
+
+			plotAxisScaleAuto(pl, aN);
+			plotAxisLabel(pl, aN, pl->axis[N].label);
+		}
+		else {
+			ERROR("Unable to get free axis on X\n");
+			return ;
+		}
+	}
+
+	if (rY == 0) {
+
+		aN = plotGetFreeAxis(pl);
+
+		if (aN != -1) {
+
+			N = pl->figure[fN].axis_Y;
+
+			pl->axis[aN].busy = AXIS_BUSY_Y;
+			pl->figure[fN].axis_Y = aN;
+
+			plotAxisScaleAuto(pl, aN);
+			plotAxisLabel(pl, aN, pl->axis[N].label);
+		}
+		else {
+			ERROR("Unable to get free axis on Y\n");
+			return ;
+		}
+	}
+}
+
+void plotFigureExchange(plot_t *pl, int fN, int fN_1)
+{
+	char		backup[sizeof(pl->figure[0])];
+
+	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return ;
+	}
+
+	if (fN_1 < 0 || fN_1 >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number (exchange) is out of range\n");
+		return ;
+	}
+
+	memcpy(backup, &pl->figure[fN_1], sizeof(pl->figure[0]));
+	memcpy(&pl->figure[fN_1], &pl->figure[fN], sizeof(pl->figure[0]));
+	memcpy(&pl->figure[fN], backup, sizeof(pl->figure[0]));
+}
+
+int plotFigureSelected(plot_t *pl)
+{
+	int		fN, N = 0;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0) {
+
+			N++;
+		}
+	}
+
+	return N;
+}
+
+int plotFigureAnyData(plot_t *pl)
+{
+	int		fN, dN = 0;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0) {
+
+			dN = pl->figure[fN].data_N;
+			break;
+		}
+	}
+
+	return dN;
+}
+
+int plotFigureHaveData(plot_t *pl, int dN)
+{
+	int		fN, N = 0;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].data_N == dN) {
+
+			N++;
+		}
+	}
+
+	return N;
+}
+
+static int
+plotGetSubtractTimeMedianByMatch(plot_t *pl, int dN, int cNX, int length, int unwrap)
+{
+	int		sN, rN = -1;
+
+	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+
+		if (		pl->data[dN].sub[sN].busy == SUBTRACT_TIME_MEDIAN
+				&& pl->data[dN].sub[sN].op.median.column_X == cNX
+				&& pl->data[dN].sub[sN].op.median.length == length
+				&& pl->data[dN].sub[sN].op.median.unwrap == unwrap) {
+
+			rN = sN;
+			break;
+		}
+	}
+
+	return rN;
+}
+
+static int
+plotGetSubtractScaleByMatch(plot_t *pl, int dN, int cN, double scale, double offset)
+{
+	int		sN, rN = -1;
+
+	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+
+		if (		pl->data[dN].sub[sN].busy == SUBTRACT_SCALE
+				&& pl->data[dN].sub[sN].op.scale.column_X == cN
+				&& pl->data[dN].sub[sN].op.scale.scale == scale
+				&& pl->data[dN].sub[sN].op.scale.offset == offset) {
+
+			rN = sN;
+			break;
+		}
+	}
+
+	return rN;
+}
+
+static int
+plotGetFreeSubtract(plot_t *pl, int dN)
+{
+	int		sN, rN = -1;
+
+	for (sN = 0; sN < PLOT_SUBTRACT; ++sN) {
+
+		if (pl->data[dN].sub[sN].busy == 0) {
+
+			rN = sN;
+			break;
+		}
+	}
+
+	return rN;
+}
+
+tuple_t plotGetSubtractTimeMedian(plot_t *pl, int dN, int cNX, int cNY, int length, int unwrap, int opdata)
+{
+	tuple_t		uN = { -1, -1 };
+	int		sNX, sNY;
+
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return uN;
+	}
+
+	if (length < 1 || length > PLOT_MEDIAN_MAX) {
+
+		ERROR("Median length %i is out of range\n", length);
+		return uN;
+	}
+
+	sNX = plotGetSubtractTimeMedianByMatch(pl, dN, cNX, length, unwrap);
+
+	if (sNX < 0) {
+
+		sNX = plotGetFreeSubtract(pl, dN);
+
+		if (sNX < 0) {
+
+			ERROR("Unable to get free subtract\n");
+			return uN;
+		}
+
+		pl->data[dN].sub[sNX].busy = SUBTRACT_TIME_MEDIAN;
+		pl->data[dN].sub[sNX].op.median.column_X = cNX;
+		pl->data[dN].sub[sNX].op.median.length = length;
+		pl->data[dN].sub[sNX].op.median.unwrap = unwrap;
+		pl->data[dN].sub[sNX].op.median.opdata = 0;
+	}
+
+	sNY = plotGetFreeSubtract(pl, dN);
+
+	if (sNY < 0) {
+
+		ERROR("Unable to get free subtract\n");
+		return uN;
+	}
+
+	pl->data[dN].sub[sNY].busy = SUBTRACT_DATA_MEDIAN;
+	pl->data[dN].sub[sNY].op.median.column_X = cNX;
+	pl->data[dN].sub[sNY].op.median.column_Y = cNY;
+	pl->data[dN].sub[sNY].op.median.column_T = sNX + pl->data[dN].column_N;
+	pl->data[dN].sub[sNY].op.median.length = length;
+	pl->data[dN].sub[sNY].op.median.unwrap = unwrap;
+	pl->data[dN].sub[sNY].op.median.opdata = opdata;
+
+	plotDataSubtractCompute(pl, dN, sNY);
+
+	uN.X = sNX + pl->data[dN].column_N;
+	uN.Y = sNY + pl->data[dN].column_N;
+
+	return uN;
+}
+
+int plotGetSubtractScale(plot_t *pl, int dN, int cN, double scale, double offset)
+{
+	int		sN;
+
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return -1;
+	}
+
+	sN = plotGetSubtractScaleByMatch(pl, dN, cN, scale, offset);
+
+	if (sN < 0) {
+
+		sN = cN - pl->data[dN].column_N;
+
+		if (		sN >= 0 && sN < PLOT_SUBTRACT
+				&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+
+			offset = scale * pl->data[dN].sub[sN].op.scale.offset + offset;
+			scale *= pl->data[dN].sub[sN].op.scale.scale;
+
+			pl->data[dN].sub[sN].op.scale.scale = scale;
+			pl->data[dN].sub[sN].op.scale.offset = offset;
+		}
+		else {
+			sN = plotGetFreeSubtract(pl, dN);
+
+			if (sN < 0) {
+
+				ERROR("Unable to get free subtract\n");
+				return -1;
+			}
+
+			pl->data[dN].sub[sN].busy = SUBTRACT_SCALE;
+			pl->data[dN].sub[sN].op.scale.column_X = cN;
+			pl->data[dN].sub[sN].op.scale.modified = 0;
+			pl->data[dN].sub[sN].op.scale.scale = scale;
+			pl->data[dN].sub[sN].op.scale.offset = offset;
+		}
+
+		plotDataSubtractCompute(pl, dN, sN);
+	}
+
+	cN = sN + pl->data[dN].column_N;
+
+	return cN;
+}
+
+static int
+plotGetSubtractClone(plot_t *pl, int dN, int cN)
+{
+	int		sN, modified = 0;
+
+	sN = cN - pl->data[dN].column_N;
+
+	if (		sN >= 0 && sN < PLOT_SUBTRACT
+			&& pl->data[dN].sub[sN].busy == SUBTRACT_SCALE) {
+
+		modified = pl->data[dN].sub[sN].op.scale.modified;
+	}
+
+	sN = plotGetFreeSubtract(pl, dN);
+
+	if (sN < 0) {
+
+		ERROR("Unable to get free subtract\n");
+		return -1;
+	}
+
+	pl->data[dN].sub[sN].busy = SUBTRACT_SCALE;
+	pl->data[dN].sub[sN].op.scale.column_X = cN;
+	pl->data[dN].sub[sN].op.scale.modified = modified;
+	pl->data[dN].sub[sN].op.scale.scale = (double) 1.;
+	pl->data[dN].sub[sN].op.scale.offset = (double) 0.;
+
+	plotDataSubtractCompute(pl, dN, sN);
+
+	cN = sN + pl->data[dN].column_N;
+
+	return cN;
+}
+
+int plotGetSubtractResample(plot_t *pl, int dN, int cNX, int in_dN, int in_cNX, int in_cNY)
+{
+	int		sN, cN;
+
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return -1;
+	}
+
+	sN = plotGetFreeSubtract(pl, dN);
+
+	if (sN < 0) {
+
+		ERROR("Unable to get free subtract\n");
+		return -1;
+	}
+
+	pl->data[dN].sub[sN].busy = SUBTRACT_RESAMPLE;
+	pl->data[dN].sub[sN].op.resample.column_X = cNX;
+	pl->data[dN].sub[sN].op.resample.in_data_N = in_dN;
+	pl->data[dN].sub[sN].op.resample.in_column_X = in_cNX;
+	pl->data[dN].sub[sN].op.resample.in_column_Y = in_cNY;
+
+	plotDataSubtractCompute(pl, dN, sN);
+
+	cN = sN + pl->data[dN].column_N;
+
+	return cN;
+}
+
+int plotGetSubtractBinary(plot_t *pl, int dN, int opSUB, int cN1, int cN2)
+{
+	int		sN, cN;
+
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return -1;
+	}
+
+	if (cN1 < -1 || cN1 >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+
+		ERROR("Column number %i is out of range\n", cN1);
+		return -1;
+	}
+
+	if (cN2 < -1 || cN2 >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+
+		ERROR("Column number %i is out of range\n", cN2);
+		return -1;
+	}
+
+	sN = plotGetFreeSubtract(pl, dN);
+
+	if (sN < 0) {
+
+		ERROR("Unable to get free subtract\n");
+		return -1;
+	}
+
+	pl->data[dN].sub[sN].busy = opSUB;
+	pl->data[dN].sub[sN].op.binary.column_X = cN1;
+	pl->data[dN].sub[sN].op.binary.column_Y = cN2;
+
+	plotDataSubtractCompute(pl, dN, sN);
+
+	cN = sN + pl->data[dN].column_N;
+
+	return cN;
+}
+
+int plotGetSubtractFilter(plot_t *pl, int dN, int cNX, int cNY, int opSUB, double gain)
+{
+	int		sN;
+
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return -1;
+	}
+
+	if (cNX < -1 || cNX >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+
+		ERROR("Column number %i is out of range\n", cNX);
+		return -1;
+	}
+
+	if (cNY < -1 || cNY >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+
+		ERROR("Column number %i is out of range\n", cNY);
+		return -1;
+	}
+
+	sN = plotGetFreeSubtract(pl, dN);
+
+	if (sN < 0) {
+
+		ERROR("Unable to get free subtract\n");
+		return -1;
+	}
+
+	pl->data[dN].sub[sN].busy = opSUB;
+	pl->data[dN].sub[sN].op.filter.column_X = cNX;
+	pl->data[dN].sub[sN].op.filter.column_Y = cNY;
+	pl->data[dN].sub[sN].op.filter.gain = gain;
+
+	plotDataSubtractCompute(pl, dN, sN);
+
+	cNY = sN + pl->data[dN].column_N;
+
+	return cNY;
+}
+
+int plotGetSubtractMedian(plot_t *pl, int dN, int cN, int opSUB, int length)
+{
+	int		sN;
+
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return -1;
+	}
+
+	if (cN < -1 || cN >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+
+		ERROR("Column number %i is out of range\n", cN);
+		return -1;
+	}
+
+	if (length < 1 || length > PLOT_MEDIAN_MAX) {
+
+		ERROR("Median length %i is out of range\n", length);
+		return -1;
+	}
+
+	sN = plotGetFreeSubtract(pl, dN);
+
+	if (sN < 0) {
+
+		ERROR("Unable to get free subtract\n");
+		return -1;
+	}
+
+	pl->data[dN].sub[sN].busy = opSUB;
+	pl->data[dN].sub[sN].op.median.column_Y = cN;
+	pl->data[dN].sub[sN].op.median.length = length;
+	pl->data[dN].sub[sN].op.median.unwrap = 0;
+	pl->data[dN].sub[sN].op.median.opdata = 0;
+
+	plotDataSubtractCompute(pl, dN, sN);
+
+	cN = sN + pl->data[dN].column_N;
+
+	return cN;
+}
+
+int plotGetFreeFigure(plot_t *pl)
+{
+	int		N, fN = -1;
+
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+		if (pl->figure[N].busy == 0) {
+
+			fN = N;
+			break;
+		}
+	}
+
+	return fN;
+}
+
+int plotFigureSubtractGetMedianConfig(plot_t *pl, int fN, int *length, int *unwrap, int *opdata)
+{
+	int		dN, cN, sN;
+
+	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return -1;
+	}
+
+	dN = pl->figure[fN].data_N;
+	cN = pl->figure[fN].column_Y;
+
+	sN = cN - pl->data[dN].column_N;
+
+	if (		sN >= 0 && sN < PLOT_SUBTRACT
+			&& pl->data[dN].sub[sN].busy == SUBTRACT_DATA_MEDIAN) {
+
+		*length = pl->data[dN].sub[sN].op.median.length;
+		*unwrap = pl->data[dN].sub[sN].op.median.unwrap;
+		*opdata = pl->data[dN].sub[sN].op.median.opdata;
+
+		return sN;
+	}
+
+	return -1;
+}
+
+void plotFigureSubtractTimeMedian(plot_t *pl, int fN, int length, int unwrap, int opdata)
+{
+	tuple_t		uN;
+	int		dN, cNX, cNY, sN;
+
+	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return ;
+	}
+
+	dN = pl->figure[fN].data_N;
+	cNX = pl->figure[fN].column_X;
+	cNY = pl->figure[fN].column_Y;
+
+	if (length < 1) {
+
+		sN = cNY - pl->data[dN].column_N;
+
+		if (		sN >= 0 && sN < PLOT_SUBTRACT
+				&& pl->data[dN].sub[sN].busy == SUBTRACT_DATA_MEDIAN) {
+
+			cNX = pl->data[dN].sub[sN].op.median.column_X;
+			cNY = pl->data[dN].sub[sN].op.median.column_Y;
+
+			pl->figure[fN].column_X = cNX;
+			pl->figure[fN].column_Y = cNY;
+
+			plotSubtractGarbage(pl, dN);
+		}
+	}
+	else {
+		sN = cNY - pl->data[dN].column_N;
+
+		if (		sN >= 0 && sN < PLOT_SUBTRACT
+				&& pl->data[dN].sub[sN].busy == SUBTRACT_DATA_MEDIAN) {
+
+			if (		pl->data[dN].sub[sN].op.median.length != length
+					|| pl->data[dN].sub[sN].op.median.unwrap != unwrap
+					|| pl->data[dN].sub[sN].op.median.opdata != opdata) {
+
+				cNX = pl->data[dN].sub[sN].op.median.column_X;
+				cNY = pl->data[dN].sub[sN].op.median.column_Y;
+
+				pl->figure[fN].column_X = cNX;
+				pl->figure[fN].column_Y = cNY;
+
+				plotSubtractGarbage(pl, dN);
+
+				uN = plotGetSubtractTimeMedian(pl, dN, cNX, cNY, length, unwrap, opdata);
+
+				if (uN.X != -1) {
+
+					pl->figure[fN].column_X = uN.X;
+					pl->figure[fN].column_Y = uN.Y;
+				}
+			}
+		}
+		else {
+			uN = plotGetSubtractTimeMedian(pl, dN, cNX, cNY, length, unwrap, opdata);
+
+			if (uN.X != -1) {
+
+				pl->figure[fN].column_X = uN.X;
+				pl->figure[fN].column_Y = uN.Y;
+			}
+		}
+	}
+}
+
+void plotFigureSubtractScale(plot_t *pl, int fN, int aBUSY, double scale, double offset)
+{
+	int		dN, cN;
+
+	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return ;
+	}
+
+	dN = pl->figure[fN].data_N;
+
+	if (aBUSY == AXIS_BUSY_X) {
+
+		cN = plotGetSubtractScale(pl, dN, pl->figure[fN].column_X, scale, offset);
+
+		if (cN != -1) {
+
+			pl->figure[fN].column_X = cN;
+		}
+	}
+	else if (aBUSY == AXIS_BUSY_Y) {
+
+		cN = plotGetSubtractScale(pl, dN, pl->figure[fN].column_Y, scale, offset);
+
+		if (cN != -1) {
+
+			pl->figure[fN].column_Y = cN;
+		}
+	}
+}
+
+static int
+plotFigureSubtractAdd(plot_t *pl, int fN, int fN_1, int fN_2, int opSUB)
+{
+	const char	*label_1, *label_2, *delim;
+	int		dN, aNX, aNY, cNX, cNY;
+
+	dN = pl->figure[fN_1].data_N;
+
+	cNX = pl->figure[fN_1].column_X;
+	aNX = pl->figure[fN_1].axis_X;
+
+	if (aNX != pl->figure[fN_2].axis_X) {
+
+		ERROR("Both figures must be on the same axis on X\n");
+		return 0;
+	}
+
+	if (		dN != pl->figure[fN_2].data_N
+			|| cNX != pl->figure[fN_2].column_X) {
+
+		cNY = plotGetSubtractResample(pl, dN, cNX,
+				pl->figure[fN_2].data_N,
+				pl->figure[fN_2].column_X,
+				pl->figure[fN_2].column_Y);
+
+		if (cNY < 0) {
+
+			ERROR("Unable to get resample subtract\n");
+			return 0;
+		}
+	}
+	else {
+		cNY = pl->figure[fN_2].column_Y;
+	}
+
+	cNY = plotGetSubtractBinary(pl, dN, opSUB, pl->figure[fN_1].column_Y, cNY);
+
+	if (cNY < 0) {
+
+		return 0;
+	}
+
+	aNY = plotGetFreeAxis(pl);
+
+	if (aNY != -1) {
+
+		pl->axis[aNY].busy = AXIS_BUSY_Y;
+		plotAxisLabel(pl, aNY, pl->axis[pl->figure[fN_1].axis_Y].label);
+	}
+	else {
+		aNY = pl->figure[fN_1].axis_Y;
+	}
+
+	plotFigureAdd(pl, fN, dN, cNX, cNY, aNX, aNY, "");
+
+	label_1 = pl->figure[fN_1].label;
+	label_2 = pl->figure[fN_2].label;
+
+	delim = strrchr(label_1, ' ');
+	label_1 = (delim != NULL) ? delim + 1 : label_1;
+
+	delim = strrchr(label_2, ' ');
+	label_2 = (delim != NULL) ? delim + 1 : label_2;
+
+	if (opSUB == SUBTRACT_BINARY_SUBTRACTION) {
+
+		sprintf(pl->figure[fN].label, "R: %.35s - %.35s", label_1, label_2);
+	}
+	else if (opSUB == SUBTRACT_BINARY_ADDITION) {
+
+		sprintf(pl->figure[fN].label, "A: %.35s + %.35s", label_1, label_2);
+	}
+	else if (opSUB == SUBTRACT_BINARY_MULTIPLICATION) {
+
+		sprintf(pl->figure[fN].label, "X: %.35s * %.35s", label_1, label_2);
+	}
+	else if (opSUB == SUBTRACT_BINARY_HYPOTENUSE) {
+
+		sprintf(pl->figure[fN].label, "H: %.35s ~ %.35s", label_1, label_2);
+	}
+
+	pl->figure[fN].drawing = pl->figure[fN_1].drawing;
+	pl->figure[fN].width = pl->figure[fN_1].width;
+
+	return AXIS_BUSY_Y;
+}
+
+void plotFigureSubtractFilter(plot_t *pl, int fN_1, int opSUB, double gain)
+{
+	int		fN, dN, cNX, cNY, aN;
+
+	if (fN_1 < 0 || fN_1 >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return ;
+	}
+
+	dN = pl->figure[fN_1].data_N;
+	cNX = pl->figure[fN_1].column_X;
+	cNY = pl->figure[fN_1].column_Y;
+
+	fN = plotGetFreeFigure(pl);
+
+	if (fN < 0) {
+
+		ERROR("Unable to get free figure to subtract\n");
+		return ;
+	}
+
+	if (opSUB == SUBTRACT_FILTER_MEDIAN) {
+
+		cNY = plotGetSubtractMedian(pl, dN, cNY, opSUB, (int) gain);
+	}
+	else {
+		cNY = plotGetSubtractFilter(pl, dN, cNX, cNY, opSUB, gain);
+	}
+
+	if (cNY < 0) {
+
+		return ;
+	}
+
+	if (		opSUB == SUBTRACT_FILTER_LOW_PASS
+			|| opSUB == SUBTRACT_FILTER_MEDIAN) {
+
+		aN = pl->figure[fN_1].axis_Y;
+	}
+	else {
+		aN = plotGetFreeAxis(pl);
+
+		if (aN != -1) {
+
+			pl->axis[aN].busy = AXIS_BUSY_Y;
+			plotAxisLabel(pl, aN, pl->axis[pl->figure[fN_1].axis_Y].label);
+		}
+		else {
+			aN = pl->figure[fN_1].axis_Y;
+		}
+	}
+
+	plotFigureAdd(pl, fN, dN, cNX, cNY, pl->figure[fN_1].axis_X, aN, "");
+
+	if (opSUB == SUBTRACT_FILTER_DIFFERENCE) {
+
+		sprintf(pl->figure[fN].label, "D: %.75s", pl->figure[fN_1].label);
+	}
+	else if (opSUB == SUBTRACT_FILTER_CUMULATIVE) {
+
+		sprintf(pl->figure[fN].label, "I: %.75s", pl->figure[fN_1].label);
+	}
+	else if (opSUB == SUBTRACT_FILTER_BITMASK) {
+
+		int	bf[2] = { 0, (int) gain };
+
+		bf[0] = bf[1] & 0xFFU;
+		bf[1] = bf[1] >> 8;
+
+		if (bf[0] == bf[1]) {
+
+			sprintf(pl->figure[fN].label, "B(%d): %.75s",
+					(int) bf[0], pl->figure[fN_1].label);
+		}
+		else {
+			sprintf(pl->figure[fN].label, "B(%d-%d): %.75s",
+					(int) bf[0], (int) bf[1], pl->figure[fN_1].label);
+		}
+	}
+	else if (opSUB == SUBTRACT_FILTER_LOW_PASS) {
+
+		sprintf(pl->figure[fN].label, "L(%.2E): %.75s",
+				gain, pl->figure[fN_1].label);
+	}
+	else if (opSUB == SUBTRACT_FILTER_MEDIAN) {
+
+		sprintf(pl->figure[fN].label, "M(%d): %.75s",
+				(int) gain, pl->figure[fN_1].label);
+	}
+
+	pl->figure[fN].drawing = pl->figure[fN_1].drawing;
+	pl->figure[fN].width = pl->figure[fN_1].width;
+
+	if (opSUB == SUBTRACT_FILTER_LOW_PASS) {
+
+		/* Do nothing */
+	}
+	else {
+		plotAxisScaleAutoCond(pl, pl->figure[fN].axis_Y, pl->figure[fN].axis_X);
+
+		pl->on_X = pl->figure[fN].axis_X;
+		pl->on_Y = pl->figure[fN].axis_Y;
+
+		if (pl->axis[pl->on_X].slave != 0) {
+
+			pl->on_X = pl->axis[pl->on_X].slave_N;
+		}
+
+		if (pl->axis[pl->on_Y].slave != 0) {
+
+			pl->on_Y = pl->axis[pl->on_Y].slave_N;
+		}
+	}
+}
+
+static void
+plotFigureSubtractBinaryLinked(plot_t *pl, int fN, int opSUB, int fNP[2])
+{
+	int		dN, dN1, sN, sE, cN, cN1, fN_1, fN_2;
+
+	dN = pl->figure[fN].data_N;
+	sN = pl->figure[fN].column_Y - pl->data[dN].column_N;
+
+	fN_1 = -1;
+	fN_2 = -1;
+
+	if (		sN >= 0 && sN < PLOT_SUBTRACT
+			&& pl->data[dN].sub[sN].busy == opSUB) {
+
+		cN = pl->data[dN].sub[sN].op.binary.column_X;
+		sE = cN - pl->data[dN].column_N;
+
+		dN1 = dN;
+		cN1 = cN;
+
+		if (		sE >= 0 && sE < PLOT_SUBTRACT
+				&& pl->data[dN].sub[sE].busy == SUBTRACT_RESAMPLE) {
+
+			dN1 = pl->data[dN].sub[sE].op.resample.in_data_N;
+			cN1 = pl->data[dN].sub[sE].op.resample.in_column_Y;
+		}
+
+		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+			if (pl->figure[fN].busy != 0) {
+
+				if (		dN == pl->figure[fN].data_N
+						&& cN == pl->figure[fN].column_Y) {
+
+					fN_1 = fN;
+					break;
+				}
+
+				if (		dN1 == pl->figure[fN].data_N
+						&& cN1 == pl->figure[fN].column_Y) {
+
+					fN_1 = fN;
+					break;
+				}
+			}
+		}
+
+		cN = pl->data[dN].sub[sN].op.binary.column_Y;
+		sE = cN - pl->data[dN].column_N;
+
+		dN1 = dN;
+		cN1 = cN;
+
+		if (		sE >= 0 && sE < PLOT_SUBTRACT
+				&& pl->data[dN].sub[sE].busy == SUBTRACT_RESAMPLE) {
+
+			dN1 = pl->data[dN].sub[sE].op.resample.in_data_N;
+			cN1 = pl->data[dN].sub[sE].op.resample.in_column_Y;
+		}
+
+		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+			if (pl->figure[fN].busy != 0) {
+
+				if (		dN == pl->figure[fN].data_N
+						&& cN == pl->figure[fN].column_Y) {
+
+					fN_2 = fN;
+					break;
+				}
+
+				if (		dN1 == pl->figure[fN].data_N
+						&& cN1 == pl->figure[fN].column_Y) {
+
+					fN_2 = fN;
+					break;
+				}
+			}
+		}
+	}
+
+	fNP[0] = fN_1;
+	fNP[1] = fN_2;
+}
+
+void plotFigureSubtractSwitch(plot_t *pl, int opSUB)
+{
+	int		fN, fN_1, fN_2, fNQ[2], rBUSY, N = 0;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (pl->figure[fN].busy != 0 && pl->figure[fN].hidden == 0) {
+
+			if (N < 2) {
+
+				fNQ[N] = fN;
+			}
+
+			N++;
+		}
+	}
+
+	if (N == 1) {
+
+		fN = fNQ[0];
+
+		plotFigureSubtractBinaryLinked(pl, fN, opSUB, fNQ);
+
+		fN_1 = fNQ[0];
+		fN_2 = fNQ[1];
+
+		if (fN_1 != -1 && fN_2 != -1) {
+
+			pl->figure[fN].hidden = 1;
+
+			pl->figure[fN_1].hidden = 0;
+			pl->figure[fN_2].hidden = 0;
+
+			pl->on_X = pl->figure[fN_1].axis_X;
+			pl->on_Y = pl->figure[fN_1].axis_Y;
+		}
+	}
+	else if (N == 2) {
+
+		fN_1 = fNQ[0];
+		fN_2 = fNQ[1];
+
+		fN = -1;
+
+		for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+			if (pl->figure[N].busy != 0) {
+
+				plotFigureSubtractBinaryLinked(pl, N, opSUB, fNQ);
+
+				if (fNQ[0] == fN_1 && fNQ[1] == fN_2) {
+
+					fN = N;
+					break;
+				}
+
+				if (fNQ[0] == fN_2 && fNQ[1] == fN_1) {
+
+					fN = N;
+					break;
+				}
+			}
+		}
+
+		if (fN != -1) {
+
+			pl->figure[fN].hidden = 0;
+
+			pl->figure[fN_1].hidden = 1;
+			pl->figure[fN_2].hidden = 1;
+
+			if (		pl->figure[fN].axis_X == pl->figure[fN_1].axis_X
+					&& pl->figure[fN].axis_X == pl->figure[fN_2].axis_X) {
+
+				plotAxisScaleAutoCond(pl, pl->figure[fN].axis_Y,
+						pl->figure[fN].axis_X);
+			}
+			else if (	pl->figure[fN].axis_Y == pl->figure[fN_1].axis_Y
+					&& pl->figure[fN].axis_Y == pl->figure[fN_2].axis_Y) {
+
+				plotAxisScaleAutoCond(pl, pl->figure[fN].axis_X,
+						pl->figure[fN].axis_Y);
+			}
+
+			pl->on_X = pl->figure[fN].axis_X;
+			pl->on_Y = pl->figure[fN].axis_Y;
+		}
+		else {
+			fN = plotGetFreeFigure(pl);
+
+			if (fN < 0) {
+
+				ERROR("Unable to get free figure to subtract\n");
+				return ;
+			}
+
+			rBUSY = plotFigureSubtractAdd(pl, fN, fN_1, fN_2, opSUB);
+
+			if (rBUSY != 0) {
+
+				pl->figure[fN_1].hidden = 1;
+				pl->figure[fN_2].hidden = 1;
+
+				if (rBUSY == AXIS_BUSY_X) {
+
+					plotAxisScaleAutoCond(pl, pl->figure[fN].axis_X,
+							pl->figure[fN].axis_Y);
+				}
+				else if (rBUSY == AXIS_BUSY_Y) {
+
+					plotAxisScaleAutoCond(pl, pl->figure[fN].axis_Y,
+							pl->figure[fN].axis_X);
+				}
+				else {
+					plotAxisScaleAuto(pl, pl->figure[fN].axis_X);
+					plotAxisScaleAuto(pl, pl->figure[fN].axis_Y);
+				}
+
+				pl->on_X = pl->figure[fN].axis_X;
+				pl->on_Y = pl->figure[fN].axis_Y;
+			}
+		}
+	}
+
+	if (pl->axis[pl->on_X].slave != 0) {
+
+		pl->on_X = pl->axis[pl->on_X].slave_N;
+	}
+
+	if (pl->axis[pl->on_Y].slave != 0) {
+
+		pl->on_Y = pl->axis[pl->on_Y].slave_N;
+	}
+}
+
+void plotTotalSubtractResample(plot_t *pl, int dN, double tmin, double tmax)
+{
+	double		scale, offset;
+	int		N, cNX, cNY;
+
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return ;
+	}
+
+	if (pl->data[dN].column_N < 1) {
+
+		ERROR("Dataset %i is not allocated\n", dN);
+		return ;
+	}
+
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+		if (		pl->figure[N].busy != 0
+				&& pl->figure[N].hidden == 0) {
+
+			if (pl->figure[N].axis_X != pl->on_X) {
+
+				ERROR("All figures must be on the active axis on X\n");
+				return ;
+			}
+		}
+	}
+
+	N = plotDataLength(pl, dN);
+
+	scale = (tmax - tmin) / (double) (N - 1);
+	offset = tmin;
+
+	cNX = plotGetSubtractScale(pl, dN, -1, scale, offset);
+
+	if (cNX < 0)
+		return ;
+
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+		if (		pl->figure[N].busy != 0
+				&& pl->figure[N].hidden == 0) {
+
+			if (		dN != pl->figure[N].data_N
+					|| cNX != pl->figure[N].column_X) {
+
+				cNY = plotGetSubtractResample(pl, dN, cNX,
+						pl->figure[N].data_N,
+						pl->figure[N].column_X,
+						pl->figure[N].column_Y);
+
+				if (cNY < 0) {
+
+					ERROR("Unable to get resample subtract\n");
+					return ;
+				}
+
+				pl->figure[N].data_N = dN;
+				pl->figure[N].column_X = cNX;
+				pl->figure[N].column_Y = cNY;
+			}
+		}
+	}
+}
+
+int plotDataBoxPolyfit(plot_t *pl, int fN)
+{
+	int		N, dN, sN, N0, N1;
+	double		*coefs, std;
+
+	if (fN < 0 || fN >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return 0;
+	}
+
+	dN = pl->figure[fN].data_N;
+	sN = pl->figure[fN].column_Y - pl->data[dN].column_N;
+
+	if (sN < 0 || sN >= PLOT_SUBTRACT) {
+
+		return 0;
+	}
+	else if (pl->data[dN].sub[sN].busy != SUBTRACT_POLYFIT) {
+
+		return 0;
+	}
+
+	N0 = pl->data[dN].sub[sN].op.polyfit.poly_N0;
+	N1 = pl->data[dN].sub[sN].op.polyfit.poly_N1;
+
+	coefs = pl->data[dN].sub[sN].op.polyfit.coefs;
+	std = pl->data[dN].sub[sN].op.polyfit.std;
+
+	for (N = 0; N < PLOT_DATA_BOX_MAX; ++N) {
+
+		pl->data_box_text[N][0] = 0;
+
+		if (N == 0 && N1 == 0) {
+
+			sprintf(pl->data_box_text[N], " [%i] = ", N);
+			plotDataBoxTextFmt(pl, N, coefs[N]);
+		}
+		else if (N < N1 - N0 + 1) {
+
+			char		sfmt[PLOT_STRING_MAX];
+
+			sprintf(sfmt, " [%%i] = %% .%iE ", pl->fprecision - 1);
+			sprintf(pl->data_box_text[N], sfmt, N + N0, coefs[N]);
+		}
+		else if (N == N1 - N0 + 1) {
+
+			sprintf(pl->data_box_text[N], " STD = ");
+			plotDataBoxTextFmt(pl, N, std);
+		}
+	}
+
+	if (pl->data_box_on != DATA_BOX_POLYFIT) {
+
+		pl->data_box_on = DATA_BOX_POLYFIT;
+		pl->data_box_X = pl->viewport.max_x;
+		pl->data_box_Y = 0;
+	}
+
+	return 1;
+}
+
+void plotFigureSubtractPolyfit(plot_t *pl, int fN_1, int N0, int N1)
+{
+	int		N, fN, dN, sN, cN, aN, bN;
+	double		scale_X, offset_X, scale_Y, offset_Y;
+
+	if (fN_1 < 0 || fN_1 >= PLOT_FIGURE_MAX) {
+
+		ERROR("Figure number is out of range\n");
+		return ;
+	}
+
+	if (N0 < 0 || N0 > N1) {
+
+		ERROR("Polynomial base %i is out of range\n", N0);
+		return ;
+	}
+
+	if (N1 < 0 || N1 > PLOT_POLYFIT_MAX) {
+
+		ERROR("Polynomial degree %i is out of range\n", N1);
+		return ;
+	}
+
+	fN = plotGetFreeFigure(pl);
+
+	if (fN < 0) {
+
+		ERROR("Unable to get free figure to subtract\n");
+		return ;
+	}
+
+	dN = pl->figure[fN_1].data_N;
+	sN = plotGetFreeSubtract(pl, dN);
+
+	if (sN < 0) {
+
+		ERROR("Unable to get free subtract\n");
+		return ;
+	}
+
+	aN = pl->figure[fN_1].axis_X;
+
+	scale_X = pl->axis[aN].scale;
+	offset_X = pl->axis[aN].offset;
+
+	if (pl->axis[aN].slave != 0) {
+
+		bN = pl->axis[aN].slave_N;
+		scale_X *= pl->axis[bN].scale;
+		offset_X = offset_X * pl->axis[bN].scale + pl->axis[bN].offset;
+	}
+
+	aN = pl->figure[fN_1].axis_Y;
+
+	scale_Y = pl->axis[aN].scale;
+	offset_Y = pl->axis[aN].offset;
+
+	if (pl->axis[aN].slave != 0) {
+
+		bN = pl->axis[aN].slave_N;
+		scale_Y *= pl->axis[bN].scale;
+		offset_Y = offset_X * pl->axis[bN].scale + pl->axis[bN].offset;
+	}
+
+	plotDataPolyfit(pl, dN, pl->figure[fN_1].column_X, pl->figure[fN_1].column_Y,
+			scale_X, offset_X, scale_Y, offset_Y, N0, N1);
+
+	pl->data[dN].sub[sN].busy = SUBTRACT_POLYFIT;
+	pl->data[dN].sub[sN].op.polyfit.column_X = pl->figure[fN_1].column_X;
+	pl->data[dN].sub[sN].op.polyfit.column_Y = pl->figure[fN_1].column_Y;
+	pl->data[dN].sub[sN].op.polyfit.poly_N0 = N0;
+	pl->data[dN].sub[sN].op.polyfit.poly_N1 = N1;
+
+	for (N = 0; N < N1 - N0 + 1; ++N) {
+
+		pl->data[dN].sub[sN].op.polyfit.coefs[N] = pl->lsq.sol.m[N];
+	}
+
+	pl->data[dN].sub[sN].op.polyfit.std = pl->lsq.std.m[0];
+
+	plotDataSubtractCompute(pl, dN, sN);
+
+	cN = sN + pl->data[dN].column_N;
+	aN = pl->figure[fN_1].axis_Y;
+
+	plotFigureAdd(pl, fN, dN, pl->figure[fN_1].column_X, cN,
+			pl->figure[fN_1].axis_X, aN, "");
+
+	sprintf(pl->figure[fN].label, "P: %.75s", pl->figure[fN_1].label);
+
+	pl->figure[fN].drawing = pl->figure[fN_1].drawing;
+	pl->figure[fN].width = pl->figure[fN_1].width;
+
+	plotDataBoxPolyfit(pl, fN);
+}
+
+static void
+plotLabelFusedCSV(plot_t *pl, char *label, const char *name, const char *unit)
+{
+	const read_t	*rd = (const read_t *) pl->ld;
+
+	const char	*s;
+	char		*l = label;
+	int		n;
+
+	s = strrchr(name, ' ');
+	s = (s != NULL) ? s + 1 : name;
+	n = 0;
+
+	while (*s != 0) {
+
+		if (*s == '@')
+			break;
+
+		*l++ = (strchr(rd->mk_text.space, *s) == NULL) ? *s : '_';
+
+		++s;
+		++n;
+
+		if (n >= 50)
+			break;
+	}
+
+	s = unit;
+	n = 0;
+
+	if (*s != 0) {
+
+		*l++ = '@';
+	}
+
+	while (*s != 0) {
+
+		if (*s == '@')
+			break;
+
+		*l++ = (strchr(rd->mk_text.space, *s) == NULL) ? *s : '_';
+
+		++s;
+		++n;
+
+		if (n >= 20)
+			break;
+	}
+
+	*l = 0;
+}
+
+int plotFigureExportOpen(plot_t *pl, const char *file, int format)
+{
+	const read_t	*rd = (const read_t *) pl->ld;
+	pexport_t	*ex;
+
+	char		labelbuf[PLOT_STRING_MAX];
+	int		list_fN[PLOT_FIGURE_MAX * 2];
+	int		N, fN, aN, dN, cN, job, size;
+
+	if (pl->export_job != NULL) {
+
+		ERROR("Previous export was interrupted\n");
+		plotFigureExportClose(pl);
+	}
+
+	ex = (pexport_t *) calloc(1, sizeof(pexport_t));
+
+	if (ex == NULL) {
+
+		ERROR("No memory allocated for export\n");
+		return -1;
+	}
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0) {
+
+			job = 1;
+
+			for (N = 0; N < ex->len_N; ++N) {
+
+				if (		ex->list_dN[N] == pl->figure[fN].data_N
+						&& ex->list_cN[N] == pl->figure[fN].column_X) {
+
+					job = 0;
+					break;
+				}
+			}
+
+			if (job != 0) {
+
+				ex->list_dN[ex->len_N] = pl->figure[fN].data_N;
+				ex->list_cN[ex->len_N] = pl->figure[fN].column_X;
+				list_fN[ex->len_N] = fN;
+
+				ex->len_N++;
+			}
+
+			job = 1;
+
+			for (N = 0; N < ex->len_N; ++N) {
+
+				if (		ex->list_dN[N] == pl->figure[fN].data_N
+						&& ex->list_cN[N] == pl->figure[fN].column_Y) {
+
+					job = 0;
+					break;
+				}
+			}
+
+			if (job != 0) {
+
+				ex->list_dN[ex->len_N] = pl->figure[fN].data_N;
+				ex->list_cN[ex->len_N] = pl->figure[fN].column_Y;
+				list_fN[ex->len_N] = fN;
+
+				ex->len_N++;
+			}
+		}
+	}
+
+	if (ex->len_N < 2) {
+
+		free(ex);
+		return 0;
+	}
+
+	ex->format = format;
+	ex->fprecision = pl->fprecision;
+	ex->space = rd->mk_text.space[0];
+
+	size = (format == EXPORT_CSV) ? ex->len_N * (ex->fprecision + 24) + 1
+		: (format == EXPORT_FP32) ? ex->len_N * sizeof(float)
+		: ex->len_N * sizeof(double);
+
+	for (N = 0; N < PLOT_EXPORT_JOB_MAX; ++N) {
+
+		ex->job[N].ex = ex;
+
+		ex->job[N].fval = (double *) malloc(sizeof(double) * ex->len_N * PLOT_EXPORT_ROWS);
+		ex->job[N].text = (char *) malloc(size * PLOT_EXPORT_ROWS);
+
+		if (ex->job[N].fval == NULL || ex->job[N].text == NULL) {
+
+			ERROR("No memory allocated for export\n");
+
+			pl->export_job = ex;
+			plotFigureExportClose(pl);
+
+			return -1;
+		}
+	}
+
+	ex->fd = unified_fopen(file, (format == EXPORT_CSV) ? "w" : "wb");
+
+	if (ex->fd == NULL) {
+
+		ERROR("fopen(\"%s\"): %s\n", file, strerror(errno));
+
+		pl->export_job = ex;
+		plotFigureExportClose(pl);
+
+		return -1;
+	}
+
+	ex->afd = async_open_write(ex->fd, rd->preload, rd->preload / 4);
+
+	if (ex->afd == NULL) {
+
+		pl->export_job = ex;
+		plotFigureExportClose(pl);
+
+		return -1;
+	}
+
+	for (N = 0; N < ex->len_N; ++N) {
+
+		fN = list_fN[N];
+		dN = ex->list_dN[N];
+		cN = ex->list_cN[N];
+
+		if (format == EXPORT_CSV) {
+
+			if (cN == pl->figure[fN].column_X) {
+
+				aN = pl->figure[fN].axis_X;
+
+				plotLabelFusedCSV(pl, labelbuf, "time",
+						pl->axis[aN].label);
+			}
+			else {
+				aN = pl->figure[fN].axis_Y;
+
+				plotLabelFusedCSV(pl, labelbuf,
+						pl->figure[fN].label,
+						pl->axis[aN].label);
+			}
+
+#ifdef _WINDOWS
+			if (rd->legacy_label == 1) {
+
+				legacy_UTF8_to_ACP(labelbuf, labelbuf, sizeof(labelbuf));
+			}
+			else if (rd->legacy_label == 2) {
+
+				legacy_UTF8_to_OEM(labelbuf, labelbuf, sizeof(labelbuf));
+			}
+#endif /* _WINDOWS */
+
+			size = strlen(labelbuf);
+
+			labelbuf[size++] = rd->mk_text.space[0];
+			labelbuf[size] = 0;
+
+			plotExportWrite(ex, labelbuf, size);
+		}
+
+		/* Hexadecimal and octal columns are exported as they were
+		 * read.
+		 * */
+		ex->list_hint[N] = (	   pl->fhexadecimal != 0
+					&& cN >= 0 && cN < READ_COLUMN_MAX)
+					? rd->data[dN].hint[cN] : DATA_HINT_NONE;
+
+		ex->local[dN].busy = 1;
+	}
+
+	if (format == EXPORT_CSV) {
+
+		plotExportWrite(ex, "\n", 1);
+	}
+
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+
+		if (ex->local[dN].busy != 0) {
+
+			ex->local[dN].rN = pl->data[dN].head_N;
+			ex->local[dN].id_N = pl->data[dN].id_N;
+			ex->local[dN].row_N = plotDataLength(pl, dN);
+			ex->local[dN].length_N = pl->data[dN].length_N;
+
+			ex->total_N = (ex->local[dN].row_N > ex->total_N)
+				? ex->local[dN].row_N : ex->total_N;
+		}
+	}
+
+	pl->export_job = ex;
+
+	return 0;
+}
+
+int plotFigureExportStep(plot_t *pl)
+{
+	pexport_t	*ex = pl->export_job;
+	int		N, job_N;
+
+	if (ex == NULL)
+		return -1;
+
+	if (plotExportCheck(pl, ex) == 0) {
+
+		ERROR("Export was interrupted by dataset change\n");
+		plotFigureExportClose(pl);
+
+		return -1;
+	}
+
+	/* Gather the blocks one by one and format them in parallel. Then the
+	 * output is written in order.
+	 * */
+	for (N = 0; N < PLOT_EXPORT_JOB_MAX; ++N) {
+
+		if (ex->done_N >= ex->total_N)
+			break;
+
+		plotExportGather(pl, ex, &ex->job[N]);
+
+		poolSubmit(pl->pool, &ex->job[N].task,
+				(void (*) (void *)) &plotExportFormat, &ex->job[N]);
+	}
+
+	job_N = N;
+
+	for (N = 0; N < job_N; ++N) {
+
+		poolWait(pl->pool, &ex->job[N].task);
+
+		plotExportWrite(ex, ex->job[N].text, ex->job[N].text_N);
+	}
+
+	if (ex->done_N >= ex->total_N) {
+
+		return (plotFigureExportClose(pl) == 0) ? 100 : -1;
+	}
+
+	return (int) ((long long) ex->done_N * 100 / ex->total_N);
+}
+
+int plotFigureExportClose(plot_t *pl)
+{
+	pexport_t	*ex = pl->export_job;
+	int		N, rc = 0;
+
+	if (ex == NULL)
+		return -1;
+
+	if (ex->afd != NULL) {
+
+		async_close(ex->afd);
+	}
+
+	if (ex->fd != NULL) {
+
+		rc = (ferror(ex->fd) != 0) ? -1 : 0;
+
+		if (fclose(ex->fd) != 0 || rc != 0) {
+
+			ERROR("Unable to write export file: %s\n", strerror(errno));
+			rc = -1;
+		}
+	}
+
+	for (N = 0; N < PLOT_EXPORT_JOB_MAX; ++N) {
+
+		free(ex->job[N].fval);
+		free(ex->job[N].text);
+	}
+
+	free(ex);
+
+	pl->export_job = NULL;
+
+	return rc;
+}
+
+int plotFigureExportCSV(plot_t *pl, const char *file)
+{
+	int		rc;
+
+	rc = plotFigureExportOpen(pl, file, EXPORT_CSV);
+
+	while (pl->export_job != NULL) {
+
+		rc = plotFigureExportStep(pl);
+		rc = (rc < 0) ? -1 : 0;
+	}
+
+	return rc;
+}
+
+void plotFigureClean(plot_t *pl)
+{
+	int		N;
+
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+		pl->figure[N].busy = 0;
+		pl->figure[N].hidden = 0;
+		pl->figure[N].label[0] = 0;
+	}
+
+	for (N = 0; N < PLOT_AXES_MAX; ++N) {
+
+		pl->axis[N].busy = AXIS_FREE;
+		pl->axis[N].slave = 0;
+		pl->axis[N].label[0] = 0;
+		pl->axis[N].compact = 1;
+		pl->axis[N].exponential = 0;
+	}
+
+	pl->legend_X = 0;
+	pl->legend_Y = 0;
+
+	pl->data_box_on = DATA_BOX_FREE;
+	pl->data_box_X = pl->viewport.max_x;
+	pl->data_box_Y = 0;
+
+	pl->slice_on = 0;
+	pl->slice_mode_N = 0;
+
+	pl->pick_on = 0;
+
+	pl->on_X = -1;
+	pl->on_Y = -1;
+
+	pl->hover_figure = -1;
+	pl->hover_legend = -1;
+	pl->hover_data_box = -1;
+	pl->hover_axis = -1;
+
+	pl->mark_on = 0;
+	pl->brush_on = 0;
+
+	plotSketchClean(pl);
+}
+
+static void
+plotMarkLayout(plot_t *pl)
+{
+	const fval_t	*row;
+
+	double		bias, urand, sigma, total, scale, offset, fval_X, fval_Y;
+	int		fN, vN, aN, bN, cX, cY, cZ, N, id_N, cSTEP, fMAX = 0;
+
+	Uint32		rseed;
+
+	const int	ltdense[PLOT_FIGURE_MAX] = {
+
+		250, 353, 433, 500, 559, 612, 661, 707, 750, 790	/* 250 * sqrt(N) */
+	};
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0) {
+
+			fMAX++;
+		}
+	}
+
+	if (fMAX == 0)
+		return ;
+
+	rseed = SDL_GetTicks();
+
+	rseed = rseed * 17317U + 1U;
+	rseed = rseed * 17317U + 1U;
+
+	pl->layout_mark_size = pl->layout_font_height * pl->mark_size / 200;
+	pl->layout_mark_size = (pl->layout_mark_size < 1) ? 1 : pl->layout_mark_size;
+
+	pl->mark_length = (pl->viewport.max_x - pl->viewport.min_x)
+		* pl->mark_density / (pl->layout_mark_size * ltdense[fMAX - 1]);
+
+	pl->mark_length = (pl->mark_length > PLOT_MARK_MAX) ? PLOT_MARK_MAX
+		: (pl->mark_length < 4) ? 4 : pl->mark_length;
+
+	total = (double) (pl->viewport.max_x - pl->viewport.min_x);
+	sigma = (double) pl->layout_mark_size / total;
+
+	total = (double) (pl->mark_length * fMAX);
+
+	for (fN = 0, vN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0) {
+
+			aN = pl->figure[fN].axis_X;
+			cZ = pl->figure[fN].column_X;
+
+			scale = pl->axis[aN].scale;
+			offset = pl->axis[aN].offset;
+
+			if (pl->axis[aN].slave != 0) {
+
+				bN = pl->axis[aN].slave_N;
+
+				scale *= pl->axis[bN].scale;
+				offset = offset * pl->axis[bN].scale
+					+ pl->axis[bN].offset;
+			}
+
+			rseed = rseed * 17317U + 1U;
+			bias = (double) ((rseed >> 16) & 65535U)
+				/ (double) (pl->mark_length * 65535U);
+
+			for (N = 0; N < pl->mark_length; ++N) {
+
+				rseed = rseed * 17317U + 1U;
+				urand = (double) ((int) ((rseed >> 16) & 65535U)
+						- 32767) / (double) 32767U;
+
+				bias += urand * sigma;
+
+				fval_X = bias + (double) (N * fMAX + vN) / total;
+				fval_X = (fval_X > 1.) ? fval_X - 1.
+					: (fval_X < 0.) ? fval_X + 1. : fval_X;
+
+				fval_X = (fval_X - offset) / scale;
+
+				row = plotDataSliceGet(pl, pl->figure[fN].data_N,
+							cZ, fval_X, &id_N);
+
+				if (row != NULL) {
+
+					cX = pl->figure[fN].column_X;
+					cY = pl->figure[fN].column_Y;
+
+					cSTEP = pl->data[pl->figure[fN].data_N].column_STEP;
+
+					fval_X = (cX < 0) ? id_N : row[cX * cSTEP];
+					fval_Y = (cY < 0) ? id_N : row[cY * cSTEP];
+
+					pl->figure[fN].mark_X[N] = fval_X;
+					pl->figure[fN].mark_Y[N] = fval_Y;
+				}
+				else {
+					pl->figure[fN].mark_X[N] = FP_NAN;
+					pl->figure[fN].mark_Y[N] = FP_NAN;
+				}
+			}
+
+			vN++;
+		}
+	}
+}
+
+static void
+plotMarkDraw(plot_t *pl, SDL_Surface *surface)
+{
+	double		X, Y, scale_X, scale_Y, offset_X, offset_Y;
+	int		N, fN, aN, bN, fwidth;
+
+	int		ncolor;
+
+	SDL_LockSurface(surface);
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0) {
+
+			ncolor = (pl->figure[fN].hidden != 0) ? 11 : fN + 1;
+
+			fwidth = pl->figure[fN].width;
+			fwidth = (fwidth < 1) ? 1 : fwidth;
+
+			aN = pl->figure[fN].axis_X;
+			scale_X = pl->axis[aN].scale;
+			offset_X = pl->axis[aN].offset;
+
+			if (pl->axis[aN].slave != 0) {
+
+				bN = pl->axis[aN].slave_N;
+
+				scale_X *= pl->axis[bN].scale;
+				offset_X = offset_X * pl->axis[bN].scale
+					+ pl->axis[bN].offset;
+			}
+
+			aN = pl->figure[fN].axis_Y;
+			scale_Y = pl->axis[aN].scale;
+			offset_Y = pl->axis[aN].offset;
+
+			if (pl->axis[aN].slave != 0) {
+
+				bN = pl->axis[aN].slave_N;
+
+				scale_Y *= pl->axis[bN].scale;
+				offset_Y = offset_Y * pl->axis[bN].scale
+					+ pl->axis[bN].offset;
+			}
+
+			X = (double) (pl->viewport.max_x - pl->viewport.min_x);
+			Y = (double) (pl->viewport.min_y - pl->viewport.max_y);
+
+			scale_X *= X;
+			offset_X = offset_X * X + pl->viewport.min_x;
+			scale_Y *= Y;
+			offset_Y = offset_Y * Y + pl->viewport.max_y;
+
+			for (N = 0; N < pl->mark_length; ++N) {
+
+				X = pl->figure[fN].mark_X[N] * scale_X + offset_X;
+				Y = pl->figure[fN].mark_Y[N] * scale_Y + offset_Y;
+
+				if (fp_isfinite(X) && fp_isfinite(Y)) {
+
+					drawMarkCanvas(pl->dw, surface, &pl->viewport, X, Y,
+							pl->layout_mark_size, fN, ncolor, fwidth);
+				}
+			}
+		}
+	}
+
+	SDL_UnlockSurface(surface);
+}
+
+void plotGroupAdd(plot_t *pl, int dN, int gN, int cN)
+{
+	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+
+		ERROR("Dataset number is out of range\n");
+		return ;
+	}
+
+	if (gN < 0 || gN >= PLOT_GROUP_MAX) {
+
+		ERROR("Group number is out of range\n");
+		return ;
+	}
+
+	if (cN < -1 || cN >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+
+		ERROR("Column number %i is out of range\n", cN);
+		return ;
+	}
+
+	pl->data[dN].map[cN] = gN;
+}
+
+void plotGroupLabel(plot_t *pl, int gN, const char *label)
+{
+	if (gN < 0 || gN >= PLOT_GROUP_MAX) {
+
+		ERROR("Group number is out of range\n");
+		return ;
+	}
+
+	if (label[0] != 0) {
+
+		strcpy(pl->group[gN].label, label);
+	}
+}
+
+void plotGroupMedian(plot_t *pl, int gN, int length, int unwrap, int opdata)
+{
+	if (gN < 0 || gN >= PLOT_GROUP_MAX) {
+
+		ERROR("Group number is out of range\n");
+		return ;
+	}
+
+	pl->group[gN].op_time_median = (length >= 1) ? 1 : 0;
+	pl->group[gN].op_time_unwrap = unwrap;
+	pl->group[gN].op_time_opdata = opdata;
+
+	pl->group[gN].length = length;
+}
+
+void plotGroupScale(plot_t *pl, int gN, int knob, double scale, double offset)
+{
+	if (gN < 0 || gN >= PLOT_GROUP_MAX) {
+
+		ERROR("Group number is out of range\n");
+		return ;
+	}
+
+	pl->group[gN].op_scale = (knob != 0) ? 1 : 0;
+
+	pl->group[gN].scale = scale;
+	pl->group[gN].offset = offset;
+}
+
+void plotSliceSwitch(plot_t *pl)
+{
+	int		fN;
+
+	if (pl->slice_mode_N == 0) {
+
+		pl->slice_mode_N = 1;
+
+		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+			pl->figure[fN].slice_base_catch = pl->figure[fN].slice_busy;
+
+			if (pl->figure[fN].slice_busy != 0) {
+
+				pl->figure[fN].slice_base_X = pl->figure[fN].slice_X;
+				pl->figure[fN].slice_base_Y = pl->figure[fN].slice_Y;
+			}
+		}
+	}
+	else if (pl->slice_mode_N == 1) {
+
+		pl->slice_mode_N = 2;
+	}
+	else if (pl->slice_mode_N == 2) {
+
+		pl->slice_mode_N = 0;
+	}
+}
+
+void plotSliceTrack(plot_t *pl, int cur_X, int cur_Y)
+{
+	const fval_t	*row = NULL;
+
+	double		fval_X, fval_Y;
+	int		N, fN, aN, bN, dN, cX, cY, id_N, job, cSTEP;
+	int		dN_cache, aN_cache, cX_cache;
+
+	if (pl->slice_mode_N == 2)
+		return ;
+
+	if (pl->slice_axis_N < 0) {
+
+		pl->slice_axis_N = pl->on_X;
+	}
+
+	if (pl->slice_axis_N < 0) {
+
+		ERROR("No valid axis number to slice data\n");
+		return ;
+	}
+
+	dN_cache = -1;
+	aN_cache = -1;
+	cX_cache = -1;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		pl->figure[fN].slice_busy = 0;
+		pl->figure[fN].slice_row = NULL;
+
+		job = 0;
+
+		if (pl->figure[fN].busy != 0 && pl->figure[fN].hidden == 0) {
+
+			aN = pl->slice_axis_N;
+
+			if (pl->axis[aN].busy == AXIS_BUSY_X) {
+
+				if (pl->figure[fN].axis_X == aN) {
+
+					job = 1;
+				}
+				else {
+					bN = pl->figure[fN].axis_X;
+
+					if (pl->axis[bN].slave != 0) {
+
+						if (pl->axis[bN].slave_N == aN)
+							job = 1;
+					}
+					else if (pl->axis[aN].slave != 0) {
+
+						if (pl->axis[aN].slave_N == bN)
+							job = 1;
+					}
+				}
+
+				aN = pl->figure[fN].axis_X;
+				cX = pl->figure[fN].column_X;
+
+				fval_X = plotAxisConvBackward(pl, aN, cur_X);
+			}
+			else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+
+				if (pl->figure[fN].axis_Y == aN) {
+
+					job = 1;
+				}
+				else {
+					bN = pl->figure[fN].axis_Y;
+
+					if (pl->axis[bN].slave != 0) {
+
+						if (pl->axis[bN].slave_N == aN)
+							job = 1;
+					}
+					else if (pl->axis[aN].slave != 0) {
+
+						if (pl->axis[aN].slave_N == bN)
+							job = 1;
+					}
+				}
+
+				aN = pl->figure[fN].axis_Y;
+				cX = pl->figure[fN].column_Y;
+
+				fval_X = plotAxisConvBackward(pl, aN, cur_Y);
+			}
+		}
+
+		if (job) {
+
+			dN = pl->figure[fN].data_N;
+
+			if (		   dN_cache != dN
+					|| aN_cache != aN
+					|| cX_cache != cX) {
+
+				row = plotDataSliceGet(pl, dN, cX, fval_X, &id_N);
+
+				dN_cache = dN;
+				aN_cache = aN;
+				cX_cache = cX;
+			}
+
+			if (row != NULL) {
+
+				cX = pl->figure[fN].column_X;
+				cY = pl->figure[fN].column_Y;
+
+				cSTEP = pl->data[dN].column_STEP;
+
+				fval_X = (cX < 0) ? id_N : row[cX * cSTEP];
+				fval_Y = (cY < 0) ? id_N : row[cY * cSTEP];
+
+				pl->figure[fN].slice_busy = 1;
+				pl->figure[fN].slice_row = row;
+				pl->figure[fN].slice_id_N = id_N;
+				pl->figure[fN].slice_X = fval_X;
+				pl->figure[fN].slice_Y = fval_Y;
+			}
+		}
+	}
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].slice_busy == 0
+				&& pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0) {
+
+			dN = pl->figure[fN].data_N;
+
+			for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+
+				if (		pl->figure[N].slice_busy != 0
+						&& pl->figure[N].busy != 0
+						&& pl->figure[N].hidden == 0
+						&& pl->figure[N].slice_row != NULL
+						&& pl->figure[N].data_N == dN) {
+
+					row = pl->figure[N].slice_row;
+					id_N = pl->figure[N].slice_id_N;
+
+					cX = pl->figure[fN].column_X;
+					cY = pl->figure[fN].column_Y;
+
+					cSTEP = pl->data[dN].column_STEP;
+
+					fval_X = (cX < 0) ? id_N : row[cX * cSTEP];
+					fval_Y = (cY < 0) ? id_N : row[cY * cSTEP];
+
+					pl->figure[fN].slice_busy = 1;
+					pl->figure[fN].slice_X = fval_X;
+					pl->figure[fN].slice_Y = fval_Y;
+
+					break;
+				}
+			}
+		}
+	}
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		pl->data_box_text[fN][0] = 0;
+
+		if (pl->figure[fN].slice_busy != 0) {
+
+			const read_t		*rd = (const read_t *) pl->ld;
+
+			if (		pl->slice_mode_N != 0
+					&& pl->figure[fN].slice_base_catch != 0) {
+
+				fval_X = pl->figure[fN].slice_base_X;
+				fval_Y = pl->figure[fN].slice_base_Y;
+
+				strcat(pl->data_box_text[fN], " \xCE\x94");
+				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_X - fval_X);
+
+				strcat(pl->data_box_text[fN], "\xCE\x94");
+				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_Y - fval_Y);
+			}
+			else {
+				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_X);
+
+				dN = pl->figure[fN].data_N;
+				cY = pl->figure[fN].column_Y;
+
+				if (		pl->fhexadecimal != 0
+						&& (	   rd->data[dN].hint[cY] == DATA_HINT_HEX
+							|| rd->data[dN].hint[cY] == DATA_HINT_OCT)) {
+
+					plotDataBoxTextHex(pl, fN, pl->figure[fN].slice_Y);
+				}
+				else {
+					plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_Y);
+				}
+			}
+		}
+	}
+
+	if (pl->data_box_on != DATA_BOX_SLICE) {
+
+		pl->data_box_on = DATA_BOX_SLICE;
+		pl->data_box_X = pl->viewport.max_x;
+		pl->data_box_Y = 0;
+	}
+}
+
+static void
+plotSliceDrawLight(plot_t *pl, SDL_Surface *surface)
+{
+	double		base_X, base_Y, data_X, data_Y, temp;
+	int		fN, aN, bN;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (		pl->figure[fN].slice_busy != 0
+				&& pl->figure[fN].slice_base_catch != 0) {
+
+			aN = pl->figure[fN].axis_X;
+			bN = pl->figure[fN].axis_Y;
+
+			base_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_base_X);
+			base_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_base_Y);
+
+			data_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_X);
+			data_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_Y);
+
+			if (data_X < base_X) {
+
+				temp = base_X;
+				base_X = data_X;
+				data_X = temp;
+			}
+
+			if (data_Y < base_Y) {
+
+				temp = base_Y;
+				base_Y = data_Y;
+				data_Y = temp;
+			}
+
+			SDL_LockSurface(surface);
+
+			if (pl->axis[pl->slice_axis_N].busy == AXIS_BUSY_X) {
+
+				if (fp_isfinite(base_X) && fp_isfinite(data_X)) {
+
+					drawClipRect(surface, &pl->viewport,
+							(int) base_X, pl->viewport.min_y,
+							(int) data_X, pl->viewport.max_y,
+							pl->sch->plot_hidden);
+				}
+			}
+			else if (pl->axis[pl->slice_axis_N].busy == AXIS_BUSY_Y) {
+
+				if (fp_isfinite(base_Y) && fp_isfinite(data_Y)) {
+
+					drawClipRect(surface, &pl->viewport,
+							pl->viewport.min_x, (int) base_Y,
+							pl->viewport.max_x, (int) data_Y,
+							pl->sch->plot_hidden);
+				}
+			}
+
+			SDL_UnlockSurface(surface);
+		}
+	}
+}
+
+static void
+plotSliceDraw(plot_t *pl, SDL_Surface *surface)
+{
+	double		base_X, base_Y, data_X, data_Y;
+	int		fN, aN, bN;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		if (pl->figure[fN].slice_busy != 0) {
+
+			aN = pl->figure[fN].axis_X;
+			bN = pl->figure[fN].axis_Y;
+
+			if (		pl->slice_mode_N != 0
+					&& pl->figure[fN].slice_base_catch != 0) {
+
+				base_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_base_X);
+				base_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_base_Y);
+			}
+
+			data_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_X);
+			data_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_Y);
+
+			SDL_LockSurface(surface);
+
+			if (pl->axis[pl->slice_axis_N].busy == AXIS_BUSY_X) {
+
+				if (		pl->slice_mode_N != 0
+						&& pl->figure[fN].slice_base_catch != 0) {
+
+					if (fp_isfinite(base_X)) {
+
+						drawDashReset(pl->dw);
+						drawDash(pl->dw, surface, &pl->viewport,
+								base_X, pl->viewport.min_y,
+								base_X, pl->viewport.max_y,
+								pl->sch->plot_text,
+								pl->layout_fence_dash,
+								pl->layout_fence_space);
+					}
+				}
+
+				if (fp_isfinite(data_X)) {
+
+					drawDashReset(pl->dw);
+					drawDash(pl->dw, surface, &pl->viewport,
+							data_X, pl->viewport.min_y,
+							data_X, pl->viewport.max_y,
+							pl->sch->plot_text,
+							pl->layout_fence_dash,
+							pl->layout_fence_space);
+				}
+			}
+			else if (pl->axis[pl->slice_axis_N].busy == AXIS_BUSY_Y) {
+
+				if (		pl->slice_mode_N != 0
+						&& pl->figure[fN].slice_base_catch != 0) {
+
+					if (fp_isfinite(base_Y)) {
+
+						drawDashReset(pl->dw);
+						drawDash(pl->dw, surface, &pl->viewport,
+								pl->viewport.min_x, base_Y,
+								pl->viewport.max_x, base_Y,
+								pl->sch->plot_text,
+								pl->layout_fence_dash,
+								pl->layout_fence_space);
+					}
+				}
+
+				if (fp_isfinite(data_Y)) {
+
+					drawDashReset(pl->dw);
+					drawDash(pl->dw, surface, &pl->viewport,
+							pl->viewport.min_x, data_Y,
+							pl->viewport.max_x, data_Y,
+							pl->sch->plot_text,
+							pl->layout_fence_dash,
+							pl->layout_fence_space);
+				}
+			}
+
+			if (		pl->slice_mode_N != 0
+					&& pl->figure[fN].slice_base_catch != 0) {
+
+				if (fp_isfinite(base_X) && fp_isfinite(base_Y)) {
+
+					drawDotCanvas(pl->dw, surface, &pl->viewport,
+							base_X, base_Y,
+							pl->layout_fence_point, 12, 0);
+				}
+			}
+
+			if (fp_isfinite(data_X) && fp_isfinite(data_Y)) {
+
+				drawDotCanvas(pl->dw, surface, &pl->viewport,
+						data_X, data_Y,
+						pl->layout_fence_point, 12, 0);
+			}
+
+			SDL_UnlockSurface(surface);
+		}
+	}
+}
+
+void plotPickTrack(plot_t *pl, int cur_X, int cur_Y)
+{
+	const fval_t	*row = NULL;
+
+	double		fval_X, fval_Y, tol_X, tol_Y;
+	int		N, fN, aN, bN, dN, cNX, cNY, id_N, cSTEP;
+
+	if (pl->slice_mode_N == 2)
+		return ;
+
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+
+		pl->figure[fN].slice_busy = 0;
+		pl->figure[fN].slice_row = NULL;
+
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0) {
+
+			aN = pl->figure[fN].axis_X;
+			bN = pl->figure[fN].axis_Y;
+
+			cNX = pl->figure[fN].column_X;
+			cNY = pl->figure[fN].column_Y;
+
+			fval_X = plotAxisConvBackward(pl, aN, cur_X);
+			fval_Y = plotAxisConvBackward(pl, bN, cur_Y);
+
+			if (pl->data_box_on == DATA_BOX_PICK) {
+
+				tol_X = plotAxisConvBackward(pl, aN, cur_X - pl->layout_font_height);
+				tol_Y = plotAxisConvBackward(pl, bN, cur_Y + pl->layout_font_height);
+
+				tol_X = fval_X - tol_X;
+				tol_Y = fval_Y - tol_Y;
+			}
+			else {
+				tol_X = plotAxisConvBackward(pl, aN, cur_X - (pl->viewport.max_x - pl->viewport.min_x));
+				tol_Y = plotAxisConvBackward(pl, bN, cur_Y + (pl->viewport.max_y - pl->viewport.min_y));
+
+				tol_X = fval_X - tol_X;
+				tol_Y = fval_Y - tol_Y;
+			}
+
+			if (		pl->slice_mode_N == 1 && pl->shift_on != 0
+					&& pl->figure[fN].slice_base_catch == 1) {
+
+				pl->figure[fN].slice_busy = 1;
+				pl->figure[fN].slice_X = fval_X;
+				pl->figure[fN].slice_Y = fval_Y;
+			}
+
+			dN = pl->figure[fN].data_N;
+
+			row = plotDataPickGet(pl, dN, cNX, cNY,
+					fval_X, fval_Y, tol_X, tol_Y, &id_N);
 
-	pl->figure[fN].drawing = pl->figure[fN_1].drawing;
-	pl->figure[fN].width = pl->figure[fN_1].width;
+			if (row != NULL) {
 
-	plotDataBoxPolyfit(pl, fN);
-}
+				cNX = pl->figure[fN].column_X;
+				cNY = pl->figure[fN].column_Y;
 
-static void
-plotLabelFusedCSV(plot_t *pl, char *label, const char *name, const char *unit)
-{
-	const read_t	*rd = (const read_t *) pl->ld;
+				cSTEP = pl->data[dN].column_STEP;
 
-	const char	*s;
-	char		*l = label;
-	int		n;
+				fval_X = (cNX < 0) ? id_N : row[cNX * cSTEP];
+				fval_Y = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-	s = strrchr(name, ' ');
-	s = (s != NULL) ? s + 1 : name;
-	n = 0;
+				if (pl->figure[fN].slice_busy == 0) {
 
-	while (*s != 0) {
+					pl->figure[fN].slice_busy = 1;
+					pl->figure[fN].slice_X = fval_X;
+					pl->figure[fN].slice_Y = fval_Y;
+				}
 
-		if (*s == '@')
-			break;
+				pl->figure[fN].slice_row = row;
+				pl->figure[fN].slice_id_N = id_N;
+			}
+		}
+	}
 
-		*l++ = (strchr(rd->mk_text.space, *s) == NULL) ? *s : '_';
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-		++s;
-		++n;
+		if (		pl->figure[fN].slice_busy == 0
+				&& pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0) {
 
-		if (n >= 50)
-			break;
-	}
+			dN = pl->figure[fN].data_N;
 
-	s = unit;
-	n = 0;
+			for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
 
-	if (*s != 0) {
+				if (		pl->figure[N].slice_busy != 0
+						&& pl->figure[N].busy != 0
+						&& pl->figure[N].hidden == 0
+						&& pl->figure[N].slice_row != NULL
+						&& pl->figure[N].data_N == dN) {
 
-		*l++ = '@';
-	}
+					row = pl->figure[N].slice_row;
+					id_N = pl->figure[N].slice_id_N;
 
-	while (*s != 0) {
+					cNX = pl->figure[fN].column_X;
+					cNY = pl->figure[fN].column_Y;
 
-		if (*s == '@')
-			break;
+					cSTEP = pl->data[dN].column_STEP;
 
-		*l++ = (strchr(rd->mk_text.space, *s) == NULL) ? *s : '_';
+					fval_X = (cNX < 0) ? id_N : row[cNX * cSTEP];
+					fval_Y = (cNY < 0) ? id_N : row[cNY * cSTEP];
 
-		++s;
-		++n;
+					pl->figure[fN].slice_busy = 2;
+					pl->figure[fN].slice_X = fval_X;
+					pl->figure[fN].slice_Y = fval_Y;
 
-		if (n >= 20)
-			break;
+					break;
+				}
+			}
+		}
 	}
 
-	*l = 0;
-}
+	for (fN = 0, N = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-int plotFigureExportCSV(plot_t *pl, const char *file)
-{
-	int		list_dN[20], list_cN[20], list_fN[20];
-	int		N, fN, aN, job, len_N = 0;
+		N += (pl->figure[fN].slice_busy != 0) ? 1 : 0;
+	}
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	if (N == 0)
+		return ;
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0) {
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-			job = 1;
+		pl->data_box_text[fN][0] = 0;
 
-			for (N = 0; N < len_N; ++N) {
+		if (pl->figure[fN].slice_busy != 0) {
 
-				if (		list_dN[N] == pl->figure[fN].data_N
-						&& list_cN[N] == pl->figure[fN].column_X) {
+			const read_t		*rd = (const read_t *) pl->ld;
 
-					job = 0;
-					break;
-				}
-			}
+			if (		pl->slice_mode_N != 0
+					&& pl->figure[fN].slice_base_catch != 0) {
 
-			if (job != 0) {
+				fval_X = pl->figure[fN].slice_base_X;
+				fval_Y = pl->figure[fN].slice_base_Y;
 
-				list_dN[len_N] = pl->figure[fN].data_N;
-				list_cN[len_N] = pl->figure[fN].column_X;
-				list_fN[len_N] = fN;
+				strcat(pl->data_box_text[fN], " \xCE\x94");
+				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_X - fval_X);
 
-				len_N++;
+				strcat(pl->data_box_text[fN], "\xCE\x94");
+				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_Y - fval_Y);
 			}
+			else {
+				dN = pl->figure[fN].data_N;
 
-			job = 1;
-
-			for (N = 0; N < len_N; ++N) {
+				cNX = pl->figure[fN].column_Y;
+				cNY = pl->figure[fN].column_Y;
 
-				if (		list_dN[N] == pl->figure[fN].data_N
-						&& list_cN[N] == pl->figure[fN].column_Y) {
+				if (		pl->fhexadecimal != 0
+						&& (	   rd->data[dN].hint[cNX] == DATA_HINT_HEX
+							|| rd->data[dN].hint[cNX] == DATA_HINT_OCT)) {
 
-					job = 0;
-					break;
+					plotDataBoxTextHex(pl, fN, pl->figure[fN].slice_X);
+				}
+				else {
+					plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_X);
 				}
-			}
-
-			if (job != 0) {
 
-				list_dN[len_N] = pl->figure[fN].data_N;
-				list_cN[len_N] = pl->figure[fN].column_Y;
-				list_fN[len_N] = fN;
+				if (		pl->fhexadecimal != 0
+						&& (	   rd->data[dN].hint[cNY] == DATA_HINT_HEX
+							|| rd->data[dN].hint[cNY] == DATA_HINT_OCT)) {
 
-				len_N++;
+					plotDataBoxTextHex(pl, fN, pl->figure[fN].slice_Y);
+				}
+				else {
+					plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_Y);
+				}
 			}
 		}
 	}
 
-	if (len_N >= 2) {
+	if (pl->data_box_on != DATA_BOX_PICK) {
 
-		const read_t	*rd = (const read_t *) pl->ld;
-		FILE		*fd_csv;
+		pl->data_box_on = DATA_BOX_PICK;
+		pl->data_box_X = pl->viewport.max_x;
+		pl->data_box_Y = 0;
+	}
+}
 
-		char		labelbuf[PLOT_STRING_MAX];
+static void
+plotPickDraw(plot_t *pl, SDL_Surface *surface)
+{
+	double		base_X, base_Y, data_X, data_Y;
+	int		fN, aN, bN;
 
-		fd_csv = unified_fopen(file, "w");
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-		if (fd_csv == NULL) {
+		if (pl->figure[fN].slice_busy != 0) {
 
-			ERROR("fopen(\"%s\"): %s\n", file, strerror(errno));
-			return -1;
-		}
+			aN = pl->figure[fN].axis_X;
+			bN = pl->figure[fN].axis_Y;
 
-		for (N = 0; N < len_N; ++N) {
+			if (		pl->slice_mode_N != 0
+					&& pl->figure[fN].slice_base_catch != 0) {
 
-			fN = list_fN[N];
+				base_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_base_X);
+				base_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_base_Y);
+			}
 
-			if (list_cN[N] == pl->figure[fN].column_X) {
+			data_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_X);
+			data_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_Y);
 
-				aN = pl->figure[fN].axis_X;
+			SDL_LockSurface(surface);
 
-				plotLabelFusedCSV(pl, labelbuf, "time",
-						pl->axis[aN].label);
-			}
-			else {
-				aN = pl->figure[fN].axis_Y;
+			if (		pl->slice_mode_N != 0
+					&& pl->figure[fN].slice_base_catch != 0) {
 
-				plotLabelFusedCSV(pl, labelbuf,
-						pl->figure[fN].label,
-						pl->axis[aN].label);
-			}
+				if (		   fp_isfinite(base_X)
+						&& fp_isfinite(base_Y)
+						&& fp_isfinite(data_X)
+						&& fp_isfinite(data_Y)) {
 
-#ifdef _WINDOWS
-			if (rd->legacy_label == 1) {
+					drawDashReset(pl->dw);
+					drawDashCanvas(pl->dw, surface, &pl->viewport,
+							base_X, base_Y, data_X, data_Y,
+							12, pl->dw->thickness,
+							pl->layout_fence_dash,
+							pl->layout_fence_space);
+				}
 
-				legacy_UTF8_to_ACP(labelbuf, labelbuf, sizeof(labelbuf));
+				if (fp_isfinite(base_X) && fp_isfinite(base_Y)) {
+
+					drawDotCanvas(pl->dw, surface, &pl->viewport,
+							base_X, base_Y,
+							pl->layout_fence_point, 12, 0);
+				}
 			}
-			else if (rd->legacy_label == 2) {
 
-				legacy_UTF8_to_OEM(labelbuf, labelbuf, sizeof(labelbuf));
+			if (fp_isfinite(data_X) && fp_isfinite(data_Y)) {
+
+				drawDotCanvas(pl->dw, surface, &pl->viewport,
+						data_X, data_Y,
+						pl->layout_fence_point, 12, 0);
 			}
-#endif /* _WINDOWS */
 
-			fprintf(fd_csv, "%s%c", labelbuf, rd->mk_text.space[0]);
+			SDL_UnlockSurface(surface);
 		}
+	}
+}
 
-		fprintf(fd_csv, "\n");
+void plotBrushErase(plot_t *pl)
+{
+	double		fmin_X, fmin_Y, fmax_X, fmax_Y;
+	int		N, fN, aN, bN, dN, cNX, cNY, sNX, sNY;
 
-		plotDataFileCSV(pl, list_dN, list_cN, len_N, fd_csv);
+	int		modified = (int) (SDL_GetTicks() & 65535U);
 
-		fclose(fd_csv);
-	}
+	modified += pl->brush_box_X + pl->brush_box_Y
+		+ pl->brush_cur_X + pl->brush_cur_Y;
 
-	return 0;
-}
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-void plotFigureClean(plot_t *pl)
-{
-	int		N;
+		if (		pl->figure[fN].busy != 0
+				&& pl->figure[fN].hidden == 0
+				&& pl->figure[fN].brush_N != 0) {
 
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+			dN = pl->figure[fN].data_N;
 
-		pl->figure[N].busy = 0;
-		pl->figure[N].hidden = 0;
-		pl->figure[N].label[0] = 0;
-	}
+			cNX = pl->figure[fN].column_X;
+			cNY = pl->figure[fN].column_Y;
 
-	for (N = 0; N < PLOT_AXES_MAX; ++N) {
+			if (cNX < pl->data[dN].column_N) {
 
-		pl->axis[N].busy = AXIS_FREE;
-		pl->axis[N].slave = 0;
-		pl->axis[N].label[0] = 0;
-		pl->axis[N].compact = 1;
-		pl->axis[N].exponential = 0;
-	}
+				cNX = plotGetSubtractClone(pl, dN, cNX);
+			}
+			else {
+				for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
 
-	pl->legend_X = 0;
-	pl->legend_Y = 0;
+					if (		N != fN && pl->figure[N].busy != 0
+							&& dN == pl->figure[N].data_N
+							&& cNX == pl->figure[N].column_X) {
 
-	pl->data_box_on = DATA_BOX_FREE;
-	pl->data_box_X = pl->viewport.max_x;
-	pl->data_box_Y = 0;
+						cNX = plotGetSubtractClone(pl, dN, cNX);
+						break;
+					}
 
-	pl->slice_on = 0;
-	pl->slice_mode_N = 0;
+					if (		N != fN && pl->figure[N].busy != 0
+							&& dN == pl->figure[N].data_N
+							&& cNX == pl->figure[N].column_Y) {
+
+						cNX = plotGetSubtractClone(pl, dN, cNX);
+						break;
+					}
+				}
+			}
+
+			if (cNY < pl->data[dN].column_N) {
 
-	pl->pick_on = 0;
+				cNY = plotGetSubtractClone(pl, dN, cNY);
+			}
+			else {
+				for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
 
-	pl->on_X = -1;
-	pl->on_Y = -1;
+					if (		N != fN && pl->figure[N].busy != 0
+							&& dN == pl->figure[N].data_N
+							&& cNY == pl->figure[N].column_X) {
 
-	pl->hover_figure = -1;
-	pl->hover_legend = -1;
-	pl->hover_data_box = -1;
-	pl->hover_axis = -1;
+						cNY = plotGetSubtractClone(pl, dN, cNY);
+						break;
+					}
 
-	pl->mark_on = 0;
-	pl->brush_on = 0;
+					if (		N != fN && pl->figure[N].busy != 0
+							&& dN == pl->figure[N].data_N
+							&& cNY == pl->figure[N].column_Y) {
 
-	plotSketchClean(pl);
-}
+						cNY = plotGetSubtractClone(pl, dN, cNY);
+						break;
+					}
+				}
+			}
 
-static void
-plotMarkLayout(plot_t *pl)
-{
-	const fval_t	*row;
+			if (		   cNX >= pl->data[dN].column_N
+					&& cNY >= pl->data[dN].column_N) {
 
-	double		bias, urand, sigma, total, scale, offset, fval_X, fval_Y;
-	int		fN, vN, aN, bN, cX, cY, cZ, N, id_N, fMAX = 0;
+				aN = pl->figure[fN].axis_X;
+				bN = pl->figure[fN].axis_Y;
 
-	Uint32		rseed;
+				if (pl->brush_box_X < pl->brush_cur_X) {
 
-	const int	ltdense[PLOT_FIGURE_MAX] = {
+					fmin_X = plotAxisConvBackward(pl, aN, pl->brush_box_X);
+					fmax_X = plotAxisConvBackward(pl, aN, pl->brush_cur_X);
+				}
+				else {
+					fmin_X = plotAxisConvBackward(pl, aN, pl->brush_cur_X);
+					fmax_X = plotAxisConvBackward(pl, aN, pl->brush_box_X);
+				}
 
-		250, 353, 433, 500, 559, 612, 661, 707, 750, 790	/* 250 * sqrt(N) */
-	};
+				if (pl->brush_box_Y < pl->brush_cur_Y) {
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+					fmax_Y = plotAxisConvBackward(pl, bN, pl->brush_box_Y);
+					fmin_Y = plotAxisConvBackward(pl, bN, pl->brush_cur_Y);
+				}
+				else {
+					fmax_Y = plotAxisConvBackward(pl, bN, pl->brush_cur_Y);
+					fmin_Y = plotAxisConvBackward(pl, bN, pl->brush_box_Y);
+				}
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0) {
+				sNX = cNX - pl->data[dN].column_N;
+				sNY = cNY - pl->data[dN].column_N;
 
-			fMAX++;
-		}
-	}
+				if (pl->data[dN].sub[sNX].busy == SUBTRACT_SCALE) {
 
-	if (fMAX == 0)
-		return ;
+					pl->data[dN].sub[sNX].op.scale.modified += modified;
+				}
 
-	rseed = SDL_GetTicks();
+				if (pl->data[dN].sub[sNY].busy == SUBTRACT_SCALE) {
 
-	rseed = rseed * 17317U + 1U;
-	rseed = rseed * 17317U + 1U;
+					pl->data[dN].sub[sNY].op.scale.modified += modified;
+				}
 
-	pl->layout_mark_size = pl->layout_font_height * pl->mark_size / 200;
-	pl->layout_mark_size = (pl->layout_mark_size < 1) ? 1 : pl->layout_mark_size;
+				plotDataErase(pl, dN, cNX, cNY, fmin_X, fmin_Y, fmax_X, fmax_Y);
 
-	pl->mark_length = (pl->viewport.max_x - pl->viewport.min_x)
-		* pl->mark_density / (pl->layout_mark_size * ltdense[fMAX - 1]);
+				cNX = plotSubtractOriginal(pl, dN, cNX);
+				cNY = plotSubtractOriginal(pl, dN, cNY);
 
-	pl->mark_length = (pl->mark_length > PLOT_MARK_MAX) ? PLOT_MARK_MAX
-		: (pl->mark_length < 4) ? 4 : pl->mark_length;
+				pl->figure[fN].column_X = cNX;
+				pl->figure[fN].column_Y = cNY;
 
-	total = (double) (pl->viewport.max_x - pl->viewport.min_x);
-	sigma = (double) pl->layout_mark_size / total;
+				plotSubtractGarbage(pl, dN);
+			}
+		}
+	}
+}
 
-	total = (double) (pl->mark_length * fMAX);
+static void
+plotDrawFigureView(plot_t *pl, int fN, double view[4])
+{
+	double		scale_X, scale_Y, offset_X, offset_Y, X, Y;
+	int		aN, bN;
 
-	for (fN = 0, vN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	aN = pl->figure[fN].axis_X;
+	scale_X = pl->axis[aN].scale;
+	offset_X = pl->axis[aN].offset;
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0) {
+	if (pl->axis[aN].slave != 0) {
 
-			aN = pl->figure[fN].axis_X;
-			cZ = pl->figure[fN].column_X;
+		bN = pl->axis[aN].slave_N;
+		scale_X *= pl->axis[bN].scale;
+		offset_X = offset_X * pl->axis[bN].scale + pl->axis[bN].offset;
+	}
 
-			scale = pl->axis[aN].scale;
-			offset = pl->axis[aN].offset;
+	aN = pl->figure[fN].axis_Y;
+	scale_Y = pl->axis[aN].scale;
+	offset_Y = pl->axis[aN].offset;
 
-			if (pl->axis[aN].slave != 0) {
+	if (pl->axis[aN].slave != 0) {
 
-				bN = pl->axis[aN].slave_N;
+		bN = pl->axis[aN].slave_N;
+		scale_Y *= pl->axis[bN].scale;
+		offset_Y = offset_Y * pl->axis[bN].scale + pl->axis[bN].offset;
+	}
 
-				scale *= pl->axis[bN].scale;
-				offset = offset * pl->axis[bN].scale
-					+ pl->axis[bN].offset;
-			}
+	X = (double) (pl->viewport.max_x - pl->viewport.min_x);
+	Y = (double) (pl->viewport.min_y - pl->viewport.max_y);
 
-			rseed = rseed * 17317U + 1U;
-			bias = (double) ((rseed >> 16) & 65535U)
-				/ (double) (pl->mark_length * 65535U);
+	view[0] = scale_X * X;
+	view[1] = offset_X * X + pl->viewport.min_x;
+	view[2] = scale_Y * Y;
+	view[3] = offset_Y * Y + pl->viewport.max_y;
+}
 
-			for (N = 0; N < pl->mark_length; ++N) {
+static void
+plotSketchGrow(plot_t *pl)
+{
+	psketch_t	*sketch;
+	int		N, sketch_N;
 
-				rseed = rseed * 17317U + 1U;
-				urand = (double) ((int) ((rseed >> 16) & 65535U)
-						- 32767) / (double) 32767U;
+	if (pl->sketch_N >= PLOT_SKETCH_MAX)
+		return ;
 
-				bias += urand * sigma;
+	sketch_N = pl->sketch_N * 2;
+	sketch_N = (sketch_N > PLOT_SKETCH_MAX) ? PLOT_SKETCH_MAX : sketch_N;
 
-				fval_X = bias + (double) (N * fMAX + vN) / total;
-				fval_X = (fval_X > 1.) ? fval_X - 1.
-					: (fval_X < 0.) ? fval_X + 1. : fval_X;
+	sketch = (psketch_t *) realloc(pl->sketch, sizeof(psketch_t) * sketch_N);
 
-				fval_X = (fval_X - offset) / scale;
+	if (sketch == NULL) {
 
-				row = plotDataSliceGet(pl, pl->figure[fN].data_N,
-							cZ, fval_X, &id_N);
+		ERROR("No memory allocated for %i sketch chunks\n", sketch_N);
+		return ;
+	}
 
-				if (row != NULL) {
+	memset(sketch + pl->sketch_N, 0, sizeof(psketch_t) * (sketch_N - pl->sketch_N));
 
-					cX = pl->figure[fN].column_X;
-					cY = pl->figure[fN].column_Y;
+	/* Link all of new chunks to the garbage list.
+	 * */
+	for (N = pl->sketch_N; N < sketch_N - 1; ++N)
+		sketch[N].linked = N + 1;
 
-					fval_X = (cX < 0) ? id_N : row[cX];
-					fval_Y = (cY < 0) ? id_N : row[cY];
+	sketch[sketch_N - 1].linked = pl->sketch_list_garbage;
 
-					pl->figure[fN].mark_X[N] = fval_X;
-					pl->figure[fN].mark_Y[N] = fval_Y;
-				}
-				else {
-					pl->figure[fN].mark_X[N] = FP_NAN;
-					pl->figure[fN].mark_Y[N] = FP_NAN;
-				}
-			}
+	pl->sketch_list_garbage = pl->sketch_N;
 
-			vN++;
-		}
-	}
+	pl->sketch = sketch;
+	pl->sketch_N = sketch_N;
 }
 
 static void
-plotMarkDraw(plot_t *pl, SDL_Surface *surface)
+plotSketchDataChunkTake(plot_t *pl, int fN)
 {
-	double		X, Y, scale_X, scale_Y, offset_X, offset_Y;
-	int		N, fN, aN, bN, fwidth;
+	double		view[4];
+	int		hN, half_X, half_Y, fixed;
 
-	int		ncolor;
+	hN = pl->draw[fN].list_self;
 
-	SDL_LockSurface(surface);
+	plotDrawFigureView(pl, fN, view);
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	if (pl->sketch_list_garbage < 0) {
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0) {
+		plotSketchGrow(pl);
+	}
 
-			ncolor = (pl->figure[fN].hidden != 0) ? 11 : fN + 1;
+	if (hN >= 0	&& pl->sketch[hN].figure_N == fN
+			&& pl->sketch[hN].drawing == pl->figure[fN].drawing
+			&& pl->sketch[hN].width == pl->figure[fN].width
+			&& memcmp(pl->sketch[hN].view, view, sizeof(view)) == 0
+			&& pl->sketch[hN].length + 6 <= PLOT_SKETCH_CHUNK_SIZE) {
 
-			fwidth = pl->figure[fN].width;
-			fwidth = (fwidth < 1) ? 1 : fwidth;
+		/* Keep using this chunk */
+	}
+	else if (pl->sketch_list_garbage >= 0) {
 
-			aN = pl->figure[fN].axis_X;
-			scale_X = pl->axis[aN].scale;
-			offset_X = pl->axis[aN].offset;
+		hN = pl->sketch_list_garbage;
 
-			if (pl->axis[aN].slave != 0) {
+		if (pl->sketch[hN].chunk == NULL) {
 
-				bN = pl->axis[aN].slave_N;
+			pl->sketch[hN].chunk = (Sint16 *) malloc(sizeof(Sint16) * PLOT_SKETCH_CHUNK_SIZE);
 
-				scale_X *= pl->axis[bN].scale;
-				offset_X = offset_X * pl->axis[bN].scale
-					+ pl->axis[bN].offset;
-			}
+			if (pl->sketch[hN].chunk == NULL) {
 
-			aN = pl->figure[fN].axis_Y;
-			scale_Y = pl->axis[aN].scale;
-			offset_Y = pl->axis[aN].offset;
+				ERROR("Unable to allocate memory of %i sketch chunk\n", hN);
 
-			if (pl->axis[aN].slave != 0) {
+				pl->draw[fN].list_self = -1;
+				return ;
+			}
+		}
 
-				bN = pl->axis[aN].slave_N;
+		pl->sketch_list_garbage = pl->sketch[hN].linked;
 
-				scale_Y *= pl->axis[bN].scale;
-				offset_Y = offset_Y * pl->axis[bN].scale
-					+ pl->axis[bN].offset;
-			}
+		pl->sketch[hN].figure_N = fN;
+		pl->sketch[hN].drawing = pl->figure[fN].drawing;
+		pl->sketch[hN].width = pl->figure[fN].width;
 
-			X = (double) (pl->viewport.max_x - pl->viewport.min_x);
-			Y = (double) (pl->viewport.min_y - pl->viewport.max_y);
+		memcpy(pl->sketch[hN].view, view, sizeof(view));
 
-			scale_X *= X;
-			offset_X = offset_X * X + pl->viewport.min_x;
-			scale_Y *= Y;
-			offset_Y = offset_Y * Y + pl->viewport.max_y;
+		/* Take the base point in the middle of viewport and reduce
+		 * the resolution if viewport does not fit into 16-bit range.
+		 * */
+		pl->sketch[hN].base_X = (pl->viewport.min_x + pl->viewport.max_x) / 2;
+		pl->sketch[hN].base_Y = (pl->viewport.min_y + pl->viewport.max_y) / 2;
 
-			for (N = 0; N < pl->mark_length; ++N) {
+		half_X = pl->viewport.max_x - pl->sketch[hN].base_X + 17;
+		half_Y = pl->viewport.max_y - pl->sketch[hN].base_Y + 17;
 
-				X = pl->figure[fN].mark_X[N] * scale_X + offset_X;
-				Y = pl->figure[fN].mark_Y[N] * scale_Y + offset_Y;
+		fixed = 4;
 
-				if (fp_isfinite(X) && fp_isfinite(Y)) {
+		while (fixed > 0 && (	   (half_X << fixed) > 32767
+					|| (half_Y << fixed) > 32767))
+			fixed--;
 
-					drawMarkCanvas(pl->dw, surface, &pl->viewport, X, Y,
-							pl->layout_mark_size, fN, ncolor, fwidth);
-				}
-			}
-		}
-	}
+		pl->sketch[hN].fixed = fixed;
 
-	SDL_UnlockSurface(surface);
-}
+		pl->sketch[hN].length = 0;
+		pl->sketch[hN].drawn = 0;
 
-void plotGroupAdd(plot_t *pl, int dN, int gN, int cN)
-{
-	if (dN < 0 || dN >= PLOT_DATASET_MAX) {
+		if (pl->draw[fN].list_self >= 0) {
 
-		ERROR("Dataset number is out of range\n");
-		return ;
-	}
+			pl->sketch[hN].linked = pl->sketch[pl->draw[fN].list_self].linked;
+			pl->sketch[pl->draw[fN].list_self].linked = hN;
 
-	if (gN < 0 || gN >= PLOT_GROUP_MAX) {
+			if (pl->draw[fN].list_self == pl->sketch_list_current_end)
+				pl->sketch_list_current_end = hN;
+		}
+		else {
+			pl->sketch[hN].linked = -1;
 
-		ERROR("Group number is out of range\n");
-		return ;
-	}
+			if (pl->sketch_list_current >= 0) {
 
-	if (cN < -1 || cN >= pl->data[dN].column_N + PLOT_SUBTRACT) {
+				pl->sketch[pl->sketch_list_current_end].linked = hN;
+				pl->sketch_list_current_end = hN;
+			}
+			else {
+				pl->sketch_list_current = hN;
+				pl->sketch_list_current_end = hN;
+			}
+		}
 
-		ERROR("Column number %i is out of range\n", cN);
-		return ;
+		pl->draw[fN].list_self = hN;
 	}
+	else {
+		ERROR("Unable to get free sketch chunk\n");
 
-	pl->data[dN].map[cN] = gN;
+		pl->draw[fN].list_self = -1;
+	}
 }
 
-void plotGroupLabel(plot_t *pl, int gN, const char *label)
+static void
+plotSketchDataChunkSetUp(plot_t *pl, int fN)
 {
-	if (gN < 0 || gN >= PLOT_GROUP_MAX) {
-
-		ERROR("Group number is out of range\n");
-		return ;
-	}
+	/* The chunks are taken from the common list by figures that are
+	 * drawn on worker threads.
+	 * */
+	if (pl->sketch_lock != NULL)
+		SDL_LockMutex(pl->sketch_lock);
 
-	if (label[0] != 0) {
+	plotSketchDataChunkTake(pl, fN);
 
-		strcpy(pl->group[gN].label, label);
-	}
+	if (pl->sketch_lock != NULL)
+		SDL_UnlockMutex(pl->sketch_lock);
 }
 
-void plotGroupMedian(plot_t *pl, int gN, int length, int unwrap, int opdata)
+static void
+plotSketchDataLine(plot_t *pl, int fN, const clipBox_t *kb,
+		double X1, double Y1, double X2, double Y2)
 {
-	if (gN < 0 || gN >= PLOT_GROUP_MAX) {
+	psketch_t	*sk;
+	clipBox_t	cb;
 
-		ERROR("Group number is out of range\n");
+	double		fixed;
+	int		hN, length, qX1, qY1, qX2, qY2;
+
+	hN = pl->draw[fN].list_self;
+
+	if (hN < 0)
 		return ;
-	}
 
-	pl->group[gN].op_time_median = (length >= 1) ? 1 : 0;
-	pl->group[gN].op_time_unwrap = unwrap;
-	pl->group[gN].op_time_opdata = opdata;
+	if (pl->sketch[hN].length + 6 > PLOT_SKETCH_CHUNK_SIZE) {
 
-	pl->group[gN].length = length;
-}
+		plotSketchDataChunkSetUp(pl, fN);
 
-void plotGroupScale(plot_t *pl, int gN, int knob, double scale, double offset)
-{
-	if (gN < 0 || gN >= PLOT_GROUP_MAX) {
+		hN = pl->draw[fN].list_self;
 
-		ERROR("Group number is out of range\n");
-		return ;
+		if (hN < 0)
+			return ;
 	}
 
-	pl->group[gN].op_scale = (knob != 0) ? 1 : 0;
+	sk = &pl->sketch[hN];
 
-	pl->group[gN].scale = scale;
-	pl->group[gN].offset = offset;
-}
+	X1 = X1 * sk->view[0] + sk->view[1];
+	Y1 = Y1 * sk->view[2] + sk->view[3];
+	X2 = X2 * sk->view[0] + sk->view[1];
+	Y2 = Y2 * sk->view[2] + sk->view[3];
 
-void plotSliceSwitch(plot_t *pl)
-{
-	int		fN;
+	/* We clip the segment the same way as it will be clipped on drawing
+	 * so the fixed point coordinates are always in range.
+	 * */
+	cb = *kb;
 
-	if (pl->slice_mode_N == 0) {
+	if (clipLine(&cb, &X1, &Y1, &X2, &Y2) < 0)
+		return ;
 
-		pl->slice_mode_N = 1;
+	fixed = (double) (1 << sk->fixed);
 
-		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	qX1 = (int) floor(X1 * fixed) - (sk->base_X << sk->fixed);
+	qY1 = (int) floor(Y1 * fixed) - (sk->base_Y << sk->fixed);
+	qX2 = (int) floor(X2 * fixed) - (sk->base_X << sk->fixed);
+	qY2 = (int) floor(Y2 * fixed) - (sk->base_Y << sk->fixed);
 
-			pl->figure[fN].slice_base_catch = pl->figure[fN].slice_busy;
+	length = sk->length;
 
-			if (pl->figure[fN].slice_busy != 0) {
+	if (		length > 0
+			&& sk->chunk[length - 2] == qX1
+			&& sk->chunk[length - 1] == qY1) {
 
-				pl->figure[fN].slice_base_X = pl->figure[fN].slice_X;
-				pl->figure[fN].slice_base_Y = pl->figure[fN].slice_Y;
-			}
-		}
+		/* Continue the polyline but drop the segment that does not
+		 * leave the last point.
+		 * */
+		if (qX2 == qX1 && qY2 == qY1)
+			return ;
 	}
-	else if (pl->slice_mode_N == 1) {
+	else {
+		if (length > 0) {
 
-		pl->slice_mode_N = 2;
-	}
-	else if (pl->slice_mode_N == 2) {
+			sk->chunk[length++] = PLOT_SKETCH_BREAK;
+			sk->chunk[length++] = 0;
+		}
 
-		pl->slice_mode_N = 0;
+		sk->chunk[length++] = qX1;
+		sk->chunk[length++] = qY1;
 	}
+
+	sk->chunk[length++] = qX2;
+	sk->chunk[length++] = qY2;
+
+	sk->length = length;
 }
 
-void plotSliceTrack(plot_t *pl, int cur_X, int cur_Y)
+static void
+plotSketchDataDot(plot_t *pl, int fN, const clipBox_t *kb, double X, double Y)
 {
-	const fval_t	*row = NULL;
+	psketch_t	*sk;
 
-	double		fval_X, fval_Y;
-	int		N, fN, aN, bN, dN, cX, cY, id_N, job;
-	int		dN_cache, aN_cache, cX_cache;
+	double		fixed;
+	int		hN, length, qX, qY;
 
-	if (pl->slice_mode_N == 2)
+	hN = pl->draw[fN].list_self;
+
+	if (hN < 0)
 		return ;
 
-	if (pl->slice_axis_N < 0) {
+	if (pl->sketch[hN].length + 2 > PLOT_SKETCH_CHUNK_SIZE) {
 
-		pl->slice_axis_N = pl->on_X;
-	}
+		plotSketchDataChunkSetUp(pl, fN);
 
-	if (pl->slice_axis_N < 0) {
+		hN = pl->draw[fN].list_self;
 
-		ERROR("No valid axis number to slice data\n");
-		return ;
+		if (hN < 0)
+			return ;
 	}
 
-	dN_cache = -1;
-	aN_cache = -1;
-	cX_cache = -1;
+	sk = &pl->sketch[hN];
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	X = X * sk->view[0] + sk->view[1];
+	Y = Y * sk->view[2] + sk->view[3];
 
-		pl->figure[fN].slice_busy = 0;
-		pl->figure[fN].slice_row = NULL;
+	if (		X < kb->min_x || X > kb->max_x
+			|| Y < kb->min_y || Y > kb->max_y)
+		return ;
 
-		job = 0;
+	fixed = (double) (1 << sk->fixed);
 
-		if (pl->figure[fN].busy != 0 && pl->figure[fN].hidden == 0) {
+	qX = (int) floor(X * fixed) - (sk->base_X << sk->fixed);
+	qY = (int) floor(Y * fixed) - (sk->base_Y << sk->fixed);
 
-			aN = pl->slice_axis_N;
+	length = sk->length;
 
-			if (pl->axis[aN].busy == AXIS_BUSY_X) {
+	if (		length > 0
+			&& sk->chunk[length - 2] == qX
+			&& sk->chunk[length - 1] == qY)
+		return ;
 
-				if (pl->figure[fN].axis_X == aN) {
+	sk->chunk[length++] = qX;
+	sk->chunk[length++] = qY;
 
-					job = 1;
-				}
-				else {
-					bN = pl->figure[fN].axis_X;
+	sk->length = length;
+}
 
-					if (pl->axis[bN].slave != 0) {
+/* Get the transform from the fixed point of sketch chunk to the screen in the
+ * current view of the figure.
+ * */
+static void
+plotSketchTransform(plot_t *pl, int hN, double tf[4])
+{
+	psketch_t	*sk = &pl->sketch[hN];
 
-						if (pl->axis[bN].slave_N == aN)
-							job = 1;
-					}
-					else if (pl->axis[aN].slave != 0) {
+	double		view[4], fixed, kX, kY;
 
-						if (pl->axis[aN].slave_N == bN)
-							job = 1;
-					}
-				}
+	plotDrawFigureView(pl, sk->figure_N, view);
 
-				aN = pl->figure[fN].axis_X;
-				cX = pl->figure[fN].column_X;
+	fixed = 1. / (double) (1 << sk->fixed);
 
-				fval_X = plotAxisConvBackward(pl, aN, cur_X);
-			}
-			else if (pl->axis[aN].busy == AXIS_BUSY_Y) {
+	kX = (sk->view[0] != 0.) ? view[0] / sk->view[0] : 1.;
+	kY = (sk->view[2] != 0.) ? view[2] / sk->view[2] : 1.;
 
-				if (pl->figure[fN].axis_Y == aN) {
+	tf[0] = fixed * kX;
+	tf[1] = (sk->base_X - sk->view[1]) * kX + view[1];
+	tf[2] = fixed * kY;
+	tf[3] = (sk->base_Y - sk->view[3]) * kY + view[3];
+}
 
-					job = 1;
-				}
-				else {
-					bN = pl->figure[fN].axis_Y;
+static void
+plotSketchGarbage(plot_t *pl)
+{
+	int		N, hN, linked;
 
-					if (pl->axis[bN].slave != 0) {
+	hN = pl->sketch_list_todraw;
 
-						if (pl->axis[bN].slave_N == aN)
-							job = 1;
-					}
-					else if (pl->axis[aN].slave != 0) {
+	while (hN >= 0) {
 
-						if (pl->axis[aN].slave_N == bN)
-							job = 1;
-					}
-				}
+		linked = pl->sketch[hN].linked;
 
-				aN = pl->figure[fN].axis_Y;
-				cX = pl->figure[fN].column_Y;
+		pl->sketch[hN].linked = pl->sketch_list_garbage;
+		pl->sketch_list_garbage = hN;
 
-				fval_X = plotAxisConvBackward(pl, aN, cur_Y);
-			}
-		}
+		hN = linked;
+	}
 
-		if (job) {
+	pl->sketch_list_todraw = pl->sketch_list_current;
+	pl->sketch_list_current = -1;
+	pl->sketch_list_current_end = -1;
 
-			dN = pl->figure[fN].data_N;
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
 
-			if (		   dN_cache != dN
-					|| aN_cache != aN
-					|| cX_cache != cX) {
+		pl->draw[N].list_self = -1;
+		pl->draw[N].layer.on = 0;
+	}
+}
 
-				row = plotDataSliceGet(pl, dN, cX, fval_X, &id_N);
+void plotSketchClean(plot_t *pl)
+{
+	int		N, hN, linked;
 
-				dN_cache = dN;
-				aN_cache = aN;
-				cX_cache = cX;
-			}
+	hN = pl->sketch_list_todraw;
 
-			if (row != NULL) {
+	while (hN >= 0) {
 
-				cX = pl->figure[fN].column_X;
-				cY = pl->figure[fN].column_Y;
+		linked = pl->sketch[hN].linked;
 
-				fval_X = (cX < 0) ? id_N : row[cX];
-				fval_Y = (cY < 0) ? id_N : row[cY];
+		pl->sketch[hN].linked = pl->sketch_list_garbage;
+		pl->sketch_list_garbage = hN;
 
-				pl->figure[fN].slice_busy = 1;
-				pl->figure[fN].slice_row = row;
-				pl->figure[fN].slice_id_N = id_N;
-				pl->figure[fN].slice_X = fval_X;
-				pl->figure[fN].slice_Y = fval_Y;
-			}
-		}
+		hN = linked;
 	}
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
-
-		if (		pl->figure[fN].slice_busy == 0
-				&& pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0) {
-
-			dN = pl->figure[fN].data_N;
-
-			for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
-
-				if (		pl->figure[N].slice_busy != 0
-						&& pl->figure[N].busy != 0
-						&& pl->figure[N].hidden == 0
-						&& pl->figure[N].slice_row != NULL
-						&& pl->figure[N].data_N == dN) {
-
-					row = pl->figure[N].slice_row;
-					id_N = pl->figure[N].slice_id_N;
+	hN = pl->sketch_list_current;
 
-					cX = pl->figure[fN].column_X;
-					cY = pl->figure[fN].column_Y;
+	while (hN >= 0) {
 
-					fval_X = (cX < 0) ? id_N : row[cX];
-					fval_Y = (cY < 0) ? id_N : row[cY];
+		linked = pl->sketch[hN].linked;
 
-					pl->figure[fN].slice_busy = 1;
-					pl->figure[fN].slice_X = fval_X;
-					pl->figure[fN].slice_Y = fval_Y;
+		pl->sketch[hN].linked = pl->sketch_list_garbage;
+		pl->sketch_list_garbage = hN;
 
-					break;
-				}
-			}
-		}
+		hN = linked;
 	}
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
-
-		pl->data_box_text[fN][0] = 0;
+	pl->sketch_list_todraw = -1;
+	pl->sketch_list_current = -1;
+	pl->sketch_list_current_end = -1;
 
-		if (pl->figure[fN].slice_busy != 0) {
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
 
-			const read_t		*rd = (const read_t *) pl->ld;
+		pl->draw[N].list_self = -1;
+		pl->draw[N].stream.on = 0;
+		pl->draw[N].layer.on = 0;
+	}
 
-			if (		pl->slice_mode_N != 0
-					&& pl->figure[fN].slice_base_catch != 0) {
+	pl->draw_in_progress = 0;
+}
 
-				fval_X = pl->figure[fN].slice_base_X;
-				fval_Y = pl->figure[fN].slice_base_Y;
+static void
+plotSketchStreamAppend(plot_t *pl)
+{
+	int		N, hN;
 
-				strcat(pl->data_box_text[fN], " \xCE\x94");
-				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_X - fval_X);
+	/* Keep the sketch of the previous pass and append the chunks we
+	 * got in this pass to the end of list.
+	 * */
+	if (pl->sketch_list_current >= 0) {
 
-				strcat(pl->data_box_text[fN], "\xCE\x94");
-				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_Y - fval_Y);
-			}
-			else {
-				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_X);
+		hN = pl->sketch_list_todraw;
 
-				dN = pl->figure[fN].data_N;
-				cY = pl->figure[fN].column_Y;
+		if (hN >= 0) {
 
-				if (		pl->fhexadecimal != 0
-						&& (	   rd->data[dN].hint[cY] == DATA_HINT_HEX
-							|| rd->data[dN].hint[cY] == DATA_HINT_OCT)) {
+			while (pl->sketch[hN].linked >= 0)
+				hN = pl->sketch[hN].linked;
 
-					plotDataBoxTextHex(pl, fN, pl->figure[fN].slice_Y);
-				}
-				else {
-					plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_Y);
-				}
-			}
+			pl->sketch[hN].linked = pl->sketch_list_current;
+		}
+		else {
+			pl->sketch_list_todraw = pl->sketch_list_current;
 		}
 	}
 
-	if (pl->data_box_on != DATA_BOX_SLICE) {
+	pl->sketch_list_current = -1;
+	pl->sketch_list_current_end = -1;
 
-		pl->data_box_on = DATA_BOX_SLICE;
-		pl->data_box_X = pl->viewport.max_x;
-		pl->data_box_Y = 0;
-	}
+	for (N = 0; N < PLOT_FIGURE_MAX; ++N)
+		pl->draw[N].list_self = -1;
 }
 
 static void
-plotSliceDrawLight(plot_t *pl, SDL_Surface *surface)
+plotDrawPalette(plot_t *pl)
 {
-	double		base_X, base_Y, data_X, data_Y, temp;
-	int		fN, aN, bN;
+	draw_t			*dw = pl->dw;
+	scheme_t		*sch = pl->sch;
+	Uint32			*palette;
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	palette = dw->palette;
 
-		if (		pl->figure[fN].slice_busy != 0
-				&& pl->figure[fN].slice_base_catch != 0) {
+	palette[0] = drawRGBMap(dw, sch->plot_background);
+	palette[1] = drawRGBMap(dw, sch->plot_figure[0]);
+	palette[2] = drawRGBMap(dw, sch->plot_figure[1]);
+	palette[3] = drawRGBMap(dw, sch->plot_figure[2]);
+	palette[4] = drawRGBMap(dw, sch->plot_figure[3]);
+	palette[5] = drawRGBMap(dw, sch->plot_figure[4]);
+	palette[6] = drawRGBMap(dw, sch->plot_figure[5]);
+	palette[7] = drawRGBMap(dw, sch->plot_figure[6]);
+	palette[8] = drawRGBMap(dw, sch->plot_figure[7]);
+	palette[9] = drawRGBMap(dw, sch->plot_figure[8]);
+	palette[10] = drawRGBMap(dw, sch->plot_figure[9]);
+	palette[11] = drawRGBMap(dw, sch->plot_hidden);
+	palette[12] = drawRGBMap(dw, sch->plot_text);
+}
 
-			aN = pl->figure[fN].axis_X;
-			bN = pl->figure[fN].axis_Y;
+static Uint32
+plotTrialTick(ptrial_t *tr)
+{
+	if (tr->tick_skip++ >= 63) {
 
-			base_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_base_X);
-			base_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_base_Y);
+		tr->tick_cached = SDL_GetTicks();
+		tr->tick_skip = 0;
+	}
 
-			data_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_X);
-			data_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_Y);
+	return tr->tick_cached;
+}
 
-			if (data_X < base_X) {
+static int
+plotTrialSetUp(plot_t *pl, int fN)
+{
+	ptrial_t	*tr = &pl->trial[fN];
+	int		fresh = 0;
 
-				temp = base_X;
-				base_X = data_X;
-				data_X = temp;
-			}
+	if (tr->pixmap_len < pl->dw->pixmap.len) {
 
-			if (data_Y < base_Y) {
+		if (tr->pixmap != NULL)
+			free(tr->pixmap);
 
-				temp = base_Y;
-				base_Y = data_Y;
-				data_Y = temp;
-			}
+		tr->pixmap = (void *) malloc(pl->dw->pixmap.len);
+		tr->pixmap_len = 0;
 
-			SDL_LockSurface(surface);
+		if (tr->pixmap != NULL) {
 
-			if (pl->axis[pl->slice_axis_N].busy == AXIS_BUSY_X) {
+			tr->pixmap_len = pl->dw->pixmap.len;
 
-				if (fp_isfinite(base_X) && fp_isfinite(data_X)) {
+			memset(tr->pixmap, 0, tr->pixmap_len);
+		}
+		else {
+			ERROR("Unable to allocate memory of %i trial pixmap\n", fN);
+		}
 
-					drawClipRect(surface, &pl->viewport,
-							(int) base_X, pl->viewport.min_y,
-							(int) data_X, pl->viewport.max_y,
-							pl->sch->plot_hidden);
-				}
-			}
-			else if (pl->axis[pl->slice_axis_N].busy == AXIS_BUSY_Y) {
+		fresh = 1;
+	}
 
-				if (fp_isfinite(base_Y) && fp_isfinite(data_Y)) {
+	tr->pl = pl;
+	tr->dw = *pl->dw;
 
-					drawClipRect(surface, &pl->viewport,
-							pl->viewport.min_x, (int) base_Y,
-							pl->viewport.max_x, (int) data_Y,
-							pl->sch->plot_hidden);
-				}
-			}
+	/* Fall back to the common trial pixmap so the figure is drawn on
+	 * main thread only.
+	 * */
+	tr->dw.pixmap.trial = (tr->pixmap != NULL) ? tr->pixmap : pl->dw->pixmap.trial;
+	tr->dw.cached_ncol = -1;
 
-			SDL_UnlockSurface(surface);
-		}
-	}
+	return (tr->pixmap != NULL) ? fresh : -1;
 }
 
-static void
-plotSliceDraw(plot_t *pl, SDL_Surface *surface)
+static int
+plotTrialFetched(plot_t *pl, int dN, int rN)
 {
-	double		base_X, base_Y, data_X, data_Y;
-	int		fN, aN, bN;
-
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	int		kN;
 
-		if (pl->figure[fN].slice_busy != 0) {
+	if (		pl->data[dN].lz4_compress == 0
+			|| rN == pl->data[dN].tail_N)
+		return 1;
 
-			aN = pl->figure[fN].axis_X;
-			bN = pl->figure[fN].axis_Y;
+	kN = rN >> pl->data[dN].chunk_SHIFT;
 
-			if (		pl->slice_mode_N != 0
-					&& pl->figure[fN].slice_base_catch != 0) {
+	return (pl->data[dN].raw[kN] != NULL) ? 1 : 0;
+}
 
-				base_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_base_X);
-				base_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_base_Y);
-			}
+static const fval_t *
+plotTrialGet(plot_t *pl, int dN, int *rN)
+{
+	const fval_t	*row = NULL;
 
-			data_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_X);
-			data_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_Y);
+	int		lN, kN, jN;
 
-			SDL_LockSurface(surface);
+	/* The same as plotDataGet but the chunk cache is not touched. The
+	 * chunks are fetched on main thread before the trial round.
+	 * */
+	if (*rN != pl->data[dN].tail_N) {
 
-			if (pl->axis[pl->slice_axis_N].busy == AXIS_BUSY_X) {
+		kN = *rN >> pl->data[dN].chunk_SHIFT;
+		jN = *rN & pl->data[dN].chunk_MASK;
 
-				if (		pl->slice_mode_N != 0
-						&& pl->figure[fN].slice_base_catch != 0) {
+		row = pl->data[dN].raw[kN];
 
-					if (fp_isfinite(base_X)) {
+		if (row != NULL) {
 
-						drawDashReset(pl->dw);
-						drawDash(pl->dw, surface, &pl->viewport,
-								base_X, pl->viewport.min_y,
-								base_X, pl->viewport.max_y,
-								pl->sch->plot_text,
-								pl->layout_fence_dash,
-								pl->layout_fence_space);
-					}
-				}
+			row += pl->data[dN].row_STEP * jN;
 
-				if (fp_isfinite(data_X)) {
+			lN = pl->data[dN].length_N;
+			*rN = (*rN < lN - 1) ? *rN + 1 : 0;
+		}
+	}
 
-					drawDashReset(pl->dw);
-					drawDash(pl->dw, surface, &pl->viewport,
-							data_X, pl->viewport.min_y,
-							data_X, pl->viewport.max_y,
-							pl->sch->plot_text,
-							pl->layout_fence_dash,
-							pl->layout_fence_space);
-				}
-			}
-			else if (pl->axis[pl->slice_axis_N].busy == AXIS_BUSY_Y) {
+	return row;
+}
 
-				if (		pl->slice_mode_N != 0
-						&& pl->figure[fN].slice_base_catch != 0) {
+static void
+plotDataLodPolyline(const double vbox[8], double scale_X, double vX[4], double vY[4])
+{
+	int		N;
 
-					if (fp_isfinite(base_Y)) {
+	/* The bucket is drawn as polyline through the first row, the range
+	 * across the narrow axis and the last row. This gives the same pixels
+	 * as the whole set of bucket segments without access to the chunk
+	 * data.
+	 * */
+	vX[0] = vbox[4];
+	vY[0] = vbox[5];
+	vX[3] = vbox[6];
+	vY[3] = vbox[7];
 
-						drawDashReset(pl->dw);
-						drawDash(pl->dw, surface, &pl->viewport,
-								pl->viewport.min_x, base_Y,
-								pl->viewport.max_x, base_Y,
-								pl->sch->plot_text,
-								pl->layout_fence_dash,
-								pl->layout_fence_space);
-					}
-				}
+	if ((vbox[1] - vbox[0]) * fabs(scale_X) <= 1.) {
 
-				if (fp_isfinite(data_Y)) {
+		N = (vY[0] - vbox[2] < vbox[3] - vY[0]) ? 0 : 1;
 
-					drawDashReset(pl->dw);
-					drawDash(pl->dw, surface, &pl->viewport,
-							pl->viewport.min_x, data_Y,
-							pl->viewport.max_x, data_Y,
-							pl->sch->plot_text,
-							pl->layout_fence_dash,
-							pl->layout_fence_space);
-				}
-			}
+		vX[1] = vX[0];
+		vY[1] = vbox[2 + N];
+		vX[2] = vX[0];
+		vY[2] = vbox[3 - N];
+	}
+	else {
+		N = (vX[0] - vbox[0] < vbox[1] - vX[0]) ? 0 : 1;
 
-			if (		pl->slice_mode_N != 0
-					&& pl->figure[fN].slice_base_catch != 0) {
+		vX[1] = vbox[0 + N];
+		vY[1] = vY[0];
+		vX[2] = vbox[1 - N];
+		vY[2] = vY[0];
+	}
+}
 
-				if (fp_isfinite(base_X) && fp_isfinite(base_Y)) {
+static int
+plotDrawFigureSame(plot_t *pl, int fN, const pview_t *pv)
+{
+	double		view[4];
+	int		dN;
 
-					drawDotCanvas(pl->dw, surface, &pl->viewport,
-							base_X, base_Y,
-							pl->layout_fence_point, 12, 0);
-				}
-			}
+	dN = pl->figure[fN].data_N;
 
-			if (fp_isfinite(data_X) && fp_isfinite(data_Y)) {
+	plotDrawFigureView(pl, fN, view);
 
-				drawDotCanvas(pl->dw, surface, &pl->viewport,
-						data_X, data_Y,
-						pl->layout_fence_point, 12, 0);
-			}
+	if (		pv->on != 0
+			&& pv->data_N == dN
+			&& pv->id_N == pl->data[dN].id_N
+			&& pv->column_X == pl->figure[fN].column_X
+			&& pv->column_Y == pl->figure[fN].column_Y
+			&& pv->drawing == pl->figure[fN].drawing
+			&& pv->width == pl->figure[fN].width
+			&& pv->hidden == pl->figure[fN].hidden
+			&& pv->antialiasing == pl->dw->antialiasing
+			&& pv->view[0] == view[0]
+			&& pv->view[1] == view[1]
+			&& pv->view[2] == view[2]
+			&& pv->view[3] == view[3]) {
 
-			SDL_UnlockSurface(surface);
-		}
+		return 1;
 	}
+
+	return 0;
 }
 
-void plotPickTrack(plot_t *pl, int cur_X, int cur_Y)
+static void
+plotDrawFigureKeep(plot_t *pl, int fN, pview_t *pv)
 {
-	const fval_t	*row = NULL;
+	int		dN;
 
-	double		fval_X, fval_Y, tol_X, tol_Y;
-	int		N, fN, aN, bN, dN, cNX, cNY, id_N;
+	dN = pl->figure[fN].data_N;
 
-	if (pl->slice_mode_N == 2)
-		return ;
+	pv->on = 1;
+	pv->data_N = dN;
+	pv->id_N = pl->data[dN].id_N;
+	pv->column_X = pl->figure[fN].column_X;
+	pv->column_Y = pl->figure[fN].column_Y;
+	pv->drawing = pl->figure[fN].drawing;
+	pv->width = pl->figure[fN].width;
+	pv->hidden = pl->figure[fN].hidden;
+	pv->antialiasing = pl->dw->antialiasing;
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+	plotDrawFigureView(pl, fN, pv->view);
+}
 
-		pl->figure[fN].slice_busy = 0;
-		pl->figure[fN].slice_row = NULL;
+static int
+plotDrawFigureShift(plot_t *pl, int fN, const pview_t *pv, double *dX, double *dY)
+{
+	double		view[4];
+	int		dN;
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0) {
+	dN = pl->figure[fN].data_N;
 
-			aN = pl->figure[fN].axis_X;
-			bN = pl->figure[fN].axis_Y;
+	plotDrawFigureView(pl, fN, view);
 
-			cNX = pl->figure[fN].column_X;
-			cNY = pl->figure[fN].column_Y;
+	if (		pv->on != 0
+			&& pv->data_N == dN
+			&& pv->id_N == pl->data[dN].id_N
+			&& pv->column_X == pl->figure[fN].column_X
+			&& pv->column_Y == pl->figure[fN].column_Y
+			&& pv->drawing == pl->figure[fN].drawing
+			&& pv->width == pl->figure[fN].width
+			&& pv->hidden == pl->figure[fN].hidden
+			&& pv->antialiasing == pl->dw->antialiasing
+			&& pv->view[0] == view[0]
+			&& pv->view[2] == view[2]) {
 
-			fval_X = plotAxisConvBackward(pl, aN, cur_X);
-			fval_Y = plotAxisConvBackward(pl, bN, cur_Y);
+		/* The scale is the same so the figure is only moved.
+		 * */
+		*dX = view[1] - pv->view[1];
+		*dY = view[3] - pv->view[3];
 
-			if (pl->data_box_on == DATA_BOX_PICK) {
+		return 1;
+	}
 
-				tol_X = plotAxisConvBackward(pl, aN, cur_X - pl->layout_font_height);
-				tol_Y = plotAxisConvBackward(pl, bN, cur_Y + pl->layout_font_height);
+	return 0;
+}
 
-				tol_X = fval_X - tol_X;
-				tol_Y = fval_Y - tol_Y;
-			}
-			else {
-				tol_X = plotAxisConvBackward(pl, aN, cur_X - (pl->viewport.max_x - pl->viewport.min_x));
-				tol_Y = plotAxisConvBackward(pl, bN, cur_Y + (pl->viewport.max_y - pl->viewport.min_y));
+static void
+plotDrawFigureTrial(plot_t *pl, ptrial_t *tr)
+{
+	const fval_t	*row;
+	const pstat_t	*st_X, *st_Y;
+	clipBox_t	kb;
 
-				tol_X = fval_X - tol_X;
-				tol_Y = fval_Y - tol_Y;
-			}
+	double		scale_X, scale_Y, offset_X, offset_Y, im_MIN, im_MAX;
+	double		X, Y, last_X, last_Y, im_X, im_Y, last_im_X, last_im_Y;
+	double		view[4], vbox[8], vX[4], vY[4];
+	int		dN, rN, xN, yN, xNR, yNR, id_N, kN, kN_cached, cSTEP;
+	int		job, skipped, line, rc, ncolor, fdrawing, fwidth, lod_N, N, fN, jN;
 
-			if (		pl->slice_mode_N == 1 && pl->shift_on != 0
-					&& pl->figure[fN].slice_base_catch == 1) {
+	fN = (int) (tr - pl->trial);
 
-				pl->figure[fN].slice_busy = 1;
-				pl->figure[fN].slice_X = fval_X;
-				pl->figure[fN].slice_Y = fval_Y;
-			}
+	ncolor = (pl->figure[fN].hidden != 0) ? 11 : fN + 1;
 
-			dN = pl->figure[fN].data_N;
+	fdrawing = pl->figure[fN].drawing;
+	fwidth = pl->figure[fN].width;
 
-			row = plotDataPickGet(pl, dN, cNX, cNY,
-					fval_X, fval_Y, tol_X, tol_Y, &id_N);
+	dN = pl->figure[fN].data_N;
+	xN = pl->figure[fN].column_X;
+	yN = pl->figure[fN].column_Y;
 
-			if (row != NULL) {
+	cSTEP = pl->data[dN].column_STEP;
 
-				cNX = pl->figure[fN].column_X;
-				cNY = pl->figure[fN].column_Y;
+	xNR = tr->column_XR;
+	yNR = tr->column_YR;
+
+	plotDrawFigureView(pl, fN, view);
+
+	scale_X = view[0];
+	offset_X = view[1];
+	scale_Y = view[2];
+	offset_Y = view[3];
+
+	rN = pl->draw[fN].rN;
+	id_N = pl->draw[fN].id_N;
 
-				fval_X = (cNX < 0) ? id_N : row[cNX];
-				fval_Y = (cNY < 0) ? id_N : row[cNY];
+	kN_cached = -1;
 
-				if (pl->figure[fN].slice_busy == 0) {
+	kb.min_x = pl->viewport.min_x - 16;
+	kb.min_y = pl->viewport.min_y - 16;
+	kb.max_x = pl->viewport.max_x + 16;
+	kb.max_y = pl->viewport.max_y + 16;
 
-					pl->figure[fN].slice_busy = 1;
-					pl->figure[fN].slice_X = fval_X;
-					pl->figure[fN].slice_Y = fval_Y;
-				}
+	plotSketchDataChunkSetUp(pl, fN);
 
-				pl->figure[fN].slice_row = row;
-				pl->figure[fN].slice_id_N = id_N;
-			}
-		}
-	}
+	if (		fdrawing == FIGURE_DRAWING_LINE
+			|| fdrawing == FIGURE_DRAWING_DASH) {
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+		skipped = pl->draw[fN].skipped;
+		line = pl->draw[fN].line;
 
-		if (		pl->figure[fN].slice_busy == 0
-				&& pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0) {
+		last_X = pl->draw[fN].last_X;
+		last_Y = pl->draw[fN].last_Y;
 
-			dN = pl->figure[fN].data_N;
+		last_im_X = last_X * scale_X + offset_X;
+		last_im_Y = last_Y * scale_Y + offset_Y;
 
-			for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+		do {
+			kN = plotDataChunkN(pl, dN, rN);
+			job = 1;
 
-				if (		pl->figure[N].slice_busy != 0
-						&& pl->figure[N].busy != 0
-						&& pl->figure[N].hidden == 0
-						&& pl->figure[N].slice_row != NULL
-						&& pl->figure[N].data_N == dN) {
+			if (kN != kN_cached) {
 
-					row = pl->figure[N].slice_row;
-					id_N = pl->figure[N].slice_id_N;
+				st_X = plotDataStatChunk(pl, dN, kN, xN);
+				st_Y = plotDataStatChunk(pl, dN, kN, yN);
 
-					cNX = pl->figure[fN].column_X;
-					cNY = pl->figure[fN].column_Y;
+				if (st_X != NULL) {
 
-					fval_X = (cNX < 0) ? id_N : row[cNX];
-					fval_Y = (cNY < 0) ? id_N : row[cNY];
+					if (st_X->finite != 0) {
 
-					pl->figure[fN].slice_busy = 2;
-					pl->figure[fN].slice_X = fval_X;
-					pl->figure[fN].slice_Y = fval_Y;
+						im_MIN = st_X->fmin * scale_X + offset_X;
+						im_MAX = st_X->fmax * scale_X + offset_X;
 
-					break;
+						job = (	   im_MAX < pl->viewport.min_x - 16
+							|| im_MIN > pl->viewport.max_x + 16) ? 0 : job;
+					}
+					else {
+						job = 0;
+					}
 				}
-			}
-		}
-	}
 
-	for (fN = 0, N = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+				if (st_Y != NULL) {
 
-		N += (pl->figure[fN].slice_busy != 0) ? 1 : 0;
-	}
+					if (st_Y->finite != 0) {
 
-	if (N == 0)
-		return ;
+						im_MIN = st_Y->fmin * scale_Y + offset_Y;
+						im_MAX = st_Y->fmax * scale_Y + offset_Y;
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+						job = (	   im_MIN < pl->viewport.min_y - 16
+							|| im_MAX > pl->viewport.max_y + 16) ? 0 : job;
+					}
+					else {
+						job = 0;
+					}
+				}
 
-		pl->data_box_text[fN][0] = 0;
+				kN_cached = kN;
+			}
 
-		if (pl->figure[fN].slice_busy != 0) {
+			if (		kN != tr->chunk_N
+					&& (job != 0 || line != 0)) {
 
-			const read_t		*rd = (const read_t *) pl->ld;
+				/* The next chunk is not fetched for this round so
+				 * we get back to it in the next one.
+				 * */
+				pl->draw[fN].sketch = SKETCH_INTERRUPTED;
+				pl->draw[fN].rN = rN;
+				pl->draw[fN].id_N = id_N;
+				pl->draw[fN].skipped = skipped;
+				pl->draw[fN].line = line;
+				pl->draw[fN].last_X = last_X;
+				pl->draw[fN].last_Y = last_Y;
 
-			if (		pl->slice_mode_N != 0
-					&& pl->figure[fN].slice_base_catch != 0) {
+				tr->chunk_N = kN;
+				break;
+			}
 
-				fval_X = pl->figure[fN].slice_base_X;
-				fval_Y = pl->figure[fN].slice_base_Y;
+			lod_N = 0;
 
-				strcat(pl->data_box_text[fN], " \xCE\x94");
-				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_X - fval_X);
+			if (		job != 0 && skipped == 0
+					&& pl->lod != 0) {
 
-				strcat(pl->data_box_text[fN], "\xCE\x94");
-				plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_Y - fval_Y);
+				lod_N = plotDataLodGet(pl, dN, xNR, yNR, rN, id_N,
+						scale_X, scale_Y, vbox);
 			}
-			else {
-				dN = pl->figure[fN].data_N;
-
-				cNX = pl->figure[fN].column_Y;
-				cNY = pl->figure[fN].column_Y;
 
-				if (		pl->fhexadecimal != 0
-						&& (	   rd->data[dN].hint[cNX] == DATA_HINT_HEX
-							|| rd->data[dN].hint[cNX] == DATA_HINT_OCT)) {
+			if (lod_N != 0) {
 
-					plotDataBoxTextHex(pl, fN, pl->figure[fN].slice_X);
-				}
-				else {
-					plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_X);
-				}
+				plotDataLodPolyline(vbox, scale_X, vX, vY);
 
-				if (		pl->fhexadecimal != 0
-						&& (	   rd->data[dN].hint[cNY] == DATA_HINT_HEX
-							|| rd->data[dN].hint[cNY] == DATA_HINT_OCT)) {
+				for (N = 0; N < 4; ++N) {
 
-					plotDataBoxTextHex(pl, fN, pl->figure[fN].slice_Y);
-				}
-				else {
-					plotDataBoxTextFmt(pl, fN, pl->figure[fN].slice_Y);
-				}
-			}
-		}
-	}
+					if (		N != 0 && vX[N] == last_X
+							&& vY[N] == last_Y)
+						continue;
 
-	if (pl->data_box_on != DATA_BOX_PICK) {
+					im_X = vX[N] * scale_X + offset_X;
+					im_Y = vY[N] * scale_Y + offset_Y;
 
-		pl->data_box_on = DATA_BOX_PICK;
-		pl->data_box_X = pl->viewport.max_x;
-		pl->data_box_Y = 0;
-	}
-}
+					if (line != 0) {
 
-static void
-plotPickDraw(plot_t *pl, SDL_Surface *surface)
-{
-	double		base_X, base_Y, data_X, data_Y;
-	int		fN, aN, bN;
+						rc = drawLineTrial(&tr->dw, &pl->viewport,
+								last_im_X, last_im_Y, im_X, im_Y,
+								ncolor, fwidth);
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+						if (rc != 0) {
 
-		if (pl->figure[fN].slice_busy != 0) {
+							plotSketchDataLine(pl, fN, &kb, last_X, last_Y,
+									vX[N], vY[N]);
+						}
+					}
+					else {
+						line = 1;
+					}
 
-			aN = pl->figure[fN].axis_X;
-			bN = pl->figure[fN].axis_Y;
+					last_X = vX[N];
+					last_Y = vY[N];
 
-			if (		pl->slice_mode_N != 0
-					&& pl->figure[fN].slice_base_catch != 0) {
+					last_im_X = im_X;
+					last_im_Y = im_Y;
+				}
 
-				base_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_base_X);
-				base_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_base_Y);
+				plotDataSkip(pl, dN, &rN, &id_N, lod_N);
 			}
+			else if (job != 0 || line != 0) {
 
-			data_X = plotAxisConvForward(pl, aN, pl->figure[fN].slice_X);
-			data_Y = plotAxisConvForward(pl, bN, pl->figure[fN].slice_Y);
+				jN = rN;
 
-			SDL_LockSurface(surface);
+				if (skipped != 0) {
 
-			if (		pl->slice_mode_N != 0
-					&& pl->figure[fN].slice_base_catch != 0) {
+					plotDataSkip(pl, dN, &jN, NULL, -1);
+				}
 
-				if (		   fp_isfinite(base_X)
-						&& fp_isfinite(base_Y)
-						&& fp_isfinite(data_X)
-						&& fp_isfinite(data_Y)) {
+				if (plotTrialFetched(pl, dN, jN) == 0) {
 
-					drawDashReset(pl->dw);
-					drawDashCanvas(pl->dw, surface, &pl->viewport,
-							base_X, base_Y, data_X, data_Y,
-							12, pl->dw->thickness,
-							pl->layout_fence_dash,
-							pl->layout_fence_space);
+					/* The row is not in chunk cache so we ask main
+					 * thread to fetch it.
+					 * */
+					pl->draw[fN].sketch = SKETCH_INTERRUPTED;
+					pl->draw[fN].rN = rN;
+					pl->draw[fN].id_N = id_N;
+					pl->draw[fN].skipped = skipped;
+					pl->draw[fN].line = line;
+					pl->draw[fN].last_X = last_X;
+					pl->draw[fN].last_Y = last_Y;
+
+					tr->chunk_N = kN;
+					tr->fetch_N = plotDataChunkN(pl, dN, jN);
+					break;
 				}
 
-				if (fp_isfinite(base_X) && fp_isfinite(base_Y)) {
+				if (skipped != 0) {
 
-					drawDotCanvas(pl->dw, surface, &pl->viewport,
-							base_X, base_Y,
-							pl->layout_fence_point, 12, 0);
+					plotDataSkip(pl, dN, &rN, &id_N, -1);
+
+					skipped = 0;
 				}
-			}
 
-			if (fp_isfinite(data_X) && fp_isfinite(data_Y)) {
+				row = plotTrialGet(pl, dN, &rN);
 
-				drawDotCanvas(pl->dw, surface, &pl->viewport,
-						data_X, data_Y,
-						pl->layout_fence_point, 12, 0);
-			}
+				if (row == NULL) {
 
-			SDL_UnlockSurface(surface);
-		}
-	}
-}
+					pl->draw[fN].sketch = SKETCH_FINISHED;
+					pl->draw[fN].rN = rN;
+					pl->draw[fN].id_N = id_N;
+					pl->draw[fN].skipped = skipped;
+					pl->draw[fN].line = line;
+					pl->draw[fN].last_X = last_X;
+					pl->draw[fN].last_Y = last_Y;
+					break;
+				}
 
-void plotBrushErase(plot_t *pl)
-{
-	double		fmin_X, fmin_Y, fmax_X, fmax_Y;
-	int		N, fN, aN, bN, dN, cNX, cNY, sNX, sNY;
+				X = (xN < 0) ? id_N : row[xN * cSTEP];
+				Y = (yN < 0) ? id_N : row[yN * cSTEP];
 
-	int		modified = (int) (SDL_GetTicks() & 65535U);
+				im_X = X * scale_X + offset_X;
+				im_Y = Y * scale_Y + offset_Y;
 
-	modified += pl->brush_box_X + pl->brush_box_Y
-		+ pl->brush_cur_X + pl->brush_cur_Y;
+				if (fp_isfinite(im_X) && fp_isfinite(im_Y)) {
 
-	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
+					if (line != 0) {
 
-		if (		pl->figure[fN].busy != 0
-				&& pl->figure[fN].hidden == 0
-				&& pl->figure[fN].brush_N != 0) {
+						rc = drawLineTrial(&tr->dw, &pl->viewport,
+								last_im_X, last_im_Y, im_X, im_Y,
+								ncolor, fwidth);
 
-			dN = pl->figure[fN].data_N;
+						if (rc != 0) {
 
-			cNX = pl->figure[fN].column_X;
-			cNY = pl->figure[fN].column_Y;
+							plotSketchDataLine(pl, fN, &kb, last_X, last_Y, X, Y);
+						}
+					}
+					else {
+						line = 1;
+					}
 
-			if (cNX < pl->data[dN].column_N) {
+					last_X = X;
+					last_Y = Y;
 
-				cNX = plotGetSubtractClone(pl, dN, cNX);
+					last_im_X = im_X;
+					last_im_Y = im_Y;
+				}
+				else {
+					line = 0;
+				}
+
+				id_N++;
 			}
-			else {
-				for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
 
-					if (		N != fN && pl->figure[N].busy != 0
-							&& dN == pl->figure[N].data_N
-							&& cNX == pl->figure[N].column_X) {
+			if (job == 0) {
 
-						cNX = plotGetSubtractClone(pl, dN, cNX);
-						break;
-					}
+				plotDataChunkSkip(pl, dN, &rN, &id_N);
 
-					if (		N != fN && pl->figure[N].busy != 0
-							&& dN == pl->figure[N].data_N
-							&& cNX == pl->figure[N].column_Y) {
+				skipped = 1;
+				line = 0;
+			}
 
-						cNX = plotGetSubtractClone(pl, dN, cNX);
-						break;
-					}
-				}
+			if (plotTrialTick(tr) > tr->tTOP) {
+
+				pl->draw[fN].sketch = SKETCH_INTERRUPTED;
+				pl->draw[fN].rN = rN;
+				pl->draw[fN].id_N = id_N;
+				pl->draw[fN].skipped = skipped;
+				pl->draw[fN].line = line;
+				pl->draw[fN].last_X = last_X;
+				pl->draw[fN].last_Y = last_Y;
+
+				tr->chunk_N = -1;
+				break;
 			}
+		}
+		while (1);
+	}
+	else if (fdrawing == FIGURE_DRAWING_DOT) {
 
-			if (cNY < pl->data[dN].column_N) {
+		do {
+			kN = plotDataChunkN(pl, dN, rN);
+			job = 1;
 
-				cNY = plotGetSubtractClone(pl, dN, cNY);
-			}
-			else {
-				for (N = 0; N < PLOT_FIGURE_MAX; ++N) {
+			if (kN != kN_cached) {
 
-					if (		N != fN && pl->figure[N].busy != 0
-							&& dN == pl->figure[N].data_N
-							&& cNY == pl->figure[N].column_X) {
+				st_X = plotDataStatChunk(pl, dN, kN, xN);
+				st_Y = plotDataStatChunk(pl, dN, kN, yN);
 
-						cNY = plotGetSubtractClone(pl, dN, cNY);
-						break;
-					}
+				if (st_X != NULL) {
 
-					if (		N != fN && pl->figure[N].busy != 0
-							&& dN == pl->figure[N].data_N
-							&& cNY == pl->figure[N].column_Y) {
+					if (st_X->finite != 0) {
 
-						cNY = plotGetSubtractClone(pl, dN, cNY);
-						break;
+						im_MIN = st_X->fmin * scale_X + offset_X;
+						im_MAX = st_X->fmax * scale_X + offset_X;
+
+						job = (	   im_MAX < pl->viewport.min_x - 16
+							|| im_MIN > pl->viewport.max_x + 16) ? 0 : job;
+					}
+					else {
+						job = 0;
 					}
 				}
-			}
 
-			if (		   cNX >= pl->data[dN].column_N
-					&& cNY >= pl->data[dN].column_N) {
+				if (st_Y != NULL) {
 
-				aN = pl->figure[fN].axis_X;
-				bN = pl->figure[fN].axis_Y;
+					if (st_Y->finite != 0) {
 
-				if (pl->brush_box_X < pl->brush_cur_X) {
+						im_MIN = st_Y->fmin * scale_Y + offset_Y;
+						im_MAX = st_Y->fmax * scale_Y + offset_Y;
 
-					fmin_X = plotAxisConvBackward(pl, aN, pl->brush_box_X);
-					fmax_X = plotAxisConvBackward(pl, aN, pl->brush_cur_X);
-				}
-				else {
-					fmin_X = plotAxisConvBackward(pl, aN, pl->brush_cur_X);
-					fmax_X = plotAxisConvBackward(pl, aN, pl->brush_box_X);
+						job = (	   im_MIN < pl->viewport.min_y - 16
+							|| im_MAX > pl->viewport.max_y + 16) ? 0 : job;
+					}
+					else {
+						job = 0;
+					}
 				}
 
-				if (pl->brush_box_Y < pl->brush_cur_Y) {
-
-					fmax_Y = plotAxisConvBackward(pl, bN, pl->brush_box_Y);
-					fmin_Y = plotAxisConvBackward(pl, bN, pl->brush_cur_Y);
-				}
-				else {
-					fmax_Y = plotAxisConvBackward(pl, bN, pl->brush_cur_Y);
-					fmin_Y = plotAxisConvBackward(pl, bN, pl->brush_box_Y);
-				}
+				kN_cached = kN;
+			}
 
-				sNX = cNX - pl->data[dN].column_N;
-				sNY = cNY - pl->data[dN].column_N;
+			if (		kN != tr->chunk_N
+					&& job != 0) {
 
-				if (pl->data[dN].sub[sNX].busy == SUBTRACT_SCALE) {
+				pl->draw[fN].sketch = SKETCH_INTERRUPTED;
+				pl->draw[fN].rN = rN;
+				pl->draw[fN].id_N = id_N;
 
-					pl->data[dN].sub[sNX].op.scale.modified += modified;
-				}
+				tr->chunk_N = kN;
+				break;
+			}
 
-				if (pl->data[dN].sub[sNY].busy == SUBTRACT_SCALE) {
+			if (job != 0) {
 
-					pl->data[dN].sub[sNY].op.scale.modified += modified;
-				}
+				if (plotTrialFetched(pl, dN, rN) == 0) {
 
-				plotDataErase(pl, dN, cNX, cNY, fmin_X, fmin_Y, fmax_X, fmax_Y);
+					pl->draw[fN].sketch = SKETCH_INTERRUPTED;
+					pl->draw[fN].rN = rN;
+					pl->draw[fN].id_N = id_N;
 
-				cNX = plotSubtractOriginal(pl, dN, cNX);
-				cNY = plotSubtractOriginal(pl, dN, cNY);
+					tr->chunk_N = kN;
+					tr->fetch_N = kN;
+					break;
+				}
 
-				pl->figure[fN].column_X = cNX;
-				pl->figure[fN].column_Y = cNY;
+				row = plotTrialGet(pl, dN, &rN);
 
-				plotSubtractGarbage(pl, dN);
-			}
-		}
-	}
-}
+				if (row == NULL) {
 
-static void
-plotSketchDataChunkSetUp(plot_t *pl, int fN)
-{
-	int		hN;
+					pl->draw[fN].sketch = SKETCH_FINISHED;
+					pl->draw[fN].rN = rN;
+					pl->draw[fN].id_N = id_N;
+					break;
+				}
 
-	hN = pl->draw[fN].list_self;
+				X = (xN < 0) ? id_N : row[xN * cSTEP];
+				Y = (yN < 0) ? id_N : row[yN * cSTEP];
 
-	if (hN >= 0	&& pl->sketch[hN].figure_N == fN
-			&& pl->sketch[hN].drawing == pl->figure[fN].drawing
-			&& pl->sketch[hN].width == pl->figure[fN].width
-			&& pl->sketch[hN].length < PLOT_SKETCH_CHUNK_SIZE) {
+				im_X = X * scale_X + offset_X;
+				im_Y = Y * scale_Y + offset_Y;
 
-		/* Keep using this chunk */
-	}
-	else if (pl->sketch_list_garbage >= 0) {
+				if (fp_isfinite(im_X) && fp_isfinite(im_Y)) {
 
-		hN = pl->sketch_list_garbage;
-		pl->sketch_list_garbage = pl->sketch[hN].linked;
+					rc = drawDotTrial(&tr->dw, &pl->viewport,
+							im_X, im_Y, fwidth,
+							ncolor, 1);
 
-		pl->sketch[hN].figure_N = fN;
-		pl->sketch[hN].drawing = pl->figure[fN].drawing;
-		pl->sketch[hN].width = pl->figure[fN].width;
+					if (rc != 0) {
 
-		if (pl->sketch[hN].chunk == NULL) {
+						plotSketchDataDot(pl, fN, &kb, X, Y);
+					}
+				}
 
-			pl->sketch[hN].chunk = (double *) malloc(sizeof(double) * PLOT_SKETCH_CHUNK_SIZE);
+				id_N++;
+			}
 
-			if (pl->sketch[hN].chunk == NULL) {
+			if (job == 0) {
 
-				ERROR("Unable to allocate memory of %i sketch chunk\n", hN);
+				plotDataChunkSkip(pl, dN, &rN, &id_N);
 			}
-		}
 
-		pl->sketch[hN].length = 0;
-
-		if (pl->draw[fN].list_self >= 0) {
+			if (plotTrialTick(tr) > tr->tTOP) {
 
-			pl->sketch[hN].linked = pl->sketch[pl->draw[fN].list_self].linked;
-			pl->sketch[pl->draw[fN].list_self].linked = hN;
+				pl->draw[fN].sketch = SKETCH_INTERRUPTED;
+				pl->draw[fN].rN = rN;
+				pl->draw[fN].id_N = id_N;
 
-			if (pl->draw[fN].list_self == pl->sketch_list_current_end)
-				pl->sketch_list_current_end = hN;
+				tr->chunk_N = -1;
+				break;
+			}
 		}
-		else {
-			pl->sketch[hN].linked = -1;
+		while (1);
+	}
+}
 
-			if (pl->sketch_list_current >= 0) {
+int plotGetSketchLength(plot_t *pl)
+{
+	int		hN, length = 0;
 
-				pl->sketch[pl->sketch_list_current_end].linked = hN;
-				pl->sketch_list_current_end = hN;
-			}
-			else {
-				pl->sketch_list_current = hN;
-				pl->sketch_list_current_end = hN;
-			}
-		}
+	hN = pl->sketch_list_todraw;
 
-		pl->draw[fN].list_self = hN;
-	}
-	else {
-		ERROR("Unable to get free sketch chunk\n");
+	while (hN >= 0) {
 
-		pl->draw[fN].list_self = -1;
+		length += pl->sketch[hN].length;
+		hN = pl->sketch[hN].linked;
 	}
+
+	return length;
 }
 
 static void
-plotSketchDataAdd(plot_t *pl, int fN, double X, double Y)
+plotDrawSketchList(plot_t *pl, draw_t *dw, SDL_Surface *surface, int resume)
 {
-	int		hN, length;
+	const Sint16	*chunk, *lend;
 
-	hN = pl->draw[fN].list_self;
-
-	if (hN >= 0) {
+	double		X, Y, last_X, last_Y, tf[4];
+	int		hN, fN, line;
 
-		length = pl->sketch[hN].length;
+	int		fdrawing, fwidth, ncolor;
 
-		pl->sketch[hN].chunk[length++] = X;
-		pl->sketch[hN].chunk[length++] = Y;
+	hN = pl->sketch_list_todraw;
 
-		pl->sketch[hN].length = length;
+	drawDashReset(dw);
 
-		if (length >= PLOT_SKETCH_CHUNK_SIZE) {
+	if (resume != 0) {
 
-			plotSketchDataChunkSetUp(pl, fN);
-		}
+		dw->dash_context = pl->draw_layer_dash;
 	}
-}
-
-static void
-plotSketchGarbage(plot_t *pl)
-{
-	int		N, hN, linked;
-
-	hN = pl->sketch_list_todraw;
 
 	while (hN >= 0) {
 
-		linked = pl->sketch[hN].linked;
+		fN = pl->sketch[hN].figure_N;
 
-		pl->sketch[hN].linked = pl->sketch_list_garbage;
-		pl->sketch_list_garbage = hN;
+		ncolor = (pl->figure[fN].hidden != 0) ? 11 : fN + 1;
 
-		hN = linked;
-	}
+		fdrawing = pl->sketch[hN].drawing;
+		fwidth = pl->sketch[hN].width;
 
-	pl->sketch_list_todraw = pl->sketch_list_current;
-	pl->sketch_list_current = -1;
-	pl->sketch_list_current_end = -1;
+		plotSketchTransform(pl, hN, tf);
 
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N)
-		pl->draw[N].list_self = -1;
-}
+		chunk = pl->sketch[hN].chunk;
+		lend = chunk + pl->sketch[hN].length;
 
-void plotSketchClean(plot_t *pl)
-{
-	int		N, hN, linked;
+		line = 0;
 
-	hN = pl->sketch_list_todraw;
+		last_X = 0.;
+		last_Y = 0.;
 
-	while (hN >= 0) {
+		if (resume != 0 && pl->sketch[hN].drawn != 0) {
 
-		linked = pl->sketch[hN].linked;
+			/* Skip the segments that are already in layer.
+			 * */
+			chunk += pl->sketch[hN].drawn;
 
-		pl->sketch[hN].linked = pl->sketch_list_garbage;
-		pl->sketch_list_garbage = hN;
+			if (chunk[-2] != PLOT_SKETCH_BREAK) {
 
-		hN = linked;
-	}
+				last_X = chunk[-2] * tf[0] + tf[1];
+				last_Y = chunk[-1] * tf[2] + tf[3];
 
-	hN = pl->sketch_list_current;
+				line = 1;
+			}
+		}
 
-	while (hN >= 0) {
+		if (		fdrawing == FIGURE_DRAWING_LINE
+				|| fdrawing == FIGURE_DRAWING_DASH) {
 
-		linked = pl->sketch[hN].linked;
+			while (chunk < lend) {
 
-		pl->sketch[hN].linked = pl->sketch_list_garbage;
-		pl->sketch_list_garbage = hN;
+				if (chunk[0] == PLOT_SKETCH_BREAK) {
 
-		hN = linked;
-	}
+					chunk += 2;
+					line = 0;
+					continue;
+				}
 
-	pl->sketch_list_todraw = -1;
-	pl->sketch_list_current = -1;
-	pl->sketch_list_current_end = -1;
+				X = *chunk++ * tf[0] + tf[1];
+				Y = *chunk++ * tf[2] + tf[3];
 
-	for (N = 0; N < PLOT_FIGURE_MAX; ++N)
-		pl->draw[N].list_self = -1;
+				if (line == 0) {
 
-	pl->draw_in_progress = 0;
-}
+					line = 1;
+				}
+				else if (fdrawing == FIGURE_DRAWING_LINE) {
 
-static void
-plotDrawPalette(plot_t *pl)
-{
-	draw_t			*dw = pl->dw;
-	scheme_t		*sch = pl->sch;
-	Uint32			*palette;
+					drawLineCanvas(dw, surface, &pl->viewport,
+							last_X, last_Y, X, Y,
+							ncolor, fwidth);
+				}
+				else {
+					drawDashCanvas(dw, surface, &pl->viewport,
+							last_X, last_Y, X, Y,
+							ncolor, fwidth, pl->layout_drawing_dash,
+							pl->layout_drawing_space);
+				}
 
-	palette = dw->palette;
+				last_X = X;
+				last_Y = Y;
+			}
+		}
+		else if (fdrawing == FIGURE_DRAWING_DOT) {
 
-	palette[0] = drawRGBMap(dw, sch->plot_background);
-	palette[1] = drawRGBMap(dw, sch->plot_figure[0]);
-	palette[2] = drawRGBMap(dw, sch->plot_figure[1]);
-	palette[3] = drawRGBMap(dw, sch->plot_figure[2]);
-	palette[4] = drawRGBMap(dw, sch->plot_figure[3]);
-	palette[5] = drawRGBMap(dw, sch->plot_figure[4]);
-	palette[6] = drawRGBMap(dw, sch->plot_figure[5]);
-	palette[7] = drawRGBMap(dw, sch->plot_figure[6]);
-	palette[8] = drawRGBMap(dw, sch->plot_figure[7]);
-	palette[9] = drawRGBMap(dw, sch->plot_figure[8]);
-	palette[10] = drawRGBMap(dw, sch->plot_figure[9]);
-	palette[11] = drawRGBMap(dw, sch->plot_hidden);
-	palette[12] = drawRGBMap(dw, sch->plot_text);
-}
+			while (chunk < lend) {
 
-static Uint32
-plotGetTick(plot_t *pl)
-{
-	if (pl->tick_skip++ >= 63) {
+				X = *chunk++ * tf[0] + tf[1];
+				Y = *chunk++ * tf[2] + tf[3];
+
+				drawDotCanvas(dw, surface, &pl->viewport,
+						X, Y, fwidth,
+						ncolor, 1);
+			}
+		}
 
-		pl->tick_cached = SDL_GetTicks();
-		pl->tick_skip = 0;
+		hN = pl->sketch[hN].linked;
 	}
+}
 
-	return pl->tick_cached;
+static void
+plotDrawSketchTile(ptile_t *tl)
+{
+	plotDrawSketchList((plot_t *) tl->pl, &tl->dw, tl->surface, tl->resume);
 }
 
 static void
-plotDrawFigureTrial(plot_t *pl, int fN, Uint32 tTOP)
+plotDrawFigureStrip(plot_t *pl, int fN, clipBox_t *sb, const clipBox_t *kb)
 {
 	const fval_t	*row;
+	const pstat_t	*st_X, *st_Y;
+	draw_t		*dw;
 
 	double		scale_X, scale_Y, offset_X, offset_Y, im_MIN, im_MAX;
 	double		X, Y, last_X, last_Y, im_X, im_Y, last_im_X, last_im_Y;
-	int		dN, rN, xN, yN, xNR, yNR, aN, bN, id_N, id_N_top, kN, kN_cached;
-	int		job, skipped, line, rc, ncolor, fdrawing, fwidth;
+	double		view[4], vbox[8], vX[4], vY[4];
+	int		dN, rN, xN, yN, xNR, yNR, id_N, kN, kN_cached, cSTEP;
+	int		job, skipped, line, rc, ncolor, fdrawing, fwidth, lod_N, N;
+
+	dw = &pl->trial[fN].dw;
 
 	ncolor = (pl->figure[fN].hidden != 0) ? 11 : fN + 1;
 
@@ -7128,395 +11294,404 @@ plotDrawFigureTrial(plot_t *pl, int fN, Uint32 tTOP)
 	xN = pl->figure[fN].column_X;
 	yN = pl->figure[fN].column_Y;
 
-	xNR = plotDataRangeCacheFetch(pl, dN, xN);
-	yNR = plotDataRangeCacheFetch(pl, dN, yN);
-
-	aN = pl->figure[fN].axis_X;
-	scale_X = pl->axis[aN].scale;
-	offset_X = pl->axis[aN].offset;
-
-	if (pl->axis[aN].slave != 0) {
-
-		bN = pl->axis[aN].slave_N;
-		scale_X *= pl->axis[bN].scale;
-		offset_X = offset_X * pl->axis[bN].scale + pl->axis[bN].offset;
-	}
-
-	aN = pl->figure[fN].axis_Y;
-	scale_Y = pl->axis[aN].scale;
-	offset_Y = pl->axis[aN].offset;
+	cSTEP = pl->data[dN].column_STEP;
 
-	if (pl->axis[aN].slave != 0) {
+	plotDataStatFetch(pl, dN, xN, NULL, NULL);
+	plotDataStatFetch(pl, dN, yN, NULL, NULL);
 
-		bN = pl->axis[aN].slave_N;
-		scale_Y *= pl->axis[bN].scale;
-		offset_Y = offset_Y * pl->axis[bN].scale + pl->axis[bN].offset;
-	}
+	xNR = plotDataRangeCacheFetch(pl, dN, xN);
+	yNR = plotDataRangeCacheFetch(pl, dN, yN);
 
-	X = (double) (pl->viewport.max_x - pl->viewport.min_x);
-	Y = (double) (pl->viewport.min_y - pl->viewport.max_y);
+	plotDrawFigureView(pl, fN, view);
 
-	scale_X *= X;
-	offset_X = offset_X * X + pl->viewport.min_x;
-	scale_Y *= Y;
-	offset_Y = offset_Y * Y + pl->viewport.max_y;
+	scale_X = view[0];
+	offset_X = view[1];
+	scale_Y = view[2];
+	offset_Y = view[3];
 
-	rN = pl->draw[fN].rN;
-	id_N = pl->draw[fN].id_N;
+	rN = pl->data[dN].head_N;
+	id_N = pl->data[dN].id_N;
 
-	id_N_top = id_N + (1UL << pl->data[dN].chunk_SHIFT);
 	kN_cached = -1;
 
-	plotSketchDataChunkSetUp(pl, fN);
+	skipped = 0;
+	line = 0;
 
-	if (		fdrawing == FIGURE_DRAWING_LINE
-			|| fdrawing == FIGURE_DRAWING_DASH) {
+	last_X = 0.;
+	last_Y = 0.;
 
-		skipped = pl->draw[fN].skipped;
-		line = pl->draw[fN].line;
+	last_im_X = 0.;
+	last_im_Y = 0.;
 
-		last_X = pl->draw[fN].last_X;
-		last_Y = pl->draw[fN].last_Y;
+	plotSketchDataChunkSetUp(pl, fN);
 
-		last_im_X = last_X * scale_X + offset_X;
-		last_im_Y = last_Y * scale_Y + offset_Y;
+	/* Go through all of dataset but only the chunks that have range
+	 * within the strip are read. The trial is clipped to the strip so
+	 * the segments already in sketch are not taken again.
+	 * */
+	do {
+		kN = plotDataChunkN(pl, dN, rN);
+		job = 1;
 
-		do {
-			kN = plotDataChunkN(pl, dN, rN);
-			job = 1;
+		if (kN != kN_cached) {
 
-			if (kN != kN_cached) {
+			st_X = plotDataStatChunk(pl, dN, kN, xN);
+			st_Y = plotDataStatChunk(pl, dN, kN, yN);
 
-				if (xNR >= 0 && pl->rcache[xNR].chunk[kN].computed != 0) {
+			if (st_X != NULL) {
 
-					if (pl->rcache[xNR].chunk[kN].finite != 0) {
+				if (st_X->finite != 0) {
 
-						im_MIN = pl->rcache[xNR].chunk[kN].fmin * scale_X + offset_X;
-						im_MAX = pl->rcache[xNR].chunk[kN].fmax * scale_X + offset_X;
+					im_MIN = st_X->fmin * scale_X + offset_X;
+					im_MAX = st_X->fmax * scale_X + offset_X;
 
-						job = (	   im_MAX < pl->viewport.min_x - 16
-							|| im_MIN > pl->viewport.max_x + 16) ? 0 : job;
-					}
-					else {
-						job = 0;
-					}
+					job = (	   im_MAX < sb->min_x - 16
+						|| im_MIN > sb->max_x + 16) ? 0 : job;
+				}
+				else {
+					job = 0;
 				}
+			}
 
-				if (yNR >= 0 && pl->rcache[yNR].chunk[kN].computed != 0) {
+			if (st_Y != NULL) {
 
-					if (pl->rcache[yNR].chunk[kN].finite != 0) {
+				if (st_Y->finite != 0) {
 
-						im_MIN = pl->rcache[yNR].chunk[kN].fmin * scale_Y + offset_Y;
-						im_MAX = pl->rcache[yNR].chunk[kN].fmax * scale_Y + offset_Y;
+					im_MIN = st_Y->fmin * scale_Y + offset_Y;
+					im_MAX = st_Y->fmax * scale_Y + offset_Y;
 
-						job = (	   im_MIN < pl->viewport.min_y - 16
-							|| im_MAX > pl->viewport.max_y + 16) ? 0 : job;
-					}
-					else {
-						job = 0;
-					}
+					job = (	   im_MIN < sb->min_y - 16
+						|| im_MAX > sb->max_y + 16) ? 0 : job;
+				}
+				else {
+					job = 0;
 				}
-
-				kN_cached = kN;
 			}
 
-			if (job != 0 || line != 0) {
-
-				if (skipped != 0) {
+			kN_cached = kN;
+		}
 
-					plotDataSkip(pl, dN, &rN, &id_N, -1);
+		lod_N = 0;
 
-					skipped = 0;
-				}
+		if (		job != 0 && skipped == 0
+				&& fdrawing != FIGURE_DRAWING_DOT
+				&& pl->lod != 0) {
 
-				row = plotDataGet(pl, dN, &rN);
+			lod_N = plotDataLodGet(pl, dN, xNR, yNR, rN, id_N,
+					scale_X, scale_Y, vbox);
+		}
 
-				if (row == NULL) {
+		if (lod_N != 0) {
 
-					pl->draw[fN].sketch = SKETCH_FINISHED;
-					break;
-				}
+			plotDataLodPolyline(vbox, scale_X, vX, vY);
 
-				X = (xN < 0) ? id_N : row[xN];
-				Y = (yN < 0) ? id_N : row[yN];
+			for (N = 0; N < 4; ++N) {
 
-				im_X = X * scale_X + offset_X;
-				im_Y = Y * scale_Y + offset_Y;
+				if (		N != 0 && vX[N] == last_X
+						&& vY[N] == last_Y)
+					continue;
 
-				if (fp_isfinite(im_X) && fp_isfinite(im_Y)) {
+				im_X = vX[N] * scale_X + offset_X;
+				im_Y = vY[N] * scale_Y + offset_Y;
 
-					if (line != 0) {
+				if (line != 0) {
 
-						rc = drawLineTrial(pl->dw, &pl->viewport,
-								last_im_X, last_im_Y, im_X, im_Y,
-								ncolor, fwidth);
+					rc = drawLineTrial(dw, sb, last_im_X, last_im_Y,
+							im_X, im_Y, ncolor, fwidth);
 
-						if (rc != 0) {
+					if (rc != 0) {
 
-							plotSketchDataAdd(pl, fN, last_X, last_Y);
-							plotSketchDataAdd(pl, fN, X, Y);
-						}
-					}
-					else {
-						line = 1;
+						plotSketchDataLine(pl, fN, kb, last_X, last_Y,
+								vX[N], vY[N]);
 					}
-
-					last_X = X;
-					last_Y = Y;
-
-					last_im_X = im_X;
-					last_im_Y = im_Y;
 				}
 				else {
-					line = 0;
+					line = 1;
 				}
 
-				id_N++;
+				last_X = vX[N];
+				last_Y = vY[N];
+
+				last_im_X = im_X;
+				last_im_Y = im_Y;
 			}
 
-			if (job == 0) {
+			plotDataSkip(pl, dN, &rN, &id_N, lod_N);
+		}
+		else if (job != 0 || line != 0) {
 
-				plotDataChunkSkip(pl, dN, &rN, &id_N);
+			if (		skipped != 0
+					&& fdrawing != FIGURE_DRAWING_DOT) {
 
-				skipped = 1;
-				line = 0;
+				plotDataSkip(pl, dN, &rN, &id_N, -1);
 			}
 
-			if (id_N > id_N_top || plotGetTick(pl) > tTOP) {
+			skipped = 0;
 
-				pl->draw[fN].sketch = SKETCH_INTERRUPTED;
-				pl->draw[fN].rN = rN;
-				pl->draw[fN].id_N = id_N;
-				pl->draw[fN].skipped = skipped;
-				pl->draw[fN].line = line;
-				pl->draw[fN].last_X = last_X;
-				pl->draw[fN].last_Y = last_Y;
+			row = plotDataGet(pl, dN, &rN);
+
+			if (row == NULL)
 				break;
-			}
-		}
-		while (1);
-	}
-	else if (fdrawing == FIGURE_DRAWING_DOT) {
 
-		do {
-			kN = plotDataChunkN(pl, dN, rN);
-			job = 1;
+			X = (xN < 0) ? id_N : row[xN * cSTEP];
+			Y = (yN < 0) ? id_N : row[yN * cSTEP];
 
-			if (kN != kN_cached) {
+			im_X = X * scale_X + offset_X;
+			im_Y = Y * scale_Y + offset_Y;
 
-				if (xNR >= 0 && pl->rcache[xNR].chunk[kN].computed != 0) {
+			if (fp_isfinite(im_X) && fp_isfinite(im_Y)) {
 
-					if (pl->rcache[xNR].chunk[kN].finite != 0) {
+				if (fdrawing == FIGURE_DRAWING_DOT) {
 
-						im_MIN = pl->rcache[xNR].chunk[kN].fmin * scale_X + offset_X;
-						im_MAX = pl->rcache[xNR].chunk[kN].fmax * scale_X + offset_X;
+					rc = drawDotTrial(dw, sb, im_X, im_Y,
+							fwidth, ncolor, 1);
 
-						job = (	   im_MAX < pl->viewport.min_x - 16
-							|| im_MIN > pl->viewport.max_x + 16) ? 0 : job;
-					}
-					else {
-						job = 0;
+					if (rc != 0) {
+
+						plotSketchDataDot(pl, fN, kb, X, Y);
 					}
 				}
+				else if (line != 0) {
 
-				if (yNR >= 0 && pl->rcache[yNR].chunk[kN].computed != 0) {
+					rc = drawLineTrial(dw, sb, last_im_X, last_im_Y,
+							im_X, im_Y, ncolor, fwidth);
 
-					if (pl->rcache[yNR].chunk[kN].finite != 0) {
-
-						im_MIN = pl->rcache[yNR].chunk[kN].fmin * scale_Y + offset_Y;
-						im_MAX = pl->rcache[yNR].chunk[kN].fmax * scale_Y + offset_Y;
+					if (rc != 0) {
 
-						job = (	   im_MIN < pl->viewport.min_y - 16
-							|| im_MAX > pl->viewport.max_y + 16) ? 0 : job;
-					}
-					else {
-						job = 0;
+						plotSketchDataLine(pl, fN, kb, last_X, last_Y, X, Y);
 					}
 				}
+				else {
+					line = 1;
+				}
 
-				kN_cached = kN;
+				last_X = X;
+				last_Y = Y;
+
+				last_im_X = im_X;
+				last_im_Y = im_Y;
+			}
+			else {
+				line = 0;
 			}
 
-			if (job != 0) {
+			id_N++;
+		}
 
-				row = plotDataGet(pl, dN, &rN);
+		if (job == 0) {
 
-				if (row == NULL) {
+			if (rN == pl->data[dN].tail_N)
+				break;
 
-					pl->draw[fN].sketch = SKETCH_FINISHED;
-					break;
-				}
+			plotDataChunkSkip(pl, dN, &rN, &id_N);
+
+			skipped = 1;
+			line = 0;
+		}
+	}
+	while (1);
+}
 
-				X = (xN < 0) ? id_N : row[xN];
-				Y = (yN < 0) ? id_N : row[yN];
+static void
+plotSketchStrip(plot_t *pl, const int *FIGS, int lN, clipBox_t *sb)
+{
+	clipBox_t	kb;
+	int		N;
 
-				im_X = X * scale_X + offset_X;
-				im_Y = Y * scale_Y + offset_Y;
+	if (		sb->min_x > sb->max_x
+			|| sb->min_y > sb->max_y)
+		return ;
 
-				if (fp_isfinite(im_X) && fp_isfinite(im_Y)) {
+	/* The segments are kept a bit over the strip so the pixels on its
+	 * sides are drawn the same way as without the clipping.
+	 * */
+	kb.min_x = sb->min_x - 16;
+	kb.min_y = sb->min_y - 16;
+	kb.max_x = sb->max_x + 16;
+	kb.max_y = sb->max_y + 16;
 
-					rc = drawDotTrial(pl->dw, &pl->viewport,
-							im_X, im_Y, fwidth,
-							ncolor, 1);
+	for (N = 0; N < lN; ++N) {
 
-					if (rc != 0) {
+		plotDrawFigureStrip(pl, FIGS[N], sb, &kb);
+	}
+}
 
-						plotSketchDataAdd(pl, fN, X, Y);
-					}
-				}
+static int
+plotDrawSketchLayer(plot_t *pl)
+{
+	double		dX, dY, sX, sY;
+	int		hN, fN, resume, shift;
 
-				id_N++;
-			}
+	resume = 1;
+	shift = 0;
 
-			if (job == 0) {
+	dX = 0.;
+	dY = 0.;
 
-				plotDataChunkSkip(pl, dN, &rN, &id_N);
-			}
+	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-			if (id_N > id_N_top || plotGetTick(pl) > tTOP) {
+		if (pl->figure[fN].busy == 0)
+			continue;
 
-				pl->draw[fN].sketch = SKETCH_INTERRUPTED;
-				pl->draw[fN].rN = rN;
-				pl->draw[fN].id_N = id_N;
-				break;
-			}
+		if (		plotDrawFigureShift(pl, fN, &pl->draw[fN].layer, &sX, &sY) != 0
+				&& (shift == 0 || (sX == dX && sY == dY))) {
+
+			dX = sX;
+			dY = sY;
+
+			shift = 1;
+		}
+		else {
+			resume = 0;
+			break;
 		}
-		while (1);
 	}
-}
 
-int plotGetSketchLength(plot_t *pl)
-{
-	int		hN, length = 0;
+	/* If there is no figure to keep the layer still has the picture of
+	 * figures removed so it is cleared.
+	 * */
+	resume = (shift != 0) ? resume : 0;
 
 	hN = pl->sketch_list_todraw;
 
-	while (hN >= 0) {
+	while (hN >= 0 && resume != 0) {
 
-		length += pl->sketch[hN].length;
+		fN = pl->sketch[hN].figure_N;
+
+		resume = (pl->figure[fN].busy != 0) ? resume : 0;
 		hN = pl->sketch[hN].linked;
 	}
 
-	return length;
-}
-
-static void
-plotDrawSketch(plot_t *pl, SDL_Surface *surface)
-{
-	double		scale_X, offset_X, scale_Y, offset_Y;
-	double		X, Y, last_X, last_Y, *chunk, *lend;
-	int		hN, fN, aN, bN;
-
-	int		fdrawing, fwidth, ncolor;
+	if (resume != 0 && (dX != 0. || dY != 0.)) {
 
-	hN = pl->sketch_list_todraw;
+		/* All figures are moved by the same integer offset and the
+		 * exposed strips were appended to the sketch by this trial.
+		 * So we shift the layer and draw only the new chunks.
+		 * */
+		sX = floor(dX + .5);
+		sY = floor(dY + .5);
 
-	drawDashReset(pl->dw);
+		if (		pl->draw_shift != 0
+				&& fabs(dX - sX) < 1E-6 && (int) sX == pl->draw_shift_X
+				&& fabs(dY - sY) < 1E-6 && (int) sY == pl->draw_shift_Y) {
 
-	SDL_LockSurface(surface);
+			drawCanvasShift(pl->dw, &pl->viewport, (int) sX, (int) sY);
 
-	while (hN >= 0) {
+			for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-		fN = pl->sketch[hN].figure_N;
+				if (pl->figure[fN].busy != 0)
+					plotDrawFigureKeep(pl, fN, &pl->draw[fN].layer);
+			}
+		}
+		else {
+			resume = 0;
+		}
+	}
 
-		ncolor = (pl->figure[fN].hidden != 0) ? 11 : fN + 1;
+	if (resume == 0) {
 
-		fdrawing = pl->sketch[hN].drawing;
-		fwidth = pl->sketch[hN].width;
+		/* Redraw the whole sketch into the clean layer.
+		 * */
+		drawClearCanvas(pl->dw);
 
-		aN = pl->figure[fN].axis_X;
-		scale_X = pl->axis[aN].scale;
-		offset_X = pl->axis[aN].offset;
+		for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN) {
 
-		if (pl->axis[aN].slave != 0) {
+			if (pl->figure[fN].busy != 0) {
 
-			bN = pl->axis[aN].slave_N;
-			scale_X *= pl->axis[bN].scale;
-			offset_X = offset_X * pl->axis[bN].scale + pl->axis[bN].offset;
+				plotDrawFigureKeep(pl, fN, &pl->draw[fN].layer);
+			}
+			else {
+				pl->draw[fN].layer.on = 0;
+			}
 		}
+	}
 
-		aN = pl->figure[fN].axis_Y;
-		scale_Y = pl->axis[aN].scale;
-		offset_Y = pl->axis[aN].offset;
+	return resume;
+}
 
-		if (pl->axis[aN].slave != 0) {
+static void
+plotDrawSketch(plot_t *pl, SDL_Surface *surface)
+{
+	ptile_t		*tl;
+	int		N, tile_N, min_y, len_y, layer, resume, hN;
 
-			bN = pl->axis[aN].slave_N;
-			scale_Y *= pl->axis[bN].scale;
-			offset_Y = offset_Y * pl->axis[bN].scale + pl->axis[bN].offset;
-		}
+	tile_N = (pl->pool != NULL) ? pl->pool->thread_N : 0;
+	tile_N = (tile_N > PLOT_TILE_MAX) ? PLOT_TILE_MAX : tile_N;
 
-		X = (double) (pl->viewport.max_x - pl->viewport.min_x);
-		Y = (double) (pl->viewport.min_y - pl->viewport.max_y);
+	min_y = pl->viewport.min_y;
+	len_y = pl->viewport.max_y - min_y + 1;
 
-		scale_X *= X;
-		offset_X = offset_X * X + pl->viewport.min_x;
-		scale_Y *= Y;
-		offset_Y = offset_Y * Y + pl->viewport.max_y;
+	layer = (pl->incremental != 0 && surface->userdata == NULL) ? 1 : 0;
+	resume = 0;
 
-		chunk = pl->sketch[hN].chunk;
-		lend = chunk + pl->sketch[hN].length;
+	drawDashReset(pl->dw);
 
-		if (fdrawing == FIGURE_DRAWING_LINE) {
+	SDL_LockSurface(surface);
 
-			while (chunk < lend) {
+	if (layer != 0) {
 
-				X = *chunk++;
-				Y = *chunk++;
+		/* Draw into the layer pixmap that keeps the sketch drawn in
+		 * previous frames. Only the segments appended to the sketch
+		 * since that are drawn if the view is not changed.
+		 * */
+		drawLayerSwap(pl->dw);
 
-				last_X = X * scale_X + offset_X;
-				last_Y = Y * scale_Y + offset_Y;
+		resume = plotDrawSketchLayer(pl);
+	}
+	else {
+		drawClearCanvas(pl->dw);
+	}
 
-				X = *chunk++;
-				Y = *chunk++;
+	if (		tile_N < 2 || len_y < tile_N * 16
+			|| surface->userdata != NULL) {
 
-				X = X * scale_X + offset_X;
-				Y = Y * scale_Y + offset_Y;
+		/* Draw in place. The SVG output is not split as it should
+		 * get each line only once.
+		 * */
+		plotDrawSketchList(pl, pl->dw, surface, resume);
+	}
+	else {
+		for (N = 0; N < tile_N; ++N) {
 
-				drawLineCanvas(pl->dw, surface, &pl->viewport,
-						last_X, last_Y, X, Y,
-						ncolor, fwidth);
-			}
-		}
-		else if (fdrawing == FIGURE_DRAWING_DASH) {
+			tl = &pl->tile[N];
 
-			while (chunk < lend) {
+			tl->pl = pl;
+			tl->surface = surface;
+			tl->dw = *pl->dw;
+			tl->resume = resume;
 
-				X = *chunk++;
-				Y = *chunk++;
+			tl->dw.tile_min_y = (N == 0) ? pl->dw->tile_min_y
+				: min_y + len_y * N / tile_N;
 
-				last_X = X * scale_X + offset_X;
-				last_Y = Y * scale_Y + offset_Y;
+			tl->dw.tile_max_y = (N == tile_N - 1) ? pl->dw->tile_max_y
+				: min_y + len_y * (N + 1) / tile_N - 1;
 
-				X = *chunk++;
-				Y = *chunk++;
+			poolSubmit(pl->pool, &tl->task, (void (*) (void *))
+					&plotDrawSketchTile, tl);
+		}
 
-				X = X * scale_X + offset_X;
-				Y = Y * scale_Y + offset_Y;
+		for (N = 0; N < tile_N; ++N) {
 
-				drawDashCanvas(pl->dw, surface, &pl->viewport,
-						last_X, last_Y, X, Y,
-						ncolor, fwidth, pl->layout_drawing_dash,
-						pl->layout_drawing_space);
-			}
+			poolWait(pl->pool, &pl->tile[N].task);
 		}
-		else if (fdrawing == FIGURE_DRAWING_DOT) {
 
-			while (chunk < lend) {
+		pl->dw->dash_context = pl->tile[0].dw.dash_context;
+	}
 
-				X = *chunk++;
-				Y = *chunk++;
+	if (layer != 0) {
 
-				X = X * scale_X + offset_X;
-				Y = Y * scale_Y + offset_Y;
+		hN = pl->sketch_list_todraw;
 
-				drawDotCanvas(pl->dw, surface, &pl->viewport,
-						X, Y, fwidth,
-						ncolor, 1);
-			}
+		while (hN >= 0) {
+
+			pl->sketch[hN].drawn = pl->sketch[hN].length;
+			hN = pl->sketch[hN].linked;
 		}
 
-		hN = pl->sketch[hN].linked;
+		pl->draw_layer_dash = pl->dw->dash_context;
+
+		drawLayerSwap(pl->dw);
+		drawLayerCopy(pl->dw);
 	}
 
 	SDL_UnlockSurface(surface);
@@ -7525,9 +11700,10 @@ plotDrawSketch(plot_t *pl, SDL_Surface *surface)
 static void
 plotDrawBrush(plot_t *pl, SDL_Surface *surface)
 {
-	double		scale_X, offset_X, scale_Y, offset_Y;
-	double		X, Y, *chunk, *lend;
-	int		hN, fN, aN, bN, min_X, min_Y, max_X, max_Y;
+	const Sint16	*chunk, *lend;
+
+	double		X, Y, tf[4];
+	int		hN, fN, min_X, min_Y, max_X, max_Y;
 
 	for (fN = 0; fN < PLOT_FIGURE_MAX; ++fN)
 		pl->figure[fN].brush_N = 0;
@@ -7543,35 +11719,7 @@ plotDrawBrush(plot_t *pl, SDL_Surface *surface)
 		if (pl->figure[fN].hidden != 0)
 			goto plotDrawBrush_SKIP;
 
-		aN = pl->figure[fN].axis_X;
-		scale_X = pl->axis[aN].scale;
-		offset_X = pl->axis[aN].offset;
-
-		if (pl->axis[aN].slave != 0) {
-
-			bN = pl->axis[aN].slave_N;
-			scale_X *= pl->axis[bN].scale;
-			offset_X = offset_X * pl->axis[bN].scale + pl->axis[bN].offset;
-		}
-
-		aN = pl->figure[fN].axis_Y;
-		scale_Y = pl->axis[aN].scale;
-		offset_Y = pl->axis[aN].offset;
-
-		if (pl->axis[aN].slave != 0) {
-
-			bN = pl->axis[aN].slave_N;
-			scale_Y *= pl->axis[bN].scale;
-			offset_Y = offset_Y * pl->axis[bN].scale + pl->axis[bN].offset;
-		}
-
-		X = (double) (pl->viewport.max_x - pl->viewport.min_x);
-		Y = (double) (pl->viewport.min_y - pl->viewport.max_y);
-
-		scale_X *= X;
-		offset_X = offset_X * X + pl->viewport.min_x;
-		scale_Y *= Y;
-		offset_Y = offset_Y * Y + pl->viewport.max_y;
+		plotSketchTransform(pl, hN, tf);
 
 		if (pl->brush_box_X < pl->brush_cur_X) {
 
@@ -7598,11 +11746,14 @@ plotDrawBrush(plot_t *pl, SDL_Surface *surface)
 
 		while (chunk < lend) {
 
-			X = *chunk++;
-			Y = *chunk++;
+			if (chunk[0] == PLOT_SKETCH_BREAK) {
 
-			X = X * scale_X + offset_X;
-			Y = Y * scale_Y + offset_Y;
+				chunk += 2;
+				continue;
+			}
+
+			X = *chunk++ * tf[0] + tf[1];
+			Y = *chunk++ * tf[2] + tf[3];
 
 			if (		   X > min_X && X < max_X
 					&& Y > min_Y && Y < max_Y) {
@@ -8499,11 +12650,335 @@ void plotLayout(plot_t *pl)
 	}
 }
 
+static int
+plotSketchStreamSetUp(plot_t *pl, const int *FIGS, int lN)
+{
+	int		N, fN, hN, length;
+
+	if (		pl->incremental == 0
+			|| pl->sketch_list_current >= 0)
+		return 0;
+
+	for (N = 0; N < lN; ++N) {
+
+		fN = FIGS[N];
+
+		if (plotDrawFigureSame(pl, fN, &pl->draw[fN].stream) == 0)
+			return 0;
+	}
+
+	hN = pl->sketch_list_todraw;
+	length = 0;
+
+	while (hN >= 0) {
+
+		fN = pl->sketch[hN].figure_N;
+
+		if (		pl->figure[fN].busy == 0
+				|| pl->draw[fN].stream.on == 0)
+			return 0;
+
+		hN = pl->sketch[hN].linked;
+		length++;
+	}
+
+	/* We do not let the sketch to grow too long so there is enough free
+	 * chunks to do the full redraw.
+	 * */
+	if (length > PLOT_SKETCH_MAX / 4)
+		return 0;
+
+	/* Continue to fill the last chunk of each figure so the new rows are
+	 * shown as soon as they are drawn.
+	 * */
+	hN = pl->sketch_list_todraw;
+
+	while (hN >= 0) {
+
+		fN = pl->sketch[hN].figure_N;
+
+		if (		pl->sketch[hN].drawing == pl->figure[fN].drawing
+				&& pl->sketch[hN].width == pl->figure[fN].width) {
+
+			pl->draw[fN].list_self = hN;
+		}
+
+		hN = pl->sketch[hN].linked;
+	}
+
+	return 1;
+}
+
+static int
+plotSketchPanSetUp(plot_t *pl, const int *FIGS, int lN)
+{
+	clipBox_t	sb;
+
+	double		dX, dY, sX, sY;
+	int		N, fN, hN, length, lenX, lenY;
+
+	if (		pl->incremental == 0
+			|| pl->sketch_list_current >= 0
+			|| lN < 1)
+		return 0;
+
+	dX = 0.;
+	dY = 0.;
+
+	for (N = 0; N < lN; ++N) {
+
+		fN = FIGS[N];
+
+		if (plotDrawFigureShift(pl, fN, &pl->draw[fN].stream, &sX, &sY) == 0)
+			return 0;
+
+		if (N != 0 && (sX != dX || sY != dY))
+			return 0;
+
+		dX = sX;
+		dY = sY;
+	}
+
+	if (dX == 0. && dY == 0.)
+		return 0;
+
+	hN = pl->sketch_list_todraw;
+	length = 0;
+
+	while (hN >= 0) {
+
+		fN = pl->sketch[hN].figure_N;
+
+		if (		pl->figure[fN].busy == 0
+				|| pl->draw[fN].stream.on == 0)
+			return 0;
+
+		hN = pl->sketch[hN].linked;
+		length++;
+	}
+
+	if (length > PLOT_SKETCH_MAX / 4)
+		return 0;
+
+	lenX = pl->viewport.max_x - pl->viewport.min_x + 1;
+	lenY = pl->viewport.max_y - pl->viewport.min_y + 1;
+
+	sX = floor(dX + .5);
+	sY = floor(dY + .5);
+
+	if (		fabs(dX - sX) >= 1E-6 || fabs(sX) >= lenX / 2
+			|| fabs(dY - sY) >= 1E-6 || fabs(sY) >= lenY / 2)
+		return 0;
+
+	for (N = 0; N < lN; ++N) {
+
+		if (plotTrialSetUp(pl, FIGS[N]) != 0)
+			return 0;
+	}
+
+	/* All figures are moved by the same integer offset. We keep the
+	 * sketch and move the trial pixmaps so only the exposed strips are
+	 * taken from the dataset.
+	 * */
+	for (N = 0; N < lN; ++N) {
+
+		fN = FIGS[N];
+
+		drawTrialShift(&pl->trial[fN].dw, &pl->viewport, (int) sX, (int) sY);
+	}
+
+	sb = pl->viewport;
+
+	if (sX > 0.) {
+
+		sb.max_x = sb.min_x + (int) sX - 1;
+	}
+	else {
+		sb.min_x = sb.max_x + (int) sX + 1;
+	}
+
+	plotSketchStrip(pl, FIGS, lN, &sb);
+
+	sb = pl->viewport;
+
+	if (sX > 0.) {
+
+		sb.min_x += (int) sX;
+	}
+	else {
+		sb.max_x += (int) sX;
+	}
+
+	if (sY > 0.) {
+
+		sb.max_y = sb.min_y + (int) sY - 1;
+	}
+	else {
+		sb.min_y = sb.max_y + (int) sY + 1;
+	}
+
+	plotSketchStrip(pl, FIGS, lN, &sb);
+
+	plotSketchStreamAppend(pl);
+
+	for (N = 0; N < lN; ++N) {
+
+		fN = FIGS[N];
+
+		plotDrawFigureKeep(pl, fN, &pl->draw[fN].stream);
+	}
+
+	pl->draw_shift = 1;
+	pl->draw_shift_X = (int) sX;
+	pl->draw_shift_Y = (int) sY;
+
+	return 1;
+}
+
+
+static void
+plotDrawFigureTask(ptrial_t *tr)
+{
+	plotDrawFigureTrial((plot_t *) tr->pl, tr);
+}
+
+static void
+plotDrawFigureRound(plot_t *pl, const int *FIGS, int lN, int parallel)
+{
+	ptrial_t	*tr;
+
+	int		LIST[PLOT_FIGURE_MAX], LAST[PLOT_DATASET_MAX], FETCH[PLOT_DATASET_MAX];
+	int		N, fN, fQ, dN, kN, run_N;
+
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+
+		LAST[dN] = -1;
+		FETCH[dN] = -1;
+	}
+
+	/* Take the chunk that is next to the figure which is the most behind
+	 * on each dataset.
+	 * */
+	for (N = 0; N < lN; ++N) {
+
+		fN = FIGS[N];
+		dN = pl->figure[fN].data_N;
+
+		if (		pl->draw[fN].sketch == SKETCH_FINISHED
+				|| pl->trial[fN].chunk_N < 0)
+			continue;
+
+		fQ = LAST[dN];
+
+		if (fQ < 0 || pl->draw[fN].id_N < pl->draw[fQ].id_N)
+			LAST[dN] = fN;
+	}
+
+	run_N = 0;
+
+	for (N = 0; N < lN; ++N) {
+
+		fN = FIGS[N];
+		dN = pl->figure[fN].data_N;
+
+		tr = &pl->trial[fN];
+
+		if (pl->draw[fN].sketch == SKETCH_FINISHED)
+			continue;
+
+		if (tr->chunk_N >= 0) {
+
+			kN = pl->trial[LAST[dN]].chunk_N;
+
+			if (tr->chunk_N != kN)
+				continue;
+
+			if (tr->fetch_N >= 0) {
+
+				/* Only one chunk is fetched on each dataset so
+				 * it is not evicted until the round is done.
+				 * */
+				if (FETCH[dN] < 0)
+					FETCH[dN] = tr->fetch_N;
+
+				if (tr->fetch_N != FETCH[dN])
+					continue;
+			}
+
+			/* Everything the trial needs from the chunk is fetched on
+			 * main thread so the figures drawn in parallel only read
+			 * the data.
+			 * */
+			if (		pl->lod != 0
+					&& pl->figure[fN].drawing != FIGURE_DRAWING_DOT
+					&& tr->column_XR >= 0 && tr->column_YR >= 0) {
+
+				plotDataLodFetch(pl, tr->column_XR, kN);
+				plotDataLodFetch(pl, tr->column_YR, kN);
+			}
+		}
+
+		LIST[run_N++] = fN;
+	}
+
+	for (N = 0, fQ = 0; N < run_N; ++N) {
+
+		fN = LIST[N];
+		dN = pl->figure[fN].data_N;
+
+		tr = &pl->trial[fN];
+
+		if (tr->fetch_N >= 0) {
+
+			plotDataChunkFetch(pl, dN, tr->fetch_N);
+
+			if (pl->data[dN].raw[tr->fetch_N] == NULL) {
+
+				/* The chunk could not be fetched so the figure
+				 * is truncated as plotDataGet does.
+				 * */
+				pl->draw[fN].sketch = SKETCH_FINISHED;
+				continue;
+			}
+
+			tr->fetch_N = -1;
+		}
+
+		LIST[fQ++] = fN;
+	}
+
+	run_N = fQ;
+
+	if (parallel != 0 && run_N > 1) {
+
+		for (N = 0; N < run_N; ++N) {
+
+			tr = &pl->trial[LIST[N]];
+
+			poolSubmit(pl->pool, &tr->task, (void (*) (void *))
+					&plotDrawFigureTask, tr);
+		}
+
+		for (N = 0; N < run_N; ++N) {
+
+			poolWait(pl->pool, &pl->trial[LIST[N]].task);
+		}
+	}
+	else {
+		for (N = 0; N < run_N; ++N) {
+
+			plotDrawFigureTrial(pl, &pl->trial[LIST[N]]);
+		}
+	}
+}
+
 static void
 plotDrawFigureTrialAll(plot_t *pl)
 {
+	ptrial_t	*tr;
+
 	int		FIGS[PLOT_FIGURE_MAX];
-	int		N, fN, fQ, lN, dN;
+	int		N, fN, lN, dN, xN, yN, stream, started, parallel;
 
 	Uint32		tTOP;
 
@@ -8521,49 +12996,127 @@ plotDrawFigureTrialAll(plot_t *pl)
 			FIGS[lN++] = fN;
 	}
 
+	pl->draw_shift = 0;
+
+	started = 0;
+
 	if (pl->draw_in_progress == 0) {
 
+		/* If the figures are only moved we take the exposed strips
+		 * first and then continue as if nothing is changed.
+		 * */
+		plotSketchPanSetUp(pl, FIGS, lN);
+
+		/* If nothing is changed except the new rows appended we resume
+		 * each figure from the row where the previous pass finished.
+		 * */
+		stream = plotSketchStreamSetUp(pl, FIGS, lN);
+
 		for (N = 0; N < lN; ++N) {
 
 			fN = FIGS[N];
 			dN = pl->figure[fN].data_N;
 
 			pl->draw[fN].sketch = SKETCH_STARTED;
-			pl->draw[fN].rN = pl->data[dN].head_N;
-			pl->draw[fN].id_N = pl->data[dN].id_N;
 
-			pl->draw[fN].skipped = 0;
-			pl->draw[fN].line = 0;
+			if (stream == 0) {
+
+				pl->draw[fN].rN = pl->data[dN].head_N;
+				pl->draw[fN].id_N = pl->data[dN].id_N;
+
+				pl->draw[fN].skipped = 0;
+				pl->draw[fN].line = 0;
+			}
+
+			plotDrawFigureKeep(pl, fN, &pl->draw[fN].stream);
 		}
 
 		pl->draw_in_progress = 1;
+		pl->draw_stream = stream;
+
+		started = (stream == 0) ? 1 : 0;
 	}
 
 	if (pl->draw_in_progress != 0) {
 
-		pl->tick_cached = SDL_GetTicks();
+		tTOP = SDL_GetTicks() + (Uint32) PLOT_RUNTIME_MAX;
 
-		tTOP = pl->tick_cached + (Uint32) PLOT_RUNTIME_MAX;
+		parallel = (	   pl->pool != NULL && pl->pool->thread_N >= 2
+				&& pl->sketch_lock != NULL) ? 1 : 0;
 
-		drawClearTrial(pl->dw);
+		for (N = 0; N < lN; ++N) {
 
-		do {
-			fN = -1;
+			fN = FIGS[N];
 
-			for (N = 0; N < lN; ++N) {
+			if (pl->draw[fN].sketch == SKETCH_FINISHED)
+				continue;
 
-				fQ = FIGS[N];
+			tr = &pl->trial[fN];
 
-				if (pl->draw[fQ].sketch != SKETCH_FINISHED) {
+			if (plotTrialSetUp(pl, fN) < 0)
+				parallel = 0;
 
-					if (fN < 0) {
+			if (		started != 0
+					|| plotDrawFigureSame(pl, fN, &pl->draw[fN].stream) == 0) {
 
-						fN = fQ;
-					}
-					else if (pl->draw[fQ].id_N < pl->draw[fN].id_N) {
+				/* The trial pixmap is kept until the pass is done
+				 * unless the view is changed. The pixmap of resumed
+				 * pass is kept so the segments drawn over the old
+				 * ones are rejected.
+				 * */
+				drawClearTrial(&tr->dw);
+			}
 
-						fN = fQ;
-					}
+			dN = pl->figure[fN].data_N;
+			xN = pl->figure[fN].column_X;
+			yN = pl->figure[fN].column_Y;
+
+			plotDataStatFetch(pl, dN, xN, NULL, NULL);
+			plotDataStatFetch(pl, dN, yN, NULL, NULL);
+
+			tr->column_XR = plotDataRangeCacheFetch(pl, dN, xN);
+			tr->column_YR = plotDataRangeCacheFetch(pl, dN, yN);
+
+			tr->chunk_N = -1;
+			tr->fetch_N = -1;
+			tr->tTOP = tTOP;
+
+			tr->tick_cached = SDL_GetTicks();
+			tr->tick_skip = 0;
+
+			/* Take the first sketch chunks in order of figures so
+			 * the layering does not depend on the threads.
+			 * */
+			plotSketchDataChunkSetUp(pl, fN);
+		}
+
+		if (parallel != 0) {
+
+			/* The sketch could not be reallocated while figures are
+			 * drawn so we grow it up to the limit in advance.
+			 * */
+			while (pl->sketch_N < PLOT_SKETCH_MAX) {
+
+				N = pl->sketch_N;
+
+				plotSketchGrow(pl);
+
+				if (pl->sketch_N == N)
+					break;
+			}
+
+			parallel = (pl->sketch_N >= PLOT_SKETCH_MAX) ? 1 : 0;
+		}
+
+		do {
+			fN = -1;
+
+			for (N = 0; N < lN; ++N) {
+
+				if (pl->draw[FIGS[N]].sketch != SKETCH_FINISHED) {
+
+					fN = FIGS[N];
+					break;
 				}
 			}
 
@@ -8572,10 +13125,27 @@ plotDrawFigureTrialAll(plot_t *pl)
 				if (SDL_GetTicks() > tTOP)
 					break;
 
-				plotDrawFigureTrial(pl, fN, tTOP);
+				plotDrawFigureRound(pl, FIGS, lN, parallel);
 			}
 			else {
-				plotSketchGarbage(pl);
+				if (pl->draw_stream != 0) {
+
+					plotSketchStreamAppend(pl);
+				}
+				else {
+					plotSketchGarbage(pl);
+				}
+
+				/* The view was changed during the pass so the trial
+				 * is not consistent and the next pass is full.
+				 * */
+				for (N = 0; N < lN; ++N) {
+
+					fN = FIGS[N];
+
+					if (plotDrawFigureSame(pl, fN, &pl->draw[fN].stream) == 0)
+						pl->draw[fN].stream.on = 0;
+				}
 
 				pl->draw_in_progress = 0;
 				break;
@@ -8601,6 +13171,8 @@ plotDrawAxisAll(plot_t *pl, SDL_Surface *surface)
 
 void plotDraw(plot_t *pl, SDL_Surface *surface)
 {
+	Uint64		tSTART;
+
 	if (		pl->slice_on != 0
 			&& pl->slice_mode_N != 0) {
 
@@ -8610,12 +13182,19 @@ void plotDraw(plot_t *pl, SDL_Surface *surface)
 	drawPixmapAlloc(pl->dw, surface);
 
 	plotDrawPalette(pl);
+
+	tSTART = SDL_GetPerformanceCounter();
+
 	plotDrawFigureTrialAll(pl);
 
-	drawClearCanvas(pl->dw);
+	pl->perf.trial += SDL_GetPerformanceCounter() - tSTART;
+
+	tSTART = SDL_GetPerformanceCounter();
 
 	plotDrawSketch(pl, surface);
 
+	pl->perf.raster += SDL_GetPerformanceCounter() - tSTART;
+
 	if (pl->mark_on != 0) {
 
 		plotMarkDraw(pl, surface);
@@ -19,11 +19,15 @@
 #ifndef _H_PLOT_
 #define _H_PLOT_
 
+#include <stdio.h>
+
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "async.h"
 #include "draw.h"
 #include "lse.h"
+#include "pool.h"
 #include "scheme.h"
 
 #ifdef ERROR
@@ -39,22 +43,32 @@
 
 #define PLOT_DATASET_MAX			10
 #define PLOT_CHUNK_SIZE				16777216
-#define PLOT_CHUNK_MAX				2000
-#define PLOT_CHUNK_CACHE			4
+#define PLOT_CHUNK_TABLE_MIN			16
+#define PLOT_CHUNK_CACHE			64
+#define PLOT_CHUNK_CACHE_DEFAULT		4
+#define PLOT_LZ4_JOB_MAX			4
 #define PLOT_RCACHE_SIZE			32
+#define PLOT_LOD_SHIFT				6
 #define PLOT_SLICE_SPAN				4
 #define PLOT_AXES_MAX				10
 #define PLOT_FIGURE_MAX 			10
 #define PLOT_DATA_BOX_MAX			10
-#define PLOT_MEDIAN_MAX 			37
+#define PLOT_MEDIAN_MAX 			65535
 #define PLOT_POLYFIT_MAX			7
 #define PLOT_SUBTRACT				20
+#define PLOT_SUBTRACT_BLOCK			1024
+#define PLOT_SUBTRACT_JOB_MAX			16
 #define PLOT_GROUP_MAX				40
 #define PLOT_MARK_MAX				80
 #define PLOT_SKETCH_CHUNK_SIZE			32768
-#define PLOT_SKETCH_MAX				800
+#define PLOT_SKETCH_MIN				100
+#define PLOT_SKETCH_MAX				3200
+#define PLOT_SKETCH_BREAK			(-32768)
 #define PLOT_STRING_MAX				200
 #define PLOT_RUNTIME_MAX			20
+#define PLOT_TILE_MAX				16
+#define PLOT_EXPORT_ROWS			16384
+#define PLOT_EXPORT_JOB_MAX			8
 
 enum {
 	TTF_ID_NONE			= 0,
@@ -116,6 +130,23 @@ enum {
 	SKETCH_FINISHED
 };
 
+enum {
+	STORAGE_FP64			= 0,
+	STORAGE_FP32
+};
+
+enum {
+	LZ4_JOB_FREE			= 0,
+	LZ4_JOB_COMPRESS,
+	LZ4_JOB_DECOMPRESS
+};
+
+enum {
+	EXPORT_CSV			= 0,
+	EXPORT_FP32,
+	EXPORT_FP64
+};
+
 enum {
 	DATA_BOX_FREE			= 0,
 	DATA_BOX_SLICE,
@@ -132,10 +163,297 @@ typedef struct {
 }
 tuple_t;
 
+/* The background LZ4 job. It owns the uncompressed chunk buffer while it
+ * is busy, then the buffer is kept as spare one for the next job.
+ * */
+typedef struct {
+
+	ptask_t		task;
+
+	int		busy;
+	int		chunk_N;
+	int		bSIZE;
+
+	int		column_N;
+	int		row_N;
+	int		row_STEP;
+	int		column_STEP;
+
+	int		storage;
+	int		filter;
+
+	fval_t		*raw;
+	void		*reserved;
+	void		*packed;
+
+	void		*lz4;
+	int		length;
+	int		rc;
+}
+lz4job_t;
+
+/* The heaps split the finite values of the median window into two halves.
+ * The top of the lower heap is the median itself. We keep the position of
+ * each window slot in heaps to remove the oldest value in O(log n).
+ * */
+typedef struct {
+
+	int		*lo;
+	int		*hi;
+	int		*pos;
+
+	int		lo_N;
+	int		hi_N;
+}
+pmheap_t;
+
+/* The sliding median window. It is allocated on demand at the size of the
+ * longest window used by the subtract and freed with the dataset.
+ * */
+typedef struct {
+
+	double		*fval;
+	double		*fpay;
+
+	pmheap_t	hval;
+	pmheap_t	hpay;
+
+	int		size;
+	int		keep;
+	int		tail;
+}
+pmedian_t;
+
+/* The figure setup and the view transform that the sketch was drawn with.
+ * Drawing can be continued with the new rows only if nothing of this is
+ * changed.
+ * */
+typedef struct {
+
+	int		on;
+
+	int		data_N;
+	int		id_N;
+	int		column_X;
+	int		column_Y;
+	int		drawing;
+	int		width;
+	int		hidden;
+	int		antialiasing;
+
+	double		view[4];
+}
+pview_t;
+
+/* The chunk of sketch keeps the points in screen space relative to the base
+ * point in fixed point format with 1/16 pixel resolution. Line and dash are
+ * stored as polylines that are split by PLOT_SKETCH_BREAK marker. The view
+ * transform the chunk was filled with is kept to draw it in another view.
+ * */
+typedef struct {
+
+	int		figure_N;
+
+	int		drawing;
+	int		width;
+
+	double		view[4];
+
+	int		base_X;
+	int		base_Y;
+	int		fixed;
+
+	Sint16		*chunk;
+	int		length;
+	int		drawn;
+
+	int		linked;
+}
+psketch_t;
+
+/* The horizontal tile of canvas that is drawn on worker thread. Each tile goes
+ * through the whole sketch in the same order so the layering of figures is
+ * the same as it was drawn by one thread.
+ * */
+typedef struct {
+
+	ptask_t		task;
+
+	void		*pl;
+	SDL_Surface	*surface;
+	draw_t		dw;
+
+	int		resume;
+}
+ptile_t;
+
+/* The trial of one figure that is run on worker thread. Each figure has its
+ * own trial pixmap so the only thing they share is the sketch chunk list that
+ * is taken under the lock.
+ * */
+typedef struct {
+
+	ptask_t		task;
+
+	void		*pl;
+	draw_t		dw;
+
+	void		*pixmap;
+	int		pixmap_len;
+
+	int		column_XR;
+	int		column_YR;
+	int		chunk_N;
+	int		fetch_N;
+
+	Uint32		tTOP;
+	Uint32		tick_cached;
+	int		tick_skip;
+}
+ptrial_t;
+
+/* The range of rows within one chunk that subtracts of the stage are computed
+ * on worker thread.
+ * */
+typedef struct {
+
+	ptask_t		task;
+
+	void		*pl;
+
+	int		data_N;
+	int		stage_N;
+	int		chunk_N;
+	int		row_N;
+	int		length;
+	int		id_N;
+}
+psubjob_t;
+
+/* Partial polyfit factorization over the rows of one chunk. It is merged again
+ * without refit while the chunk lies entirely inside of the fit window.
+ * */
+typedef struct {
+
+	ptask_t		task;
+
+	void		*pl;
+
+	int		computed;
+
+	int		data_N;
+	int		chunk_N;
+	int		row_N;
+	int		length;
+	int		id_N;
+
+	int		column_X;
+	int		column_Y;
+	int		poly_N0;
+	int		poly_N1;
+
+	double		scale_X;
+	double		offset_X;
+	double		scale_Y;
+	double		offset_Y;
+
+	/* The number of finite rows that are out of window and the range of
+	 * all finite rows.
+	 * */
+	int		clip_N;
+	int		finite;
+
+	double		fmin_X;
+	double		fmax_X;
+	double		fmin_Y;
+	double		fmax_Y;
+
+	lse_t		lsq;
+}
+ppolyfit_t;
+
+/* Block of exported rows that is formatted on worker thread while the next
+ * block is gathered.
+ * */
+typedef struct {
+
+	ptask_t		task;
+
+	void		*ex;
+
+	double		*fval;
+	int		row_N;
+
+	char		*text;
+	int		text_N;
+}
+pexjob_t;
+
+/* Export of figure columns to the file that goes block by block along with
+ * drawing. The output is flushed to the file by asynchronous writer.
+ * */
+typedef struct {
+
+	FILE		*fd;
+	async_FILE	*afd;
+
+	int		format;
+	int		fprecision;
+	int		space;
+
+	int		list_dN[PLOT_FIGURE_MAX * 2];
+	int		list_cN[PLOT_FIGURE_MAX * 2];
+	int		list_hint[PLOT_FIGURE_MAX * 2];
+	int		len_N;
+
+	struct {
+
+		int		busy;
+		int		rN;
+		int		id_N;
+		int		row_N;
+		int		length_N;
+	}
+	local[PLOT_DATASET_MAX];
+
+	int		total_N;
+	int		done_N;
+
+	pexjob_t	job[PLOT_EXPORT_JOB_MAX];
+}
+pexport_t;
+
+/* Data column is monotonic if all its values are finite and go in ascending
+ * order. The row of monotonic column is looked up by binary search.
+ * */
+typedef struct {
+
+	int		monotonic;
+	int		started;
+
+	double		last;
+}
+pmono_t;
+
+/* Column range of the chunk that is maintained incrementally. It covers the
+ * first row_N rows of the chunk that can be less than the rows written if
+ * the column is not scanned yet.
+ * */
+typedef struct {
+
+	int		finite;
+	int		row_N;
+
+	fval_t		fmin;
+	fval_t		fmax;
+}
+pstat_t;
+
 typedef struct {
 
 	draw_t			*dw;
 	scheme_t		*sch;
+	pool_t			*pool;
 
 	void			*ld;
 
@@ -148,8 +466,23 @@ typedef struct {
 		int		chunk_MASK;
 		int		chunk_bSIZE;
 
+		/* Row major chunk keeps each row contiguous. Columnar chunk
+		 * keeps each column contiguous so that figure drawing touches
+		 * only two columns of memory and LZ4 finds similar values next
+		 * to each other. The value of row jN and column cN is located at
+		 * raw[kN][jN * row_STEP + cN * column_STEP].
+		 * */
+		int		columnar;
+		int		row_STEP;
+		int		column_STEP;
+
 		int		lz4_compress;
-		void		*lz4_reserved;
+		int		lz4_filter;
+
+		/* Data columns of compressed chunks are narrowed to float if
+		 * dataset storage is FP32. Subtract columns are kept in double.
+		 * */
+		int		storage;
 
 		struct {
 
@@ -157,21 +490,80 @@ typedef struct {
 
 			int		chunk_N;
 			int		dirty;
+			int		stamp;
 		}
 		cache[PLOT_CHUNK_CACHE];
 
-		int		cache_ID;
+		int		cache_size;
+		int		cache_clock;
+		int		cache_last;
+		int		cache_last_ID;
+		int		cache_ahead;
+
+		unsigned long long	cache_hit;
+		unsigned long long	cache_miss;
+
+		lz4job_t	lz4_job[PLOT_LZ4_JOB_MAX];
+
+		/* The chunk tables are grown on demand up to chunk_MAX.
+		 * */
+		int		chunk_MAX;
 
 		struct {
 
 			void		*raw;
 			int		length;
+
+			/* The place of chunk in the spill file. The copy in
+			 * file is valid only if the chunk is spilled.
+			 * */
+			long long	offset;
+			int		capacity;
+			int		spilled;
+
+			unsigned long	stamp;
+
+			/* Chunks resident in RAM are linked in order of
+			 * access so the oldest one is at the head.
+			 * */
+			int		lru_prev;
+			int		lru_next;
 		}
-		compress[PLOT_CHUNK_MAX];
+		*compress;
 
-		fval_t		*raw[PLOT_CHUNK_MAX];
+		fval_t		**raw;
 		int		*map;
 
+		FILE		*spill_fd;
+		long long	spill_end;
+		int		spill_failed;
+
+		int		spill_head;
+		int		spill_tail;
+		int		spill_resident;
+
+		pmono_t		*mono;
+
+		struct {
+
+			/* The range of each column with the row index one
+			 * at first place.
+			 * */
+			pstat_t		*column;
+			int		fill;
+		}
+		*stat;
+
+		/* The chunk that is being overwritten by the tail keeps
+		 * the range of its older rows separately. It covers only
+		 * the rows from the head that are not gone yet.
+		 * */
+		pstat_t		*stat_head;
+		pstat_t		*stat_split;
+		int		stat_head_N;
+		int		stat_head_fill;
+		int		stat_head_from;
+
 		int		head_N;
 		int		tail_N;
 		int		id_N;
@@ -193,16 +585,6 @@ typedef struct {
 					int	unwrap;
 					int	opdata;
 
-					struct {
-
-						double	fval;
-						double	fpay;
-					}
-					window[PLOT_MEDIAN_MAX];
-
-					int	keep;
-					int	tail;
-
 					double	prev[2];
 					double	offset;
 				}
@@ -259,6 +641,13 @@ typedef struct {
 				filter;
 			}
 			op;
+
+			pmedian_t	window;
+
+			/* The stage of subtract pipeline or -1 if it is not
+			 * computed in this pass.
+			 * */
+			int		stage;
 		}
 		sub[PLOT_SUBTRACT];
 
@@ -276,18 +665,19 @@ typedef struct {
 
 		struct {
 
-			int		computed;
-			int		finite;
-
-			fval_t		fmin;
-			fval_t		fmax;
+			/* The min/max pyramid of chunk. Level L keeps pairs
+			 * of bucket range of (1 << (PLOT_LOD_SHIFT + L)) rows
+			 * so the drawing can replace the whole bucket by a few
+			 * segments if it fits in one pixel. Extended lazily up
+			 * to lod_N buckets of the lowest level.
+			 * */
+			fval_t		*lod;
+			int		lod_size;
+			int		lod_N;
 		}
-		chunk[PLOT_CHUNK_MAX];
+		*chunk;
 
-		int		cached;
-
-		fval_t		fmin;
-		fval_t		fmax;
+		int		chunk_MAX;
 	}
 	rcache[PLOT_RCACHE_SIZE];
 
@@ -373,11 +763,27 @@ typedef struct {
 
 	TTF_Font		*font;
 
+	/* Lock to open and close fonts when contexts run on several
+	 * threads as FreeType library is shared.
+	 * */
+	SDL_mutex		*font_lock;
+
 	lse_t			lsq;
 
+	/* The first slot is taken by the rest of head chunk when the ring
+	 * buffer is wrapped.
+	 * */
+	ppolyfit_t		**polyfit;
+	ppolyfit_t		**polyfit_list;
+	int			polyfit_MAX;
+
 	int			rcache_ID;
 	int			rcache_wipe_data_N;
 	int			rcache_wipe_chunk_N;
+	int			rcache_append_data_N;
+	int			rcache_append_chunk_N;
+
+	psubjob_t		subjob[PLOT_SUBTRACT_JOB_MAX];
 
 	int			legend_hidden;
 	int			legend_X;
@@ -424,27 +830,44 @@ typedef struct {
 		double		last_Y;
 
 		int		list_self;
+
+		pview_t		stream;
+		pview_t		layer;
 	}
 	draw[PLOT_FIGURE_MAX];
 
 	int			draw_in_progress;
-
-	Uint32			tick_cached;
-	int			tick_skip;
-
+	int			draw_stream;
+	int			draw_layer_dash;
+
+	/* The integer offset the sketch and trial were moved by in this
+	 * frame so the layer is shifted the same way.
+	 * */
+	int			draw_shift;
+	int			draw_shift_X;
+	int			draw_shift_Y;
+
+	/* The total time spent in data stages in performance counter ticks.
+	 * The trial includes the range cache that is built on demand.
+	 * */
 	struct {
 
-		int		figure_N;
+		Uint64		subtract;
+		Uint64		rcache;
+		Uint64		trial;
+		Uint64		raster;
+	}
+	perf;
 
-		int		drawing;
-		int		width;
+	psketch_t		*sketch;
+	int			sketch_N;
 
-		double		*chunk;
-		int		length;
+	ptile_t			tile[PLOT_TILE_MAX];
+	ptrial_t		trial[PLOT_FIGURE_MAX];
 
-		int		linked;
-	}
-	sketch[PLOT_SKETCH_MAX];
+	SDL_mutex		*sketch_lock;
+
+	pexport_t		*export_job;
 
 	int			sketch_list_garbage;
 	int			sketch_list_todraw;
@@ -487,6 +910,14 @@ typedef struct {
 	int			fprecision;
 	int			fhexadecimal;
 	int			lz4_compress;
+	int			lz4_filter;
+	int			cache_size;
+	int			spill_budget;
+	unsigned long		spill_clock;
+	unsigned long long	spill_usage;
+	int			columnar;
+	int			lod;
+	int			incremental;
 
 	int			shift_on;
 }
@@ -504,18 +935,28 @@ int plotFontOpen(plot_t *pl, const char *ttf, int ptsize, int style);
 unsigned long long plotDataMemoryUsage(plot_t *pl, int dN);
 unsigned long long plotDataMemoryUncompressed(plot_t *pl, int dN);
 unsigned long long plotDataMemoryCached(plot_t *pl, int dN);
+unsigned long long plotDataCacheHit(plot_t *pl, int dN);
+unsigned long long plotDataCacheMiss(plot_t *pl, int dN);
+
+void plotDataCacheResize(plot_t *pl, int dN, int size);
 
-void plotDataAlloc(plot_t *pl, int dN, int cN, int lN);
+void plotDataAlloc(plot_t *pl, int dN, int cN, int lN, int storage);
 void plotDataResize(plot_t *pl, int dN, int lN);
 int plotDataLength(plot_t *pl, int dN);
 int plotDataSpaceLeft(plot_t *pl, int dN);
-void plotDataGrowUp(plot_t *pl, int dN);
+int plotDataGrowUp(plot_t *pl, int dN);
 void plotDataSubtractCompute(plot_t *pl, int dN, int sN);
 void plotDataSubtractResidual(plot_t *pl, int dN);
 void plotDataSubtractClean(plot_t *pl);
 void plotDataSubtractPaused(plot_t *pl);
 void plotDataSubtractAlternate(plot_t *pl);
 void plotDataInsert(plot_t *pl, int dN, const fval_t *row);
+
+/* Insert N rows that are packed with column_N stride. The chunk preparation
+ * and range cache wipe are done once per chunk instead of once per row.
+ * */
+void plotDataInsertBlock(plot_t *pl, int dN, const fval_t *rows, int n);
+
 void plotDataClean(plot_t *pl, int dN);
 
 void plotDataRangeCacheClean(plot_t *pl, int dN);
@@ -572,6 +1013,14 @@ void plotTotalSubtractResample(plot_t *pl, int dN, double tmin, double tmax);
 int plotDataBoxPolyfit(plot_t *pl, int fN);
 void plotFigureSubtractPolyfit(plot_t *pl, int fN_1, int N0, int N1);
 int plotFigureExportCSV(plot_t *pl, const char *file);
+
+/* Export the figure columns step by step. The step returns the progress in
+ * percent and 100 when the file is finished.
+ * */
+int plotFigureExportOpen(plot_t *pl, const char *file, int format);
+int plotFigureExportStep(plot_t *pl);
+int plotFigureExportClose(plot_t *pl);
+
 void plotFigureClean(plot_t *pl);
 void plotSketchClean(plot_t *pl);
 int plotGetSketchLength(plot_t *pl);
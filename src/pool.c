@@ -0,0 +1,222 @@
+/*
+   Graph Plotter is a tool to analyse numerical data.
+   Copyright (C) 2024 Roman Belov <romblv@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
+
+#include "pool.h"
+#include "plot.h"
+
+static void
+poolTaskRun(pool_t *po, ptask_t *tk)
+{
+	tk->job(tk->arg);
+
+	SDL_LockMutex(po->lock);
+
+	SDL_AtomicSet(&tk->state, POOL_TASK_DONE);
+	SDL_CondBroadcast(po->done);
+
+	SDL_UnlockMutex(po->lock);
+}
+
+static int
+poolWORKER(pool_t *po)
+{
+	ptask_t		*tk;
+
+	do {
+		SDL_LockMutex(po->lock);
+
+		while (po->head == NULL && po->flag_break == 0) {
+
+			SDL_CondWait(po->wake, po->lock);
+		}
+
+		if (po->flag_break != 0) {
+
+			SDL_UnlockMutex(po->lock);
+			break;
+		}
+
+		tk = po->head;
+
+		po->head = tk->next;
+		po->tail = (po->head != NULL) ? po->tail : NULL;
+
+		SDL_AtomicSet(&tk->state, POOL_TASK_RUNNING);
+
+		SDL_UnlockMutex(po->lock);
+
+		poolTaskRun(po, tk);
+	}
+	while (1);
+
+	return 0;
+}
+
+pool_t *poolAlloc(int thread_N)
+{
+	pool_t		*po;
+	int		N;
+
+	po = (pool_t *) calloc(1, sizeof(pool_t));
+
+	if (po == NULL) {
+
+		ERROR("No memory allocated for thread pool\n");
+		return NULL;
+	}
+
+	po->lock = SDL_CreateMutex();
+	po->wake = SDL_CreateCond();
+	po->done = SDL_CreateCond();
+
+	thread_N = (thread_N > POOL_THREAD_MAX) ? POOL_THREAD_MAX : thread_N;
+
+	for (N = 0; N < thread_N; ++N) {
+
+		po->thread[N] = SDL_CreateThread((int (*) (void *)) &poolWORKER, "poolWORKER", po);
+
+		if (po->thread[N] == NULL) {
+
+			ERROR("SDL_CreateThread: %s\n", SDL_GetError());
+			break;
+		}
+
+		po->thread_N++;
+	}
+
+	return po;
+}
+
+void poolClean(pool_t *po)
+{
+	int		N;
+
+	SDL_LockMutex(po->lock);
+
+	po->flag_break = 1;
+
+	SDL_CondBroadcast(po->wake);
+	SDL_UnlockMutex(po->lock);
+
+	for (N = 0; N < po->thread_N; ++N) {
+
+		SDL_WaitThread(po->thread[N], NULL);
+	}
+
+	SDL_DestroyCond(po->done);
+	SDL_DestroyCond(po->wake);
+	SDL_DestroyMutex(po->lock);
+
+	free(po);
+}
+
+void poolSubmit(pool_t *po, ptask_t *tk, void (* job) (void *), void *arg)
+{
+	tk->job = job;
+	tk->arg = arg;
+	tk->next = NULL;
+
+	if (po == NULL || po->thread_N < 1) {
+
+		SDL_AtomicSet(&tk->state, POOL_TASK_RUNNING);
+
+		job(arg);
+
+		SDL_AtomicSet(&tk->state, POOL_TASK_DONE);
+		return ;
+	}
+
+	SDL_LockMutex(po->lock);
+
+	SDL_AtomicSet(&tk->state, POOL_TASK_QUEUED);
+
+	if (po->tail != NULL) {
+
+		po->tail->next = tk;
+	}
+	else {
+		po->head = tk;
+	}
+
+	po->tail = tk;
+
+	SDL_CondSignal(po->wake);
+	SDL_UnlockMutex(po->lock);
+}
+
+int poolIsDone(ptask_t *tk)
+{
+	int		state;
+
+	state = SDL_AtomicGet(&tk->state);
+
+	return (state == POOL_TASK_DONE || state == POOL_TASK_FREE) ? 1 : 0;
+}
+
+void poolWait(pool_t *po, ptask_t *tk)
+{
+	ptask_t		*prev;
+
+	if (poolIsDone(tk) != 0)
+		return ;
+
+	SDL_LockMutex(po->lock);
+
+	if (SDL_AtomicGet(&tk->state) == POOL_TASK_QUEUED) {
+
+		/* The task was not taken by any worker yet so we run it
+		 * in place instead of waiting for the queue.
+		 * */
+		if (po->head == tk) {
+
+			po->head = tk->next;
+			prev = NULL;
+		}
+		else {
+			prev = po->head;
+
+			while (prev->next != tk)
+				prev = prev->next;
+
+			prev->next = tk->next;
+		}
+
+		po->tail = (po->tail == tk) ? prev : po->tail;
+
+		SDL_AtomicSet(&tk->state, POOL_TASK_RUNNING);
+
+		SDL_UnlockMutex(po->lock);
+
+		poolTaskRun(po, tk);
+	}
+	else {
+		while (SDL_AtomicGet(&tk->state) != POOL_TASK_DONE) {
+
+			SDL_CondWait(po->done, po->lock);
+		}
+
+		SDL_UnlockMutex(po->lock);
+	}
+}
+
@@ -0,0 +1,73 @@
+/*
+   Graph Plotter is a tool to analyse numerical data.
+   Copyright (C) 2024 Roman Belov <romblv@gmail.com>
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _H_POOL_
+#define _H_POOL_
+
+#include <SDL2/SDL.h>
+
+#define POOL_THREAD_MAX		32
+
+enum {
+	POOL_TASK_FREE		= 0,
+	POOL_TASK_QUEUED,
+	POOL_TASK_RUNNING,
+	POOL_TASK_DONE
+};
+
+typedef struct pool_task {
+
+	void 			(* job) (void *);
+	void			*arg;
+
+	SDL_atomic_t		state;
+
+	struct pool_task	*next;
+}
+ptask_t;
+
+typedef struct {
+
+	SDL_Thread	*thread[POOL_THREAD_MAX];
+	int		thread_N;
+
+	SDL_mutex	*lock;
+	SDL_cond	*wake;
+	SDL_cond	*done;
+
+	ptask_t		*head;
+	ptask_t		*tail;
+
+	int		flag_break;
+}
+pool_t;
+
+pool_t *poolAlloc(int thread_N);
+void poolClean(pool_t *po);
+
+/* Put the task to the queue. The task structure is owned by the caller and
+ * must stay intact until the task is DONE. Without worker threads the job is
+ * executed in place.
+ * */
+void poolSubmit(pool_t *po, ptask_t *tk, void (* job) (void *), void *arg);
+
+int poolIsDone(ptask_t *tk);
+void poolWait(pool_t *po, ptask_t *tk);
+
+#endif /* _H_POOL_ */
+
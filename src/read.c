@@ -32,6 +32,7 @@
 #include "draw.h"
 #include "edit.h"
 #include "lang.h"
+#include "lz4.h"
 #include "plot.h"
 #include "read.h"
 
@@ -194,12 +195,14 @@ read_t *readAlloc(draw_t *dw, plot_t *pl)
 
 	rd->screenpath[0] = 0;
 	rd->ttfname[0] = 0;
+	rd->statsfile[0] = 0;
 
 	rd->window_size_x = GP_MIN_SIZE_X;
 	rd->window_size_y = GP_MIN_SIZE_Y;
 	rd->timecol = -1;
 	rd->shortfilename = 1;
 	rd->fastdraw = 200;
+	rd->renderer = 0;
 
 	rd->mk_config.delim = '.';
 	strcpy(rd->mk_config.space, " \t");
@@ -215,7 +218,10 @@ read_t *readAlloc(draw_t *dw, plot_t *pl)
 
 	rd->preload = 8388608;
 	rd->chunk = 4096;
+	rd->mmap = 1;
+	rd->sidecar = 0;
 	rd->timeout = 5000;
+	rd->backpressure = 0;
 	rd->length_N = 0;
 
 	rd->bind_N = -1;
@@ -225,8 +231,39 @@ read_t *readAlloc(draw_t *dw, plot_t *pl)
 	return rd;
 }
 
+static void
+readBlockFree(read_t *rd, int dN)
+{
+	rblock_t	*bk = rd->data[dN].block;
+
+	if (bk != NULL) {
+
+		if (bk->busy != 0) {
+
+			/* Wait for the background task before the block and
+			 * the stream are released.
+			 * */
+			poolWait(rd->pl->pool, &bk->task);
+		}
+
+		free(bk->text);
+		free(bk->rows);
+		free(bk->pack);
+		free(bk);
+
+		rd->data[dN].block = NULL;
+	}
+}
+
 void readClean(read_t *rd)
 {
+	int		dN;
+
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+
+		readBlockFree(rd, dN);
+	}
+
 	free(rd);
 }
 
@@ -769,12 +806,26 @@ readCSVGetBuf(char *s, int len, FILE *fd, int timeout)
 	}
 }
 
+static void
+readCSVMakeMap(char *cmap, const markup_t *mk)
+{
+	const char	*s;
+
+	memset(cmap, 0, 256);
+
+	for (s = mk->space; *s != 0; ++s)
+		cmap[(unsigned char) *s] = 1;
+
+	for (s = mk->lend; *s != 0; ++s)
+		cmap[(unsigned char) *s] = 1;
+}
+
 static int
-readCSVGetRow(read_t *rd, int dN, int label_N)
+readCSVParseRow(const markup_t *mk, const char *cmap, int *hint,
+		fval_t *row, char *s, int label_N, int *changed)
 {
-	fval_t 		*row = rd->data[dN].row;
-	int		*hint = rd->data[dN].hint;
-	char 		*r, *s = rd->data[dN].buf;
+	fval_t		*base = row;
+	char 		*r;
 
 	int		hex, m, N;
 	double		val;
@@ -784,8 +835,7 @@ readCSVGetRow(read_t *rd, int dN, int label_N)
 
 	while (*s != 0) {
 
-		if (		strchr(rd->mk_text.space, *s) != NULL
-				|| strchr(rd->mk_text.lend, *s) != NULL) {
+		if (cmap[(unsigned char) *s] != 0) {
 
 			m = 0;
 		}
@@ -796,7 +846,7 @@ readCSVGetRow(read_t *rd, int dN, int label_N)
 
 				if (hint[N] == DATA_HINT_FLOAT) {
 
-					r = stod(&rd->mk_text, &val, s);
+					r = stod(mk, &val, s);
 
 					if (r != NULL) {
 
@@ -808,7 +858,7 @@ readCSVGetRow(read_t *rd, int dN, int label_N)
 				}
 				else if (hint[N] == DATA_HINT_HEX) {
 
-					r = htoi(&rd->mk_text, &hex, s);
+					r = htoi(mk, &hex, s);
 
 					if (r != NULL) {
 
@@ -820,7 +870,7 @@ readCSVGetRow(read_t *rd, int dN, int label_N)
 				}
 				else if (hint[N] == DATA_HINT_OCT) {
 
-					r = otoi(&rd->mk_text, &hex, s);
+					r = otoi(mk, &hex, s);
 
 					if (r != NULL) {
 
@@ -831,20 +881,21 @@ readCSVGetRow(read_t *rd, int dN, int label_N)
 					}
 				}
 				else {
-					r = stod(&rd->mk_text, &val, s);
+					r = stod(mk, &val, s);
 
 					if (r != NULL) {
 
 						*row++ = (fval_t) val;
 					}
 					else {
-						r = htoi(&rd->mk_text, &hex, s);
+						r = htoi(mk, &hex, s);
 
 						if (r != NULL) {
 
 							if (hint[N] == DATA_HINT_NONE) {
 
 								hint[N] = DATA_HINT_HEX;
+								*changed = 1;
 							}
 
 							*row++ = (fval_t) hex;
@@ -869,7 +920,7 @@ readCSVGetRow(read_t *rd, int dN, int label_N)
 
 		fval_t		*end = row;
 
-		row = rd->data[dN].row;
+		row = base;
 
 		m = 0;
 
@@ -908,6 +959,18 @@ readCSVGetRow(read_t *rd, int dN, int label_N)
 	return N;
 }
 
+static int
+readCSVGetRow(read_t *rd, int dN, int label_N)
+{
+	char		cmap[256];
+	int		changed = 0;
+
+	readCSVMakeMap(cmap, &rd->mk_text);
+
+	return readCSVParseRow(&rd->mk_text, cmap, rd->data[dN].hint,
+			rd->data[dN].row, rd->data[dN].buf, label_N, &changed);
+}
+
 static int
 readCSVGetLabel(read_t *rd, int dN)
 {
@@ -1001,8 +1064,32 @@ readCSVGetBOM(FILE *fd)
 	return bom;
 }
 
+static char *
+readCSVGetAsync(char *s, int len, async_FILE *afd, int timeout)
+{
+	int		rc, waiting = 0;
+
+	do {
+		rc = async_gets(afd, s, len);
+
+		if (rc == ASYNC_OK)
+			return s;
+
+		if (		rc == ASYNC_END_OF_FILE
+				|| waiting >= timeout)
+			break;
+
+		SDL_Delay(10);
+
+		waiting += 10;
+	}
+	while (1);
+
+	return NULL;
+}
+
 static int
-readCSVGetCN(read_t *rd, int dN, FILE *fd, fval_t *rbuf, int *rbuf_N)
+readCSVGetCN(read_t *rd, int dN, FILE *fd, async_FILE *afd, fval_t *rbuf, int *rbuf_N)
 {
 	int		label_N, fixed_N, total_N;
 	int		N, cN, timeout;
@@ -1017,7 +1104,13 @@ readCSVGetCN(read_t *rd, int dN, FILE *fd, fval_t *rbuf, int *rbuf_N)
 	timeout = 200;
 
 	do {
-		r = readCSVGetBuf(rd->data[dN].buf, sizeof(rd->data[0].buf), fd, timeout);
+		if (fd != NULL) {
+
+			r = readCSVGetBuf(rd->data[dN].buf, sizeof(rd->data[0].buf), fd, timeout);
+		}
+		else {
+			r = readCSVGetAsync(rd->data[dN].buf, sizeof(rd->data[0].buf), afd, rd->timeout);
+		}
 
 		total_N++;
 
@@ -1068,284 +1161,1084 @@ readCSVGetCN(read_t *rd, int dN, FILE *fd, fval_t *rbuf, int *rbuf_N)
 	return cN;
 }
 
-static void
-readCloseFile(read_t *rd, int dN)
+static rblock_t *
+readBlockAlloc(read_t *rd, int dN)
 {
-	async_close(rd->data[dN].afd);
+	rblock_t	*bk = rd->data[dN].block;
+	int		cN, rows_MAX;
 
-	if (rd->data[dN].fd != stdin) {
+	if (bk == NULL) {
 
-		fclose(rd->data[dN].fd);
-	}
+		bk = (rblock_t *) calloc(1, sizeof(rblock_t));
 
-	rd->data[dN].fd = NULL;
-	rd->data[dN].afd = NULL;
-}
+		if (bk == NULL) {
 
-void readOpenUnified(read_t *rd, int dN, int cN, int lN, const char *file, int fmt)
-{
-	fval_t		rbuf[READ_COLUMN_MAX * READ_TEXT_HEAD_MAX];
+			ERROR("No memory allocated for text block\n");
+			return NULL;
+		}
 
-	int		N, rbuf_N, bom;
+		bk->text = (char *) malloc(READ_BLOCK_SIZE + sizeof(rd->data[0].buf));
 
-	FILE			*fd;
-	unsigned long long	bF = 0U;
+		if (bk->text == NULL) {
 
-	if (rd->data[dN].fd != NULL) {
+			ERROR("No memory allocated for text block\n");
 
-		readCloseFile(rd, dN);
+			free(bk);
+			return NULL;
+		}
+
+		rd->data[dN].block = bk;
 	}
 
-	if (fmt == FORMAT_TEXT_STDIN) {
+	cN = rd->pl->data[dN].column_N;
 
-		fd = stdin;
-	}
-	else {
-		fd = unified_fopen(file, "rb");
-	}
+	rows_MAX = READ_BLOCK_ROWS_SIZE / (cN * (int) sizeof(fval_t));
+	rows_MAX = (rows_MAX > READ_BLOCK_LINE_MAX) ? READ_BLOCK_LINE_MAX
+		: (rows_MAX < 1) ? 1 : rows_MAX;
 
-	if (fd == NULL) {
+	if (bk->column_N != cN) {
 
-		ERROR("fopen(\"%s\"): %s\n", file, strerror(errno));
-	}
-	else {
-		if (fmt != FORMAT_TEXT_STDIN) {
+		free(bk->rows);
 
-			file_stat(file, &bF);
-		}
+		bk->rows = (fval_t *) malloc(rows_MAX * cN * sizeof(fval_t));
 
-		rd->data[dN].length_N = (rd->length_N < 1) ? lN : rd->length_N;
+		if (bk->rows == NULL) {
 
-		if (		fmt == FORMAT_TEXT_STDIN
-				|| fmt == FORMAT_TEXT_CSV) {
+			ERROR("No memory allocated for text block\n");
 
-			if (fmt != FORMAT_TEXT_STDIN) {
+			bk->column_N = 0;
+			return NULL;
+		}
 
-				bom = readCSVGetBOM(fd);
+		bk->column_N = cN;
+		bk->rows_MAX = rows_MAX;
+	}
 
-				if (bom == BOM_UTF_UNKNOWN) {
+	return bk;
+}
 
-					ERROR("Unsupported BOM in file \"%s\"\n", file);
+static int
+readBlockLimit(read_t *rd, int dN, int n)
+{
+	int		lN;
 
-					fclose(fd);
-					return ;
-				}
+	if (rd->data[dN].length_N < 1) {
 
-				rd->data[dN].bom = bom;
-			}
+		/* Keep the free space to grow up the dataset after block is
+		 * inserted.
+		 * */
+		lN = plotDataSpaceLeft(rd->pl, dN) - 2;
 
-			cN = readCSVGetCN(rd, dN, fd, rbuf, &rbuf_N);
+		n = (n > lN) ? lN : n;
+		n = (n < 1) ? 1 : n;
+	}
 
-			if (cN < 1) {
+	return n;
+}
 
-				ERROR("No correct data in file \"%s\"\n", file);
-				fclose(fd);
-				return ;
-			}
+static void
+readBlockInsert(read_t *rd, int dN, const fval_t *rows, int n)
+{
+	plotDataInsertBlock(rd->pl, dN, rows, n);
 
-			if (lN < 1) {
+	rd->data[dN].line_N += n;
 
-				/* We do not use the actual file size to guess
-				 * the length since there is an incremental
-				 * dataset memory allocation.
-				 * */
-				lN = (rd->length_N < 1) ? 1000 : rd->length_N;
-			}
-		}
-		else if (fmt == FORMAT_BINARY_FP_32) {
+	if (		rd->data[dN].length_N < 1
+			&& plotDataSpaceLeft(rd->pl, dN) < 3) {
 
-			lN = (lN < 1) ? (int) (bF / (cN * sizeof(float))) : lN;
-			rd->data[dN].line_N = 1;
-		}
-		else if (fmt == FORMAT_BINARY_FP_64) {
+		plotDataGrowUp(rd->pl, dN);
+	}
+}
 
-			lN = (lN < 1) ? (int) (bF / (cN * sizeof(double))) : lN;
-			rd->data[dN].line_N = 1;
-		}
+static void
+readFileSeek(FILE *fd, unsigned long long offset)
+{
+#ifdef _WINDOWS
+	_fseeki64(fd, (__int64) offset, SEEK_SET);
+#else /* _WINDOWS */
+	fseeko(fd, (off_t) offset, SEEK_SET);
+#endif /* _WINDOWS */
+}
 
-#ifdef _LEGACY
-		else if (fmt == FORMAT_BINARY_LEGACY_V1) {
+static unsigned long long
+readFileTell(FILE *fd)
+{
+#ifdef _WINDOWS
+	return (unsigned long long) _ftelli64(fd);
+#else /* _WINDOWS */
+	return (unsigned long long) ftello(fd);
+#endif /* _WINDOWS */
+}
 
-			lN = (lN < 1) ? (int) ((bF - 6) / (cN * 6)) : lN;
-			rd->data[dN].line_N = 1;
+static unsigned long long
+readSideHash(unsigned long long hash, const void *raw, int n)
+{
+	const unsigned char	*b = (const unsigned char *) raw;
+	int			N;
 
-			fseek(fd, 6UL, SEEK_SET);
-		}
-		else if (fmt == FORMAT_BINARY_LEGACY_V2) {
+	for (N = 0; N < n; ++N) {
 
-			lN = (lN < 1) ? (int) ((bF - 4) / (cN * 4)) : lN;
-			rd->data[dN].line_N = 1;
+		hash ^= (unsigned long long) b[N];
+		hash *= 1099511628211ULL;
+	}
 
-			fseek(fd, 4UL, SEEK_SET);
-		}
-#endif /* _LEGACY */
+	return hash;
+}
 
-		plotDataAlloc(rd->pl, dN, cN, lN + 1);
+static unsigned long long
+readSideMarkup(const markup_t *mk)
+{
+	unsigned long long	hash = 14695981039346656037ULL;
 
-		if (		fmt == FORMAT_TEXT_STDIN
-				|| fmt == FORMAT_TEXT_CSV) {
+	hash = readSideHash(hash, &mk->delim, 1);
+	hash = readSideHash(hash, mk->space, strlen(mk->space));
+	hash = readSideHash(hash, mk->lend, strlen(mk->lend));
 
-			for (N = 0; N < rbuf_N; ++N) {
+	return hash;
+}
 
-				plotDataInsert(rd->pl, dN, rbuf + READ_COLUMN_MAX * N);
-			}
-		}
+static int
+readSideTail(FILE *fd, unsigned long long offset, unsigned long long *hash)
+{
+	char		tbuf[READ_SIDE_TAIL];
+	int		n;
 
-		rd->data[dN].format = fmt;
-		rd->data[dN].column_N = cN;
+	n = (offset < READ_SIDE_TAIL) ? (int) offset : READ_SIDE_TAIL;
 
-		strcpy(rd->data[dN].file, file);
+	readFileSeek(fd, offset - n);
 
-		rd->data[dN].fd = fd;
-		rd->data[dN].afd = async_open(fd, rd->preload, rd->chunk, rd->timeout);
+	if (fread(tbuf, 1, n, fd) != (size_t) n)
+		return -1;
 
-		rd->keep_N += 1;
-		rd->bind_N = dN;
-	}
+	*hash = readSideHash(14695981039346656037ULL, tbuf, n);
+
+	/* Tell if the tail ends on the line boundary.
+	 * */
+	return (n > 0 && (tbuf[n - 1] == '\n' || tbuf[n - 1] == '\r')) ? 1 : 0;
 }
 
-void readOpenStub(read_t *rd, int dN, int cN, int lN, const char *file, int fmt)
+static void
+readSideClose(read_t *rd, int dN)
 {
-	rd->data[dN].length_N = lN;
+	char		side[READ_FILE_PATH_MAX + 8];
 
-	lN = (lN < 1) ? 3 : lN;
+	if (rd->data[dN].side != NULL) {
 
-	plotDataAlloc(rd->pl, dN, cN, lN + 1);
+		fclose(rd->data[dN].side);
 
-	rd->data[dN].format = fmt;
-	rd->data[dN].column_N = cN;
+		if (rd->data[dN].side_state == SIDE_CREATE) {
 
-	strcpy(rd->data[dN].file, file);
+			/* Unfinished sidecar is useless. But we keep the old
+			 * one as its header still covers the valid blocks.
+			 * */
+			sprintf(side, "%s.gpc", rd->data[dN].file);
+			file_remove(side);
+		}
+	}
 
-	if (fmt == FORMAT_STUB_DATA) {
+	rd->data[dN].side = NULL;
+	rd->data[dN].side_state = SIDE_NONE;
+}
 
-		rd->data[dN].fd = NULL;
-		rd->data[dN].afd = async_stub(rd->preload, rd->chunk, rd->timeout);
-	}
+static int
+readSideWriteHead(read_t *rd, int dN, const rside_t *head)
+{
+	FILE		*sd = rd->data[dN].side;
+	int		cN = head->column_N;
 
-	rd->keep_N += 1;
-	rd->bind_N = dN;
+	readFileSeek(sd, 0U);
+
+	if (		fwrite(head, sizeof(rside_t), 1, sd) != 1
+			|| fwrite(rd->data[dN].hint, sizeof(int), cN, sd) != (size_t) cN
+			|| fwrite(rd->data[dN].label, READ_TOKEN_MAX, cN, sd) != (size_t) cN)
+		return -1;
+
+	return 0;
 }
 
-void readToggleHint(read_t *rd, int dN, int cN)
+static void
+readSideFinal(read_t *rd, int dN)
 {
-	if (rd->data[dN].format == FORMAT_NONE) {
+	rside_t		head;
 
-		ERROR("Dataset number %i was not allocated\n", dN);
+	if (rd->data[dN].side == NULL)
 		return ;
-	}
 
-	if (cN < 0 || cN >= rd->data[dN].column_N) {
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, "GPSIDE", 6);
 
-		return ;
-	}
+	head.version = READ_SIDE_VERSION;
+	head.fval_size = (int) sizeof(fval_t);
 
-	if (rd->data[dN].hint[cN] == DATA_HINT_NONE) {
+	head.source_size = readFileTell(rd->data[dN].fd);
+	head.markup = readSideMarkup(&rd->mk_text);
+	head.data_end = readFileTell(rd->data[dN].side);
 
-		rd->data[dN].hint[cN] = DATA_HINT_FLOAT;
-	}
-	else if (rd->data[dN].hint[cN] == DATA_HINT_FLOAT) {
+	head.column_N = rd->data[dN].column_N;
+	head.line_N = rd->data[dN].line_N;
+	head.row_N = rd->data[dN].side_row_N;
+	head.bom = rd->data[dN].bom;
+	head.complete = 1;
 
-		rd->data[dN].hint[cN] = DATA_HINT_HEX;
-	}
-	else if (rd->data[dN].hint[cN] == DATA_HINT_HEX) {
+	if (		file_stat_mtime(rd->data[dN].file, &head.source_time) == ENT_OK
+			&& readSideTail(rd->data[dN].fd, head.source_size, &head.source_tail) >= 0
+			&& readSideWriteHead(rd, dN, &head) == 0
+			&& fclose(rd->data[dN].side) == 0) {
 
-		rd->data[dN].hint[cN] = DATA_HINT_OCT;
+		rd->data[dN].side = NULL;
+		rd->data[dN].side_state = SIDE_NONE;
 	}
-	else if (rd->data[dN].hint[cN] == DATA_HINT_OCT) {
+	else {
+		rd->data[dN].side_state = SIDE_CREATE;
 
-		rd->data[dN].hint[cN] = DATA_HINT_NONE;
+		readSideClose(rd, dN);
 	}
 }
 
 static int
-readSTUB(read_t *rd, int dN)
+readSideBusy(read_t *rd, int dN, const char *file)
 {
-	double		*fbuf = (double *) rd->data[dN].buf;
-	int		rc, N, cN = rd->pl->data[dN].column_N;
-
-	rc = async_read(rd->data[dN].afd, (void *) fbuf, cN * sizeof(double));
-
-	if (rc == ASYNC_OK) {
+	int		N;
 
-		for (N = 0; N < cN; ++N)
-			rd->data[dN].row[N] = (fval_t) fbuf[N];
+	for (N = 0; N < PLOT_DATASET_MAX; ++N) {
 
-		plotDataInsert(rd->pl, dN, rd->data[dN].row);
+		if (		N != dN && rd->data[N].side != NULL
+				&& strcmp(rd->data[N].file, file) == 0) {
 
-		return 1;
+			/* The same file is loaded into another dataset and
+			 * its sidecar is used already.
+			 * */
+			return 1;
+		}
 	}
 
 	return 0;
 }
 
 static int
-readCSV(read_t *rd, int dN)
+readSideOpen(read_t *rd, int dN, const char *file, FILE *fd, rside_t *head)
 {
-	int		rc, cN;
+	char			side[READ_FILE_PATH_MAX + 8];
+	FILE			*sd;
 
-	rc = async_gets(rd->data[dN].afd, rd->data[dN].buf, sizeof(rd->data[0].buf));
+	unsigned long long	nsize, mtime, hash;
+	int			cN, eol;
 
-	if (rc == ASYNC_OK) {
+	if (readSideBusy(rd, dN, file) != 0)
+		return -1;
 
-		cN = readCSVGetRow(rd, dN, rd->pl->data[dN].column_N);
+	sprintf(side, "%s.gpc", file);
 
-		if (cN == rd->pl->data[dN].column_N) {
+	sd = unified_fopen(side, "r+b");
 
-			plotDataInsert(rd->pl, dN, rd->data[dN].row);
-		}
+	if (sd == NULL)
+		return -1;
 
-		return 1;
-	}
-	else if (rc == ASYNC_END_OF_FILE) {
+	do {
+		if (fread(head, sizeof(rside_t), 1, sd) != 1)
+			break;
 
-		readCloseFile(rd, dN);
-	}
+		if (		memcmp(head->magic, "GPSIDE", 6) != 0
+				|| head->version != READ_SIDE_VERSION
+				|| head->fval_size != (int) sizeof(fval_t)
+				|| head->complete != 1
+				|| head->column_N < 1
+				|| head->column_N > READ_COLUMN_MAX
+				|| head->markup != readSideMarkup(&rd->mk_text))
+			break;
 
-	return 0;
-}
+		if (		file_stat(file, &nsize) != ENT_OK
+				|| file_stat_mtime(file, &mtime) != ENT_OK)
+			break;
 
-static int
-readFP32(read_t *rd, int dN)
-{
-	float		*fbuf = (float *) rd->data[dN].buf;
-	int		rc, N, cN = rd->pl->data[dN].column_N;
+		/* The source file must be the same or only appended since
+		 * the sidecar was written.
+		 * */
+		if (		nsize < head->source_size
+				|| (nsize == head->source_size && mtime != head->source_time))
+			break;
 
-	rc = async_read(rd->data[dN].afd, (void *) fbuf, cN * sizeof(float));
+		eol = readSideTail(fd, head->source_size, &hash);
 
-	if (rc == ASYNC_OK) {
+		if (		eol < 0 || hash != head->source_tail
+				|| (nsize != head->source_size && eol == 0))
+			break;
 
-		for (N = 0; N < cN; ++N)
-			rd->data[dN].row[N] = (fval_t) fbuf[N];
+		cN = head->column_N;
 
-		plotDataInsert(rd->pl, dN, rd->data[dN].row);
+		if (		fread(rd->data[dN].hint, sizeof(int), cN, sd) != (size_t) cN
+				|| fread(rd->data[dN].label, READ_TOKEN_MAX, cN, sd) != (size_t) cN)
+			break;
 
-		return 1;
-	}
-	else if (rc == ASYNC_END_OF_FILE) {
+		rd->data[dN].side = sd;
+		rd->data[dN].side_state = SIDE_LOAD;
+		rd->data[dN].side_row_N = head->row_N;
+		rd->data[dN].side_offset = head->source_size;
+		rd->data[dN].side_end = head->data_end;
 
-		readCloseFile(rd, dN);
+		rd->data[dN].bom = head->bom;
+		rd->data[dN].line_N = 0;
+
+		return 0;
 	}
+	while (0);
 
-	return 0;
+	fclose(sd);
+
+	readFileSeek(fd, 0U);
+
+	return -1;
 }
 
-static int
-readFP64(read_t *rd, int dN)
+static void
+readSideCreate(read_t *rd, int dN)
 {
-	double		*fbuf = (double *) rd->data[dN].buf;
-	int		rc, N, cN = rd->pl->data[dN].column_N;
+	char		side[READ_FILE_PATH_MAX + 8];
+	rside_t		head;
 
-	rc = async_read(rd->data[dN].afd, (void *) fbuf, cN * sizeof(double));
+	if (readSideBusy(rd, dN, rd->data[dN].file) != 0)
+		return ;
 
-	if (rc == ASYNC_OK) {
+	sprintf(side, "%s.gpc", rd->data[dN].file);
 
-		for (N = 0; N < cN; ++N)
-			rd->data[dN].row[N] = (fval_t) fbuf[N];
+	rd->data[dN].side = unified_fopen(side, "w+b");
 
-		plotDataInsert(rd->pl, dN, rd->data[dN].row);
+	if (rd->data[dN].side == NULL) {
 
-		return 1;
+		ERROR("fopen(\"%s\"): %s\n", side, strerror(errno));
+		return ;
+	}
+
+	rd->data[dN].side_state = SIDE_CREATE;
+	rd->data[dN].side_row_N = 0;
+
+	/* Write incomplete header to reserve the space.
+	 * */
+	memset(&head, 0, sizeof(head));
+
+	head.column_N = rd->data[dN].column_N;
+
+	if (readSideWriteHead(rd, dN, &head) != 0) {
+
+		readSideClose(rd, dN);
+	}
+}
+
+static int
+readSidePack(rblock_t *bk)
+{
+	if (bk->pack == NULL) {
+
+		bk->pack_MAX = bk->rows_MAX * bk->column_N * (int) sizeof(fval_t);
+		bk->pack = (char *) malloc(bk->pack_MAX + LZ4_compressBound(bk->pack_MAX));
+
+		if (bk->pack == NULL) {
+
+			ERROR("No memory allocated for sidecar block\n");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+readSideWrite(read_t *rd, int dN, rblock_t *bk, const fval_t *rows, int row_N, int line_N)
+{
+	const Uint64	*src = (const Uint64 *) rows;
+	Uint64		*xb;
+
+	int		cN, N, meta[3];
+
+	if (readSidePack(bk) != 0)
+		return -1;
+
+	cN = bk->column_N;
+	xb = (Uint64 *) bk->pack;
+
+	/* XOR with previous row to make slowly changing data compressible.
+	 * */
+	for (N = 0; N < row_N * cN; ++N)
+		xb[N] = (N < cN) ? src[N] : src[N] ^ src[N - cN];
+
+	meta[0] = row_N;
+	meta[1] = line_N;
+	meta[2] = LZ4_compress_default(bk->pack, bk->pack + bk->pack_MAX,
+			row_N * cN * (int) sizeof(fval_t),
+			LZ4_compressBound(bk->pack_MAX));
+
+	if (		meta[2] <= 0
+			|| fwrite(meta, sizeof(int), 3, rd->data[dN].side) != 3
+			|| fwrite(bk->pack + bk->pack_MAX, 1, meta[2], rd->data[dN].side)
+				!= (size_t) meta[2])
+		return -1;
+
+	rd->data[dN].side_row_N += row_N;
+
+	return 0;
+}
+
+static void
+readSideHead(read_t *rd, int dN, const fval_t *rbuf, int rbuf_N)
+{
+	rblock_t	*bk;
+	int		N, cN;
+
+	if (rd->data[dN].side == NULL)
+		return ;
+
+	cN = rd->pl->data[dN].column_N;
+	bk = readBlockAlloc(rd, dN);
+
+	if (bk == NULL) {
+
+		readSideClose(rd, dN);
+		return ;
+	}
+
+	for (N = 0; N < rbuf_N; ++N) {
+
+		memcpy(bk->rows + N * cN, rbuf + READ_COLUMN_MAX * N,
+				cN * sizeof(fval_t));
+	}
+
+	if (readSideWrite(rd, dN, bk, bk->rows, rbuf_N, rd->data[dN].line_N) != 0) {
+
+		readSideClose(rd, dN);
+	}
+}
+
+static void
+readCloseFile(read_t *rd, int dN)
+{
+	readBlockFree(rd, dN);
+	readSideClose(rd, dN);
+
+	if (rd->data[dN].afd != NULL) {
+
+		async_close(rd->data[dN].afd);
+	}
+
+	file_unmap(&rd->data[dN].map);
+
+	if (		rd->data[dN].fd != NULL
+			&& rd->data[dN].fd != stdin) {
+
+		fclose(rd->data[dN].fd);
+	}
+
+	rd->data[dN].fd = NULL;
+	rd->data[dN].afd = NULL;
+	rd->data[dN].socket = 0;
+}
+
+static int
+readIsSocket(const char *file)
+{
+	return (	   strncmp(file, "udp://", 6) == 0
+			|| strncmp(file, "tcp://", 6) == 0) ? 1 : 0;
+}
+
+static void
+readOpenSocket(read_t *rd, int dN, int cN, int lN, const char *file, int fmt)
+{
+	fval_t		rbuf[READ_COLUMN_MAX * READ_TEXT_HEAD_MAX];
+	async_FILE	*afd;
+
+	int		N, rbuf_N = 0, frame = 0;
+
+	if (rd->data[dN].fd != NULL || rd->data[dN].socket != 0) {
+
+		readCloseFile(rd, dN);
+	}
+
+	if (fmt == FORMAT_BINARY_FP_32) {
+
+		frame = cN * (int) sizeof(float);
+	}
+	else if (fmt == FORMAT_BINARY_FP_64) {
+
+		frame = cN * (int) sizeof(double);
+	}
+	else if (fmt != FORMAT_TEXT_CSV) {
+
+		ERROR("Unsupported format of socket \"%s\"\n", file);
+		return ;
+	}
+
+	afd = async_open_socket(file, rd->preload, rd->chunk, rd->timeout, frame);
+
+	if (afd == NULL)
+		return ;
+
+	rd->data[dN].length_N = (rd->length_N < 1) ? lN : rd->length_N;
+
+	if (fmt == FORMAT_TEXT_CSV) {
+
+		/* We have to wait for the first lines to know the columns.
+		 * */
+		cN = readCSVGetCN(rd, dN, NULL, afd, rbuf, &rbuf_N);
+
+		if (cN < 1) {
+
+			ERROR("No correct data in socket \"%s\"\n", file);
+			async_close(afd);
+			return ;
+		}
+	}
+	else {
+		rd->data[dN].line_N = 1;
+	}
+
+	lN = (lN < 1) ? ((rd->length_N < 1) ? 1000 : rd->length_N) : lN;
+
+	plotDataAlloc(rd->pl, dN, cN, lN + 1, (fmt == FORMAT_BINARY_FP_32)
+			? STORAGE_FP32 : STORAGE_FP64);
+
+	for (N = 0; N < rbuf_N; ++N) {
+
+		plotDataInsert(rd->pl, dN, rbuf + READ_COLUMN_MAX * N);
+	}
+
+	rd->data[dN].format = fmt;
+	rd->data[dN].column_N = cN;
+
+	strcpy(rd->data[dN].file, file);
+
+	rd->data[dN].fd = NULL;
+	rd->data[dN].afd = afd;
+	rd->data[dN].socket = 1;
+
+	rd->data[dN].map_offset = 0;
+
+	rd->keep_N += 1;
+	rd->bind_N = dN;
+}
+
+void readOpenUnified(read_t *rd, int dN, int cN, int lN, const char *file, int fmt)
+{
+	fval_t		rbuf[READ_COLUMN_MAX * READ_TEXT_HEAD_MAX];
+	rside_t		head;
+
+	int		N, rbuf_N = 0, bom;
+
+	FILE			*fd;
+	unsigned long long	bF = 0U;
+
+	if (readIsSocket(file) != 0) {
+
+		readOpenSocket(rd, dN, cN, lN, file, fmt);
+		return ;
+	}
+
+	if (rd->data[dN].fd != NULL || rd->data[dN].socket != 0) {
+
+		readCloseFile(rd, dN);
+	}
+
+	if (fmt == FORMAT_TEXT_STDIN) {
+
+		fd = stdin;
+	}
+	else {
+		fd = unified_fopen(file, "rb");
+	}
+
+	if (fd == NULL) {
+
+		ERROR("fopen(\"%s\"): %s\n", file, strerror(errno));
+	}
+	else {
+		if (fmt != FORMAT_TEXT_STDIN) {
+
+			file_stat(file, &bF);
+		}
+
+		rd->data[dN].length_N = (rd->length_N < 1) ? lN : rd->length_N;
+
+		if (		fmt == FORMAT_TEXT_CSV
+				&& rd->sidecar != 0
+				&& readSideOpen(rd, dN, file, fd, &head) == 0) {
+
+			/* We take the parsed data from sidecar and then
+			 * continue to read the appended rest of file.
+			 * */
+			cN = head.column_N;
+
+			if (lN < 1) {
+
+				lN = (rd->length_N < 1) ? head.row_N + 1 : rd->length_N;
+			}
+		}
+		else if (	fmt == FORMAT_TEXT_STDIN
+				|| fmt == FORMAT_TEXT_CSV) {
+
+			if (fmt != FORMAT_TEXT_STDIN) {
+
+				bom = readCSVGetBOM(fd);
+
+				if (bom == BOM_UTF_UNKNOWN) {
+
+					ERROR("Unsupported BOM in file \"%s\"\n", file);
+
+					fclose(fd);
+					return ;
+				}
+
+				rd->data[dN].bom = bom;
+			}
+
+			cN = readCSVGetCN(rd, dN, fd, NULL, rbuf, &rbuf_N);
+
+			if (cN < 1) {
+
+				ERROR("No correct data in file \"%s\"\n", file);
+				fclose(fd);
+				return ;
+			}
+
+			if (lN < 1) {
+
+				/* We do not use the actual file size to guess
+				 * the length since there is an incremental
+				 * dataset memory allocation.
+				 * */
+				lN = (rd->length_N < 1) ? 1000 : rd->length_N;
+			}
+		}
+		else if (fmt == FORMAT_BINARY_FP_32) {
+
+			lN = (lN < 1) ? (int) (bF / (cN * sizeof(float))) : lN;
+			rd->data[dN].line_N = 1;
+		}
+		else if (fmt == FORMAT_BINARY_FP_64) {
+
+			lN = (lN < 1) ? (int) (bF / (cN * sizeof(double))) : lN;
+			rd->data[dN].line_N = 1;
+		}
+
+#ifdef _LEGACY
+		else if (fmt == FORMAT_BINARY_LEGACY_V1) {
+
+			lN = (lN < 1) ? (int) ((bF - 6) / (cN * 6)) : lN;
+			rd->data[dN].line_N = 1;
+
+			fseek(fd, 6UL, SEEK_SET);
+		}
+		else if (fmt == FORMAT_BINARY_LEGACY_V2) {
+
+			lN = (lN < 1) ? (int) ((bF - 4) / (cN * 4)) : lN;
+			rd->data[dN].line_N = 1;
+
+			fseek(fd, 4UL, SEEK_SET);
+		}
+#endif /* _LEGACY */
+
+		plotDataAlloc(rd->pl, dN, cN, lN + 1, (fmt == FORMAT_BINARY_FP_32)
+				? STORAGE_FP32 : STORAGE_FP64);
+
+		if (		fmt == FORMAT_TEXT_STDIN
+				|| fmt == FORMAT_TEXT_CSV) {
+
+			for (N = 0; N < rbuf_N; ++N) {
+
+				plotDataInsert(rd->pl, dN, rbuf + READ_COLUMN_MAX * N);
+			}
+		}
+
+		rd->data[dN].format = fmt;
+		rd->data[dN].column_N = cN;
+
+		strcpy(rd->data[dN].file, file);
+
+		rd->data[dN].fd = fd;
+		rd->data[dN].afd = NULL;
+
+		rd->data[dN].map_offset = 0;
+
+		if (		rd->mmap != 0
+				&& (	   fmt == FORMAT_BINARY_FP_32
+					|| fmt == FORMAT_BINARY_FP_64)
+				&& file_map(&rd->data[dN].map, file) == ENT_OK) {
+
+			/* We read the mapped file directly and start
+			 * asynchronous reader only when we reach the end of
+			 * mapping to get the data appended later.
+			 * */
+		}
+		else if (rd->data[dN].side_state == SIDE_LOAD) {
+
+			/* Asynchronous reader is started when we reach the
+			 * end of sidecar.
+			 * */
+		}
+		else {
+			if (		fmt == FORMAT_TEXT_CSV
+					&& rd->sidecar != 0) {
+
+				readSideCreate(rd, dN);
+				readSideHead(rd, dN, rbuf, rbuf_N);
+			}
+
+			rd->data[dN].afd = async_open(fd, rd->preload, rd->chunk, rd->timeout);
+		}
+
+		rd->keep_N += 1;
+		rd->bind_N = dN;
+	}
+}
+
+void readOpenStub(read_t *rd, int dN, int cN, int lN, const char *file, int fmt)
+{
+	rd->data[dN].length_N = lN;
+
+	lN = (lN < 1) ? 3 : lN;
+
+	plotDataAlloc(rd->pl, dN, cN, lN + 1, STORAGE_FP64);
+
+	rd->data[dN].format = fmt;
+	rd->data[dN].column_N = cN;
+
+	strcpy(rd->data[dN].file, file);
+
+	if (fmt == FORMAT_STUB_DATA) {
+
+		rd->data[dN].fd = NULL;
+		rd->data[dN].afd = async_stub(rd->preload, rd->chunk, rd->timeout);
+	}
+
+	rd->keep_N += 1;
+	rd->bind_N = dN;
+}
+
+void readToggleHint(read_t *rd, int dN, int cN)
+{
+	if (rd->data[dN].format == FORMAT_NONE) {
+
+		ERROR("Dataset number %i was not allocated\n", dN);
+		return ;
+	}
+
+	if (cN < 0 || cN >= rd->data[dN].column_N) {
+
+		return ;
+	}
+
+	if (rd->data[dN].hint[cN] == DATA_HINT_NONE) {
+
+		rd->data[dN].hint[cN] = DATA_HINT_FLOAT;
+	}
+	else if (rd->data[dN].hint[cN] == DATA_HINT_FLOAT) {
+
+		rd->data[dN].hint[cN] = DATA_HINT_HEX;
+	}
+	else if (rd->data[dN].hint[cN] == DATA_HINT_HEX) {
+
+		rd->data[dN].hint[cN] = DATA_HINT_OCT;
+	}
+	else if (rd->data[dN].hint[cN] == DATA_HINT_OCT) {
+
+		rd->data[dN].hint[cN] = DATA_HINT_NONE;
+	}
+}
+
+static int
+readSTUB(read_t *rd, int dN)
+{
+	rblock_t	*bk;
+	int		rc, cN, n;
+
+	cN = rd->pl->data[dN].column_N;
+	bk = readBlockAlloc(rd, dN);
+
+	if (bk == NULL)
+		return 0;
+
+	n = readBlockLimit(rd, dN, bk->rows_MAX);
+
+	rc = async_read_block(rd->data[dN].afd, (void *) bk->rows, cN * sizeof(double), &n);
+
+	if (rc == ASYNC_OK) {
+
+		readBlockInsert(rd, dN, bk->rows, n);
+
+		return n;
+	}
+
+	return 0;
+}
+
+static void
+readBlockJOB(rjob_t *jb)
+{
+	rblock_t	*bk = (rblock_t *) jb->bk;
+	int		lN, cN, changed = 0;
+
+	cN = bk->column_N;
+
+	for (lN = jb->line_A; lN < jb->line_B; ++lN) {
+
+		bk->count[lN] = readCSVParseRow(&bk->mk, bk->cmap, jb->hint, jb->row,
+				bk->text + bk->line[lN], cN, &changed);
+
+		if (changed != 0) {
+
+			/* Hint was changed so the rest of lines must be
+			 * parsed again in order.
+			 * */
+			jb->changed = lN;
+			break;
+		}
+
+		memcpy(bk->rows + lN * cN, jb->row, cN * sizeof(fval_t));
+	}
+}
+
+static void
+readBlockLOAD(rblock_t *bk)
+{
+	read_t		*rd = (read_t *) bk->rd;
+	rjob_t		*jb;
+
+	int		rc, dN, cN, lN, jN, job_N, line_L, changed;
+
+	dN = bk->dN;
+	cN = bk->column_N;
+
+	bk->text_N = 0;
+	bk->line_N = 0;
+	bk->row_N = 0;
+	bk->side_fail = 0;
+
+	do {
+		rc = async_gets(rd->data[dN].afd, bk->text + bk->text_N,
+				sizeof(rd->data[0].buf));
+
+		if (rc != ASYNC_OK)
+			break;
+
+		bk->line[bk->line_N++] = bk->text_N;
+		bk->text_N += strlen(bk->text + bk->text_N) + 1;
+
+		if (		bk->line_N >= bk->line_MAX
+				|| bk->text_N >= READ_BLOCK_SIZE)
+			break;
+	}
+	while (1);
+
+	bk->rc = rc;
+
+	if (bk->line_N > 0) {
+
+		readCSVMakeMap(bk->cmap, &bk->mk);
+
+		job_N = (rd->pl->pool != NULL) ? rd->pl->pool->thread_N + 1 : 1;
+		job_N = (job_N > READ_BLOCK_JOB_MAX) ? READ_BLOCK_JOB_MAX : job_N;
+
+		lN = (bk->line_N + READ_BLOCK_JOB_LINES - 1) / READ_BLOCK_JOB_LINES;
+		job_N = (job_N > lN) ? lN : job_N;
+
+		for (jN = 0; jN < job_N; ++jN) {
+
+			jb = &bk->job[jN];
+
+			jb->bk = (void *) bk;
+			jb->line_A = bk->line_N * jN / job_N;
+			jb->line_B = bk->line_N * (jN + 1) / job_N;
+			jb->changed = -1;
+
+			memcpy(jb->hint, bk->hint, sizeof(jb->hint));
+
+			if (jN != 0) {
+
+				poolSubmit(rd->pl->pool, &jb->task,
+						(void (*) (void *)) &readBlockJOB, jb);
+			}
+		}
+
+		readBlockJOB(&bk->job[0]);
+
+		line_L = bk->line_N;
+
+		for (jN = 0; jN < job_N; ++jN) {
+
+			jb = &bk->job[jN];
+
+			if (jN != 0) {
+
+				poolWait(rd->pl->pool, &jb->task);
+			}
+
+			if (jb->changed >= 0 && line_L == bk->line_N) {
+
+				line_L = jb->changed;
+			}
+		}
+
+		jb = &bk->job[0];
+
+		for (lN = line_L; lN < bk->line_N; ++lN) {
+
+			bk->count[lN] = readCSVParseRow(&bk->mk, bk->cmap, bk->hint,
+					jb->row, bk->text + bk->line[lN], cN, &changed);
+
+			memcpy(bk->rows + lN * cN, jb->row, cN * sizeof(fval_t));
+		}
+
+		/* Drop the lines that were not parsed completely.
+		 * */
+		for (lN = 0, jN = 0; lN < bk->line_N; ++lN) {
+
+			if (bk->count[lN] == cN) {
+
+				if (jN != lN) {
+
+					memcpy(bk->rows + jN * cN, bk->rows + lN * cN,
+							cN * sizeof(fval_t));
+				}
+
+				jN++;
+			}
+		}
+
+		bk->row_N = jN;
+
+		if (rd->data[dN].side != NULL) {
+
+			if (readSideWrite(rd, dN, bk, bk->rows, bk->row_N, bk->line_N) != 0) {
+
+				bk->side_fail = 1;
+			}
+		}
+	}
+}
+
+static void
+readCSVStart(read_t *rd, int dN)
+{
+	rblock_t	*bk;
+
+	bk = readBlockAlloc(rd, dN);
+
+	if (bk == NULL)
+		return ;
+
+	bk->rd = (void *) rd;
+	bk->dN = dN;
+	bk->line_MAX = readBlockLimit(rd, dN, bk->rows_MAX);
+	bk->mk = rd->mk_text;
+	bk->busy = 1;
+
+	memcpy(bk->hint, rd->data[dN].hint, sizeof(bk->hint));
+	memcpy(bk->hint_base, rd->data[dN].hint, sizeof(bk->hint_base));
+
+	poolSubmit(rd->pl->pool, &bk->task, (void (*) (void *)) &readBlockLOAD, bk);
+}
+
+static int
+readCSVFinish(read_t *rd, int dN)
+{
+	rblock_t	*bk = rd->data[dN].block;
+	int		line_N, N;
+
+	poolWait(rd->pl->pool, &bk->task);
+
+	bk->busy = 0;
+
+	for (N = 0; N < bk->column_N; ++N) {
+
+		/* Take the hint detected by worker unless it was toggled in
+		 * the meantime.
+		 * */
+		if (		bk->hint[N] != bk->hint_base[N]
+				&& rd->data[dN].hint[N] == bk->hint_base[N]) {
+
+			rd->data[dN].hint[N] = bk->hint[N];
+		}
+	}
+
+	readBlockInsert(rd, dN, bk->rows, bk->row_N);
+
+	line_N = bk->line_N;
+	rd->data[dN].line_N += line_N - bk->row_N;
+
+	if (bk->side_fail != 0) {
+
+		ERROR("Unable to write sidecar of \"%s\"\n", rd->data[dN].file);
+		readSideClose(rd, dN);
+	}
+
+	if (bk->rc == ASYNC_END_OF_FILE && line_N == 0) {
+
+		readSideFinal(rd, dN);
+		readCloseFile(rd, dN);
+	}
+
+	return line_N;
+}
+
+static int
+readFP32(read_t *rd, int dN)
+{
+	rblock_t	*bk;
+	float		*fbuf;
+
+	int		rc, N, cN, n;
+
+	cN = rd->pl->data[dN].column_N;
+	bk = readBlockAlloc(rd, dN);
+
+	if (bk == NULL)
+		return 0;
+
+	fbuf = (float *) bk->text;
+
+	n = READ_BLOCK_SIZE / (cN * (int) sizeof(float));
+	n = (n > bk->rows_MAX) ? bk->rows_MAX : n;
+	n = readBlockLimit(rd, dN, n);
+
+	rc = async_read_block(rd->data[dN].afd, (void *) fbuf, cN * sizeof(float), &n);
+
+	if (rc == ASYNC_OK) {
+
+		for (N = 0; N < n * cN; ++N)
+			bk->rows[N] = (fval_t) fbuf[N];
+
+		readBlockInsert(rd, dN, bk->rows, n);
+
+		return n;
+	}
+	else if (rc == ASYNC_END_OF_FILE) {
+
+		readCloseFile(rd, dN);
+	}
+
+	return 0;
+}
+
+static int
+readFP64(read_t *rd, int dN)
+{
+	rblock_t	*bk;
+	int		rc, cN, n;
+
+	cN = rd->pl->data[dN].column_N;
+	bk = readBlockAlloc(rd, dN);
+
+	if (bk == NULL)
+		return 0;
+
+	n = readBlockLimit(rd, dN, bk->rows_MAX);
+
+	/* Read rows straight into the block as the storage type is double.
+	 * */
+	rc = async_read_block(rd->data[dN].afd, (void *) bk->rows, cN * sizeof(double), &n);
+
+	if (rc == ASYNC_OK) {
+
+		readBlockInsert(rd, dN, bk->rows, n);
+
+		return n;
 	}
 	else if (rc == ASYNC_END_OF_FILE) {
 
@@ -1355,6 +2248,142 @@ readFP64(read_t *rd, int dN)
 	return 0;
 }
 
+static int
+readMAP(read_t *rd, int dN)
+{
+	rblock_t	*bk;
+	const char	*fb;
+
+	int		N, cN, n;
+
+	unsigned long long	bSIZE, bOFS;
+
+	cN = rd->pl->data[dN].column_N;
+	bk = readBlockAlloc(rd, dN);
+
+	if (bk == NULL)
+		return 0;
+
+	bSIZE = (rd->data[dN].format == FORMAT_BINARY_FP_32)
+		? cN * sizeof(float) : cN * sizeof(double);
+
+	bOFS = rd->data[dN].map_offset;
+
+	if (bOFS + bSIZE <= rd->data[dN].map.nsize) {
+
+		fb = (const char *) rd->data[dN].map.base + bOFS;
+
+		n = ((rd->data[dN].map.nsize - bOFS) / bSIZE > bk->rows_MAX)
+			? bk->rows_MAX : (int) ((rd->data[dN].map.nsize - bOFS) / bSIZE);
+
+		n = readBlockLimit(rd, dN, n);
+
+		if (rd->data[dN].format == FORMAT_BINARY_FP_32) {
+
+			const float	*fbuf = (const float *) fb;
+
+			for (N = 0; N < n * cN; ++N)
+				bk->rows[N] = (fval_t) fbuf[N];
+
+			readBlockInsert(rd, dN, bk->rows, n);
+		}
+		else {
+			/* Insert the rows straight from the mapped file.
+			 * */
+			readBlockInsert(rd, dN, (const fval_t *) fb, n);
+		}
+
+		rd->data[dN].map_offset = bOFS + bSIZE * n;
+
+		return n;
+	}
+
+	/* Continue to read the rest of file in usual way.
+	 * */
+	file_unmap(&rd->data[dN].map);
+
+	readFileSeek(rd->data[dN].fd, bOFS);
+
+	rd->data[dN].afd = async_open(rd->data[dN].fd, rd->preload, rd->chunk, rd->timeout);
+
+	return 0;
+}
+
+static int
+readSIDE(read_t *rd, int dN)
+{
+	rblock_t	*bk;
+	FILE		*sd = rd->data[dN].side;
+
+	const Uint64	*xb;
+	Uint64		*dst;
+
+	char		file[READ_FILE_PATH_MAX];
+	int		cN, N, meta[3];
+
+	cN = rd->pl->data[dN].column_N;
+	bk = readBlockAlloc(rd, dN);
+
+	if (bk == NULL || readSidePack(bk) != 0)
+		return 0;
+
+	if (readFileTell(sd) >= rd->data[dN].side_end) {
+
+		/* Continue to read the appended rest of file in usual way
+		 * and write new blocks to the end of sidecar.
+		 * */
+		rd->data[dN].side_state = SIDE_APPEND;
+
+		readFileSeek(sd, rd->data[dN].side_end);
+		readFileSeek(rd->data[dN].fd, rd->data[dN].side_offset);
+
+		rd->data[dN].afd = async_open(rd->data[dN].fd, rd->preload, rd->chunk, rd->timeout);
+
+		return 0;
+	}
+
+	if (		fread(meta, sizeof(int), 3, sd) == 3
+			&& meta[0] >= 0 && meta[0] <= bk->rows_MAX
+			&& meta[2] > 0 && meta[2] <= LZ4_compressBound(bk->pack_MAX)
+			&& fread(bk->pack + bk->pack_MAX, 1, meta[2], sd) == (size_t) meta[2]
+			&& LZ4_decompress_safe(bk->pack + bk->pack_MAX, bk->pack, meta[2],
+				bk->pack_MAX) == meta[0] * cN * (int) sizeof(fval_t)) {
+
+		xb = (const Uint64 *) bk->pack;
+		dst = (Uint64 *) bk->rows;
+
+		for (N = 0; N < meta[0] * cN; ++N)
+			dst[N] = (N < cN) ? xb[N] : xb[N] ^ dst[N - cN];
+
+		while (		rd->data[dN].length_N < 1
+				&& plotDataSpaceLeft(rd->pl, dN) < meta[0] + 3) {
+
+			if (plotDataGrowUp(rd->pl, dN) != 0)
+				break;
+		}
+
+		plotDataInsertBlock(rd->pl, dN, bk->rows, meta[0]);
+
+		rd->data[dN].line_N += meta[1];
+
+		return (meta[1] > 0) ? meta[1] : 1;
+	}
+
+	ERROR("Broken sidecar of \"%s\"\n", rd->data[dN].file);
+
+	/* Drop the sidecar and parse the whole file again.
+	 * */
+	rd->data[dN].side_state = SIDE_CREATE;
+
+	memset(rd->data[dN].hint, 0, sizeof(rd->data[0].hint));
+	strcpy(file, rd->data[dN].file);
+
+	readSideClose(rd, dN);
+	readOpenUnified(rd, dN, 0, rd->data[dN].length_N, file, FORMAT_TEXT_CSV);
+
+	return 0;
+}
+
 #ifdef _LEGACY
 static int
 readLEGACY(read_t *rd, int dN)
@@ -1382,7 +2411,7 @@ readLEGACY(read_t *rd, int dN)
 				rd->data[dN].row[N] = * (float *) (fb + N * 4);
 		}
 
-		plotDataInsert(rd->pl, dN, rd->data[dN].row);
+		readBlockInsert(rd, dN, rd->data[dN].row, 1);
 
 		return 1;
 	}
@@ -1397,87 +2426,137 @@ readLEGACY(read_t *rd, int dN)
 
 int readDataLoad(read_t *rd)
 {
-	int		dN, keep_N = 0, ulN = 0;
+	rblock_t	*bk;
+
+	int		dN, keep_N = 0, ulN = 0, line_N, pass_N, wait_N, idle = 0;
+	int		load[PLOT_DATASET_MAX];
 
 	Uint32		tTOP;
 
+	tTOP = SDL_GetTicks() + (Uint32) PLOT_RUNTIME_MAX;
+
 	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-		FILE		*fd = rd->data[dN].fd;
+		load[dN] = (rd->data[dN].fd != NULL || rd->data[dN].socket != 0) ? 1 : 0;
 
-		tTOP = SDL_GetTicks() + (Uint32) PLOT_RUNTIME_MAX;
+		if (		rd->data[dN].socket != 0
+				&& rd->data[dN].afd->datagram != 0) {
 
-		if (fd != NULL) {
+			/* Datagram socket is never closed on silence so it is
+			 * kept as loading only while datagrams come.
+			 * */
+			if (		SDL_GetTicks() < rd->data[dN].afd->clock
+					+ (Uint32) rd->data[dN].afd->timeout) {
 
-			keep_N += 1;
+				keep_N += 1;
+			}
+		}
+		else {
+			keep_N += load[dN];
+		}
+	}
 
-			do {
-				if (		rd->data[dN].format == FORMAT_TEXT_STDIN
-						|| rd->data[dN].format == FORMAT_TEXT_CSV) {
+	/* All of files share the same time slice. Text blocks are loaded in
+	 * background so we only insert the finished ones and start the next.
+	 * */
+	do {
+		pass_N = 0;
+		wait_N = 0;
 
-					if (readCSV(rd, dN) != 0) {
+		for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
 
-						ulN += 1;
-					}
-					else {
-						break;
-					}
-				}
-				else if (rd->data[dN].format == FORMAT_BINARY_FP_32) {
+			if (		rd->data[dN].fd == NULL
+					&& rd->data[dN].socket == 0)
+				continue;
 
-					if (readFP32(rd, dN) != 0) {
+			if (rd->data[dN].side_state == SIDE_LOAD) {
 
-						ulN += 1;
-					}
-					else {
-						break;
-					}
-				}
-				else if (rd->data[dN].format == FORMAT_BINARY_FP_64) {
+				line_N = readSIDE(rd, dN);
+			}
+			else if (rd->data[dN].map.base != NULL) {
 
-					if (readFP64(rd, dN) != 0) {
+				line_N = readMAP(rd, dN);
+			}
+			else if (	rd->data[dN].format == FORMAT_TEXT_STDIN
+					|| rd->data[dN].format == FORMAT_TEXT_CSV) {
 
-						ulN += 1;
-					}
-					else {
-						break;
-					}
-				}
+				bk = rd->data[dN].block;
+				line_N = -1;
 
-#ifdef _LEGACY
-				else if (rd->data[dN].format == FORMAT_BINARY_LEGACY_V1
-					|| rd->data[dN].format == FORMAT_BINARY_LEGACY_V2) {
+				if (bk != NULL && bk->busy != 0) {
 
-					if (readLEGACY(rd, dN) != 0) {
+					if (		idle == 0
+							&& poolIsDone(&bk->task) == 0) {
 
-						ulN += 1;
-					}
-					else {
-						break;
+						/* Do not wait for the block
+						 * while others have data.
+						 * */
+						wait_N += 1;
+						continue;
 					}
+
+					line_N = readCSVFinish(rd, dN);
 				}
-#endif /* _LEGACY */
-				else {
-					readCloseFile(rd, dN);
-					break;
+
+				if (		rd->data[dN].fd != NULL
+						|| rd->data[dN].socket != 0) {
+
+					readCSVStart(rd, dN);
+
+					bk = rd->data[dN].block;
+					wait_N += (bk != NULL && line_N != 0) ? 1 : 0;
 				}
 
-				rd->data[dN].line_N++;
+				line_N = (line_N < 0) ? 0 : line_N;
+			}
+			else if (rd->data[dN].format == FORMAT_BINARY_FP_32) {
+
+				line_N = readFP32(rd, dN);
+			}
+			else if (rd->data[dN].format == FORMAT_BINARY_FP_64) {
+
+				line_N = readFP64(rd, dN);
+			}
 
-				if (		rd->data[dN].length_N < 1
-						&& plotDataSpaceLeft(rd->pl, dN) < 3) {
+#ifdef _LEGACY
+			else if (rd->data[dN].format == FORMAT_BINARY_LEGACY_V1
+				|| rd->data[dN].format == FORMAT_BINARY_LEGACY_V2) {
 
-					plotDataGrowUp(rd->pl, dN);
-				}
+				line_N = readLEGACY(rd, dN);
+			}
+#endif /* _LEGACY */
+			else {
+				readCloseFile(rd, dN);
+				continue;
 			}
-			while (SDL_GetTicks() < tTOP);
+
+			/* Lines were counted and inserted in block already.
+			 * */
+			pass_N += line_N;
+		}
+
+		ulN += pass_N;
+		idle = (pass_N == 0) ? 1 : 0;
+	}
+	while (		(pass_N != 0 || wait_N != 0)
+			&& SDL_GetTicks() < tTOP);
+
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+
+		if (load[dN] != 0) {
 
 			plotDataSubtractResidual(rd->pl, dN);
 		}
-		else if (rd->data[dN].format == FORMAT_STUB_DATA) {
+	}
+
+	for (dN = 0; dN < PLOT_DATASET_MAX; ++dN) {
+
+		if (rd->data[dN].format == FORMAT_STUB_DATA) {
 
 			Uint32		tSTOP;
 
+			tTOP = SDL_GetTicks() + (Uint32) PLOT_RUNTIME_MAX;
+
 			tSTOP = rd->data[dN].afd->clock
 				+ (Uint32) rd->data[dN].afd->timeout;
 
@@ -1487,21 +2566,15 @@ int readDataLoad(read_t *rd)
 			}
 
 			do {
-				if (readSTUB(rd, dN) != 0) {
+				line_N = readSTUB(rd, dN);
 
-					ulN += 1;
+				if (line_N != 0) {
+
+					ulN += line_N;
 				}
 				else {
 					break;
 				}
-
-				rd->data[dN].line_N++;
-
-				if (		rd->data[dN].length_N < 1
-						&& plotDataSpaceLeft(rd->pl, dN) < 3) {
-
-					plotDataGrowUp(rd->pl, dN);
-				}
 			}
 			while (SDL_GetTicks() < tTOP);
 
@@ -1906,6 +2979,100 @@ configParseFSM(read_t *rd, parse_t *pa)
 				}
 				while (0);
 			}
+			else if (strcmp(tbuf, "cache") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (argi[0] >= 2 && argi[0] <= PLOT_CHUNK_CACHE) {
+
+						failed = 0;
+
+						if (rd->bind_N != -1) {
+
+							plotDataCacheResize(rd->pl, rd->bind_N, argi[0]);
+						}
+						else {
+							rd->pl->cache_size = argi[0];
+						}
+					}
+					else {
+						sprintf(msg_tbuf, "cache size %i is out of range", argi[0]);
+					}
+				}
+				while (0);
+			}
+			else if (strcmp(tbuf, "spill") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (argi[0] >= 0 && argi[0] <= 1048576) {
+
+						failed = 0;
+
+						rd->pl->spill_budget = argi[0];
+					}
+					else {
+						sprintf(msg_tbuf, "spill budget %i is out of range", argi[0]);
+					}
+				}
+				while (0);
+			}
+			else if (strcmp(tbuf, "mmap") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (argi[0] >= 0 && argi[0] < 2) {
+
+						failed = 0;
+
+						rd->mmap = argi[0];
+					}
+					else {
+						sprintf(msg_tbuf, "invalid mmap %i", argi[0]);
+					}
+				}
+				while (0);
+			}
+			else if (strcmp(tbuf, "sidecar") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (argi[0] >= 0 && argi[0] < 2) {
+
+						failed = 0;
+
+						rd->sidecar = argi[0];
+					}
+					else {
+						sprintf(msg_tbuf, "invalid sidecar %i", argi[0]);
+					}
+				}
+				while (0);
+			}
 			else if (strcmp(tbuf, "timeout") == 0) {
 
 				failed = 1;
@@ -1928,6 +3095,28 @@ configParseFSM(read_t *rd, parse_t *pa)
 				}
 				while (0);
 			}
+			else if (strcmp(tbuf, "backpressure") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (argi[0] >= 0 && argi[0] < 2) {
+
+						failed = 0;
+
+						rd->backpressure = argi[0];
+					}
+					else {
+						sprintf(msg_tbuf, "invalid backpressure %i", argi[0]);
+					}
+				}
+				while (0);
+			}
 			else if (strcmp(tbuf, "length") == 0) {
 
 				failed = 1;
@@ -1966,6 +3155,22 @@ configParseFSM(read_t *rd, parse_t *pa)
 				}
 				while (0);
 			}
+			else if (strcmp(tbuf, "statsfile") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0) {
+
+						failed = 0;
+
+						strcpy(rd->statsfile, tbuf);
+					}
+				}
+				while (0);
+			}
 			else if (strcmp(tbuf, "windowsize") == 0) {
 
 				failed = 1;
@@ -2194,6 +3399,28 @@ configParseFSM(read_t *rd, parse_t *pa)
 				}
 				while (0);
 			}
+			else if (strcmp(tbuf, "renderer") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (argi[0] >= 0 && argi[0] <= 1) {
+
+						failed = 0;
+
+						rd->renderer = argi[0];
+					}
+					else {
+						sprintf(msg_tbuf, "invalid renderer %i", argi[0]);
+					}
+				}
+				while (0);
+			}
 			else if (strcmp(tbuf, "interpolation") == 0) {
 
 				failed = 1;
@@ -2415,6 +3642,118 @@ configParseFSM(read_t *rd, parse_t *pa)
 				}
 				while (0);
 			}
+			else if (strcmp(tbuf, "lz4_filter") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (rd->bind_N != -1) {
+
+						if (pa->fromUI != 0) {
+
+							failed = 0;
+							break;
+						}
+
+						sprintf(msg_tbuf, "unable if dataset was already opened");
+						break;
+					}
+
+					if (argi[0] >= 0 && argi[0] < 2) {
+
+						failed = 0;
+
+						rd->pl->lz4_filter = argi[0];
+					}
+					else {
+						sprintf(msg_tbuf, "invalid lz4_filter %i", argi[0]);
+					}
+				}
+				while (0);
+			}
+			else if (strcmp(tbuf, "columnar") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (rd->bind_N != -1) {
+
+						if (pa->fromUI != 0) {
+
+							failed = 0;
+							break;
+						}
+
+						sprintf(msg_tbuf, "unable if dataset was already opened");
+						break;
+					}
+
+					if (argi[0] >= 0 && argi[0] < 2) {
+
+						failed = 0;
+
+						rd->pl->columnar = argi[0];
+					}
+					else {
+						sprintf(msg_tbuf, "invalid columnar %i", argi[0]);
+					}
+				}
+				while (0);
+			}
+			else if (strcmp(tbuf, "lod") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (argi[0] >= 0 && argi[0] <= 1) {
+
+						failed = 0;
+
+						rd->pl->lod = argi[0];
+					}
+					else {
+						sprintf(msg_tbuf, "invalid lod %i", argi[0]);
+					}
+				}
+				while (0);
+			}
+			else if (strcmp(tbuf, "incremental") == 0) {
+
+				failed = 1;
+
+				do {
+					rc = configToken(rd, pa);
+
+					if (rc == 0 && stoi(&rd->mk_config, &argi[0], tbuf) != NULL) ;
+					else break;
+
+					if (argi[0] >= 0 && argi[0] <= 1) {
+
+						failed = 0;
+
+						rd->pl->incremental = argi[0];
+					}
+					else {
+						sprintf(msg_tbuf, "invalid incremental %i", argi[0]);
+					}
+				}
+				while (0);
+			}
 			else if (strcmp(tbuf, "load") == 0) {
 
 				failed = 1;
@@ -2538,7 +3877,8 @@ configParseFSM(read_t *rd, parse_t *pa)
 
 						lbuf = tbuf;
 
-						if (pa->path != NULL && tbuf[0] != '/') {
+						if (		pa->path != NULL && tbuf[0] != '/'
+								&& readIsSocket(tbuf) == 0) {
 
 							sprintf(lpath, "%s/%s", pa->path, tbuf);
 							lbuf = lpath;
@@ -2546,7 +3886,8 @@ configParseFSM(read_t *rd, parse_t *pa)
 
 						readOpenUnified(rd, dN_remap, argi[3], argi[1], lbuf, argi[2]);
 
-						if (rd->data[dN_remap].fd == NULL) {
+						if (		rd->data[dN_remap].fd == NULL
+								&& rd->data[dN_remap].socket == 0) {
 
 							if (		argi[2] == FORMAT_BINARY_FP_32
 									|| argi[2] == FORMAT_BINARY_FP_64) {
@@ -3639,7 +4980,7 @@ void readDatasetClean(read_t *rd, int dN)
 	}
 	while (1);
 
-	if (rd->data[dN].fd != NULL) {
+	if (rd->data[dN].fd != NULL || rd->data[dN].socket != 0) {
 
 		readCloseFile(rd, dN);
 	}
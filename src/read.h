@@ -25,6 +25,7 @@
 #include <SDL2/SDL.h>
 
 #include "async.h"
+#include "dirent.h"
 #include "draw.h"
 #include "plot.h"
 
@@ -36,6 +37,13 @@
 #define READ_TEXT_HEAD_MAX	3
 #define READ_TEXT_DEVIATE_MAX	2
 #define READ_SUBTRACT_MAX	4
+#define READ_BLOCK_SIZE		1048576
+#define READ_BLOCK_LINE_MAX	4096
+#define READ_BLOCK_ROWS_SIZE	4194304
+#define READ_BLOCK_JOB_MAX	16
+#define READ_BLOCK_JOB_LINES	64
+#define READ_SIDE_VERSION	1
+#define READ_SIDE_TAIL		4096
 
 #define GP_MIN_SIZE_X		640
 #define GP_MIN_SIZE_Y		480
@@ -62,6 +70,13 @@ enum {
 	DATA_HINT_OCT
 };
 
+enum {
+	SIDE_NONE			= 0,
+	SIDE_LOAD,
+	SIDE_APPEND,
+	SIDE_CREATE
+};
+
 enum {
 	BOM_NONE			= 0,
 	BOM_UTF_8,
@@ -76,6 +91,89 @@ typedef struct {
 }
 markup_t;
 
+/* The text block is a bunch of lines taken from the async stream at once.
+ * Each dataset has its own block that is loaded in background by the worker
+ * task. Lines are parsed in parallel by the worker jobs and inserted in order
+ * by the main thread when the block is finished.
+ * */
+typedef struct {
+
+	ptask_t		task;
+	void		*bk;
+
+	int		line_A;
+	int		line_B;
+	int		changed;
+
+	int		hint[READ_COLUMN_MAX];
+	fval_t		row[READ_COLUMN_MAX];
+}
+rjob_t;
+
+typedef struct {
+
+	ptask_t		task;
+	void		*rd;
+
+	int		dN;
+	int		busy;
+	int		rc;
+
+	char		*text;
+	int		text_N;
+
+	int		line[READ_BLOCK_LINE_MAX];
+	int		count[READ_BLOCK_LINE_MAX];
+	int		line_N;
+	int		line_MAX;
+
+	fval_t		*rows;
+	int		rows_MAX;
+	int		row_N;
+	int		column_N;
+
+	char		*pack;
+	int		pack_MAX;
+	int		side_fail;
+
+	markup_t	mk;
+	char		cmap[256];
+
+	/* Private copy of hints that worker can change. The base is used to
+	 * merge the detected ones back on the main thread.
+	 * */
+	int		hint[READ_COLUMN_MAX];
+	int		hint_base[READ_COLUMN_MAX];
+
+	rjob_t		job[READ_BLOCK_JOB_MAX];
+}
+rblock_t;
+
+/* The sidecar file keeps the parsed text dataset next to the source file.
+ * Header is followed by hints and labels of columns and then by the blocks
+ * of LZ4 compressed rows. Source tail hash allows us to detect that the file
+ * was only appended since the last time.
+ * */
+typedef struct {
+
+	char			magic[8];
+	int			version;
+	int			fval_size;
+
+	unsigned long long	source_size;
+	unsigned long long	source_time;
+	unsigned long long	source_tail;
+	unsigned long long	markup;
+	unsigned long long	data_end;
+
+	int			column_N;
+	int			line_N;
+	int			row_N;
+	int			bom;
+	int			complete;
+}
+rside_t;
+
 typedef struct {
 
 	int		busy;
@@ -149,6 +247,7 @@ typedef struct {
 
 	char		screenpath[READ_FILE_PATH_MAX];
 	char		ttfname[READ_FILE_PATH_MAX];
+	char		statsfile[READ_FILE_PATH_MAX];
 
 	int		config_version;
 	int		window_size_x;
@@ -158,6 +257,7 @@ typedef struct {
 	int		timecol;
 	int		shortfilename;
 	int		fastdraw;
+	int		renderer;
 
 	markup_t	mk_config;
 	markup_t	mk_text;
@@ -168,7 +268,10 @@ typedef struct {
 
 	int		preload;
 	int		chunk;
+	int		mmap;
+	int		sidecar;
 	int		timeout;
+	int		backpressure;
 	int		length_N;
 
 	struct {
@@ -183,6 +286,19 @@ typedef struct {
 		FILE		*fd;
 		async_FILE	*afd;
 
+		/* The socket source has no FILE and is read by async only.
+		 * */
+		int		socket;
+
+		struct file_map		map;
+		unsigned long long	map_offset;
+
+		FILE			*side;
+		int			side_state;
+		int			side_row_N;
+		unsigned long long	side_offset;
+		unsigned long long	side_end;
+
 		char		buf[READ_TOKEN_MAX * READ_COLUMN_MAX];
 		fval_t		row[READ_COLUMN_MAX];
 
@@ -190,6 +306,8 @@ typedef struct {
 
 		int		hint[READ_COLUMN_MAX];
 		int		bom;
+
+		rblock_t	*block;
 	}
 	data[PLOT_DATASET_MAX];
 
@@ -18,8 +18,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include <errno.h>
+#include <math.h>
 
 #include <SDL2/SDL.h>
 
@@ -28,12 +30,334 @@
 #include "plot.h"
 #include "read.h"
 
+static void
+svgFlush(svg_t *g, int finish)
+{
+#ifdef _ZLIB
+	if (g->gzip != 0) {
+
+		g->zs.next_in = (Bytef *) g->buf;
+		g->zs.avail_in = g->buf_N;
+
+		do {
+			g->zs.next_out = (Bytef *) g->zbuf;
+			g->zs.avail_out = SVG_BUFFER_SIZE;
+
+			(void) deflate(&g->zs, (finish != 0) ? Z_FINISH : Z_NO_FLUSH);
+
+			if (fwrite(g->zbuf, 1, SVG_BUFFER_SIZE - g->zs.avail_out,
+					g->fd) != SVG_BUFFER_SIZE - g->zs.avail_out) {
+
+				g->failed = 1;
+			}
+		}
+		while (g->zs.avail_out == 0);
+
+		g->buf_N = 0;
+		return ;
+	}
+#endif /* _ZLIB */
+
+	if (g->buf_N > 0) {
+
+		if (fwrite(g->buf, 1, g->buf_N, g->fd) != g->buf_N) {
+
+			g->failed = 1;
+		}
+	}
+
+	g->buf_N = 0;
+}
+
+static void
+svgWrite(svg_t *g, const char *s, int len)
+{
+	int		n;
+
+	while (len > 0) {
+
+		if (g->buf_N >= SVG_BUFFER_SIZE) {
+
+			svgFlush(g, 0);
+		}
+
+		n = SVG_BUFFER_SIZE - g->buf_N;
+		n = (n > len) ? len : n;
+
+		memcpy(g->buf + g->buf_N, s, n);
+
+		g->buf_N += n;
+
+		s += n;
+		len -= n;
+	}
+}
+
+static void
+svgPrint(svg_t *g, const char *fmt, ...)
+{
+	va_list		ap;
+	char		ln[SVG_PRINT_MAX], *lbuf;
+	int		len;
+
+	va_start(ap, fmt);
+	len = vsnprintf(ln, sizeof(ln), fmt, ap);
+	va_end(ap);
+
+	if (len < 0)
+		return ;
+
+	if (len < sizeof(ln)) {
+
+		svgWrite(g, ln, len);
+	}
+	else {
+		lbuf = (char *) malloc(len + 1);
+
+		if (lbuf == NULL) {
+
+			g->failed = 1;
+			return ;
+		}
+
+		va_start(ap, fmt);
+		vsnprintf(lbuf, len + 1, fmt, ap);
+		va_end(ap);
+
+		svgWrite(g, lbuf, len);
+
+		free(lbuf);
+	}
+}
+
+static int
+svgNumber(char *s, int iv)
+{
+	char		rev[16];
+	int		n, len = 0;
+
+	if (iv < 0) {
+
+		s[len++] = '-';
+		iv = - iv;
+	}
+
+	n = 0;
+
+	do {
+		rev[n++] = '0' + iv % 10;
+		iv /= 10;
+
+		if (n == 1) {
+
+			rev[n++] = '.';
+		}
+	}
+	while (iv != 0 || n < 3);
+
+	while (n > 0) {
+
+		s[len++] = rev[--n];
+	}
+
+	return len;
+}
+
+static void
+svgPolyWrite(svg_t *g, double x, double y, int move)
+{
+	char		ln[40];
+	int		iX, iY, len = 0;
+
+	/* Coordinates are written with one decimal place so we drop the point
+	 * that gets the same output as the previous one.
+	 * */
+	iX = (int) floor(x * 10. + .5);
+	iY = (int) floor(y * 10. + .5);
+
+	if (		move == 0
+			&& iX == g->anchor_iX
+			&& iY == g->anchor_iY)
+		return ;
+
+	if (move != 0) {
+
+		memcpy(ln, (g->line_open != 0) ? " M " : "M ", 3);
+		len = (g->line_open != 0) ? 3 : 2;
+	}
+	else {
+		ln[len++] = ' ';
+	}
+
+	len += svgNumber(ln + len, iX);
+	ln[len++] = ',';
+	len += svgNumber(ln + len, iY);
+
+	svgWrite(g, ln, len);
+
+	g->anchor_x = x;
+	g->anchor_y = y;
+	g->anchor_iX = iX;
+	g->anchor_iY = iY;
+}
+
+static void
+svgPolyFlush(svg_t *g)
+{
+	if (g->dir_on != 0) {
+
+		/* Write out the extreme points in the order they are passed.
+		 * */
+		if (g->bwd_on != 0 && g->bwd_d < 0.) {
+
+			if (g->fwd_on < g->bwd_on) {
+
+				svgPolyWrite(g, g->fwd_x, g->fwd_y, 0);
+				svgPolyWrite(g, g->bwd_x, g->bwd_y, 0);
+			}
+			else {
+				svgPolyWrite(g, g->bwd_x, g->bwd_y, 0);
+				svgPolyWrite(g, g->fwd_x, g->fwd_y, 0);
+			}
+		}
+		else {
+			svgPolyWrite(g, g->fwd_x, g->fwd_y, 0);
+		}
+
+		g->dir_on = 0;
+	}
+
+	svgPolyWrite(g, g->last_x, g->last_y, 0);
+}
+
+static void
+svgPolyMove(svg_t *g, double x, double y)
+{
+	svgPolyWrite(g, x, y, 1);
+
+	g->last_x = x;
+	g->last_y = y;
+
+	g->dir_on = 0;
+}
+
+static void
+svgPolyPoint(svg_t *g, double x, double y)
+{
+	double		dx, dy, cross, proj, prev_x, prev_y;
+
+	prev_x = g->last_x;
+	prev_y = g->last_y;
+
+	g->last_x = x;
+	g->last_y = y;
+
+	if (g->line_d != 0) {
+
+		/* Dashed lines are written as is to keep the dash pattern.
+		 * */
+		svgPolyWrite(g, x, y, 0);
+		return ;
+	}
+
+	dx = x - g->anchor_x;
+	dy = y - g->anchor_y;
+
+	if (g->dir_on != 0) {
+
+		cross = dx * g->dir_y - dy * g->dir_x;
+		proj = dx * g->dir_x + dy * g->dir_y;
+
+		if (fabs(cross) < SVG_SIMPLIFY) {
+
+			if (proj > g->fwd_d) {
+
+				g->fwd_x = x;
+				g->fwd_y = y;
+				g->fwd_d = proj;
+				g->fwd_on = g->bwd_on + 1;
+			}
+			else if (proj < g->bwd_d) {
+
+				g->bwd_x = x;
+				g->bwd_y = y;
+				g->bwd_d = proj;
+				g->bwd_on = g->fwd_on + 1;
+			}
+
+			return ;
+		}
+
+		/* The polyline turns away so we write out the points passed
+		 * and continue from the previous one.
+		 * */
+		g->last_x = prev_x;
+		g->last_y = prev_y;
+
+		svgPolyFlush(g);
+
+		g->last_x = x;
+		g->last_y = y;
+
+		dx = x - g->anchor_x;
+		dy = y - g->anchor_y;
+	}
+
+	proj = sqrt(dx * dx + dy * dy);
+
+	if (proj < SVG_SIMPLIFY)
+		return ;
+
+	g->dir_on = 1;
+	g->dir_x = dx / proj;
+	g->dir_y = dy / proj;
+
+	g->fwd_x = x;
+	g->fwd_y = y;
+	g->fwd_d = proj;
+	g->fwd_on = 1;
+
+	g->bwd_d = 0.;
+	g->bwd_on = 0;
+}
+
+static void
+svgLineClose(svg_t *g)
+{
+	if (g->line_open != 0) {
+
+		svgPolyFlush(g);
+		svgWrite(g, "\"/>\n", 4);
+
+		g->line_open = 0;
+	}
+}
+
 svg_t *svgOpenNew(const char *file, int width, int height)
 {
 	svg_t		*g;
+	int		len, gzip;
+
+	len = strlen(file);
+	gzip = (len > 5 && strcmp(file + len - 5, ".svgz") == 0) ? 1 : 0;
+
+#ifndef _ZLIB
+	if (gzip != 0) {
+
+		ERROR("No gzip support to write \"%s\"\n", file);
+		return NULL;
+	}
+#endif /* _ZLIB */
 
 	g = (svg_t *) calloc(1, sizeof(svg_t));
-	g->fd = unified_fopen(file, "w");
+
+	if (g == NULL) {
+
+		ERROR("No memory allocated for SVG output\n");
+		return NULL;
+	}
+
+	g->fd = unified_fopen(file, (gzip != 0) ? "wb" : "w");
 
 	if (g->fd == NULL) {
 
@@ -43,7 +367,28 @@ svg_t *svgOpenNew(const char *file, int width, int height)
 		return NULL;
 	}
 
-	fprintf(g->fd, "<svg xmlns=\"http://www.w3.org/2000/svg\" "
+#ifdef _ZLIB
+	if (gzip != 0) {
+
+		/* Deflate with gzip header and trailer.
+		 * */
+		if (deflateInit2(&g->zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+					15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+
+			ERROR("deflateInit2: %s\n", (g->zs.msg != NULL)
+					? g->zs.msg : "failed");
+
+			fclose(g->fd);
+			free(g);
+
+			return NULL;
+		}
+
+		g->gzip = 1;
+	}
+#endif /* _ZLIB */
+
+	svgPrint(g, "<svg xmlns=\"http://www.w3.org/2000/svg\" "
 			"width=\"%dpx\" height=\"%dpx\"><g>\n", width, height);
 
 	g->line_open = 0;
@@ -53,15 +398,23 @@ svg_t *svgOpenNew(const char *file, int width, int height)
 
 void svgClose(svg_t *g)
 {
-	if (g->line_open != 0) {
+	svgLineClose(g);
+	svgPrint(g, "</g></svg>\n");
 
-		fprintf(g->fd, "\"/>\n");
-		g->line_open = 0;
+	svgFlush(g, 1);
+
+#ifdef _ZLIB
+	if (g->gzip != 0) {
+
+		deflateEnd(&g->zs);
 	}
+#endif /* _ZLIB */
 
-	fprintf(g->fd, "</g></svg>\n");
+	if (fclose(g->fd) != 0 || g->failed != 0) {
+
+		ERROR("Failed to write SVG output: %s\n", strerror(errno));
+	}
 
-	fclose(g->fd);
 	free(g);
 }
 
@@ -69,82 +422,82 @@ void svgDrawLine(svg_t *g, double xs, double ys, double xe, double ye, svgCol_t
 {
 	if (g->line_open != 0) {
 
-		if (xs == g->last_x && ys == g->last_y) {
+		if (		col == g->line_col && h == g->line_h
+				&& d == g->line_d && s == g->line_s) {
 
-			fprintf(g->fd, " %.1f,%.1f", xe, ye);
-		}
-		else if (xe == g->last_x && ye == g->last_y) {
+			/* Continue the polyline of the same style or start
+			 * the next subpath of the same path.
+			 * */
+			if (xs == g->last_x && ys == g->last_y) {
 
-			fprintf(g->fd, " %.1f,%.1f", xs, ys);
-		}
-		else {
-			fprintf(g->fd, "\"/>\n");
-			g->line_open = 0;
+				svgPolyPoint(g, xe, ye);
+			}
+			else if (xe == g->last_x && ye == g->last_y) {
+
+				svgPolyPoint(g, xs, ys);
+			}
+			else {
+				svgPolyFlush(g);
+				svgPolyMove(g, xs, ys);
+				svgPolyPoint(g, xe, ye);
+			}
+
+			return ;
 		}
+
+		svgLineClose(g);
 	}
 
-	if (g->line_open == 0) {
+	if (d == 0) {
 
-		if (d == 0) {
+		svgPrint(g, "<path style=\"fill:none;stroke:#%06x;stroke-width:%.1f;"
+				"stroke-linejoin:round;stroke-linecap:round\" d=\"",
+				(int) (col & 0xFFFFFF), (h != 0) ? h : 0.5);
+	}
+	else {
+		svgPrint(g, "<path style=\"fill:none;stroke:#%06x;stroke-width:%.1f;"
+				"stroke-linejoin:round;stroke-linecap:butt;"
+				"stroke-dasharray:%d,%d\" d=\"",
+				(int) (col & 0xFFFFFF), (h != 0) ? h : 0.5, d, s);
+	}
 
-			fprintf(g->fd, "<path style=\"fill:none;stroke:#%06x;stroke-width:%.1f;"
-					"stroke-linejoin:round;stroke-linecap:round\" "
-					"d=\"M %.1f,%.1f %.1f,%.1f",
-					(int) (col & 0xFFFFFF), (h != 0) ? h : 0.5, xs, ys, xe, ye);
-		}
-		else {
-			fprintf(g->fd, "<path style=\"fill:none;stroke:#%06x;stroke-width:%.1f;"
-					"stroke-linejoin:round;stroke-linecap:butt;"
-					"stroke-dasharray:%d,%d\" "
-					"d=\"M %.1f,%.1f %.1f,%.1f",
-					(int) (col & 0xFFFFFF), (h != 0) ? h : 0.5, d, s,
-					xs, ys, xe, ye);
-		}
+	g->line_col = col;
+	g->line_h = h;
+	g->line_d = d;
+	g->line_s = s;
 
-		g->line_open = 1;
-	}
+	svgPolyMove(g, xs, ys);
 
-	g->last_x = xe;
-	g->last_y = ye;
+	g->line_open = 1;
+
+	svgPolyPoint(g, xe, ye);
 }
 
 void svgDrawRect(svg_t *g, double xs, double ys, double xe, double ye, svgCol_t col)
 {
-	if (g->line_open != 0) {
+	svgLineClose(g);
 
-		fprintf(g->fd, "\"/>\n");
-		g->line_open = 0;
-	}
-
-	fprintf(g->fd, "<path style=\"fill:#%06x;stroke:none\" "
+	svgPrint(g, "<path style=\"fill:#%06x;stroke:none\" "
 			"d=\"M %.1f,%.1f %.1f,%.1f %.1f,%.1f %.1f,%.1f Z\"/>\n",
 			(int) (col & 0xFFFFFF), xs, ys, xe, ys, xe, ye, xs, ye);
 }
 
 void svgDrawCircle(svg_t *g, double xs, double ys, double r, svgCol_t col)
 {
-	if (g->line_open != 0) {
+	svgLineClose(g);
 
-		fprintf(g->fd, "\"/>\n");
-		g->line_open = 0;
-	}
-
-	fprintf(g->fd, "<circle style=\"fill:#%06x;stroke:none\" "
+	svgPrint(g, "<circle style=\"fill:#%06x;stroke:none\" "
 			"cx=\"%.1f\" cy=\"%.1f\" r=\"%.1f\"/>\n",
 			(int) (col & 0xFFFFFF), xs, ys, r);
 }
 
 void svgDrawText(svg_t *g, double xs, double ys, const char *text, svgCol_t col, int flags)
 {
-	if (g->line_open != 0) {
-
-		fprintf(g->fd, "\"/>\n");
-		g->line_open = 0;
-	}
+	svgLineClose(g);
 
 	if (flags & TEXT_VERTICAL) {
 
-		fprintf(g->fd, "<text style=\"font-family:%s;font-size:%dpx;fill:#%06x;stroke:none;"
+		svgPrint(g, "<text style=\"font-family:%s;font-size:%dpx;fill:#%06x;stroke:none;"
 				"dominant-baseline:%s;text-anchor:%s\" "
 				"transform=\"rotate(-90,%.1f,%.1f)\" "
 				"x=\"%.1f\" y=\"%.1f\">%s</text>\n",
@@ -154,7 +507,7 @@ void svgDrawText(svg_t *g, double xs, double ys, const char *text, svgCol_t col,
 				xs, ys, xs, ys, text);
 	}
 	else {
-		fprintf(g->fd, "<text style=\"font-family:%s;font-size:%dpx;fill:#%06x;stroke:none;"
+		svgPrint(g, "<text style=\"font-family:%s;font-size:%dpx;fill:#%06x;stroke:none;"
 				"dominant-baseline:%s;text-anchor:%s\" "
 				"x=\"%.1f\" y=\"%.1f\">%s</text>\n",
 				g->font_family, g->font_pt, (int) (col & 0xFFFFFF),
@@ -24,21 +24,78 @@
 
 #include <SDL2/SDL.h>
 
+#ifdef _ZLIB
+#include <zlib.h>
+#endif /* _ZLIB */
+
+#define SVG_BUFFER_SIZE		65536
+#define SVG_PRINT_MAX		1024
+
+/* Points of the polyline that stay within this distance (in pixels) from the
+ * line being drawn are dropped.
+ * */
+#define SVG_SIMPLIFY		0.2
+
 typedef Uint32		svgCol_t;
 
 typedef struct {
 
 	FILE		*fd;
 
+#ifdef _ZLIB
+	z_stream	zs;
+	int		gzip;
+
+	char		zbuf[SVG_BUFFER_SIZE];
+#endif /* _ZLIB */
+
+	char		buf[SVG_BUFFER_SIZE];
+	int		buf_N;
+
+	int		failed;
+
 	const char	*font_family;
 	int		font_pt;
 
 	int		line_open;
+	svgCol_t	line_col;
+	int		line_h;
+	int		line_d;
+	int		line_s;
+
 	double		last_x;
 	double		last_y;
+
+	/* The polyline simplification state. The anchor is the last point
+	 * that was written out, the direction is taken from the first point
+	 * that is far enough from the anchor. Until the polyline leaves the
+	 * corridor along this direction we only track the farthest points
+	 * forward and backward.
+	 * */
+	double		anchor_x;
+	double		anchor_y;
+	int		anchor_iX;
+	int		anchor_iY;
+
+	int		dir_on;
+	double		dir_x;
+	double		dir_y;
+
+	double		fwd_x;
+	double		fwd_y;
+	double		fwd_d;
+	int		fwd_on;
+
+	double		bwd_x;
+	double		bwd_y;
+	double		bwd_d;
+	int		bwd_on;
 }
 svg_t;
 
+/* Open the SVG file for writing. The output is gzip compressed if the file
+ * name ends with ".svgz".
+ * */
 svg_t *svgOpenNew(const char *file, int width, int height);
 void svgClose(svg_t *g);
 